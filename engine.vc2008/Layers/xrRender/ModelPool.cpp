@@ -378,11 +378,24 @@ void CModelPool::Prefetch()
 	string256 section;
 	strconcat				(sizeof(section),section,"prefetch_visuals_",g_pGamePersistent->m_game_params.m_game_type);
 	CInifile::Sect& sect	= pSettings->r_section(section);
+
+	// hint the file system, so the I/O threads read the files while the visuals are being created
+	// (the same search order as in Instance_Load)
+	for (CInifile::SectCIt I=sect.Data.begin(); I!=sect.Data.end(); I++)	{
+		string_path			name, fn;
+		LPCSTR N			= I->first.c_str();
+		if (0==strext(N))	strconcat	(sizeof(name),name,N,".ogf");
+		else				xr_strcpy	(name,sizeof(name),N);
+		if (FS.exist(fn,"$level$",name) || FS.exist(fn,"$game_meshes$",name))
+			FS.r_prefetch	(fn);
+	}
+
 	for (CInifile::SectCIt I=sect.Data.begin(); I!=sect.Data.end(); I++)	{
 		const CInifile::Item& item= *I;
 		dxRender_Visual* V	= Create(item.first.c_str());
 		Delete				(V,FALSE);
 	}
+	FS.r_prefetch_release	();
 	Logging					(TRUE);
 }
 
@@ -116,6 +116,15 @@ void CParticleEffect::UpdateParent(const Fmatrix& m, const Fvector& velocity, BO
 }
 
 void CParticleEffect::OnFrame(u32 frame_dt)
+{
+	for (u32 StepCount=OnFrameSteps(frame_dt); StepCount; StepCount--)	{
+		if (!OnStepBegin())	break;
+        ParticleManager()->Update(m_HandleEffect,m_HandleActionList,fDT_STEP);
+		if (!OnStepEnd())	break;
+	}
+}
+
+u32 CParticleEffect::OnFrameSteps(u32 frame_dt)
 {
 	if (m_Def && m_RT_Flags.is(flRT_Playing)){
 		m_MemDT			+= frame_dt;
@@ -128,52 +137,130 @@ void CParticleEffect::OnFrame(u32 frame_dt)
 			m_MemDT		= m_MemDT%uDT_STEP;
 			clamp		(StepCount,0,3);
 		}
-
-		for (;StepCount; StepCount--)	{
-			if (m_Def->m_Flags.is(CPEDef::dfTimeLimit)){ 
-				if (!m_RT_Flags.is(flRT_DefferedStop)){
-					m_fElapsedLimit -= fDT_STEP;
-					if (m_fElapsedLimit<0.f){
-						m_fElapsedLimit = m_Def->m_fTimeLimit;
-						Stop		(true);
-                        break;
-					}
-				}
-			}
-            ParticleManager()->Update(m_HandleEffect,m_HandleActionList,fDT_STEP);
-
-            PAPI::Particle* particles;
-            u32 p_cnt;
-            ParticleManager()->GetParticles(m_HandleEffect,particles,p_cnt);
-            
-			// our actions
-			if (m_Def->m_Flags.is(CPEDef::dfFramed|CPEDef::dfAnimated))	m_Def->ExecuteAnimate	(particles,p_cnt,fDT_STEP);
-			if (m_Def->m_Flags.is(CPEDef::dfCollision)) 				m_Def->ExecuteCollision	(particles,p_cnt,fDT_STEP,this,m_CollisionCallback);
-
-			//-move action
-			if (p_cnt)	
-			{
-				vis.box.invalidate	();
-				float p_size = 0.f;
-				for(u32 i = 0; i < p_cnt; i++){
-					Particle &m 	= particles[i]; 
-					vis.box.modify((Fvector&)m.pos);
-					if (m.size.x>p_size) p_size = m.size.x;
-					if (m.size.y>p_size) p_size = m.size.y;
-					if (m.size.z>p_size) p_size = m.size.z;
-				}
-				vis.box.grow		(p_size);
-				vis.box.getsphere	(vis.sphere.P,vis.sphere.R);
-			}
-			if (m_RT_Flags.is(flRT_DefferedStop)&&(0==p_cnt)){
-				m_RT_Flags.set		(flRT_Playing|flRT_DefferedStop,FALSE);
-				break;
-			}
-		}
+		return			(u32)StepCount;
 	} else {
 		vis.box.set			(m_InitialPosition,m_InitialPosition);
 		vis.box.grow		(EPS_L);
 		vis.box.getsphere	(vis.sphere.P,vis.sphere.R);
+		return			0;
+	}
+}
+
+BOOL CParticleEffect::OnStepBegin()
+{
+	if (m_Def->m_Flags.is(CPEDef::dfTimeLimit)){ 
+		if (!m_RT_Flags.is(flRT_DefferedStop)){
+			m_fElapsedLimit -= fDT_STEP;
+			if (m_fElapsedLimit<0.f){
+				m_fElapsedLimit = m_Def->m_fTimeLimit;
+				Stop		(true);
+				return		FALSE;
+			}
+		}
+	}
+	return				TRUE;
+}
+
+BOOL CParticleEffect::OnStepEnd()
+{
+    PAPI::Particle* particles;
+    u32 p_cnt;
+    ParticleManager()->GetParticles(m_HandleEffect,particles,p_cnt);
+    
+	// our actions
+	if (m_Def->m_Flags.is(CPEDef::dfFramed|CPEDef::dfAnimated))	m_Def->ExecuteAnimate	(particles,p_cnt,fDT_STEP);
+	if (m_Def->m_Flags.is(CPEDef::dfCollision)) 				m_Def->ExecuteCollision	(particles,p_cnt,fDT_STEP,this,m_CollisionCallback);
+
+	//-move action
+	if (p_cnt)	
+	{
+		vis.box.invalidate	();
+		float p_size = 0.f;
+		for(u32 i = 0; i < p_cnt; i++){
+			Particle &m 	= particles[i]; 
+			vis.box.modify((Fvector&)m.pos);
+			if (m.size.x>p_size) p_size = m.size.x;
+			if (m.size.y>p_size) p_size = m.size.y;
+			if (m.size.z>p_size) p_size = m.size.z;
+		}
+		vis.box.grow		(p_size);
+		vis.box.getsphere	(vis.sphere.P,vis.sphere.R);
+	}
+	if (m_RT_Flags.is(flRT_DefferedStop)&&(0==p_cnt)){
+		m_RT_Flags.set		(flRT_Playing|flRT_DefferedStop,FALSE);
+		return				FALSE;
+	}
+	return					TRUE;
+}
+
+void CParticleEffect::OnFrameBegin(u32 frame_dt, CParticleBatch& batch)
+{
+	batch.add			(this,frame_dt);
+}
+
+//------------------------------------------------------------------------------
+// class CParticleBatch
+//------------------------------------------------------------------------------
+void CParticleBatch::add(CParticleEffect* E, u32 frame_dt)
+{
+	u32 steps			= E->OnFrameSteps(frame_dt);
+	if (0==steps)		return;
+
+	item				I;
+	I.effect			= E;
+	I.steps				= steps;
+	m_items.push_back	(I);
+}
+
+void CParticleBatch::run()
+{
+	while (!m_items.empty()){
+		// the next step of every effect, the effects stopped before it drop out
+		m_updates.clear	();
+		u32 count		= 0;
+		for (u32 i=0; i<m_items.size(); ++i){
+			item& I		= m_items[i];
+			if (!I.effect->OnStepBegin())	continue;
+			PAPI::ParticleUpdate	U;
+			U.effect_id	= I.effect->GetHandleEffect();
+			U.alist_id	= I.effect->GetHandleActionList();
+			m_updates.push_back	(U);
+			m_items[count++]	= I;
+		}
+		m_items.resize	(count);
+		if (m_updates.empty())		break;
+
+		ParticleManager()->UpdateBatch(&*m_updates.begin(),m_updates.size(),fDT_STEP);
+
+		count			= 0;
+		for (u32 i=0; i<m_items.size(); ++i){
+			item& I		= m_items[i];
+			if (!I.effect->OnStepEnd() || (0==--I.steps))	continue;
+			m_items[count++]	= I;
+		}
+		m_items.resize	(count);
+	}
+}
+
+void PS::OnFrameParticles(IRenderVisual* const* visuals, const u32* dt, u32 count)
+{
+	CParticleBatch					batch;
+	xr_vector<dxParticleCustom*>	pending;
+	pending.reserve		(count);
+	for (u32 i=0; i<count; ++i){
+		dxParticleCustom* V			= static_cast<dxParticleCustom*>(visuals[i]->dcast_ParticleCustom());
+		VERIFY			(V);
+		V->OnFrameBegin	(dt[i],batch);
+		pending.push_back			(V);
+	}
+	// the groups step their children after the main effects, one more run of the batch
+	while (!pending.empty()){
+		batch.run		();
+		u32 next		= 0;
+		for (u32 i=0; i<pending.size(); ++i)
+			if (pending[i]->OnFrameNext(batch))
+				pending[next++]		= pending[i];
+		pending.resize	(next);
 	}
 }
 
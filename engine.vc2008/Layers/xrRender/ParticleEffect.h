@@ -15,6 +15,8 @@
 
 namespace PS
 {
+	class CParticleBatch;
+
 	class ECORE_API CParticleEffect: public dxParticleCustom
 	{
 //		friend void ParticleRenderStream( LPVOID lpvParams );
@@ -52,6 +54,14 @@ namespace PS
 		virtual 			~CParticleEffect	();
 
 		void	 			OnFrame				(u32 dt);
+		// OnFrame in parts for CParticleBatch : the steps due this frame, then every step
+		// around the particle manager update; FALSE means the effect has stopped stepping
+		u32					OnFrameSteps		(u32 dt);
+		BOOL				OnStepBegin			();
+		BOOL				OnStepEnd			();
+
+		virtual void		OnFrameBegin		(u32 dt, CParticleBatch& batch);
+		virtual BOOL		OnFrameNext			(CParticleBatch& batch)	{ return FALSE; }
 
 		u32					RenderTO			();
 		virtual void		Render				(float LOD);
@@ -85,6 +95,26 @@ namespace PS
 
 	    virtual u32			ParticlesCount		();
 	};
+	// effects stepped together : every step of all of them is one UpdateBatch of the particle
+	// manager, so their actions run over the task workers, the rest of the step stays on this thread
+	class ECORE_API CParticleBatch
+	{
+		struct item{
+			CParticleEffect*	effect;
+			u32					steps;
+		};
+		DEFINE_VECTOR		(item,ItemVec,ItemVecIt);
+		ItemVec				m_items;
+		xr_vector<PAPI::ParticleUpdate>	m_updates;
+	public:
+		void				add					(CParticleEffect* E, u32 dt);
+		// steps the added effects till they are done, the batch is empty after it
+		void				run					();
+	};
+
+	// the particle visuals of the frame at once, same as OnFrame of every one of them
+	void OnFrameParticles		(IRenderVisual* const* visuals, const u32* dt, u32 count);
+
     void OnEffectParticleBirth	(void* owner, u32 param, PAPI::Particle& m, u32 idx);
     void OnEffectParticleDead	(void* owner, u32 param, PAPI::Particle& m, u32 idx);
 
@@ -330,11 +330,15 @@ struct zero_vis_pred : public std::unary_function<dxRender_Visual*, bool>
 {
 	bool operator()(const dxRender_Visual* x){ return x==0; }
 };
-void CParticleGroup::SItem::OnFrame(u32 u_dt, const CPGDef::SEffect& def, Fbox& box, bool& bPlaying)
+void CParticleGroup::SItem::OnFrameBegin(u32 u_dt, CParticleBatch& batch)
+{
+    CParticleEffect* E		= static_cast<CParticleEffect*>(_effect);
+    if (E)	E->OnFrameBegin	(u_dt,batch);
+}
+void CParticleGroup::SItem::OnFrameMain(u32 u_dt, const CPGDef::SEffect& def, Fbox& box, bool& bPlaying, CParticleBatch& batch)
 {
     CParticleEffect* E		= static_cast<CParticleEffect*>(_effect);
     if (E){
-        E->OnFrame			(u_dt);
         if (E->IsPlaying()){
             bPlaying		= true;
             if (E->vis.box.is_valid())     box.merge	(E->vis.box);
@@ -355,12 +359,20 @@ void CParticleGroup::SItem::OnFrame(u32 u_dt, const CPGDef::SEffect& def, Fbox&
             }
         }
     }
+    // the children started by the births above are stepped this frame too
+    VisualVecIt it;
+    for (it=_children_related.begin(); it!=_children_related.end(); it++)
+        if (*it)	static_cast<CParticleEffect*>(*it)->OnFrameBegin(u_dt,batch);
+    for (it=_children_free.begin(); it!=_children_free.end(); it++)
+        if (*it)	static_cast<CParticleEffect*>(*it)->OnFrameBegin(u_dt,batch);
+}
+void CParticleGroup::SItem::OnFrameChildren(const CPGDef::SEffect& def, Fbox& box, bool& bPlaying)
+{
     VisualVecIt it;
     if (!_children_related.empty()){
         for (it=_children_related.begin(); it!=_children_related.end(); it++){
             CParticleEffect* E	= static_cast<CParticleEffect*>(*it);
             if (E){
-                E->OnFrame		(u_dt);
                 if (E->IsPlaying()){
                     bPlaying	= true;
                     if (E->vis.box.is_valid())     box.merge	(E->vis.box);
@@ -377,7 +389,6 @@ void CParticleGroup::SItem::OnFrame(u32 u_dt, const CPGDef::SEffect& def, Fbox&
         for (it=_children_free.begin(); it!=_children_free.end(); it++){
             CParticleEffect* E	= static_cast<CParticleEffect*>(*it);
             if (E){
-                E->OnFrame		(u_dt);
                 if (E->IsPlaying()){ 
                     bPlaying	= true;
                     if (E->vis.box.is_valid()) box.merge	(E->vis.box);
@@ -429,6 +440,9 @@ u32	CParticleGroup::SItem::ParticlesCount()
 CParticleGroup::CParticleGroup()
 {
 	m_RT_Flags.zero			();
+	m_FrameStage			= 0;
+	m_FrameDT				= 0;
+	m_FramePlaying			= false;
 	m_InitialPosition.set	(0,0,0);
 }
 
@@ -441,6 +455,15 @@ CParticleGroup::~CParticleGroup()
 
 void CParticleGroup::OnFrame(u32 u_dt)
 {
+	CParticleBatch		batch;
+	OnFrameBegin		(u_dt,batch);
+	do batch.run		();
+	while (OnFrameNext(batch));
+}
+
+void CParticleGroup::OnFrameBegin(u32 u_dt, CParticleBatch& batch)
+{
+	m_FrameStage		= 0;
 	if (m_Def&&m_RT_Flags.is(flRT_Playing)){
         float ct	= m_CurrentTime;
         float f_dt	= float(u_dt)/1000.f;
@@ -462,23 +485,43 @@ void CParticleGroup::OnFrame(u32 u_dt)
         if ((m_CurrentTime>m_Def->m_fTimeLimit)&&(m_Def->m_fTimeLimit>0.f))
             if (!m_RT_Flags.is(flRT_DefferedStop)) Stop(true);
 
-        bool bPlaying = false;
-        Fbox box; box.invalidate();
+        m_FrameStage		= 1;
+        m_FrameDT			= u_dt;
+        m_FramePlaying		= false;
+        m_FrameBox.invalidate();
         for (SItemVecIt i_it=items.begin(); i_it!=items.end(); i_it++) 
-        	i_it->OnFrame(u_dt,*m_Def->m_Effects[i_it-items.begin()],box,bPlaying);
+        	i_it->OnFrameBegin(u_dt,batch);
+	} else {
+		vis.box.set			(m_InitialPosition,m_InitialPosition);
+		vis.box.grow		(EPS_L);
+		vis.box.getsphere	(vis.sphere.P,vis.sphere.R);
+	}
+}
+
+BOOL CParticleGroup::OnFrameNext(CParticleBatch& batch)
+{
+	switch (m_FrameStage){
+	case 1:
+		// the main effects are stepped, the children follow them
+        for (SItemVecIt i_it=items.begin(); i_it!=items.end(); i_it++) 
+        	i_it->OnFrameMain(m_FrameDT,*m_Def->m_Effects[i_it-items.begin()],m_FrameBox,m_FramePlaying,batch);
+		m_FrameStage		= 2;
+		return				TRUE;
+	case 2:
+        for (SItemVecIt i_it=items.begin(); i_it!=items.end(); i_it++) 
+        	i_it->OnFrameChildren(*m_Def->m_Effects[i_it-items.begin()],m_FrameBox,m_FramePlaying);
+		m_FrameStage		= 0;
 
-        if (m_RT_Flags.is(flRT_DefferedStop)&&!bPlaying){
+        if (m_RT_Flags.is(flRT_DefferedStop)&&!m_FramePlaying){
             m_RT_Flags.set		(flRT_Playing|flRT_DefferedStop,FALSE);
         }
-        if (box.is_valid()){
-        	vis.box.set			(box);
+        if (m_FrameBox.is_valid()){
+        	vis.box.set			(m_FrameBox);
 			vis.box.getsphere	(vis.sphere.P,vis.sphere.R);
 		}
-	} else {
-		vis.box.set			(m_InitialPosition,m_InitialPosition);
-		vis.box.grow		(EPS_L);
-		vis.box.getsphere	(vis.sphere.P,vis.sphere.R);
+		return				FALSE;
 	}
+	return					FALSE;
 }
 
 void CParticleGroup::UpdateParent(const Fmatrix& m, const Fvector& velocity, BOOL bXFORM)
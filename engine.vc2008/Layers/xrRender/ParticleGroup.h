@@ -7,6 +7,7 @@
 namespace PS
 {
 	class CParticleEffect;
+	class CParticleBatch;
 
 	class ECORE_API CPGDef
 	{
@@ -96,7 +97,10 @@ namespace PS
             void			StartFreeChild		(CParticleEffect* emitter, LPCSTR eff_name, PAPI::Particle& m);
 
             void 			UpdateParent	(const Fmatrix& m, const Fvector& velocity, BOOL bXFORM);
-            void			OnFrame			(u32 u_dt, const CPGDef::SEffect& def, Fbox& box, bool& bPlaying);
+            // the main effect is stepped first, its particles lead the children stepped after it
+            void			OnFrameBegin	(u32 u_dt, CParticleBatch& batch);
+            void			OnFrameMain		(u32 u_dt, const CPGDef::SEffect& def, Fbox& box, bool& bPlaying, CParticleBatch& batch);
+            void			OnFrameChildren	(const CPGDef::SEffect& def, Fbox& box, bool& bPlaying);
 
             u32				ParticlesCount	();
             BOOL			IsPlaying		();
@@ -111,10 +115,18 @@ namespace PS
 			flRT_DefferedStop	= (1<<1),
 		};
 		Flags8				m_RT_Flags;
+	protected:
+		// the frame in progress over the batch
+		u32					m_FrameStage;
+		u32					m_FrameDT;
+		bool				m_FramePlaying;
+		Fbox				m_FrameBox;
 	public:
 		CParticleGroup	();
 		virtual				~CParticleGroup	();
 		virtual void	 	OnFrame			(u32 dt);
+		virtual void		OnFrameBegin	(u32 dt, CParticleBatch& batch);
+		virtual BOOL		OnFrameNext		(CParticleBatch& batch);
 
 		virtual void		Copy			(dxRender_Visual* pFrom) {FATAL("Can't duplicate particle system - NOT IMPLEMENTED");}
 
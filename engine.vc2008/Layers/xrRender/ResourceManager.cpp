@@ -337,10 +337,32 @@ void CResourceManager::Delete(const Shader* S)
 void CResourceManager::DeferredUpload()
 {
 	if (!RDEVICE.b_is_Ready) return;
+
+	// hint the file system, so the I/O threads read the files while the textures are being created
+	// (the same search order as in texture_load); the loaded textures keep their surfaces and
+	// the dedicated server does not read the texture files at all
+#ifndef _EDITOR
+	if (!g_dedicated_server)
+#endif
+	for (map_TextureIt t=m_textures.begin(); t!=m_textures.end(); t++)
+	{
+		CTexture		*T = t->second;
+		if (T->flags.bLoaded || (0==stricmp(*T->cName,"$null")) || (0!=strstr(*T->cName,"$user$")))
+			continue;
+
+		string_path		fname, fn;
+		xr_strcpy		(fname,*T->cName);
+		fix_texture_name(fname);
+		if (FS.exist(fn,"$level$",fname,".dds") || FS.exist(fn,"$game_saves$",fname,".dds") || FS.exist(fn,"$game_textures$",fname,".dds"))
+			FS.r_prefetch	(fn);
+	}
+
 	for (map_TextureIt t=m_textures.begin(); t!=m_textures.end(); t++)
 	{
 		t->second->Load();
 	}
+
+	FS.r_prefetch_release	();
 }
 /*
 void	CResourceManager::DeferredUnload	()
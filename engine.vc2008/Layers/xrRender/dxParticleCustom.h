@@ -5,6 +5,8 @@
 #include "../../Include/xrRender/ParticleCustom.h"
 #include "FBasicVisual.h"
 //---------------------------------------------------------------------------
+namespace PS { class CParticleBatch; }
+
 class 	dxParticleCustom		: public dxRender_Visual, public IParticleCustom
 {
 public:
@@ -14,6 +16,11 @@ public:
 	virtual 		~dxParticleCustom	(){;}
 
 	virtual IParticleCustom*	dcast_ParticleCustom	()				{ return this;	}
+
+	// OnFrame over PS::CParticleBatch : OnFrameBegin adds the effects to the batch, OnFrameNext is
+	// called after every run of it and returns TRUE when it has added more effects
+	virtual void				OnFrameBegin			(u32 dt, PS::CParticleBatch& batch)	= 0;
+	virtual BOOL				OnFrameNext				(PS::CParticleBatch& batch)			= 0;
 };
 
 //---------------------------------------------------------------------------
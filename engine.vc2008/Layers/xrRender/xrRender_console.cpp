@@ -231,6 +231,8 @@ float		ps_r2_gloss_factor			= 4.0f;
 #ifndef _EDITOR
 #include	"../../xrEngine/xr_ioconsole.h"
 #include	"../../xrEngine/xr_ioc_cmd.h"
+#include	"../../xrCore/task_scheduler.h"
+#include	"ParticleEffect.h"
 
 #if defined(USE_DX10) || defined(USE_DX11)
 #include "../xrRenderDX10/StateManager/dx10SamplerStateCache.h"
@@ -345,6 +347,160 @@ public:
 	}
 };
 
+// every effect of the library updated headless (no render, no callbacks) for a number of frames,
+// with the scalar actions and with the SSE stream kernels
+class CCC_ParticlesBenchmark : public IConsole_Command
+{
+	float		run				(u32 frames, u64& particles)
+	{
+		PAPI::IParticleManager*	PM = PAPI::ParticleManager();
+		xr_vector<int>			effects;
+		xr_vector<int>			lists;
+		// both runs take the same random numbers, the effects are seeded on creation
+		::Random.seed			(0x5eed);
+		for (PS::PEDIt I=RImplementation.PSLibrary.FirstPED(), E=RImplementation.PSLibrary.LastPED(); I!=E; ++I) {
+			int					effect = PM->CreateEffect(1);
+			int					list = PM->CreateActionList();
+			IReader				F((*I)->m_Actions.pointer(),(*I)->m_Actions.size());
+			PM->LoadActions		(list,F);
+			PM->SetMaxParticles	(effect,(*I)->m_MaxParticles);
+			PM->PlayEffect		(effect,list);
+			PM->Transform		(list,Fidentity,Fvector().set(0.f,0.f,0.f));
+			effects.push_back	(effect);
+			lists.push_back		(list);
+		}
+
+		particles				= 0;
+		CTimer					timer;
+		timer.Start				();
+		for (u32 frame=0; frame<frames; ++frame) {
+			for (u32 i=0; i<effects.size(); ++i) {
+				PM->Update		(effects[i],lists[i],PS::fDT_STEP);
+				particles		+= PM->GetParticlesCount(effects[i]);
+			}
+		}
+		float					time = timer.GetElapsed_sec();
+
+		for (u32 i=0; i<effects.size(); ++i) {
+			PM->DestroyEffect		(effects[i]);
+			PM->DestroyActionList	(lists[i]);
+		}
+		return					(time);
+	}
+
+public:
+	CCC_ParticlesBenchmark(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		u32						frames = 300;
+		if (args && args[0])
+			sscanf				(args,"%d",&frames);
+
+		PAPI::IParticleManager*	PM = PAPI::ParticleManager();
+		BOOL					streams = PM->GetStreams();
+		u64						scalar_particles, streams_particles;
+		PM->SetStreams			(FALSE);
+		float					scalar_time = run(frames,scalar_particles);
+		PM->SetStreams			(TRUE);
+		float					streams_time = run(frames,streams_particles);
+		PM->SetStreams			(streams);
+
+		Msg						("* particles benchmark: %d effect(s), %d frame(s)",RImplementation.PSLibrary.LastPED() - RImplementation.PSLibrary.FirstPED(),frames);
+		Msg						("*   scalar  : %10I64u particle updates, %8.1f particles/ms",scalar_particles,scalar_time > 0.f ? float(scalar_particles)/(scalar_time*1000.f) : 0.f);
+		Msg						("*   streams : %10I64u particle updates, %8.1f particles/ms, x%.2f",streams_particles,streams_time > 0.f ? float(streams_particles)/(streams_time*1000.f) : 0.f,streams_time > 0.f ? scalar_time/streams_time : 0.f);
+		if (scalar_particles != streams_particles)
+			Msg					("! particles benchmark: particle counts differ");
+	}
+	virtual void Info	(TInfo& I)
+	{
+		xr_strcpy(I,"[frames] : updates all the particle effects, scalar actions vs SSE stream kernels"); 
+	}
+};
+
+// hundreds of effects updated one by one and all at once over the task workers,
+// the birth/death callbacks are counted to see that the batch replays them all
+class CCC_ParticlesBatchBenchmark : public IConsole_Command
+{
+	struct counters
+	{
+		u32		births;
+		u32		deaths;
+	};
+
+	static void	on_birth		(void* owner, u32 , PAPI::Particle& , u32 )	{ ++static_cast<counters*>(owner)->births; }
+	static void	on_death		(void* owner, u32 , PAPI::Particle& , u32 )	{ ++static_cast<counters*>(owner)->deaths; }
+
+	float		run				(u32 effect_count, u32 frames, BOOL batch, u64& particles, counters& events)
+	{
+		PAPI::IParticleManager*	PM = PAPI::ParticleManager();
+		u32						ped_count = RImplementation.PSLibrary.LastPED() - RImplementation.PSLibrary.FirstPED();
+		xr_vector<PAPI::ParticleUpdate>	items(effect_count);
+		events.births			= 0;
+		events.deaths			= 0;
+		// every effect has its own generator seeded on creation, both runs take the same numbers
+		::Random.seed			(0x5eed);
+		for (u32 i=0; i<effect_count; ++i) {
+			PS::CPEDef*			def = *(RImplementation.PSLibrary.FirstPED() + i%ped_count);
+			items[i].effect_id	= PM->CreateEffect(1);
+			items[i].alist_id	= PM->CreateActionList();
+			IReader				F(def->m_Actions.pointer(),def->m_Actions.size());
+			PM->LoadActions		(items[i].alist_id,F);
+			PM->SetMaxParticles	(items[i].effect_id,def->m_MaxParticles);
+			PM->SetCallback		(items[i].effect_id,on_birth,on_death,&events,0);
+			PM->PlayEffect		(items[i].effect_id,items[i].alist_id);
+			PM->Transform		(items[i].alist_id,Fidentity,Fvector().set(0.f,0.f,0.f));
+		}
+
+		particles				= 0;
+		CTimer					timer;
+		timer.Start				();
+		for (u32 frame=0; frame<frames; ++frame) {
+			if (batch)
+				PM->UpdateBatch	(&*items.begin(),items.size(),PS::fDT_STEP);
+			else {
+				for (u32 i=0; i<items.size(); ++i)
+					PM->Update	(items[i].effect_id,items[i].alist_id,PS::fDT_STEP);
+			}
+			for (u32 i=0; i<items.size(); ++i)
+				particles		+= PM->GetParticlesCount(items[i].effect_id);
+		}
+		float					time = timer.GetElapsed_sec();
+
+		for (u32 i=0; i<items.size(); ++i) {
+			PM->DestroyEffect		(items[i].effect_id);
+			PM->DestroyActionList	(items[i].alist_id);
+		}
+		return					(time);
+	}
+
+public:
+	CCC_ParticlesBatchBenchmark(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		u32						effect_count = 500, frames = 300;
+		if (args && args[0])
+			sscanf				(args,"%d %d",&effect_count,&frames);
+
+		if (RImplementation.PSLibrary.LastPED() == RImplementation.PSLibrary.FirstPED()) {
+			Msg					("! particles batch benchmark: no effects in the library");
+			return;
+		}
+
+		u64						serial_particles, batch_particles;
+		counters				serial_events, batch_events;
+		float					serial_time = run(effect_count,frames,FALSE,serial_particles,serial_events);
+		float					batch_time = run(effect_count,frames,TRUE,batch_particles,batch_events);
+
+		Msg						("* particles batch benchmark: %d effect(s), %d frame(s), %d task worker(s)",effect_count,frames,TaskScheduler.worker_count());
+		Msg						("*   serial : %10I64u particle updates, %8.1f particles/ms, %d birth(s), %d death(s)",serial_particles,serial_time > 0.f ? float(serial_particles)/(serial_time*1000.f) : 0.f,serial_events.births,serial_events.deaths);
+		Msg						("*   batch  : %10I64u particle updates, %8.1f particles/ms, %d birth(s), %d death(s), x%.2f",batch_particles,batch_time > 0.f ? float(batch_particles)/(batch_time*1000.f) : 0.f,batch_events.births,batch_events.deaths,((batch_time > 0.f) && serial_particles) ? (float(batch_particles)*serial_time)/(float(serial_particles)*batch_time) : 0.f);
+		if ((serial_particles != batch_particles) || (serial_events.births != batch_events.births) || (serial_events.deaths != batch_events.deaths))
+			Msg					("! particles batch benchmark: particle counts differ");
+	}
+	virtual void Info	(TInfo& I)
+	{
+		xr_strcpy(I,"[effects] [frames] : updates the effects of the library one by one vs the batch over the task workers"); 
+	}
+};
+
 class	CCC_SSAO_Mode		: public CCC_Token
 {
 public:
@@ -675,6 +831,8 @@ void		xrRender_initconsole	()
 	CMD4(CCC_Float,		"r__wallmark_shift_v",	&ps_r__WallmarkSHIFT_V,		0.0f,	1.f		);
 	CMD1(CCC_ModelPoolStat,"stat_models"		);
 #endif // DEBUG
+	CMD1(CCC_ParticlesBenchmark,"ps_bench"		);
+	CMD1(CCC_ParticlesBatchBenchmark,"ps_batch_bench"	);
 	CMD4(CCC_Float,		"r__wallmark_ttl",		&ps_r__WallmarkTTL,			1.0f,	5.f*60.f);
 
 	CMD4(CCC_Integer,	"r__supersample",		&ps_r__Supersample,			1,		8		);
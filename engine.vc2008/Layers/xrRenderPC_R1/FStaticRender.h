@@ -179,6 +179,7 @@ public:
 	
 	// Models
 	virtual IRenderVisual*			model_CreateParticles	(LPCSTR name);
+	virtual void					models_UpdateParticles	(IRenderVisual* const* V, const u32* dt, u32 count);
 	virtual IRender_DetailModel*	model_CreateDM			(IReader*F);
 	virtual IRenderVisual*			model_Create			(LPCSTR name, IReader*data=0);
 	virtual IRenderVisual*			model_CreateChild		(LPCSTR name, IReader*data);
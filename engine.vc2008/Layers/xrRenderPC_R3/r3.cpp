@@ -10,6 +10,7 @@
 #include "../xrRender/dxRenderDeviceRender.h"
 #include "../xrRender/dxWallMarkArray.h"
 #include "../xrRender/dxUIShader.h"
+#include "../xrRender/ParticleEffect.h"
 
 #include "..\xrRenderDX10\3DFluid\dx103DFluidManager.h"
 
@@ -539,6 +540,7 @@ IRenderVisual*			CRender::model_CreateParticles	(LPCSTR name)
 		return				Models->CreatePG	(SG);
 	}
 }
+void					CRender::models_UpdateParticles	(IRenderVisual* const* V, const u32* dt, u32 count)	{ PS::OnFrameParticles(V,dt,count);	}
 void					CRender::models_Prefetch		()					{ Models->Prefetch	();}
 void					CRender::models_Clear			(BOOL b_complete)	{ Models->ClearPool	(b_complete);}
 
@@ -20,17 +20,28 @@ void	light::gi_generate	()
 	Fvector*	verts	= g_pGameLevel->ObjectSpace.GetStaticVerts	();
 	xrc.ray_options		(CDB::OPT_CULL|CDB::OPT_ONLYNEAREST);
 
-	for (int it=0; it<int(indirect_photons*8); it++)	{
-		Fvector	dir,idir;
+	if (!indirect_photons)	return;
+
+	// all the photons start at the light, so they are traced as ray packets
+	xr_vector<CDB::RAY>	rays	(indirect_photons*8);
+	for (u32 it=0; it<rays.size(); it++)	{
+		Fvector&	dir		= rays[it].dir;
 		switch	(flags.type)		{
 		case IRender_Light::POINT		:	dir.random_dir(random);					break;
 		case IRender_Light::SPOT		:	dir.random_dir(direction,cone,random);	break;
 		case IRender_Light::OMNIPART	:	dir.random_dir(direction,cone,random);	break;
 		}
 		dir.normalize		();
-		xrc.ray_query		(model,position,dir,range);
-		if (!xrc.r_count()) continue;
-		CDB::RESULT *R		= RImplementation.Sectors_xrc.r_begin	();
+		rays[it].start		= position;
+		rays[it].range		= range;
+	}
+	xrc.ray_packet_query	(model,&*rays.begin(),rays.size());
+
+	for (u32 it=0; it<rays.size(); it++)	{
+		if (!xrc.r_packet_count(it)) continue;
+		const Fvector&	dir	= rays[it].dir;
+		Fvector		idir;
+		CDB::RESULT *R		= xrc.r_packet_begin	(it);
 		CDB::TRI&	T		= tris[R->id];
 		Fvector		Tv[3]	= { verts[T.verts[0]],verts[T.verts[1]],verts[T.verts[2]] };
 		Fvector		TN;		TN.mknormal		(Tv[0],Tv[1],Tv[2]);
@@ -2,6 +2,7 @@
 #pragma hdrstop
 
 #include "render.h"
+#include "../../Layers/xrRender/ParticleEffect.h"
 #include "ResourceManager.h"
 #include "../../Include/xrAPI/xrAPI.h"
 //---------------------------------------------------------------------------
@@ -106,6 +107,11 @@ IRenderVisual*			CRender::model_CreateParticles	(LPCSTR name)
 	}
 }
 
+void					CRender::models_UpdateParticles	(IRenderVisual* const* V, const u32* dt, u32 count)
+{
+	PS::OnFrameParticles	(V,dt,count);
+}
+
 void	CRender::rmNear		()
 {
 	CRenderTarget* T	=	getTarget	();
@@ -87,6 +87,7 @@ public:
 	virtual IRenderVisual*	model_CreateChild		(LPCSTR name, IReader* data);
 	virtual IRenderVisual*	model_CreatePE			(LPCSTR name);
 	virtual IRenderVisual*	model_CreateParticles	(LPCSTR name);
+	virtual void			models_UpdateParticles	(IRenderVisual* const* V, const u32* dt, u32 count);
 
     virtual IRender_DetailModel*	model_CreateDM		(IReader* R);
 	virtual IRenderVisual*	model_Duplicate			(IRenderVisual* V);
@@ -30,6 +30,9 @@ int __cdecl main	(int argc, char* argv[])
 			printf("-diff /? option to get information about creating difference.\n");
 			printf("-fast	- fast compression.\n");
 			printf("-store	- store files. No compression.\n");
+			printf("-threads <count> - compression threads, default is the number of logical CPUs.\n");
+			printf("-verify	- compare the output with the single threaded one built without the cache.\n");
+			printf("-cache <file_name> - (quoted if it has spaces) reuse compressed files of the previous run (incremental repack).\n");
 			printf("-ltx <file_name.ltx> - pathes to compress.\n");
 			printf("\n");
 			printf("LTX format:\n");
@@ -52,6 +55,22 @@ int __cdecl main	(int argc, char* argv[])
 		FS.append_path	("$working_folder$","",0,false);
 
 		C.SetFastMode	(NULL!=strstr(params,"-fast"));
+		C.SetVerify		(NULL!=strstr(params,"-verify"));
+
+		u32 thread_count	= CPU::ID.n_threads;
+		if (strstr(params,"-threads "))
+			sscanf			(strstr(params,"-threads ")+9,"%d",&thread_count);
+		C.SetThreadCount	(thread_count);
+
+		// the cache name is taken from argv : the quoted path may contain spaces
+		for (int i=2; i<argc-1; ++i)
+		{
+			if (xr_strcmp(argv[i],"-cache"))
+				continue;
+
+			C.SetCacheName	(argv[i+1]);
+			break;
+		}
 		C.SetTargetName	(argv[1]);
 
 		LPCSTR p		= strstr(params,"-ltx");
@@ -25,6 +25,21 @@ xrCompressor::xrCompressor()
 
 	XRP_MAX_SIZE	= 1024*1024*640; // bytes (640Mb)
 
+	thread_count	= 1;
+	bVerify			= false;
+	bytesSRC_total	= 0;
+	sem_read		= NULL;
+	event_compressed= NULL;
+	event_written	= NULL;
+	jobs_taken		= 0;
+	jobs_written	= 0;
+	bytes_in_flight	= 0;
+	threads_alive	= 0;
+	cache_file		= NULL;
+	cache_writer	= NULL;
+	cache_hits		= 0;
+	cache_misses	= 0;
+
 //	g_temporary_stuff	= &trivial_encryptor::decode;
 //	g_dummy_stuff		= &trivial_encryptor::encode;
 }
@@ -115,6 +130,7 @@ bool xrCompressor::testVFS(LPCSTR path)
 bool xrCompressor::testEqual(LPCSTR path, IReader* base)
 {
 	bool res			= false;
+	xrCriticalSection::raii	lock(&fs_lock);
 	IReader*	test	= FS.r_open	(path);
 
 	if(test->length() == base->length())
@@ -173,31 +189,102 @@ void xrCompressor::write_file_header(LPCSTR file_name, const u32 &crc, const u32
 	fs_desc.w			(buffer_start,full_buffer_size);
 }
 
-void xrCompressor::CompressOne(LPCSTR path)
+void xrCompressor::ReadOne(COMPRESS_JOB& job)
 {
-	filesTOTAL		++;
-
-	if (testSKIP(path))	
+	job.src					= NULL;
+	job.status				= jobOK;
+	job.crc					= 0;
+	job.modif				= 0;
+	job.c_data				= NULL;
+	job.c_size_compressed	= 0;
+	job.c_ticks				= 0;
+	job.cached				= false;
+	job.ready				= 0;
+
+	if (testSKIP(job.path))
 	{
-		filesSKIP	++;
-		printf		(" - a SKIP");
-		Msg			("%-80s   - SKIP",path);
+		job.status		= jobSKIP;
 		return;
 	}
 
 	string_path		fn;				
-	strconcat		(sizeof(fn), fn, target_name.c_str(), "\\", path);
+	strconcat		(sizeof(fn), fn, target_name.c_str(), "\\", job.path);
 
 	if (::GetFileAttributes(fn)==u32(-1))
+	{
+		job.status		= jobCANT_OPEN;
+		return;
+	}
+
+	{
+		xrCriticalSection::raii	lock(&fs_lock);
+		job.src			= FS.r_open	(fn);
+		const CLocatorAPI::file* desc = job.src ? FS.exist(fn) : NULL;
+		job.modif		= desc ? desc->modif : 0;
+	}
+	if (0==job.src)
+	{
+		job.status		= jobCANT_OPEN;
+		return;
+	}
+
+	job.crc			= crc32		(job.src->pointer(),job.src->length());
+
+	if (cache_file && NeedCompression(job))
+		TakeFromCache	(job);
+}
+
+bool xrCompressor::NeedCompression(const COMPRESS_JOB& job)
+{
+	return			(job.status==jobOK) && !testVFS(job.path) && (0!=job.src->length());
+}
+
+void xrCompressor::CompressJob(COMPRESS_JOB& job, u8* heap)
+{
+	VERIFY			(NeedCompression(job) && !job.c_data);
+
+	CTimer			timer;
+	timer.Start		();
+
+	u32 c_size_real			=	job.src->length();
+	u32 c_size_max			=	rtc_csize		(c_size_real);
+	job.c_data				=	xr_alloc<u8>	(c_size_max);
+	job.c_size_compressed	=	c_size_max;
+	if (bFast)
+	{		
+		R_ASSERT(LZO_E_OK == lzo1x_1_compress	((u8*)job.src->pointer(),c_size_real,job.c_data,&job.c_size_compressed,heap));
+	}else
+	{
+		R_ASSERT(LZO_E_OK == lzo1x_999_compress	((u8*)job.src->pointer(),c_size_real,job.c_data,&job.c_size_compressed,heap));
+	}
+
+	// Compressed OK - optimize
+	if (!bFast && ((job.c_size_compressed+16) < c_size_real))
+	{
+		u8*		c_out	= xr_alloc<u8>	(c_size_real);
+		u32		c_orig	= c_size_real;
+		R_ASSERT		(LZO_E_OK	== lzo1x_optimize	(job.c_data,job.c_size_compressed,c_out,&c_orig, NULL));
+		R_ASSERT		(c_orig		== c_size_real		);
+		xr_free			(c_out);
+	}//bFast
+
+	job.c_ticks		= timer.GetElapsed_ticks();
+}
+
+void xrCompressor::WriteOne(COMPRESS_JOB& job)
+{
+	LPCSTR			path = job.path;
+	filesTOTAL		++;
+
+	if (jobSKIP==job.status)	
 	{
 		filesSKIP	++;
-		printf		(" - CAN'T OPEN");
-		Msg			("%-80s   - CAN'T OPEN",path);
+		printf		(" - a SKIP");
+		Msg			("%-80s   - SKIP",path);
 		return;
 	}
 
-	IReader*		src				=	FS.r_open	(fn);
-	if (0==src)
+	if (jobCANT_OPEN==job.status)
 	{
 		filesSKIP	++;
 		printf		(" - CAN'T OPEN");
@@ -205,8 +292,12 @@ void xrCompressor::CompressOne(LPCSTR path)
 		return;
 	}
 
+	string_path		fn;				
+	strconcat		(sizeof(fn), fn, target_name.c_str(), "\\", path);
+
+	IReader*		src				=	job.src;
 	bytesSRC						+=	src->length	();
-	u32			c_crc32				=	crc32		(src->pointer(),src->length());
+	u32			c_crc32				=	job.crc;
 	u32			c_ptr				=	0;
 	u32			c_size_real			=	0;
 	u32			c_size_compressed	=	0;
@@ -244,21 +335,22 @@ void xrCompressor::CompressOne(LPCSTR path)
 			c_size_real			=	src->length();
 			if (0!=c_size_real)
 			{
-				u32 c_size_max		=	rtc_csize		(src->length());
-				u8*	c_data			=	xr_alloc<u8>	(c_size_max);
+				// parallel stage or the cache has done it already
+				if (!job.c_data)
+					CompressJob		(job,c_heap);
 
-				t_compress.Begin	();
+				if (job.cached)
+					cache_hits		++;
+				else
+					cache_misses	++;
 
-				c_size_compressed	= c_size_max;
-				if (bFast)
-				{		
-					R_ASSERT(LZO_E_OK == lzo1x_1_compress	((u8*)src->pointer(),c_size_real,c_data,&c_size_compressed,c_heap));
-				}else
+				if (g_bEnableStatGather)
 				{
-					R_ASSERT(LZO_E_OK == lzo1x_999_compress	((u8*)src->pointer(),c_size_real,c_data,&c_size_compressed,c_heap));
+					t_compress.count	++;
+					t_compress.accum	+= job.c_ticks;
 				}
 
-				t_compress.End		();
+				c_size_compressed	= job.c_size_compressed;
 
 				if ((c_size_compressed+16) >= c_size_real)
 				{
@@ -270,22 +362,10 @@ void xrCompressor::CompressOne(LPCSTR path)
 					Msg					("%-80s   - VFS (R)",path);
 				} else 
 				{
-					// Compressed OK - optimize
-					if (!bFast)
-					{
-						u8*		c_out	= xr_alloc<u8>	(c_size_real);
-						u32		c_orig	= c_size_real;
-						R_ASSERT		(LZO_E_OK	== lzo1x_optimize	(c_data,c_size_compressed,c_out,&c_orig, NULL));
-						R_ASSERT		(c_orig		== c_size_real		);
-						xr_free			(c_out);
-					}//bFast
-					fs_pack_writer->w	(c_data,c_size_compressed);
+					fs_pack_writer->w	(job.c_data,c_size_compressed);
 					printf				("%3.1f%%",	100.f*float(c_size_compressed)/float(src->length()));
 					Msg					("%-80s   - OK (%3.1f%%)",path,100.f*float(c_size_compressed)/float(src->length()));
 				}
-
-				// cleanup
-				xr_free		(c_data);
 			}else
 			{ //0!=c_size_real
 				filesVFS				++;
@@ -296,6 +376,14 @@ void xrCompressor::CompressOne(LPCSTR path)
 		}//test VFS
 	} //(A)
 
+	// cleanup
+	if (job.c_data)
+	{
+		if (cache_writer)
+			PutToCache		(job);
+		xr_free				(job.c_data);
+	}
+
 	// Write description
 	write_file_header		(path,c_crc32,c_ptr,c_size_real,c_size_compressed);
 
@@ -311,20 +399,26 @@ void xrCompressor::CompressOne(LPCSTR path)
 		aliases.insert		(mk_pair(R.c_size_real,R));
 	}
 
-	FS.r_close	(src);
+	xrCriticalSection::raii	lock(&fs_lock);
+	FS.r_close	(job.src);
 }
 
-void xrCompressor::OpenPack(LPCSTR tgt_folder, int num)
+static void pack_volume_name(string_path& fname, LPCSTR tgt_folder, int num)
 {
-	VERIFY			(0==fs_pack_writer);
-
-	string_path		fname;
 	string128		s_num;
 #ifdef MOD_COMPRESS
 	strconcat		(sizeof(fname),fname,tgt_folder,".xdb",itoa(num,s_num,10));
 #else
 	strconcat		(sizeof(fname),fname,tgt_folder,".pack_#",itoa(num,s_num,10));
 #endif
+}
+
+void xrCompressor::OpenPack(LPCSTR tgt_folder, int num)
+{
+	VERIFY			(0==fs_pack_writer);
+
+	string_path		fname;
+	pack_volume_name(fname,tgt_folder,num);
 	unlink			(fname);
 	fs_pack_writer	= FS.w_open	(fname);
 	fs_desc.clear	();
@@ -392,6 +486,7 @@ void xrCompressor::ClosePack()
 	fs_pack_writer->close_chunk	(); 
 	// save list
 	bytesDST		= fs_pack_writer->tell	();
+	bytesSRC_total	+= bytesSRC;
 	Msg				("...Writing pack desc");
 
 	fs_pack_writer->w_chunk		(1|CFS_CompressMark, fs_desc.pointer(),fs_desc.size());
@@ -419,38 +514,367 @@ void xrCompressor::ClosePack()
 		);
 }
 
-void xrCompressor::PerformWork()
+void xrCompressor::NextFile(u32 it, int& pack_num, LPCSTR pack_name)
 {
-	if (!files_list->empty() && target_name.size())
+	string256			caption;
+	xr_sprintf			(caption,"Compress files: %d/%d - %d%%",it,files_list->size(),(it*100)/files_list->size());
+	SetWindowText		(GetConsoleWindow(),caption);
+	printf				("\n%-80s   ",(*files_list)[it]);
+
+	if (fs_pack_writer->tell()>XRP_MAX_SIZE)
+	{
+		ClosePack		();
+		OpenPack		(pack_name, pack_num++);
+	}
+}
+
+void xrCompressor::ProcessSerial(int& pack_num, LPCSTR pack_name)
+{
+	jobs.resize			(1);
+	COMPRESS_JOB& job	= jobs.front();
+	for (u32 it=0; it<files_list->size(); it++)
 	{
-		string256		caption;
+		NextFile		(it,pack_num,pack_name);
 
-		int pack_num	= 0;
-		OpenPack		(target_name.c_str(), pack_num++);
+		job.path		= (*files_list)[it];
+		ReadOne			(job);
+		WriteOne		(job);
+	}
+	jobs.clear			();
+}
 
-		for (u32 it=0; it<folders_list->size(); it++)
-			write_file_header	((*folders_list)[it],0,0,0,0);
+// reader stage : opens files in order, keeps the amount of data in flight bounded
+void xrCompressor::reader_thread(void* _this)
+{
+	xrCompressor&		C = *(xrCompressor*)_this;
+	const LONG			max_bytes_in_flight	= 256*1024*1024;
+	const LONG			max_jobs_in_flight	= 1024;
 
-		if(!bStoreFiles)
-			c_heap			= xr_alloc<u8> (LZO1X_999_MEM_COMPRESS);
+	LONG				count = LONG(C.jobs.size());
+	for (LONG it=0; it<count; it++)
+	{
+		while ((it!=C.jobs_written) && ((C.bytes_in_flight>max_bytes_in_flight) || (it-C.jobs_written>=max_jobs_in_flight)))
+			WaitForSingleObject	(C.event_written,INFINITE);
+
+		COMPRESS_JOB&	job = C.jobs[it];
+		C.ReadOne		(job);
+		if (job.src)
+			InterlockedExchangeAdd	(&C.bytes_in_flight,job.src->length());
+
+		ReleaseSemaphore(C.sem_read,1,NULL);
+	}
+
+	InterlockedDecrement	(&C.threads_alive);
+}
+
+// compressor stage : every worker has its own LZO work heap, jobs are taken in the read order
+void xrCompressor::worker_thread(void* _this)
+{
+	xrCompressor&		C = *(xrCompressor*)_this;
+	u8*					heap = C.bStoreFiles ? NULL : xr_alloc<u8>(LZO1X_999_MEM_COMPRESS);
+
+	LONG				count = LONG(C.jobs.size());
+	for (;;)
+	{
+		WaitForSingleObject	(C.sem_read,INFINITE);
+		LONG			it = InterlockedIncrement(&C.jobs_taken) - 1;
+		if (it>=count)
+			break;
+
+		COMPRESS_JOB&	job = C.jobs[it];
+		if (C.NeedCompression(job))
+			C.CompressJob	(job,heap);
+
+		InterlockedExchange	(&job.ready,1);
+		SetEvent		(C.event_compressed);
+	}
+
+	if (heap)
+		xr_free			(heap);
+
+	InterlockedDecrement	(&C.threads_alive);
+}
 
-		for (u32 it=0; it<files_list->size(); it++)
+// writer stage : this thread, in the file order, so the archive is exactly the same as the serial one
+void xrCompressor::ProcessParallel(int& pack_num, LPCSTR pack_name, u32 threads)
+{
+	u32					count = files_list->size();
+	u32					worker_count = threads - 1;
+
+	jobs.resize			(count);
+	for (u32 it=0; it<count; it++)
+	{
+		jobs[it].path	= (*files_list)[it];
+		jobs[it].ready	= 0;
+	}
+
+	jobs_taken			= 0;
+	jobs_written		= 0;
+	bytes_in_flight		= 0;
+	threads_alive		= worker_count + 1;
+	sem_read			= CreateSemaphore(NULL,0,count + worker_count,NULL);
+	event_compressed	= CreateEvent(NULL,FALSE,FALSE,NULL);
+	event_written		= CreateEvent(NULL,FALSE,FALSE,NULL);
+	R_ASSERT			(sem_read && event_compressed && event_written);
+
+	thread_spawn		(reader_thread,"xrCompress reader",0,this);
+	for (u32 i=0; i<worker_count; i++)
+		thread_spawn	(worker_thread,"xrCompress worker",0,this);
+
+	for (u32 it=0; it<count; it++)
+	{
+		NextFile		(it,pack_num,pack_name);
+
+		COMPRESS_JOB&	job = jobs[it];
+		while (!job.ready)
+			WaitForSingleObject	(event_compressed,INFINITE);
+
+		LONG			size = job.src ? job.src->length() : 0;
+		WriteOne		(job);
+
+		InterlockedExchangeAdd	(&bytes_in_flight,-size);
+		InterlockedIncrement	(&jobs_written);
+		SetEvent		(event_written);
+	}
+
+	// release workers waiting for more jobs
+	ReleaseSemaphore	(sem_read,worker_count,NULL);
+	while (threads_alive)
+		Sleep			(1);
+
+	CloseHandle			(sem_read);
+	CloseHandle			(event_compressed);
+	CloseHandle			(event_written);
+	sem_read			= NULL;
+	event_compressed	= NULL;
+	event_written		= NULL;
+	jobs.clear			();
+}
+
+static const u32 cache_version		= 1;
+
+void xrCompressor::OpenCache()
+{
+	VERIFY				(!cache_file && !cache_writer && cache.empty());
+
+	cache_file			= fopen(cache_name.c_str(),"rb");
+	if (cache_file)
+	{
+		u32				header[2];
+		if ((2!=fread(header,sizeof(u32),2,cache_file)) || (header[0]!=cache_version) || (header[1]!=u32(bFast)))
 		{
-			xr_sprintf				(caption,"Compress files: %d/%d - %d%%",it,files_list->size(),(it*100)/files_list->size());
-			SetWindowText		(GetConsoleWindow(),caption);
-			printf				("\n%-80s   ",(*files_list)[it]);
+			Msg			("Cache '%s' is incompatible, rebuilding it",cache_name.c_str());
+			fclose		(cache_file);
+			cache_file	= NULL;
+		}
+	}
 
-			if (fs_pack_writer->tell()>XRP_MAX_SIZE)
+	// index only, payloads are read on demand by the reader stage
+	while (cache_file)
+	{
+		string_path		path;
+		u32				length = 0;
+		int				c;
+		while ((EOF!=(c=fgetc(cache_file))) && c && (length<sizeof(path)-1))
+			path[length++]	= char(c);
+		path[length]	= 0;
+		if (EOF==c)
+			break;
+
+		CACHE_ENTRY		entry;
+		u32				record[4];
+		if (4!=fread(record,sizeof(u32),4,cache_file))
+			break;
+
+		entry.size_real			= record[0];
+		entry.modif				= record[1];
+		entry.crc				= record[2];
+		entry.c_size_compressed	= record[3];
+		entry.offset			= u64(_ftelli64(cache_file));
+		cache.insert			(mk_pair(shared_str(path),entry));
+
+		if (_fseeki64(cache_file,entry.c_size_compressed,SEEK_CUR))
+			break;
+	}
+
+	if (cache_file)
+		Msg				("Cache '%s': %d compressed file(s)",cache_name.c_str(),cache.size());
+
+	// the new cache gets only the files of this run
+	string_path			new_name;
+	strconcat			(sizeof(new_name),new_name,cache_name.c_str(),".new");
+	cache_writer		= FS.w_open(new_name);
+	R_ASSERT2			(cache_writer,new_name);
+	cache_writer->w_u32	(cache_version);
+	cache_writer->w_u32	(u32(bFast));
+
+	cache_hits			= 0;
+	cache_misses		= 0;
+}
+
+void xrCompressor::CloseCache()
+{
+	if (cache_file)
+	{
+		fclose			(cache_file);
+		cache_file		= NULL;
+	}
+	cache.clear			();
+
+	FS.w_close			(cache_writer);
+
+	string_path			new_name;
+	strconcat			(sizeof(new_name),new_name,cache_name.c_str(),".new");
+	unlink				(cache_name.c_str());
+	rename				(new_name,cache_name.c_str());
+
+	printf				("\nCache: %d of %d compressed file(s) reused\n",cache_hits,cache_hits+cache_misses);
+	Msg					("Cache: %d of %d compressed file(s) reused",cache_hits,cache_hits+cache_misses);
+}
+
+void xrCompressor::TakeFromCache(COMPRESS_JOB& job)
+{
+	CACHE::const_iterator	I = cache.find(shared_str(job.path));
+	if (I==cache.end())
+		return;
+
+	const CACHE_ENTRY&	entry = I->second;
+	if ((entry.size_real!=u32(job.src->length())) || (entry.modif!=job.modif) || (entry.crc!=job.crc))
+		return;
+
+	u8*					c_data = xr_alloc<u8>(_max(entry.c_size_compressed,u32(1)));
+	if (_fseeki64(cache_file,entry.offset,SEEK_SET) || (1!=fread(c_data,entry.c_size_compressed,1,cache_file)))
+	{
+		xr_free			(c_data);
+		return;
+	}
+
+	job.c_data				= c_data;
+	job.c_size_compressed	= entry.c_size_compressed;
+	job.cached				= true;
+}
+
+void xrCompressor::PutToCache(const COMPRESS_JOB& job)
+{
+	cache_writer->w_stringZ	(job.path);
+	cache_writer->w_u32		(job.src->length());
+	cache_writer->w_u32		(job.modif);
+	cache_writer->w_u32		(job.crc);
+	cache_writer->w_u32		(job.c_size_compressed);
+	cache_writer->w			(job.c_data,job.c_size_compressed);
+}
+
+int xrCompressor::Pack(LPCSTR pack_name, u32 threads, bool use_cache)
+{
+	if (use_cache && cache_name.size())
+		OpenCache		();
+
+	int pack_num	= 0;
+	OpenPack		(pack_name, pack_num++);
+
+	for (u32 it=0; it<folders_list->size(); it++)
+		write_file_header	((*folders_list)[it],0,0,0,0);
+
+	if(!bStoreFiles)
+		c_heap			= xr_alloc<u8> (LZO1X_999_MEM_COMPRESS);
+
+	if (threads>1)
+		ProcessParallel	(pack_num,pack_name,threads);
+	else
+		ProcessSerial	(pack_num,pack_name);
+
+	ClosePack			();
+
+	if(!bStoreFiles)
+		xr_free			(c_heap);
+
+	if (cache_writer)
+		CloseCache		();
+
+	return				(pack_num);
+}
+
+bool xrCompressor::VerifyPacks(LPCSTR pack_name, LPCSTR reference_name, int pack_count)
+{
+	const u32	buffer_size	= 1024*1024;
+	u8*			buffer0		= xr_alloc<u8>(buffer_size);
+	u8*			buffer1		= xr_alloc<u8>(buffer_size);
+	bool		result		= true;
+
+	for (int num=0; result && (num<pack_count); num++)
+	{
+		string_path		fname0, fname1;
+		pack_volume_name(fname0,pack_name,num);
+		pack_volume_name(fname1,reference_name,num);
+
+		FILE*			f0 = fopen(fname0,"rb");
+		FILE*			f1 = fopen(fname1,"rb");
+		if (!f0 || !f1)
+		{
+			Msg			("! cannot open %s",f0 ? fname1 : fname0);
+			result		= false;
+		}
+
+		while (result)
+		{
+			size_t		size0 = fread(buffer0,1,buffer_size,f0);
+			size_t		size1 = fread(buffer1,1,buffer_size,f1);
+			if ((size0!=size1) || memcmp(buffer0,buffer1,size0))
 			{
-				ClosePack		();
-				OpenPack		(target_name.c_str(), pack_num++);
+				Msg		("! %s differs from %s",fname0,fname1);
+				result	= false;
 			}
-			CompressOne			((*files_list)[it]);
+			if (!size0)
+				break;
 		}
-		ClosePack				();
 
-		if(!bStoreFiles)
-			xr_free				(c_heap);
+		if (f0)			fclose(f0);
+		if (f1)			fclose(f1);
+	}
+
+	xr_free				(buffer0);
+	xr_free				(buffer1);
+	return				(result);
+}
+
+void xrCompressor::PerformWork()
+{
+	if (!files_list->empty() && target_name.size())
+	{
+		bytesSRC_total			= 0;
+		u32	dwStart				= timeGetTime();
+		int pack_count			= Pack(target_name.c_str(),thread_count,true);
+		u32	dwElapsed			= timeGetTime() - dwStart;
+		float	mb_total		= float(double(bytesSRC_total)/double(1024*1024));
+		float	sec_total		= float(_max(dwElapsed,u32(1)))/1000.f;
+
+		printf					("\n\nThroughput: %3.1f Mb/s (%3.1f Mb in %3.1f s, %d thread(s), %d volume(s))\n",mb_total/sec_total,mb_total,sec_total,thread_count,pack_count);
+		Msg						("Throughput: %3.1f Mb/s (%3.1f Mb in %3.1f s, %d thread(s), %d volume(s))",mb_total/sec_total,mb_total,sec_total,thread_count,pack_count);
+
+		if (bVerify && ((thread_count>1) || cache_name.size()))
+		{
+			// determinism check : the serial path without the cache into the side volumes, byte by byte compare
+			string_path			reference_name;
+			strconcat			(sizeof(reference_name),reference_name,target_name.c_str(),".serial");
+
+			bytesSRC_total		= 0;
+			dwStart				= timeGetTime();
+			int reference_count	= Pack(reference_name,1,false);
+			dwElapsed			= timeGetTime() - dwStart;
+			sec_total			= float(_max(dwElapsed,u32(1)))/1000.f;
+			Msg					("Serial throughput: %3.1f Mb/s (%3.1f s)",mb_total/sec_total,sec_total);
+
+			bool result			= (reference_count==pack_count) && VerifyPacks(target_name.c_str(),reference_name,pack_count);
+			printf				("\n\nVerify: %s\n",result ? "archives are identical to the serial ones" : "ARCHIVES DIFFER FROM THE SERIAL ONES");
+			Msg					("Verify: %s",result ? "archives are identical to the serial ones" : "ARCHIVES DIFFER FROM THE SERIAL ONES");
+
+			for (int num=0; result && (num<reference_count); num++)
+			{
+				string_path		fname;
+				pack_volume_name(fname,reference_name,num);
+				unlink			(fname);
+			}
+		}
 	}else 
 	{
 		Msg						("ERROR: folder not found.");
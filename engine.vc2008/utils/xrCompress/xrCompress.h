@@ -24,6 +24,54 @@ class xrCompressor
 	};
 	xr_multimap<u32,ALIAS>		aliases;
 
+	enum EJobStatus
+	{
+		jobOK,
+		jobSKIP,
+		jobCANT_OPEN,
+	};
+
+	// one file on its way from the reader stage through the compressor stage to the writer stage
+	struct	COMPRESS_JOB
+	{
+		LPCSTR			path;
+		IReader*		src;
+		EJobStatus		status;
+		u32				crc;
+		u32				modif;
+		u8*				c_data;				// compressed payload, 0 - not compressed yet
+		u32				c_size_compressed;
+		u64				c_ticks;
+		bool			cached;
+		volatile LONG	ready;
+	};
+	xr_vector<COMPRESS_JOB>		jobs;
+	xrCriticalSection			fs_lock;
+	void*						sem_read;
+	void*						event_compressed;
+	void*						event_written;
+	volatile LONG				jobs_taken;
+	volatile LONG				jobs_written;
+	volatile LONG				bytes_in_flight;
+	volatile LONG				threads_alive;
+
+	// incremental repacking : (path, size, modif, crc) -> compressed payload of the previous run
+	struct	CACHE_ENTRY
+	{
+		u32				size_real;
+		u32				modif;
+		u32				crc;
+		u32				c_size_compressed;
+		u64				offset;
+	};
+	typedef xr_map<shared_str,CACHE_ENTRY>	CACHE;
+	shared_str					cache_name;
+	CACHE						cache;
+	FILE*						cache_file;
+	IWriter*					cache_writer;
+	u32							cache_hits;
+	u32							cache_misses;
+
 	xr_vector<shared_str>		exclude_exts;
 	bool	testSKIP			(LPCSTR path);
 	ALIAS*	testALIAS			(IReader* base, u32 crc, u32& a_tests);
@@ -38,8 +86,24 @@ class xrCompressor
 	void	OpenPack			(LPCSTR tgt_folder, int num);
 	
 	void	PerformWork			();
+	int		Pack				(LPCSTR pack_name, u32 thread_count, bool use_cache);
+	void	OpenCache			();
+	void	CloseCache			();
+	void	TakeFromCache		(COMPRESS_JOB& job);
+	void	PutToCache			(const COMPRESS_JOB& job);
+	bool	VerifyPacks			(LPCSTR pack_name, LPCSTR reference_name, int pack_count);
+
+	// stages, every one of them is called in the file order except CompressJob
+	void	ReadOne				(COMPRESS_JOB& job);
+	bool	NeedCompression		(const COMPRESS_JOB& job);
+	void	CompressJob			(COMPRESS_JOB& job, u8* heap);
+	void	WriteOne			(COMPRESS_JOB& job);
+	void	NextFile			(u32 it, int& pack_num, LPCSTR pack_name);
 
-	void	CompressOne			(LPCSTR path);
+	void	ProcessSerial		(int& pack_num, LPCSTR pack_name);
+	void	ProcessParallel		(int& pack_num, LPCSTR pack_name, u32 thread_count);
+	static void	reader_thread	(void* _this);
+	static void	worker_thread	(void* _this);
 
 
 
@@ -54,6 +118,9 @@ class xrCompressor
 	u32						dwTimeStart;
 
 	u32						XRP_MAX_SIZE;
+	u32						thread_count;
+	bool					bVerify;
+	u64						bytesSRC_total;
 
 public:
 			xrCompressor		();
@@ -61,6 +128,9 @@ public:
 	void	SetFastMode			(bool b)					{bFast=b;}
 	void	SetStoreFiles		(bool b)					{bStoreFiles=b;}
 	void	SetMaxVolumeSize	(u32 sz)					{XRP_MAX_SIZE=sz;}
+	void	SetThreadCount		(u32 n)						{thread_count=n?n:1;}
+	void	SetVerify			(bool b)					{bVerify=b;}
+	void	SetCacheName		(LPCSTR n)					{cache_name=n;}
 	void	SetTargetName		(LPCSTR n)					{target_name=n;}
 	void	SetPackHeaderName	(LPCSTR n);
 
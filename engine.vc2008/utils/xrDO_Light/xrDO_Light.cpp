@@ -5,6 +5,7 @@
 #include "process.h"
 
 #include "../xrlc_light/xrlc_light.h"
+#include "../xrlc_light/task_phase.h"
 //#pragma comment(linker,"/STACK:0x800000,0x400000")
 
 #pragma comment(lib,"comctl32.lib")
@@ -26,6 +27,7 @@ static const char* h_str =
 	"-? or -h	== this help\n"
 	"-f<NAME>	== compile level in gamedata\\levels\\<NAME>\\\n"
 	"-o			== modify build options\n"
+	"-threads N	== use N threads, all the hardware ones by default\n"
 	"\n"
 	"NOTE: The last key is required for any functionality\n";
 
@@ -63,6 +65,7 @@ void Startup(LPSTR     lpCmdLine)
 	CTimer				dwStartupTime; dwStartupTime.Start();
 
 	xrCompileDO			(bNet);
+	task_phase::report	();
 
 	// Show statistic
 	char	stats[256];
@@ -84,7 +87,9 @@ int APIENTRY WinMain(HINSTANCE hInstance,
 	// Initialize debugging
 	Debug._initialize	(false);
 	Core._initialize	("xrDO");
+	task_phase::initialize	();
 	Startup				(lpCmdLine);
+	task_phase::destroy	();
 	
 	return 0;
 }
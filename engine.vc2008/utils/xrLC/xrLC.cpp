@@ -4,6 +4,7 @@
 #include "math.h"
 #include "build.h"
 #include "../xrLC_Light/xrLC_GlobalData.h"
+#include "../xrLC_Light/task_phase.h"
 
 //#pragma comment(linker,"/STACK:0x800000,0x400000")
 //#pragma comment(linker,"/HEAP:0x70000000,0x10000000")
@@ -38,6 +39,7 @@ static const char* h_str =
 	"-? or -h	== this help\n"
 	"-o			== modify build options\n"
 	"-nosun		== disable sun-lighting\n"
+	"-threads N	== use N threads, all the hardware ones by default\n"
 	"-f<NAME>	== compile level in GameData\\Levels\\<NAME>\\\n"
 	"\n"
 	"NOTE: The last key is required for any functionality\n";
@@ -144,6 +146,7 @@ void Startup(LPSTR     lpCmdLine)
 	FS.update_path			(lfn,_game_levels_,name);
 	pBuild->Run				(lfn);
 	xr_delete				(pBuild);
+	task_phase::report		();
 
 	// Show statistic
 	extern	std::string make_time(u32 sec);
@@ -180,7 +183,9 @@ int APIENTRY WinMain(HINSTANCE hInst,
 	if(strstr(Core.Params,"-nosmg"))
 		g_using_smooth_groups = false;
 
+	task_phase::initialize	();
 	Startup				(lpCmdLine);
+	task_phase::destroy	();
 	Core._destroy		();
 	
 	return 0;
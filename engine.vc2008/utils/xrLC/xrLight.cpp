@@ -11,62 +11,268 @@
 //#include "../xrLC_Light/net_task_manager.h"
 #include "../xrLC_Light/lcnet_task_manager.h"
 #include "../xrLC_Light/mu_model_light.h"
-xrCriticalSection	task_CS
-#ifdef PROFILE_CRITICAL_SECTIONS
-	(MUTEX_PROFILE_ID(task_C_S))
-#endif // PROFILE_CRITICAL_SECTIONS
-;
+#include "../xrLC_Light/task_phase.h"
 
-xr_vector<int>		task_pool;
+namespace {
 
-class CLMThread		: public CThread
+// the lightmaps larger than this are lit by the bands of rows, several threads at once
+static const u32	lm_tile_area	= 64*64;
+
+// the state of a thread while it lights, a task takes one for its duration
+struct lm_context
 {
-private:
 	HASH			H;
 	CDB::COLLIDER	DB;
 	base_lighting	LightsSelected;
+};
+
+// the large deflector being lit by its tiles
+struct lm_large
+{
+	CDeflector*		D;
+	HASH			H;
+	base_lighting	LightsSelected;
+	volatile LONG	pending;
+	bool			recalculated;
+};
+
+struct lm_tile
+{
+	lm_large*		owner;
+	u32				v_begin;
+	u32				v_end;
+};
+
+class lm_tasks
+{
+	task_phase				m_phase;
+	xrCriticalSection		m_lock;
+	xr_vector<lm_context*>	m_contexts;
+	xr_deque<lm_tile>		m_tiles;
+	u32						m_deflectors;
+
 public:
-	CLMThread	(u32 ID) : CThread(ID)
+							lm_tasks	();
+							~lm_tasks	();
+	void					run			();
+
+private:
+	void					execute		(u32 id);
+	lm_context*				acquire		();
+	void					release		(lm_context* C);
+
+	void					light		(CDeflector* D);
+	void					begin		(CDeflector* D);
+	bool					prepare		(lm_large& L);
+	void					queue_tiles	(lm_large& L);
+	void					tile		(lm_tile& T);
+	void					rows_done	(lm_large& L);
+	void					finish		(lm_large& L);
+};
+
+lm_tasks::lm_tasks		() :
+	m_phase			("LMaps",task_phase::delegate_type(this,&lm_tasks::execute)),
+#ifdef PROFILE_CRITICAL_SECTIONS
+	m_lock			(MUTEX_PROFILE_ID(lm_tasks::m_lock)),
+#endif // PROFILE_CRITICAL_SECTIONS
+	m_deflectors	(lc_global_data()->g_deflectors().size())
+{
+}
+
+lm_tasks::~lm_tasks		()
+{
+	for (u32 it=0; it<m_contexts.size(); it++)
+		xr_delete		(m_contexts[it]);
+}
+
+void lm_tasks::run		()
+{
+	vecDefl&		deflectors = lc_global_data()->g_deflectors();
+#ifndef NET_CMP	
+	for (u32 dit = 0; dit<deflectors.size(); dit++)	
+		m_phase.add		(dit,deflectors[dit]->weight());
+#else
+	m_phase.add			(14,deflectors[14]->weight());
+	m_phase.add			(16,deflectors[16]->weight());
+#endif
+	m_phase.run			();
+}
+
+// ids past the deflectors are the tiles
+void lm_tasks::execute	(u32 id)
+{
+	if (id >= m_deflectors)
 	{
-		// thMonitor= TRUE;
-		thMessages	= FALSE;
+		m_lock.Enter		();
+		lm_tile&			T = m_tiles[id - m_deflectors];
+		m_lock.Leave		();
+		tile				(T);
+		return;
 	}
 
-	virtual void	Execute()
+	CDeflector*			D = lc_global_data()->g_deflectors()[id];
+	try {
+		if (D->weight() > 2*lm_tile_area)
+			begin		(D);
+		else
+			light		(D);
+	} catch (...)
 	{
-		CDeflector* D	= 0;
+		clMsg("* ERROR: CBuild::LMapsLocal - light");
+	}
+}
 
-		for (;;) 
-		{
-			// Get task
-			task_CS.Enter		();
-			thProgress			= 1.f - float(task_pool.size())/float(lc_global_data()->g_deflectors().size());
-			if (task_pool.empty())	
-			{
-				task_CS.Leave		();
-				return;
-			}
+lm_context* lm_tasks::acquire	()
+{
+	xrCriticalSection::raii	lock(&m_lock);
+	for (u32 it=0; it<m_contexts.size(); it++)
+	{
+		if (!m_contexts[it])
+			continue;
 
-			D					= lc_global_data()->g_deflectors()[task_pool.back()];
-			task_pool.pop_back	();
-			task_CS.Leave		();
+		lm_context*		C = m_contexts[it];
+		m_contexts[it]	= 0;
+		return			C;
+	}
+	return				xr_new<lm_context>();
+}
 
-			// Perform operation
-			try {
-				D->Light	(&DB,&LightsSelected,H);
-			} catch (...)
-			{
-				clMsg("* ERROR: CLMThread::Execute - light");
-			}
-		}
+void lm_tasks::release	(lm_context* C)
+{
+	xrCriticalSection::raii	lock(&m_lock);
+	for (u32 it=0; it<m_contexts.size(); it++)
+	{
+		if (m_contexts[it])
+			continue;
+
+		m_contexts[it]	= C;
+		return;
 	}
-};
+	m_contexts.push_back(C);
+}
+
+void lm_tasks::light	(CDeflector* D)
+{
+	lm_context*			C = acquire();
+	D->Light			(&C->DB,&C->LightsSelected,C->H);
+	release				(C);
+}
+
+void lm_tasks::begin	(CDeflector* D)
+{
+	lm_large*			L = xr_new<lm_large>();
+	L->D				= D;
+	L->pending			= 0;
+	L->recalculated		= false;
+	D->L_Select			(&L->LightsSelected);
+
+	if (prepare(*L))
+		queue_tiles		(*L);
+	else
+		finish			(*L);
+}
+
+bool lm_tasks::prepare	(lm_large& L)
+{
+	try {
+		L.D->L_Prepare	(L.H);
+	} catch (...)
+	{
+		clMsg("* ERROR: CDeflector::L_Calculate");
+		return			false;
+	}
+	return				true;
+}
+
+void lm_tasks::queue_tiles	(lm_large& L)
+{
+	lm_layer&			lm = L.D->layer;
+	u32 const			rows = _max(lm_tile_area/_max(lm.width,u32(1)),u32(1));
+	u32 const			count = (lm.height + rows - 1)/rows;
+	if (!count)
+	{
+		rows_done		(L);
+		return;
+	}
+
+	// the tiles may complete while the others are being queued
+	L.pending			= count;
+	for (u32 V=0; V<lm.height; V+=rows)
+	{
+		lm_tile			T;
+		T.owner			= &L;
+		T.v_begin		= V;
+		T.v_end			= _min(V + rows,lm.height);
+
+		m_lock.Enter	();
+		u32 const		id = m_deflectors + m_tiles.size();
+		m_tiles.push_back	(T);
+		m_lock.Leave	();
+
+		m_phase.add		(id,(T.v_end - T.v_begin)*lm.width);
+	}
+}
 
+void lm_tasks::tile		(lm_tile& T)
+{
+	lm_large&			L = *T.owner;
+	lm_context*			C = acquire();
+	// every thread traces with its own copy, the lights cache the last occluders
+	C->LightsSelected	= L.LightsSelected;
+	try {
+		L.D->L_Direct_Rows	(&C->DB,&C->LightsSelected,L.H,T.v_begin,T.v_end);
+	} catch (...)
+	{
+		clMsg("* ERROR: CDeflector::L_Calculate");
+	}
+	release				(C);
 
+	if (!InterlockedDecrement(&L.pending))
+		rows_done		(L);
+}
 
+void lm_tasks::rows_done	(lm_large& L)
+{
+	lm_context*			C = acquire();
+	C->LightsSelected	= L.LightsSelected;
+	try {
+		L.D->L_Direct_Edges	(&C->DB,&C->LightsSelected);
+	} catch (...)
+	{
+		clMsg("* ERROR: CDeflector::L_Calculate");
+	}
+	release				(C);
 
+	finish				(L);
+}
 
+void lm_tasks::finish	(lm_large& L)
+{
+	lm_large*			self = &L;
+	if (!L.recalculated)
+	{
+		switch (L.D->L_Shrink())
+		{
+		case CDeflector::shrinkZero:
+			xr_delete	(self);
+			return;
+		case CDeflector::shrinkRMS:
+			// Reacalculate lightmap at lower resolution
+			L.recalculated	= true;
+			if (prepare(L))
+			{
+				queue_tiles	(L);
+				return;
+			}
+			break;
+		}
+	}
 
+	L.D->L_Expand		();
+	xr_delete			(self);
+}
+
+} // namespace
 
 void	CBuild::LMapsLocal				()
 {
@@ -79,22 +285,13 @@ void	CBuild::LMapsLocal				()
 		std::random_shuffle	(lc_global_data()->g_deflectors().begin(),lc_global_data()->g_deflectors().end());
 #endif
 
-#ifndef NET_CMP	
-for(u32 dit = 0; dit<lc_global_data()->g_deflectors().size(); dit++)	
-		task_pool.push_back(dit);
-#else
-		task_pool.push_back(14);
-		task_pool.push_back(16);
-#endif
-		
-
-		// Main process (4 threads)
+		// Main process : the largest lightmaps first, the large ones by the tiles
 		Status			("Lighting...");
-		CThreadManager	threads;
-		const	u32	thNUM	= 6;
 		CTimer	start_time;	start_time.Start();				
-		for				(int L=0; L<thNUM; L++)	threads.start(xr_new<CLMThread> (L));
-		threads.wait	(500);
+		{
+			lm_tasks	tasks;
+			tasks.run	();
+		}
 		clMsg			("%f seconds",start_time.GetElapsed_sec());
 }
 
@@ -2,20 +2,13 @@
 #define __LIGHTTHREAD_H__
 
 
-#include "xrthread.h"
 #include "detail_slot_calculate.h"
 
-class	LightThread : public CThread
+// the detail slots are lit by the rows, a row is a task of the "Details" phase
+class	DetailLightRows
 {
-	u32		Nstart, Nend;
-	DWORDVec	box_result;
 public:
-	LightThread			(u32 ID, u32 _start, u32 _end) : CThread(ID)
-	{
-		Nstart	= _start;
-		Nend	= _end;
-	}
-	virtual void		Execute();
+	void				Execute(u32 _z);
 
 };
 #endif //__LIGHTTHREAD_H__
\ No newline at end of file
@@ -1,31 +1,22 @@
 #include "stdafx.h"
 #include "../../xrEngine/xrlevel.h"
 
-#include "xrThread.h"
+#include "task_phase.h"
 
 #include "global_calculation_data.h"
 #include "lightthread.h"
 #include "xrLightDoNet.h"
 
-#define NUM_THREADS		3
-
 void	xrLight			()
 {
 	u32	range				= gl_data.slots_data.size_z();
 
-	// Start threads, wait, continue --- perform all the work
-	CThreadManager		Threads;
-	CTimer				start_time;
-	u32	stride			= range/NUM_THREADS;
-	u32	last			= range-stride*	(NUM_THREADS-1);
-	for (u32 thID=0; thID<NUM_THREADS; thID++)	{
-		CThread*	T		= xr_new<LightThread> (thID,thID*stride,thID*stride+((thID==(NUM_THREADS-1))?last:stride));
-		T->thMessages		= FALSE;
-		T->thMonitor		= FALSE;
-		Threads.start		(T);
-	}
-	Threads.wait			();
-	Msg						("%d seconds elapsed.",(start_time.GetElapsed_ms())/1000);
+	// One task per row of the slots --- perform all the work
+	DetailLightRows		rows;
+	task_phase			phase("Details",task_phase::delegate_type(&rows,&DetailLightRows::Execute));
+	for (u32 _z=0; _z<range; _z++)
+		phase.add		(_z,gl_data.slots_data.size_x());
+	phase.run			();
 }
 
 void xrCompileDO( bool net )
@@ -14,13 +14,13 @@
 //#include "mu_model_face.h"
 
 #include "xrThread.h"
+#include "task_phase.h"
 #include "../../xrcore/xrSyncronize.h"
 
 
 
 CThreadManager			mu_base;
 CThreadManager			mu_secondary;
-#define		MU_THREADS	4
 // mu-light
 bool mu_models_local_calc_lightening = false;
 xrCriticalSection		mu_models_local_calc_lightening_wait_lock;
@@ -43,26 +43,12 @@ void SetMuModelsLocalCalcLighteningCompleted()
 	mu_models_local_calc_lightening = true;
 	mu_models_local_calc_lightening_wait_lock.Leave();
 }
-class CMULight	: public CThread
+class CMULight
 {
-	u32			low;
-	u32			high;
 public:
-	CMULight	(u32 ID, u32 _low, u32 _high) : CThread(ID)	{	thMessages	= FALSE; low=_low; high=_high;	}
-
-	virtual void	Execute	()
+	void			Execute	(u32 ref)
 	{
-		// Priority
-		SetThreadPriority	(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
-		Sleep				(0);
-
-		// Light references
-		for (u32 m=low; m<high; m++)
-		{
-		
-			inlc_global_data()->mu_refs()[m]->calc_lighting	();
-			thProgress							= (float(m-low)/float(high-low));
-		}
+		inlc_global_data()->mu_refs()[ref]->calc_lighting	();
 	}
 };
 
@@ -103,16 +89,12 @@ public:
 
 		SetMuModelsLocalCalcLighteningCompleted();
 
-		// Light references
-		u32	stride			= inlc_global_data()->mu_refs().size()/MU_THREADS;
-		u32	last			= inlc_global_data()->mu_refs().size()-stride*(MU_THREADS-1);
-		u32 threads = MU_THREADS;
-		get_intervals( MU_THREADS, inlc_global_data()->mu_refs().size(), threads, stride, last );
-
-		for (u32 thID=0; thID<threads; thID++)
-			mu_secondary.start	( xr_new<CMULight> (thID,thID*stride,thID*stride + stride ) );
-		if(last > 0)
-			mu_secondary.start	( xr_new<CMULight> (threads,threads*stride,threads*stride + last ) );
+		// Light references : in the background, the progress is the one of the main thread
+		CMULight			light;
+		task_phase			phase("MU references",task_phase::delegate_type(&light,&CMULight::Execute),false);
+		for (u32 m=0; m<inlc_global_data()->mu_refs().size(); m++)
+			phase.add		(m,u32(inlc_global_data()->mu_refs()[m]->model->m_vertices.size()));
+		phase.run			();
 	}
 };
 
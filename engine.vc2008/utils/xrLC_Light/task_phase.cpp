@@ -0,0 +1,199 @@
+#include "stdafx.h"
+#include "task_phase.h"
+
+LPCSTR make_time	( string64 &buf, float fsec );
+
+namespace {
+
+struct phase_timing
+{
+	shared_str		name;
+	u32				tasks;
+	u32				threads;
+	float			wall;
+	float			busy;
+	float			longest;
+};
+
+xrCriticalSection			timings_lock
+#ifdef PROFILE_CRITICAL_SECTIONS
+	(MUTEX_PROFILE_ID(task_phase::timings_lock))
+#endif // PROFILE_CRITICAL_SECTIONS
+;
+xr_vector<phase_timing>		timings;
+
+float ticks_to_sec			( u64 ticks )
+{
+	return			float( double(ticks)/double(CPU::qpc_freq) );
+}
+
+float utilization			( phase_timing const &timing )
+{
+	float const		capacity = timing.wall*float(timing.threads);
+	return			capacity > 0.f ? 100.f*timing.busy/capacity : 100.f;
+}
+
+struct item_cost_greater
+{
+	template <typename T>
+	IC bool	operator()	( T const &item0, T const &item1 ) const
+	{
+		return		item0.cost > item1.cost;
+	}
+};
+
+} // namespace
+
+void task_phase::item::execute	()
+{
+	FPU::m64r		();
+	u64 const		start = CPU::QPC();
+	owner->m_execute( id );
+	u64 const		time = CPU::QPC() - start;
+
+	xrCriticalSection::raii	lock( &owner->m_lock );
+	owner->m_cost_done	+= cost;
+	owner->m_busy		+= time;
+	owner->m_longest	= _max( owner->m_longest, time );
+}
+
+task_phase::task_phase		(LPCSTR name, delegate_type const &execute, bool progress) :
+	m_name		( name ),
+	m_execute	( execute ),
+	m_progress	( progress ),
+#ifdef PROFILE_CRITICAL_SECTIONS
+	m_lock		( MUTEX_PROFILE_ID(task_phase::m_lock) ),
+#endif // PROFILE_CRITICAL_SECTIONS
+	m_cost_total( 0 ),
+	m_cost_done	( 0 ),
+	m_busy		( 0 ),
+	m_longest	( 0 ),
+	m_running	( false )
+{
+	VERIFY		( m_execute );
+}
+
+task_phase::~task_phase		()
+{
+	VERIFY		( m_group.done() );
+}
+
+void task_phase::add		(u32 id, u32 cost)
+{
+	xrCriticalSection::raii	lock( &m_lock );
+
+	m_items.push_back	( item() );
+	item				&I = m_items.back();
+	I.owner				= this;
+	I.id				= id;
+	I.cost				= cost;
+	m_cost_total		+= cost;
+
+	if (m_running)
+		TaskScheduler.push	( m_group, task_group::delegate_type(&I,&item::execute) );
+}
+
+void task_phase::run		()
+{
+	VERIFY				( !m_running );
+	u64 const			start = CPU::QPC();
+
+	{
+		// the tasks the running items add wait for the initial ones to be queued
+		xrCriticalSection::raii	lock( &m_lock );
+		std::stable_sort	( m_items.begin(), m_items.end(), item_cost_greater() );
+		m_running			= true;
+		for (u32 i=0, n=m_items.size(); i<n; ++i)
+			TaskScheduler.push	( m_group, task_group::delegate_type(&m_items[i],&item::execute) );
+	}
+
+	CTimer				refresh;
+	refresh.Start		();
+	float				progress = 0.f;
+	while ( !m_group.done() )
+	{
+		if ( !TaskScheduler.help() )
+			Sleep		( 1 );
+
+		if ( !m_progress || refresh.GetElapsed_ms() < 500 )
+			continue;
+
+		refresh.Start	();
+		m_lock.Enter	();
+		// the items added while running grow the total, the bar must not go back
+		if ( m_cost_total )
+			progress	= _max( progress, float(double(m_cost_done)/double(m_cost_total)) );
+		m_lock.Leave	();
+		Progress		( progress );
+	}
+
+	m_running			= false;
+	if ( m_progress )
+		Progress		( 1.f );
+
+	phase_timing		timing;
+	timing.name			= m_name;
+	timing.tasks		= m_items.size();
+	timing.threads		= TaskScheduler.worker_count() + 1;
+	timing.wall			= ticks_to_sec( CPU::QPC() - start );
+	timing.busy			= ticks_to_sec( m_busy );
+	timing.longest		= ticks_to_sec( m_longest );
+
+	string64			wall;
+	clMsg				( "* %s : %d tasks, %s, %.0f%% of %d threads busy, the longest task %.2f s",
+		*timing.name, timing.tasks, make_time(wall,timing.wall), utilization(timing), timing.threads, timing.longest );
+
+	// a phase run for every implicit lightmap is reported once
+	xrCriticalSection::raii	lock( &timings_lock );
+	xr_vector<phase_timing>::iterator	I = timings.begin();
+	xr_vector<phase_timing>::iterator	E = timings.end();
+	for ( ; I != E; ++I )
+	{
+		if ( I->name != timing.name )
+			continue;
+
+		I->tasks		+= timing.tasks;
+		I->wall			+= timing.wall;
+		I->busy			+= timing.busy;
+		I->longest		= _max( I->longest, timing.longest );
+		return;
+	}
+	timings.push_back	( timing );
+}
+
+void task_phase::initialize	()
+{
+	// -threads N : N compiler threads, the calling one including
+	u32					worker_count = u32(-1);
+	LPCSTR				threads = strstr( Core.Params, "-threads " );
+	if ( threads )
+	{
+		int				count = 0;
+		sscanf			( threads + xr_strlen("-threads "), "%d", &count );
+		worker_count	= u32( _max(count,1) - 1 );
+	}
+
+	TaskScheduler.initialize	( worker_count );
+}
+
+void task_phase::destroy	()
+{
+	TaskScheduler.destroy	();
+}
+
+void task_phase::report		()
+{
+	xrCriticalSection::raii	lock( &timings_lock );
+	if ( timings.empty() )
+		return;
+
+	clMsg				( "* Phase timing (the background phases overlap the others):" );
+	xr_vector<phase_timing>::const_iterator	I = timings.begin();
+	xr_vector<phase_timing>::const_iterator	E = timings.end();
+	for ( ; I != E; ++I )
+	{
+		string64		wall, busy;
+		clMsg			( "*   %-24s : %6d tasks, %s wall, %s busy, %3.0f%% of %d threads, the longest task %.2f s",
+			*I->name, I->tasks, make_time(wall,I->wall), make_time(busy,I->busy), utilization(*I), I->threads, I->longest );
+	}
+}
@@ -0,0 +1,56 @@
+#ifndef	_TASK_PHASE_H_
+#define	_TASK_PHASE_H_
+
+#include "../../xrCore/task_scheduler.h"
+
+// The work items of a compiler phase, executed on the xrCore task scheduler : the items are
+// queued largest first, the idle workers steal from the busy ones, the calling thread helps
+// and updates the progress. The phase timing is logged and kept for task_phase::report.
+class XRLC_LIGHT_API task_phase
+{
+public:
+	typedef fastdelegate::FastDelegate1<u32>	delegate_type;
+
+private:
+	struct item
+	{
+		task_phase*		owner;
+		u32				id;
+		u32				cost;
+		void			execute		();
+	};
+
+	shared_str				m_name;
+	delegate_type			m_execute;
+	bool					m_progress;
+	task_group				m_group;
+	xr_deque<item>			m_items;
+	xrCriticalSection		m_lock;
+	u64						m_cost_total;
+	u64						m_cost_done;
+	u64						m_busy;
+	u64						m_longest;
+	bool					m_running;
+
+private:
+							task_phase	(task_phase const & copy) {}; //noncopyable
+
+public:
+							task_phase	(LPCSTR name, delegate_type const &execute, bool progress = true);
+							~task_phase	();
+
+	// before run : cost is the relative size of the item, the largest items go first
+	// from the running items : the item is queued at once (the tiles of a large item)
+	void					add			(u32 id, u32 cost);
+	// returns when all the items, the added ones including, are executed
+	void					run			();
+
+public:
+	// the compiler threads : every hardware thread but the calling one
+	static void				initialize	();
+	static void				destroy		();
+	// the timing of all the phases run so far
+	static void				report		();
+};
+
+#endif
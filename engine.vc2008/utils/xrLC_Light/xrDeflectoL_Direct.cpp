@@ -53,6 +53,14 @@ void CDeflector::L_Direct_Edge (CDB::COLLIDER* DB, base_lighting* LightsSelected
 }
 
 void CDeflector::L_Direct	(CDB::COLLIDER* DB, base_lighting* LightsSelected, HASH& H)
+{
+	if (!L_Direct_Rows(DB,LightsSelected,H,0,layer.height))
+		return;
+	L_Direct_Edges	(DB,LightsSelected);
+}
+
+// false - the net session is lost
+bool CDeflector::L_Direct_Rows	(CDB::COLLIDER* DB, base_lighting* LightsSelected, HASH& H, u32 v_begin, u32 v_end)
 {
 	R_ASSERT	(DB);
 	R_ASSERT	(LightsSelected);
@@ -75,9 +83,10 @@ void CDeflector::L_Direct	(CDB::COLLIDER* DB, base_lighting* LightsSelected, HAS
 	// Lighting itself
 	DB->ray_options	(0);
 	
-	for (u32 V=0; V<lm.height; V++)	{
+	VERIFY		(v_end<=lm.height);
+	for (u32 V=v_begin; V<v_end; V++)	{
 	if(_net_session && !_net_session->test_connection())
-			 return;
+			 return false;
 		for (u32 U=0; U<lm.width; U++)	{
 #ifdef NET_CMP
 			if(V*lm.width+U!=8335)
@@ -139,7 +148,15 @@ void CDeflector::L_Direct	(CDB::COLLIDER* DB, base_lighting* LightsSelected, HAS
 			}
 		}
 	}
+	return		true;
+}
+
+void CDeflector::L_Direct_Edges	(CDB::COLLIDER* DB, base_lighting* LightsSelected)
+{
+	lm_layer&	lm = layer;
+
 	// *** Render Edges
+	DB->ray_options	(0);
 	float texel_size = (1.f/float(_max(lm.width,lm.height)))/8.f;
 	for (u32 t=0; t<UVpolys.size(); t++)
 	{
@@ -40,10 +40,25 @@ static	CDeflector*		read_create					();
 	void	GetRect				(Fvector2 &min, Fvector2 &max);
 	u32		GetFaceCount()		{ return (u32)UVpolys.size();	};
 		
+	enum EShrink
+	{
+		shrinkNone,			// expand with borders
+		shrinkZero,			// already with borders
+		shrinkRMS			// calculate again at the new size
+	};
+
 	void	Light				(CDB::COLLIDER* DB, base_lighting* LightsSelected, HASH& H	);
 	void	L_Direct			(CDB::COLLIDER* DB, base_lighting* LightsSelected, HASH& H  );
 	void	L_Direct_Edge		(CDB::COLLIDER* DB, base_lighting* LightsSelected, Fvector2& p1, Fvector2& p2, Fvector& v1, Fvector& v2, Fvector& N, float texel_size, Face* skip);
 	void	L_Calculate			(CDB::COLLIDER* DB, base_lighting* LightsSelected, HASH& H  );
+
+	// the stages of Light, the rows of a large lightmap may be lit by several threads at once
+	void	L_Select			(base_lighting* LightsSelected);
+	void	L_Prepare			(HASH& H);
+	bool	L_Direct_Rows		(CDB::COLLIDER* DB, base_lighting* LightsSelected, HASH& H, u32 v_begin, u32 v_end);
+	void	L_Direct_Edges		(CDB::COLLIDER* DB, base_lighting* LightsSelected);
+	EShrink	L_Shrink			();
+	void	L_Expand			();
 	u32		weight				() { return layer.Area(); }	
 	u16	GetBaseMaterial		() ;
 
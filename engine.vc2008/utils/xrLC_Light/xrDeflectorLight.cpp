@@ -785,6 +785,30 @@ BOOL	compress_RMS		(lm_layer& lm, u32 rms, u32& w, u32& h)
 
 
 void CDeflector::Light(CDB::COLLIDER* DB, base_lighting* LightsSelected, HASH& H)
+{
+	L_Select			(LightsSelected);
+
+	// Calculate and fill borders
+	L_Calculate			(DB,LightsSelected,H);
+	if(_net_session && !_net_session->test_connection())
+			 return;
+
+	switch (L_Shrink())
+	{
+	case shrinkZero:
+		return;
+	case shrinkRMS:
+		// Reacalculate lightmap at lower resolution
+		L_Calculate		(DB,LightsSelected,H);
+		if(_net_session && !_net_session->test_connection())
+			 return;
+		break;
+	}
+
+	L_Expand			();
+}
+
+void CDeflector::L_Select(base_lighting* LightsSelected)
 {
 	// Geometrical bounds
 	Fbox bb;		bb.invalidate	();
@@ -802,30 +826,30 @@ void CDeflector::Light(CDB::COLLIDER* DB, base_lighting* LightsSelected, HASH& H
 
 	// Convert lights to local form
 	LightsSelected->select(inlc_global_data()->L_static(),Sphere.P,Sphere.R);
+}
 
-	// Calculate and fill borders
-	L_Calculate			(DB,LightsSelected,H);
-	if(_net_session && !_net_session->test_connection())
-			 return;
+CDeflector::EShrink CDeflector::L_Shrink()
+{
 	for (u32 ref=254; ref>0; ref--) if (!ApplyBorders(layer,ref)) break;
 
 	// Compression
 	try {
 		u32	w,h;
-		if (compress_Zero(layer,rms_zero))	return;		// already with borders
+		if (compress_Zero(layer,rms_zero))	return shrinkZero;		// already with borders
 		else if (compress_RMS(layer,rms_shrink,w,h))	
 		{
-			// Reacalculate lightmap at lower resolution
 			layer.create	(w,h);
-			L_Calculate		(DB,LightsSelected,H);
-			if(_net_session && !_net_session->test_connection())
-			 return;
+			return			shrinkRMS;
 		}
 	} catch (...)
 	{
 		clMsg("* ERROR: CDeflector::Light - Compression");
 	}
+	return				shrinkNone;
+}
 
+void CDeflector::L_Expand()
+{
 	// Expand with borders
 	try {
 		if (layer.width==1)	
@@ -1,6 +1,6 @@
 #include "stdafx.h"
 #include "xrLightVertex.h"
-#include "xrThread.h"
+#include "task_phase.h"
 #include "xrface.h"
 #include "xrLC_GlobalData.h"
 #include "light_point.h"
@@ -59,36 +59,6 @@ void	g_trans_register	(Vertex* V)
 	g_trans_CS.Leave			();
 }
 
-//////////////////////////////////////////////////////////////////////////
-const u32				VLT_END		= u32(-1);
-class CVertexLightTasker
-{
-	xrCriticalSection	cs;
-	volatile u32		index;	
-public:
-	CVertexLightTasker	() : index(0)
-#ifdef PROFILE_CRITICAL_SECTIONS
-		,cs(MUTEX_PROFILE_ID(CVertexLightTasker))
-#endif // PROFILE_CRITICAL_SECTIONS
-	{};
-	
-	void	init		()
-	{
-		index			= 0;
-	}
-
-	u32		get			()
-	{
-		cs.Enter		();
-		u32 _res		=	index;
-		if (_res>=lc_global_data()->g_vertices().size())	_res	=	VLT_END;
-		else							index	+=	1;
-		cs.Leave		();
-		return			_res;
-	}
-};
-CVertexLightTasker		VLT;
-
 bool GetTranslucency(const Vertex* V,float &v_trans )
 {
 	// Get transluency factor
@@ -106,21 +76,26 @@ bool GetTranslucency(const Vertex* V,float &v_trans )
 	return bVertexLight;
 }
 
-class CVertexLightThread : public CThread
+//////////////////////////////////////////////////////////////////////////
+// the vertices are lit by the chunks
+const u32				VL_CHUNK	= 256;
+class CVertexLightChunks
 {
 public:
-	CVertexLightThread(u32 ID) : CThread(ID)
+	u32		count		() const
 	{
-		thMessages	= FALSE;
+		return			(u32(lc_global_data()->g_vertices().size()) + VL_CHUNK - 1)/VL_CHUNK;
 	}
-	virtual void		Execute	()
+	u32		size		(u32 chunk) const
 	{
-		u32	counter		= 0;
-		for (;; counter++)
+		return			_min(VL_CHUNK,u32(lc_global_data()->g_vertices().size()) - chunk*VL_CHUNK);
+	}
+	void	Execute		(u32 chunk)
+	{
+		CDB::COLLIDER	DB;
+		DB.ray_options	(0);
+		for (u32 id=chunk*VL_CHUNK, end=id + size(chunk); id<end; id++)
 		{
-			u32 id				= VLT.get();
-			if (id==VLT_END)	break;
-
 			Vertex* V		= lc_global_data()->g_vertices()[id];
 
 			R_ASSERT		(V);
@@ -132,8 +107,6 @@ public:
 				base_color_c		vC, old;
 				V->C._get			(old);
 
-				CDB::COLLIDER	DB;
-				DB.ray_options	(0);
 				LightPoint			(&DB, lc_global_data()->RCAST_Model(), vC, V->P, V->N, lc_global_data()->L_static(), (lc_global_data()->b_nosun()?LP_dont_sun:0)|LP_dont_hemi, 0);
 				vC._tmp_			= v_trans;
 				vC.mul				(.5f);
@@ -142,15 +115,13 @@ public:
 
 				g_trans_register	(V);
 			}
-
-			thProgress			= float(counter) / float(lc_global_data()->g_vertices().size());
 		}
 	}
 };
+
 namespace lc_net{
 void RunLightVertexNet();
 }
-#define NUM_THREADS			4
 void LightVertex	( bool net )
 {
 	g_trans				= xr_new<mapVert>	();
@@ -159,12 +130,11 @@ void LightVertex	( bool net )
 	Status				("Calculating...");
 	if( !net )
 	{
-		CThreadManager		Threads;
-		VLT.init			();
-		CTimer	start_time;	start_time.Start();				
-		for (u32 thID=0; thID<NUM_THREADS; thID++)	Threads.start(xr_new<CVertexLightThread>(thID));
-		Threads.wait		();
-		clMsg				("%f seconds",start_time.GetElapsed_sec());
+		CVertexLightChunks	chunks;
+		task_phase			phase("Vertex",task_phase::delegate_type(&chunks,&CVertexLightChunks::Execute));
+		for (u32 chunk=0; chunk<chunks.count(); chunk++)
+			phase.add		(chunk,chunks.size(chunk));
+		phase.run			();
 	} else
 	{
 		lc_net::RunLightVertexNet();
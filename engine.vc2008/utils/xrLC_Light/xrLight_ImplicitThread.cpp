@@ -1,40 +1,35 @@
 #include "stdafx.h"
 #include "xrlight_implicitrun.h"
-#include "xrThread.h"
 #include "xrLight_Implicit.h"
 #include "xrlight_implicitdeflector.h"
-class ImplicitThread : public CThread
+#include "task_phase.h"
+
+// the rows of an implicit lightmap, by the bands of about the same texel count
+static const u32	implicit_band_area	= 64*64;
+
+class ImplicitBands
 {
+	u32				rows;
+	u32				height;
 public:
-
-	ImplicitExecute		execute;
-	ImplicitThread		(u32 ID, ImplicitDeflector* _DATA, u32 _y_start, u32 _y_end) :
-	CThread (ID), execute( _y_start, _y_end )
+	ImplicitBands	(ImplicitDeflector& defl) : height(defl.Height())
 	{
-		
+		rows		= _max(implicit_band_area/_max(defl.Width(),u32(1)),u32(1));
 	}
-	virtual void		Execute	();
-	
-
-};
-
-void	ImplicitThread ::	Execute	()
+	u32				count	() const	{ return (height + rows - 1)/rows; }
+	u32				size	(u32 band) const	{ return _min(rows,height - band*rows); }
+	void			Execute	(u32 band)
 	{
-		// Priority
-		SetThreadPriority		(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
-		Sleep					(0);
-		execute.Execute(0);
+		ImplicitExecute	execute( band*rows, band*rows + size(band) );
+		execute.Execute	(0);
 	}
+};
 
-
-
-#define	NUM_THREADS	8
 void RunImplicitMultithread(ImplicitDeflector& defl)
 {
-		// Start threads
-		CThreadManager			tmanager;
-		u32	stride				= defl.Height()/NUM_THREADS;
-		for (u32 thID=0; thID<NUM_THREADS; thID++)
-			tmanager.start		(xr_new<ImplicitThread> (thID,&defl,thID*stride,thID*stride+stride));
-		tmanager.wait			();
+		ImplicitBands			bands(defl);
+		task_phase				phase("Implicit",task_phase::delegate_type(&bands,&ImplicitBands::Execute));
+		for (u32 band=0; band<bands.count(); band++)
+			phase.add			(band,bands.size(band)*defl.Width());
+		phase.run				();
 }
@@ -35,6 +35,7 @@ ISpatial::ISpatial			(ISpatial_DB* space)
 	spatial.node_ptr		= NULL;
 	spatial.sector			= NULL;
 	spatial.space			= space;
+	spatial.pending			= 0;
 }
 ISpatial::~ISpatial			(void)
 {
@@ -100,8 +101,7 @@ void	ISpatial::spatial_move	()
 
 		//*** check if we are supposed to correct it's spatial location
 		if						(spatial_inside())	return;		// ???
-		spatial.space->remove	(this);
-		spatial.space->insert	(this);
+		spatial.space->move		(this);
 	} else {
 		//*** we are not registered yet, or already unregistered
 		//*** ignore request
@@ -150,6 +150,11 @@ ISpatial_DB::ISpatial_DB()
 	m_root					= NULL;
 	stat_nodes				= 0;
 	stat_objects			= 0;
+	m_readers				= 0;
+	m_writer				= 0;
+	m_pending_count			= 0;
+	cs.set_name				("ISpatial_DB::cs");
+	m_pending_cs.set_name	("ISpatial_DB::m_pending_cs");
 }
 
 ISpatial_DB::~ISpatial_DB()
@@ -251,9 +256,73 @@ void			ISpatial_DB::_insert	(ISpatial_NODE* N, Fvector& n_C, float n_R)
 	}
 }
 
+void			ISpatial_DB::read_lock	()
+{
+	for (;;) {
+		InterlockedIncrement		(&m_readers);
+		if (!m_writer)				return;
+
+		// let the writer go, then wait for it on its section
+		InterlockedDecrement		(&m_readers);
+		cs.Enter					();
+		cs.Leave					();
+	}
+}
+
+void			ISpatial_DB::read_unlock	()
+{
+	InterlockedDecrement			(&m_readers);
+}
+
+void			ISpatial_DB::write_lock	()
+{
+	cs.Enter						();
+	InterlockedExchange				(&m_writer,1);
+	while (m_readers)
+		SwitchToThread				();
+}
+
+void			ISpatial_DB::write_unlock	()
+{
+	InterlockedExchange				(&m_writer,0);
+	cs.Leave						();
+}
+
+u32				ISpatial_DB::pending_snapshot	(ISpatial** result)
+{
+	// pending orders are the list positions starting from 1, the ones appended later are greater;
+	// move publishes the count after the entry, so the entries below it are complete
+	u32								count = u32(m_pending_count);
+	CopyMemory						(result,m_pending,count*sizeof(ISpatial*));
+	return							(count);
+}
+
+void			ISpatial_DB::_pending_remove	(ISpatial* S)
+{
+	if (!S->spatial.pending)		return;
+
+	xrCriticalSection::raii			lock(&m_pending_cs);
+	u32								count = u32(m_pending_count);
+	ISpatial**						I = std::find(m_pending,m_pending + count,S);
+	VERIFY							(I != m_pending + count);
+
+	// nobody queries now, so the orders may be given anew
+	*I								= m_pending[--count];
+	m_pending_count					= LONG(count);
+	S->spatial.pending				= 0;
+	for (u32 i=0; i<count; ++i)
+		m_pending[i]->spatial.pending	= i + 1;
+}
+
 void			ISpatial_DB::insert		(ISpatial* S)
 {
-	cs.Enter			();
+	write_lock			();
+	_insert_object		(S);
+	write_unlock		();
+}
+
+void			ISpatial_DB::_insert_object	(ISpatial* S)
+{
 #ifdef DEBUG
 	stat_insert.Begin	();
 
@@ -286,7 +355,6 @@ void			ISpatial_DB::insert		(ISpatial* S)
 #ifdef DEBUG
 	stat_insert.End		();
 #endif
-	cs.Leave			();
 }
 
 void			ISpatial_DB::_remove	(ISpatial_NODE* N, ISpatial_NODE* N_sub)
@@ -313,7 +381,14 @@ void			ISpatial_DB::_remove	(ISpatial_NODE* N, ISpatial_NODE* N_sub)
 
 void			ISpatial_DB::remove		(ISpatial* S)
 {
-	cs.Enter			();
+	write_lock			();
+	_pending_remove		(S);
+	_remove_object		(S);
+	write_unlock		();
+}
+
+void			ISpatial_DB::_remove_object	(ISpatial* S)
+{
 #ifdef DEBUG
 	stat_remove.Begin	();
 #endif
@@ -326,15 +401,55 @@ void			ISpatial_DB::remove		(ISpatial* S)
 #ifdef DEBUG
 	stat_remove.End		();
 #endif
-	cs.Leave			();
+}
+
+void			ISpatial_DB::move		(ISpatial* S)
+{
+	{
+		xrCriticalSection::raii		lock(&m_pending_cs);
+		if (S->spatial.pending)		return;
+
+		u32							count = u32(m_pending_count);
+		if (count < pending_capacity) {
+			// the entry, then the order, then the count : a query, which has not seen the new count,
+			// does not skip the object in the tree, where it still is
+			m_pending[count]		= S;
+			S->spatial.pending		= count + 1;
+			InterlockedExchange		(&m_pending_count,LONG(count + 1));
+			return;
+		}
+	}
+
+	// too many have moved since the last update
+	write_lock			();
+	if (S->spatial.node_ptr) {
+		_remove_object	(S);
+		_insert_object	(S);
+	}
+	write_unlock		();
 }
 
 void			ISpatial_DB::update		(u32 nodes/* =8 */)
 {
-#ifdef DEBUG
 	if (0==m_root)	return;
-	cs.Enter		();
+
+	write_lock		();
+	{
+		xrCriticalSection::raii		lock(&m_pending_cs);
+		for (u32 i=0, n=u32(m_pending_count); i<n; ++i) {
+			ISpatial*				S = m_pending[i];
+			S->spatial.pending		= 0;
+
+			// it may have come back into its node meanwhile
+			if (S->spatial_inside())	continue;
+
+			_remove_object			(S);
+			_insert_object			(S);
+		}
+		m_pending_count				= 0;
+	}
+#ifdef DEBUG
 	VERIFY			(verify());
-	cs.Leave		();
 #endif
+	write_unlock	();
 }
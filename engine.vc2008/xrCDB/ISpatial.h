@@ -83,6 +83,7 @@ public:
 		ISpatial_NODE*			node_ptr;		// Cached parent node for "empty-members" optimization
 		IRender_Sector*			sector;
 		ISpatial_DB*			space;			// allow different spaces
+		u32						pending;		// order of the deferred move since the last update, 0 if none
 
 		_spatial() : type(0)	{}				// safe way to enhure type is zero before any contstructors takes place
 	}							spatial;
@@ -149,10 +150,28 @@ public:
 #endif // #ifndef	DLL_API
 
 //////////////////////////////////////////////////////////////////////////
+// Queries are readers : they run concurrently and never lock each other out.
+// Insert, remove and update are writers, they wait for the running queries to finish.
+// An object leaving its node is not rebucketed right away : it is appended to the pending list,
+// the tree stays as it is till update applies the list at the frame sync point.
+// Queries test the pending objects directly and skip them in the tree, so the results stay exact.
 class XRCDB_API	ISpatial_DB
 {
+public:
+	enum {
+		pending_capacity			= 256,		// more moves per frame are rebucketed right away
+	};
+
 private:
-	xrCriticalSection				cs;
+	xrCriticalSection				cs;					// writers
+	volatile LONG					m_readers;
+	volatile LONG					m_writer;
+
+	// the movers append under m_pending_cs, the queries copy the list without it :
+	// the entries below m_pending_count are rewritten by the writers only
+	xrCriticalSection				m_pending_cs;
+	ISpatial*						m_pending[pending_capacity];
+	volatile LONG					m_pending_count;
 
 	poolSS< ISpatial_NODE, 128 >	allocator;
 
@@ -162,7 +181,6 @@ public:
 	ISpatial_NODE*					m_root;
 	Fvector							m_center;
 	float							m_bounds;
-	xr_vector<ISpatial*>*			q_result;
 	u32								stat_nodes;
 	u32								stat_objects;
 	CStatTimer						stat_insert;
@@ -183,6 +201,16 @@ private:
 
 	void							_insert			(ISpatial_NODE* N, Fvector& n_center, float n_radius);
 	void							_remove			(ISpatial_NODE* N, ISpatial_NODE* N_sub);
+	void							_insert_object	(ISpatial* S);
+	void							_remove_object	(ISpatial* S);
+	void							_pending_remove	(ISpatial* S);
+
+	void							read_lock		();
+	void							read_unlock		();
+	void							write_lock		();
+	void							write_unlock	();
+	// copies the pending list : the objects with pending in [1,result] are in the copy
+	u32								pending_snapshot(ISpatial** result);
 public:
 	ISpatial_DB();
 	~ISpatial_DB();
@@ -192,6 +220,9 @@ public:
 	//void							destroy			();
 	void							insert			(ISpatial* S);
 	void							remove			(ISpatial* S);
+	// the object has left its node
+	void							move			(ISpatial* S);
+	// applies the pending moves, the frame sync point (CApplication::OnFrame)
 	void							update			(u32 nodes=8);
 	BOOL							verify			();
 
@@ -211,6 +242,9 @@ public:
 	void							q_frustum		(xr_vector<ISpatial*>& R, u32 _o, u32 _mask_or,  const CFrustum&	_frustum);
 };
 
+// query_thread_count threads query while one moves the objects : the single lock against the reader/writer one
+XRCDB_API extern void				spatial_benchmark		(u32 query_thread_count, u32 object_count, u32 milliseconds);
+
 XRCDB_API extern ISpatial_DB*		g_SpatialSpace			;
 XRCDB_API extern ISpatial_DB*		g_SpatialSpacePhysic	;
 
@@ -0,0 +1,200 @@
+#include "stdafx.h"
+#include "ISpatial.h"
+
+class	spatial_bench_object : public ISpatial
+{
+public:
+	Fvector			velocity;
+public:
+					spatial_bench_object	(ISpatial_DB* space) : ISpatial(space)	{}
+};
+
+typedef xr_vector<spatial_bench_object*>	SPATIAL_BENCH_OBJECTS;
+
+struct	spatial_bench_context
+{
+	ISpatial_DB*			space;
+	SPATIAL_BENCH_OBJECTS*	objects;
+	xrCriticalSection*		single;			// everything under one section, the way the queries were guarded before
+	volatile LONG			stop;
+	volatile LONG			alive;
+	volatile LONG			queries;
+	volatile LONG			seed;
+};
+
+static const float			c_bench_extent	= 500.f;
+
+static void	bench_query		(ISpatial_DB* space, CRandom& random, xr_vector<ISpatial*>& R)
+{
+	Fvector					P;
+	P.set					(random.randF(-c_bench_extent,c_bench_extent),random.randF(-20.f,20.f),random.randF(-c_bench_extent,c_bench_extent));
+	if (random.randI(2)) {
+		Fvector				size;
+		size.set			(random.randF(8.f,32.f),random.randF(8.f,32.f),random.randF(8.f,32.f));
+		space->q_box		(R,0,STYPE_COLLIDEABLE,P,size);
+	} else {
+		Fvector				dir;
+		dir.random_dir		(random);
+		space->q_ray		(R,0,STYPE_COLLIDEABLE,P,dir,100.f);
+	}
+}
+
+static void __cdecl bench_query_thread	(void* context_ptr)
+{
+	spatial_bench_context&	context = *(spatial_bench_context*)context_ptr;
+	CRandom					random(InterlockedIncrement(&context.seed));
+	xr_vector<ISpatial*>	R;
+	LONG					count = 0;
+
+	while (!context.stop) {
+		if (context.single) {
+			xrCriticalSection::raii	lock(context.single);
+			bench_query		(context.space,random,R);
+		} else
+			bench_query		(context.space,random,R);
+		++count;
+	}
+
+	InterlockedExchangeAdd	(&context.queries,count);
+	InterlockedDecrement	(&context.alive);
+}
+
+static void	bench_move		(spatial_bench_object* S, float dt)
+{
+	Fvector&				P = S->spatial.sphere.P;
+	P.mad					(S->velocity,dt);
+	if (_abs(P.x) > c_bench_extent)	{ S->velocity.x = -S->velocity.x; clamp(P.x,-c_bench_extent,c_bench_extent); }
+	if (_abs(P.z) > c_bench_extent)	{ S->velocity.z = -S->velocity.z; clamp(P.z,-c_bench_extent,c_bench_extent); }
+	S->spatial_move			();
+}
+
+// a frame of moves every couple of milliseconds, then the sync point
+static void __cdecl bench_move_thread	(void* context_ptr)
+{
+	spatial_bench_context&	context = *(spatial_bench_context*)context_ptr;
+	SPATIAL_BENCH_OBJECTS&	objects = *context.objects;
+
+	for (u32 frame=0; !context.stop; ++frame) {
+		for (u32 i=frame%4; i<objects.size(); i+=4) {
+			if (context.single) {
+				xrCriticalSection::raii	lock(context.single);
+				bench_move	(objects[i],.05f);
+			} else
+				bench_move	(objects[i],.05f);
+		}
+
+		if (context.single) {
+			xrCriticalSection::raii	lock(context.single);
+			context.space->update	();
+		} else
+			context.space->update	();
+
+		Sleep				(2);
+	}
+
+	InterlockedDecrement	(&context.alive);
+}
+
+static float	bench_run		(ISpatial_DB& space, SPATIAL_BENCH_OBJECTS& objects, xrCriticalSection* single, u32 query_thread_count, u32 milliseconds)
+{
+	spatial_bench_context	context;
+	context.space			= &space;
+	context.objects			= &objects;
+	context.single			= single;
+	context.stop			= 0;
+	context.alive			= query_thread_count + 1;
+	context.queries			= 0;
+	context.seed			= 0;
+
+	thread_spawn			(bench_move_thread,"X-RAY Spatial bench mover",0,&context);
+	for (u32 i=0; i<query_thread_count; ++i)
+		thread_spawn		(bench_query_thread,"X-RAY Spatial bench query",0,&context);
+
+	CTimer					timer;
+	timer.Start				();
+	Sleep					(milliseconds);
+	InterlockedExchange		(&context.stop,1);
+	while (context.alive)
+		Sleep				(1);
+
+	return					(float(context.queries)/timer.GetElapsed_sec());
+}
+
+// the queries against the brute force, while some objects wait to be rebucketed
+static u32		bench_verify	(ISpatial_DB& space, SPATIAL_BENCH_OBJECTS& objects, CRandom& random)
+{
+	u32						errors = 0;
+	xr_vector<ISpatial*>	R, expected;
+	for (u32 i=0; i<256; ++i) {
+		Fvector				P, size;
+		P.set				(random.randF(-c_bench_extent,c_bench_extent),random.randF(-20.f,20.f),random.randF(-c_bench_extent,c_bench_extent));
+		size.set			(random.randF(8.f,64.f),random.randF(8.f,64.f),random.randF(8.f,64.f));
+		space.q_box			(R,0,STYPE_COLLIDEABLE,P,size);
+
+		Fbox				box;
+		box.setb			(P,size);
+		expected.clear		();
+		SPATIAL_BENCH_OBJECTS::const_iterator	I = objects.begin();
+		SPATIAL_BENCH_OBJECTS::const_iterator	E = objects.end();
+		for ( ; I != E; ++I) {
+			Fsphere&		S = (*I)->spatial.sphere;
+			Fbox			B;
+			B.set			(S.P.x - S.R, S.P.y - S.R, S.P.z - S.R, S.P.x + S.R, S.P.y + S.R, S.P.z + S.R);
+			if (B.intersect(box))
+				expected.push_back	(*I);
+		}
+
+		std::sort			(R.begin(),R.end());
+		std::sort			(expected.begin(),expected.end());
+		if (R != expected)
+			++errors;
+	}
+	return					(errors);
+}
+
+void	spatial_benchmark		(u32 query_thread_count, u32 object_count, u32 milliseconds)
+{
+	ISpatial_DB				space;
+	Fbox					bounds;
+	bounds.set				(-c_bench_extent,-c_bench_extent,-c_bench_extent,c_bench_extent,c_bench_extent,c_bench_extent);
+	space.initialize		(bounds);
+
+	CRandom					random(0x5a7a);
+	SPATIAL_BENCH_OBJECTS	objects(object_count);
+	for (u32 i=0; i<object_count; ++i) {
+		spatial_bench_object*	S	= xr_new<spatial_bench_object>(&space);
+		S->spatial.type		= STYPE_COLLIDEABLE;
+		S->spatial.sphere.P.set	(random.randF(-c_bench_extent,c_bench_extent),random.randF(-20.f,20.f),random.randF(-c_bench_extent,c_bench_extent));
+		S->spatial.sphere.R	= random.randF(.5f,3.f);
+		S->velocity.set		(random.randF(-10.f,10.f),0.f,random.randF(-10.f,10.f));
+		S->spatial_register	();
+		objects[i]			= S;
+	}
+
+	// jumps : the first ones wait in the pending list, the rest are rebucketed right away
+	for (u32 i=0; i<object_count; i+=2) {
+		objects[i]->spatial.sphere.P.set	(random.randF(-c_bench_extent,c_bench_extent),random.randF(-20.f,20.f),random.randF(-c_bench_extent,c_bench_extent));
+		objects[i]->spatial_move	();
+	}
+	u32						errors = bench_verify(space,objects,random);
+	space.update			();
+	errors					+= bench_verify(space,objects,random);
+	if (errors)
+		Msg					("! Spatial bench : %d of %d queries differ from the brute force",errors,2*256);
+
+	Msg						("* Spatial bench : %d objects, %d ms per run, one mover thread",object_count,milliseconds);
+	xrCriticalSection		single;
+	for (u32 thread_count=1; ; thread_count=_min(2*thread_count,query_thread_count)) {
+		float				locked = bench_run(space,objects,&single,thread_count,milliseconds);
+		float				shared = bench_run(space,objects,0,thread_count,milliseconds);
+		Msg					("*   %2d query thread(s) : single lock %9.0f q/s, reader/writer %9.0f q/s, x%.2f",thread_count,locked,shared,shared/_max(locked,1.f));
+
+		if (thread_count == query_thread_count)
+			break;
+	}
+
+	SPATIAL_BENCH_OBJECTS::iterator	I = objects.begin();
+	SPATIAL_BENCH_OBJECTS::iterator	E = objects.end();
+	for ( ; I != E; ++I)
+		xr_delete			(*I);
+}
@@ -11,15 +11,36 @@ public:
 	Fvector			center;
 	Fvector			size;
 	Fbox			box;
-	ISpatial_DB*	space;
+	xr_vector<ISpatial*>*	result;
+	u32				pending;
 public:
-	walker					(ISpatial_DB*	_space, u32 _mask, const Fvector& _center, const Fvector&	_size)
+	walker					(xr_vector<ISpatial*>* _result, u32 _mask, const Fvector& _center, const Fvector&	_size, u32 _pending)
 	{
 		mask	= _mask;
 		center	= _center;
 		size	= _size;
 		box.setb(center,size);
-		space	= _space;
+		result	= _result;
+		pending	= _pending;
+	}
+	IC BOOL		test		(ISpatial* S)
+	{
+		if (0==(S->spatial.type&mask))	return FALSE;
+
+		Fvector&		sC		= S->spatial.sphere.P;
+		float			sR		= S->spatial.sphere.R;
+		Fbox			sB;		sB.set	(sC.x-sR, sC.y-sR, sC.z-sR, sC.x+sR, sC.y+sR, sC.z+sR);
+		return			sB.intersect(box);
+	}
+	void		walk_pending(ISpatial** P, u32 count)
+	{
+		for (u32 i=0; i<count; i++)
+		{
+			if (!test(P[i]))		continue;
+
+			result->push_back		(P[i]);
+			if (b_first)			return;
+		}
 	}
 	void		walk		(ISpatial_NODE* N, Fvector& n_C, float n_R)
 	{
@@ -34,14 +55,10 @@ public:
 		for (; _it!=_end; _it++)
 		{
 			ISpatial*		S	= *_it;
-			if (0==(S->spatial.type&mask))	continue;
-
-			Fvector&		sC		= S->spatial.sphere.P;
-			float			sR		= S->spatial.sphere.R;
-			Fbox			sB;		sB.set	(sC.x-sR, sC.y-sR, sC.z-sR, sC.x+sR, sC.y+sR, sC.z+sR);
-			if (!sB.intersect(box))	continue;
+			if (S->spatial.pending && (S->spatial.pending<=pending))	continue;	// tested by walk_pending
+			if (!test(S))			continue;
 
-			space->q_result->push_back	(S);
+			result->push_back		(S);
 			if (b_first)			return;
 		}
 
@@ -52,19 +69,20 @@ public:
 			if (0==N->children[octant])	continue;
 			Fvector		c_C;			c_C.mad	(n_C,c_spatial_offset[octant],c_R);
 			walk						(N->children[octant],c_C,c_R);
-			if (b_first && !space->q_result->empty())	return;
+			if (b_first && !result->empty())	return;
 		}
 	}
 };
 
 void	ISpatial_DB::q_box			(xr_vector<ISpatial*>& R, u32 _o, u32 _mask, const Fvector& _center, const Fvector& _size)
 {
-	cs.Enter			();
-	q_result			= &R;
-	q_result->clear_not_free		();
-	if (_o & O_ONLYFIRST)			{ walker<true>	W(this,_mask,_center,_size);	W.walk(m_root,m_center,m_bounds); } 
-	else							{ walker<false>	W(this,_mask,_center,_size);	W.walk(m_root,m_center,m_bounds); } 
-	cs.Leave			();
+	ISpatial*			pending[pending_capacity];
+	read_lock			();
+	u32					pending_count	= pending_snapshot(pending);
+	R.clear_not_free	();
+	if (_o & O_ONLYFIRST)			{ walker<true>	W(&R,_mask,_center,_size,pending_count);	W.walk_pending(pending,pending_count); if (R.empty()) W.walk(m_root,m_center,m_bounds); } 
+	else							{ walker<false>	W(&R,_mask,_center,_size,pending_count);	W.walk_pending(pending,pending_count); W.walk(m_root,m_center,m_bounds); } 
+	read_unlock			();
 }
 
 void	ISpatial_DB::q_sphere		(xr_vector<ISpatial*>& R, u32 _o, u32 _mask, const Fvector& _center, const float _radius)
@@ -9,13 +9,29 @@ class	walker
 public:
 	u32				mask;
 	CFrustum*		F;
-	ISpatial_DB*	space;
+	xr_vector<ISpatial*>*	result;
+	u32				pending;
 public:
-	walker					(ISpatial_DB*	_space, u32 _mask, const CFrustum* _F)
+	walker					(xr_vector<ISpatial*>* _result, u32 _mask, const CFrustum* _F, u32 _pending)
 	{
 		mask	= _mask;
 		F		= (CFrustum*)_F;
-		space	= _space;
+		result	= _result;
+		pending	= _pending;
+	}
+	IC BOOL		test		(ISpatial* S, u32 fmask)
+	{
+		if (0==(S->spatial.type&mask))	return FALSE;
+
+		Fvector&		sC		= S->spatial.sphere.P;
+		float			sR		= S->spatial.sphere.R;
+		u32				tmask	= fmask;
+		return			(fcvNone!=F->testSphere(sC,sR,tmask));
+	}
+	void		walk_pending(ISpatial** P, u32 count, u32 fmask)
+	{
+		for (u32 i=0; i<count; i++)
+			if (test(P[i],fmask))	result->push_back	(P[i]);
 	}
 	void		walk		(ISpatial_NODE* N, Fvector& n_C, float n_R, u32 fmask)
 	{
@@ -30,14 +46,10 @@ public:
 		for (; _it!=_end; _it++)
 		{
 			ISpatial*		S	= *_it;
-			if (0==(S->spatial.type&mask))	continue;
-
-			Fvector&		sC		= S->spatial.sphere.P;
-			float			sR		= S->spatial.sphere.R;
-			u32				tmask	= fmask;
-			if (fcvNone==F->testSphere(sC,sR,tmask))	continue;
+			if (S->spatial.pending && (S->spatial.pending<=pending))	continue;	// tested by walk_pending
+			if (!test(S,fmask))		continue;
 
-			space->q_result->push_back	(S);
+			result->push_back		(S);
 		}
 
 		// recurse
@@ -53,9 +65,12 @@ public:
 
 void	ISpatial_DB::q_frustum		(xr_vector<ISpatial*>& R, u32 _o, u32 _mask, const CFrustum& _frustum)	
 {
-	cs.Enter			();
-	q_result			= &R;
-	q_result->clear_not_free();
-	walker				W(this,_mask,&_frustum); W.walk(m_root,m_center,m_bounds,_frustum.getMask()); 
-	cs.Leave			();
+	ISpatial*			pending[pending_capacity];
+	read_lock			();
+	u32					pending_count	= pending_snapshot(pending);
+	R.clear_not_free	();
+	walker				W(&R,_mask,&_frustum,pending_count);
+	W.walk_pending		(pending,pending_count,_frustum.getMask());
+	W.walk				(m_root,m_center,m_bounds,_frustum.getMask()); 
+	read_unlock			();
 }
@@ -179,9 +179,10 @@ public:
 	u32				mask;
 	float			range;
 	float			range2;
-	ISpatial_DB*	space;
+	xr_vector<ISpatial*>*	result;
+	u32				pending;
 public:
-	walker					(ISpatial_DB*	_space, u32 _mask, const Fvector& _start, const Fvector&	_dir, float _range)
+	walker					(xr_vector<ISpatial*>* _result, u32 _mask, const Fvector& _start, const Fvector&	_dir, float _range, u32 _pending)
 	{
 		mask			= _mask;
 		ray.pos.set		(_start);
@@ -195,7 +196,8 @@ public:
 		}
 		range	= _range;
 		range2	= _range*_range;
-		space	= _space;
+		result	= _result;
+		pending	= _pending;
 	}
 	// fpu
 	ICF BOOL		_box_fpu	(const Fvector& n_C, const float n_R, Fvector& coord)
@@ -225,6 +227,36 @@ public:
 
 		return 		isect_sse		(box,ray,dist);
 	}
+	IC BOOL			test		(ISpatial* S)
+	{
+		if (mask!=(S->spatial.type&mask))	return FALSE;
+		Fsphere&		sS	= S->spatial.sphere;
+		int				quantity;
+		float			afT[2];
+		Fsphere::ERP_Result	result	= sS.intersect(ray.pos,ray.fwd_dir,range,quantity,afT);
+
+		if (result==Fsphere::rpOriginInside || ((result==Fsphere::rpOriginOutside)&&(afT[0]<range))){
+			if (b_nearest)				{ 
+				switch(result){
+				case Fsphere::rpOriginInside:	range	= afT[0]<range?afT[0]:range;	break;
+				case Fsphere::rpOriginOutside:	range	= afT[0];						break;
+				}
+				range2			=range*range; 
+			}
+			return				TRUE;
+		}
+		return					FALSE;
+	}
+	void			walk_pending(ISpatial** P, u32 count)
+	{
+		for (u32 i=0; i<count; i++)
+		{
+			if (!test(P[i]))			continue;
+
+			result->push_back			(P[i]);
+			if (b_first)				return;
+		}
+	}
 	void			walk		(ISpatial_NODE* N, Fvector& n_C, float n_R)
 	{
 		// Actual ray/aabb test
@@ -246,23 +278,11 @@ public:
 		for (; _it!=_end; _it++)
 		{
 			ISpatial*		S	= *_it;
-			if (mask!=(S->spatial.type&mask))	continue;
-			Fsphere&		sS	= S->spatial.sphere;
-			int				quantity;
-			float			afT[2];
-			Fsphere::ERP_Result	result	= sS.intersect(ray.pos,ray.fwd_dir,range,quantity,afT);
-
-			if (result==Fsphere::rpOriginInside || ((result==Fsphere::rpOriginOutside)&&(afT[0]<range))){
-				if (b_nearest)				{ 
-					switch(result){
-					case Fsphere::rpOriginInside:	range	= afT[0]<range?afT[0]:range;	break;
-					case Fsphere::rpOriginOutside:	range	= afT[0];						break;
-					}
-					range2			=range*range; 
-				}
-				space->q_result->push_back	(S);
-				if (b_first)				return;
-			}
+			if (S->spatial.pending && (S->spatial.pending<=pending))	continue;	// tested by walk_pending
+			if (!test(S))				continue;
+
+			result->push_back			(S);
+			if (b_first)				return;
 		}
 
 		// recurse
@@ -272,34 +292,40 @@ public:
 			if (0==N->children[octant])	continue;
 			Fvector		c_C;			c_C.mad	(n_C,c_spatial_offset[octant],c_R);
 			walk						(N->children[octant],c_C,c_R);
-			if (b_first && !space->q_result->empty())	return;
+			if (b_first && !result->empty())	return;
 		}
 	}
 };
 
+IC BOOL	first_found			(u32 _o, const xr_vector<ISpatial*>& R)
+{
+	return	(_o & ISpatial_DB::O_ONLYFIRST) && !R.empty();
+}
+
 void	ISpatial_DB::q_ray	(xr_vector<ISpatial*>& R, u32 _o, u32 _mask_and, const Fvector&	_start,  const Fvector&	_dir, float _range)
 {
-	cs.Enter						();
-	q_result						= &R;
-	q_result->clear_not_free		();
+	ISpatial*						pending[pending_capacity];
+	read_lock						();
+	u32								pending_count	= pending_snapshot(pending);
+	R.clear_not_free				();
 	if (CPU::ID.feature&_CPU_FEATURE_SSE)	{
 		if (_o & O_ONLYFIRST)
 		{
-			if (_o & O_ONLYNEAREST)		{ walker<true,true,true>	W(this,_mask_and,_start,_dir,_range);	W.walk(m_root,m_center,m_bounds); } 
-			else						{ walker<true,true,false>	W(this,_mask_and,_start,_dir,_range);	W.walk(m_root,m_center,m_bounds); } 
+			if (_o & O_ONLYNEAREST)		{ walker<true,true,true>	W(&R,_mask_and,_start,_dir,_range,pending_count);	W.walk_pending(pending,pending_count); if (!first_found(_o,R)) W.walk(m_root,m_center,m_bounds); } 
+			else						{ walker<true,true,false>	W(&R,_mask_and,_start,_dir,_range,pending_count);	W.walk_pending(pending,pending_count); if (!first_found(_o,R)) W.walk(m_root,m_center,m_bounds); } 
 		} else {
-			if (_o & O_ONLYNEAREST)		{ walker<true,false,true>	W(this,_mask_and,_start,_dir,_range);	W.walk(m_root,m_center,m_bounds); } 
-			else						{ walker<true,false,false>	W(this,_mask_and,_start,_dir,_range);	W.walk(m_root,m_center,m_bounds); } 
+			if (_o & O_ONLYNEAREST)		{ walker<true,false,true>	W(&R,_mask_and,_start,_dir,_range,pending_count);	W.walk_pending(pending,pending_count); if (!first_found(_o,R)) W.walk(m_root,m_center,m_bounds); } 
+			else						{ walker<true,false,false>	W(&R,_mask_and,_start,_dir,_range,pending_count);	W.walk_pending(pending,pending_count); if (!first_found(_o,R)) W.walk(m_root,m_center,m_bounds); } 
 		}
 	} else {
 		if (_o & O_ONLYFIRST)
 		{
-			if (_o & O_ONLYNEAREST)		{ walker<false,true,true>	W(this,_mask_and,_start,_dir,_range);	W.walk(m_root,m_center,m_bounds); } 
-			else						{ walker<false,true,false>	W(this,_mask_and,_start,_dir,_range);	W.walk(m_root,m_center,m_bounds); } 
+			if (_o & O_ONLYNEAREST)		{ walker<false,true,true>	W(&R,_mask_and,_start,_dir,_range,pending_count);	W.walk_pending(pending,pending_count); if (!first_found(_o,R)) W.walk(m_root,m_center,m_bounds); } 
+			else						{ walker<false,true,false>	W(&R,_mask_and,_start,_dir,_range,pending_count);	W.walk_pending(pending,pending_count); if (!first_found(_o,R)) W.walk(m_root,m_center,m_bounds); } 
 		} else {
-			if (_o & O_ONLYNEAREST)		{ walker<false,false,true>	W(this,_mask_and,_start,_dir,_range);	W.walk(m_root,m_center,m_bounds); } 
-			else						{ walker<false,false,false>	W(this,_mask_and,_start,_dir,_range);	W.walk(m_root,m_center,m_bounds); } 
+			if (_o & O_ONLYNEAREST)		{ walker<false,false,true>	W(&R,_mask_and,_start,_dir,_range,pending_count);	W.walk_pending(pending,pending_count); if (!first_found(_o,R)) W.walk(m_root,m_center,m_bounds); } 
+			else						{ walker<false,false,false>	W(&R,_mask_and,_start,_dir,_range,pending_count);	W.walk_pending(pending,pending_count); if (!first_found(_o,R)) W.walk(m_root,m_center,m_bounds); } 
 		}
 	}
-	cs.Leave		();
+	read_unlock		();
 }
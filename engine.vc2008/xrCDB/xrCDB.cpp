@@ -5,6 +5,7 @@
 #pragma hdrstop
 
 #include "xrCDB.h"
+#include "xr_area.h"
 
 #ifdef USE_ARENA_ALLOCATOR
 static const u32	s_arena_size = (128+16)*1024*1024;
@@ -26,9 +27,11 @@ BOOL APIENTRY DllMain( HANDLE hModule,
 {
     switch (ul_reason_for_call)
 	{
+	case DLL_THREAD_DETACH:
+		CObjectSpace::release_context	();
+		break;
 	case DLL_PROCESS_ATTACH:
 	case DLL_THREAD_ATTACH:
-	case DLL_THREAD_DETACH:
 	case DLL_PROCESS_DETACH:
 		break;
     }
@@ -190,4 +193,7 @@ RESULT& COLLIDER::r_add	()
 void COLLIDER::r_free	()
 {
 	rd.clear_and_free	();
+	rp.clear_and_free	();
+	rp_temp.clear_and_free	();
+	rp_lane.clear_and_free	();
 }
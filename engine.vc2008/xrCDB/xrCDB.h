@@ -116,6 +116,14 @@ namespace CDB
 		float			u,v;
 	};
 
+	// Ray of the packet query
+	struct XRCDB_API RAY
+	{
+		Fvector			start;
+		Fvector			dir;				// normalized
+		float			range;
+	};
+
 	// Collider Options
 	enum {
 		OPT_CULL		= (1<<0),
@@ -134,12 +142,23 @@ namespace CDB
 
 		// Result management
 		xr_vector<RESULT>	rd;
+
+		// Ray packets
+		xr_vector<u32>		rp;				// first result of every ray of the last packet query, and the end
+		xr_vector<RESULT>	rp_temp;		// results of the packet being traced
+		xr_vector<u32>		rp_lane;		// and their rays
 	public:
 		COLLIDER		();
 		~COLLIDER		();
 
 		ICF void		ray_options		(u32 f)	{	ray_mode = f;		}
 		void			ray_query		(const MODEL *m_def, const Fvector& r_start,  const Fvector& r_dir, float r_range = 10000.f);
+		// rays are walked through the tree 4 at a time (SSE) with the ray_options of ray_query,
+		// results of the ray i are [r_packet_begin(i),r_packet_end(i)), ordered as ray_query gives them
+		void			ray_packet_query(const MODEL *m_def, const RAY* rays, u32 count);
+		ICF RESULT*		r_packet_begin	(u32 i)	{	return r_begin() + rp[i];	}
+		ICF RESULT*		r_packet_end	(u32 i)	{	return r_begin() + rp[i+1];	}
+		ICF int			r_packet_count	(u32 i)	{	return rp[i+1] - rp[i];		}
 
 		ICF void		box_options		(u32 f)	{	box_mode = f;		}
 		void			box_query		(const MODEL *m_def, const Fvector& b_center, const Fvector& b_dim);
@@ -174,6 +174,53 @@ ICF BOOL isect_sse			(const aabb_t &box, const ray_t &ray, float &dist)	{
 	return  ret;
 }
 
+// the same test for the single rays and for the lanes of the packets, so both give the same results
+template <bool bCull>
+ICF bool	isect_tri		(const Fvector& pos, const Fvector& fwd_dir, Fvector* verts, u32* p, float& u, float& v, float& range)
+{
+	Fvector edge1, edge2, tvec, pvec, qvec;
+	float	det,inv_det;
+	
+	// find vectors for two edges sharing vert0
+	Fvector&			p0	= verts[ p[0] ];
+	Fvector&			p1	= verts[ p[1] ];
+	Fvector&			p2	= verts[ p[2] ];
+	edge1.sub			(p1, p0);
+	edge2.sub			(p2, p0);
+	// begin calculating determinant - also used to calculate U parameter
+	// if determinant is near zero, ray lies in plane of triangle
+	pvec.crossproduct	(fwd_dir, edge2);
+	det = edge1.dotproduct(pvec);
+	if (bCull)
+	{						
+		if (det < EPS)  return false;
+		tvec.sub(pos, p0);						// calculate distance from vert0 to ray origin
+		u = tvec.dotproduct(pvec);					// calculate U parameter and test bounds
+		if (u < 0.f || u > det) return false;
+		qvec.crossproduct(tvec, edge1);				// prepare to test V parameter
+		v = fwd_dir.dotproduct(qvec);			// calculate V parameter and test bounds
+		if (v < 0.f || u + v > det) return false;
+		range = edge2.dotproduct(qvec);				// calculate t, scale parameters, ray intersects triangle
+		inv_det = 1.0f / det;
+		range	*= inv_det;
+		u		*= inv_det;
+		v		*= inv_det;
+	}
+	else
+	{			
+		if (det > -EPS && det < EPS) return false;
+		inv_det = 1.0f / det;
+		tvec.sub(pos, p0);						// calculate distance from vert0 to ray origin
+		u = tvec.dotproduct(pvec)*inv_det;			// calculate U parameter and test bounds
+		if (u < 0.0f || u > 1.0f)    return false;
+		qvec.crossproduct(tvec, edge1);				// prepare to test V parameter
+		v = fwd_dir.dotproduct(qvec)*inv_det;	// calculate V parameter and test bounds
+		if (v < 0.0f || u + v > 1.0f) return false;
+		range = edge2.dotproduct(qvec)*inv_det;		// calculate t, ray intersects triangle
+	}
+	return true;
+	}
+
 template <bool bUseSSE, bool bCull, bool bFirst, bool bNearest>
 class _MM_ALIGN16	ray_collider
 {
@@ -231,49 +278,9 @@ public:
         return 		isect_sse	(box,ray,dist);
 	}
 	
-	IC bool			_tri		(u32* p, float& u, float& v, float& range)
+	ICF bool		_tri		(u32* p, float& u, float& v, float& range)
 	{
-		Fvector edge1, edge2, tvec, pvec, qvec;
-		float	det,inv_det;
-		
-		// find vectors for two edges sharing vert0
-		Fvector&			p0	= verts[ p[0] ];
-		Fvector&			p1	= verts[ p[1] ];
-		Fvector&			p2	= verts[ p[2] ];
-		edge1.sub			(p1, p0);
-		edge2.sub			(p2, p0);
-		// begin calculating determinant - also used to calculate U parameter
-		// if determinant is near zero, ray lies in plane of triangle
-		pvec.crossproduct	(ray.fwd_dir, edge2);
-		det = edge1.dotproduct(pvec);
-		if (bCull)
-		{						
-			if (det < EPS)  return false;
-			tvec.sub(ray.pos, p0);						// calculate distance from vert0 to ray origin
-			u = tvec.dotproduct(pvec);					// calculate U parameter and test bounds
-			if (u < 0.f || u > det) return false;
-			qvec.crossproduct(tvec, edge1);				// prepare to test V parameter
-			v = ray.fwd_dir.dotproduct(qvec);			// calculate V parameter and test bounds
-			if (v < 0.f || u + v > det) return false;
-			range = edge2.dotproduct(qvec);				// calculate t, scale parameters, ray intersects triangle
-			inv_det = 1.0f / det;
-			range	*= inv_det;
-			u		*= inv_det;
-			v		*= inv_det;
-		}
-		else
-		{			
-			if (det > -EPS && det < EPS) return false;
-			inv_det = 1.0f / det;
-			tvec.sub(ray.pos, p0);						// calculate distance from vert0 to ray origin
-			u = tvec.dotproduct(pvec)*inv_det;			// calculate U parameter and test bounds
-			if (u < 0.0f || u > 1.0f)    return false;
-			qvec.crossproduct(tvec, edge1);				// prepare to test V parameter
-			v = ray.fwd_dir.dotproduct(qvec)*inv_det;	// calculate V parameter and test bounds
-			if (v < 0.0f || u + v > 1.0f) return false;
-			range = edge2.dotproduct(qvec)*inv_det;		// calculate t, ray intersects triangle
-		}
-		return true;
+		return		isect_tri<bCull>(ray.pos,ray.fwd_dir,verts,p,u,v,range);
 	}
 	
 	void			_prim		(DWORD prim)
@@ -463,3 +470,207 @@ void	COLLIDER::ray_query	(const MODEL *m_def, const Fvector& r_start,  const Fve
 	}
 }
 
+
+// packets of 4 rays, one per SSE lane : the boxes are tested against all the lanes at once,
+// the walk goes down while any lane still enters the box, triangles are tested lane by lane
+template <bool bCull, bool bFirst, bool bNearest>
+class _MM_ALIGN16	ray_packet_collider
+{
+public:
+	enum {
+		lane_count	= 4,
+	};
+
+	__m128				pos		[3];		// x,y,z of the lanes
+	__m128				inv_dir	[3];
+	float _MM_ALIGN16	range	[lane_count];
+	int					nearest	[lane_count];
+	u32					active;				// lanes which are still traced
+
+	const RAY*			rays;
+	TRI*				tris;
+	Fvector*			verts;
+	xr_vector<RESULT>*	results;
+	xr_vector<u32>*		lanes;
+
+	IC void			_init		(const RAY* R, u32 count, Fvector* V, TRI* T, xr_vector<RESULT>& _results, xr_vector<u32>& _lanes)
+	{
+		VERIFY			((count > 0) && (count <= lane_count));
+		rays			= R;
+		verts			= V;
+		tris			= T;
+		results			= &_results;
+		lanes			= &_lanes;
+		active			= (1 << count) - 1;
+
+		float _MM_ALIGN16	p[3][lane_count], d[3][lane_count];
+		for (u32 i=0; i<lane_count; ++i) {
+			// the missing lanes repeat the first ray and stay inactive
+			const RAY&	ray	= R[i < count ? i : 0];
+			p[0][i]		= ray.start.x;
+			p[1][i]		= ray.start.y;
+			p[2][i]		= ray.start.z;
+			d[0][i]		= 1.f/ray.dir.x;
+			d[1][i]		= 1.f/ray.dir.y;
+			d[2][i]		= 1.f/ray.dir.z;
+			range[i]	= ray.range;
+			nearest[i]	= -1;
+		}
+		for (u32 k=0; k<3; ++k) {
+			pos[k]		= loadps(p[k]);
+			inv_dir[k]	= loadps(d[k]);
+		}
+	}
+
+	// mask of the lanes which enter the box, the slabs are filtered exactly as isect_sse does
+	ICF u32			_box		(const AABBNoLeafNode* node)
+	{
+		const __m128
+			plus_inf	= loadps(ps_cst_plus_inf),
+			minus_inf	= loadps(ps_cst_minus_inf);
+
+		const float*	C = (const float*)&node->mAABB.mCenter;
+		const float*	E = (const float*)&node->mAABB.mExtents;
+		__m128			t_near = minus_inf;
+		__m128			t_far = plus_inf;
+		for (u32 k=0; k<3; ++k) {
+			const __m128 l1 = mulps(subps(_mm_set1_ps(C[k] - E[k]), pos[k]), inv_dir[k]);
+			const __m128 l2 = mulps(subps(_mm_set1_ps(C[k] + E[k]), pos[k]), inv_dir[k]);
+			t_far		= minps(t_far,  maxps(minps(l1, plus_inf),  minps(l2, plus_inf)));
+			t_near		= maxps(t_near, minps(maxps(l1, minus_inf), maxps(l2, minus_inf)));
+		}
+
+		__m128			hit = _mm_and_ps(_mm_cmpge_ps(t_far,_mm_setzero_ps()),_mm_cmpge_ps(t_far,t_near));
+		hit				= _mm_and_ps(hit,_mm_cmple_ps(t_near,loadps(range)));
+		return			(u32(_mm_movemask_ps(hit)));
+	}
+
+	IC void			_add		(u32 lane, DWORD prim, float r, float u, float v)
+	{
+		RESULT*		R;
+		if (bNearest && (nearest[lane] >= 0)) {
+			R			= &(*results)[nearest[lane]];
+			if (r >= R->range)
+				return;
+		}
+		else {
+			nearest[lane]	= results->size();
+			results->push_back	(RESULT());
+			lanes->push_back	(lane);
+			R			= &results->back();
+		}
+
+		R->id		= prim;
+		R->range	= r;
+		R->u		= u;
+		R->v		= v;
+		R->verts[0]	= verts[tris[prim].verts[0]];
+		R->verts[1]	= verts[tris[prim].verts[1]];
+		R->verts[2]	= verts[tris[prim].verts[2]];
+		R->dummy	= tris[prim].dummy;
+
+		if (bNearest)	range[lane]	= r;
+		if (bFirst)		active		&= ~(1 << lane);
+	}
+
+	void			_prim		(DWORD prim, u32 mask)
+	{
+		for (u32 lane=0; mask; ++lane, mask >>= 1) {
+			if (!(mask&1))	continue;
+
+			float	u,v,r;
+			if (!isect_tri<bCull>(rays[lane].start,rays[lane].dir,verts,tris[prim].verts,u,v,r))	continue;
+			if (r<=0 || r>range[lane])																continue;
+			_add	(lane,prim,r,u,v);
+		}
+	}
+
+	void			_stab		(const AABBNoLeafNode* node, u32 mask)
+	{
+		_mm_prefetch( (char *) node->GetNeg() , _MM_HINT_NTA );
+
+		// Actual rays/aabb test, early out when no lane is left
+		mask		&= _box(node);
+		if (!mask)																			return;
+
+		// 1st chield
+		if (node->HasLeaf())	_prim	(node->GetPrimitive(),mask);
+		else					_stab	(node->GetPos(),mask);
+
+		// Early exit for "only first"
+		if (bFirst) {
+			mask	&= active;
+			if (!mask)																		return;
+		}
+
+		// 2nd chield
+		if (node->HasLeaf2())	_prim	(node->GetPrimitive2(),mask);
+		else					_stab	(node->GetNeg(),mask);
+	}
+};
+
+template <bool bCull, bool bFirst, bool bNearest>
+static void	ray_packets		(const AABBNoLeafNode* N, Fvector* V, TRI* T, const RAY* rays, u32 count, xr_vector<RESULT>& dest, xr_vector<u32>& offsets, xr_vector<RESULT>& temp, xr_vector<u32>& lanes)
+{
+	typedef ray_packet_collider<bCull,bFirst,bNearest>	collider_type;
+	for (u32 i=0; i<count; i+=collider_type::lane_count) {
+		u32				lane_count = _min(count - i,u32(collider_type::lane_count));
+
+		collider_type	RC;
+		RC._init		(rays + i,lane_count,V,T,temp,lanes);
+		RC._stab		(N,RC.active);
+
+		// the results of the lanes come interleaved, regroup them ray by ray
+		for (u32 lane=0; lane<lane_count; ++lane) {
+			for (u32 j=0, n=temp.size(); j<n; ++j)
+				if (lanes[j] == lane)
+					dest.push_back	(temp[j]);
+			offsets.push_back	(dest.size());
+		}
+		temp.clear_not_free		();
+		lanes.clear_not_free	();
+	}
+}
+
+void	COLLIDER::ray_packet_query	(const MODEL *m_def, const RAY* rays, u32 count)
+{
+	m_def->syncronize		();
+
+	// Get nodes
+	const AABBNoLeafTree* T = (const AABBNoLeafTree*)m_def->tree->GetTree();
+	const AABBNoLeafNode* N = T->GetNodes();
+	r_clear					();
+	rp.clear_not_free		();
+	rp.push_back			(0);
+
+	if ((count < 2) || !(CPU::ID.feature&_CPU_FEATURE_SSE))	{
+		// nothing to share the walk with : ray by ray
+		for (u32 i=0; i<count; ++i) {
+			ray_query			(m_def,rays[i].start,rays[i].dir,rays[i].range);
+			rp_temp.insert		(rp_temp.end(),rd.begin(),rd.end());
+			rp.push_back		(rp_temp.size());
+		}
+		rd.swap					(rp_temp);
+		rp_temp.clear_not_free	();
+		return;
+	}
+
+	// Binary dispatcher
+	if (ray_mode&OPT_CULL)		{
+		if (ray_mode&OPT_ONLYFIRST)		{
+			if (ray_mode&OPT_ONLYNEAREST)	ray_packets<true,true,true>		(N,m_def->verts,m_def->tris,rays,count,rd,rp,rp_temp,rp_lane);
+			else							ray_packets<true,true,false>	(N,m_def->verts,m_def->tris,rays,count,rd,rp,rp_temp,rp_lane);
+		} else {
+			if (ray_mode&OPT_ONLYNEAREST)	ray_packets<true,false,true>	(N,m_def->verts,m_def->tris,rays,count,rd,rp,rp_temp,rp_lane);
+			else							ray_packets<true,false,false>	(N,m_def->verts,m_def->tris,rays,count,rd,rp,rp_temp,rp_lane);
+		}
+	} else {
+		if (ray_mode&OPT_ONLYFIRST)		{
+			if (ray_mode&OPT_ONLYNEAREST)	ray_packets<false,true,true>	(N,m_def->verts,m_def->tris,rays,count,rd,rp,rp_temp,rp_lane);
+			else							ray_packets<false,true,false>	(N,m_def->verts,m_def->tris,rays,count,rd,rp,rp_temp,rp_lane);
+		} else {
+			if (ray_mode&OPT_ONLYNEAREST)	ray_packets<false,false,true>	(N,m_def->verts,m_def->tris,rays,count,rd,rp,rp_temp,rp_lane);
+			else							ray_packets<false,false,false>	(N,m_def->verts,m_def->tris,rays,count,rd,rp,rp_temp,rp_lane);
+		}
+	}
+}
@@ -32,6 +32,16 @@ public:
 		cdb_clRAY->End	();
 #endif
 	}
+	IC void			ray_packet_query(const CDB::MODEL *m_def, const CDB::RAY* rays, u32 count)
+	{
+#ifdef DEBUG
+		cdb_clRAY->Begin();
+#endif
+		CL.ray_packet_query(m_def,rays,count);
+#ifdef DEBUG
+		cdb_clRAY->End	();
+#endif
+	}
 	
 	IC void			box_options		(u32 f)	
 	{	
@@ -67,6 +77,9 @@ public:
 	IC CDB::RESULT*	r_end			()	{	return CL.r_end();			};
 	IC void			r_free			()	{	CL.r_free();				}
 	IC int			r_count			()	{	return CL.r_count();		};
+	IC CDB::RESULT*	r_packet_begin	(u32 i)	{	return CL.r_packet_begin(i);	};
+	IC CDB::RESULT*	r_packet_end	(u32 i)	{	return CL.r_packet_end(i);		};
+	IC int			r_packet_count	(u32 i)	{	return CL.r_packet_count(i);	};
 	IC void			r_clear			()	{	CL.r_clear();				};
 	IC void			r_clear_compact	()	{	CL.r_clear_compact();		};
 	
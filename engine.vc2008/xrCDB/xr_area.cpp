@@ -34,6 +34,7 @@ CObjectSpace::CObjectSpace	( ):
 	//sh_debug.create				("debug\\wireframe","$null");
 #endif
 	m_BoundingVolume.invalidate	();
+	Lock.set_name				("CObjectSpace::Lock");
 }
 //----------------------------------------------------------------------
 CObjectSpace::~CObjectSpace	( )
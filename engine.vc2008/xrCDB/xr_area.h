@@ -21,9 +21,19 @@ class 	CObject;
 struct hdrCFORM;
 class	XRCDB_API						CObjectSpace
 {
+private:
+	// ray queries keep their collider and results per thread : the static model is read only
+	// after it is built, so OPCODE is walked without any lock
+	struct query_context
+	{
+		xrXRC							xrc;
+		collide::rq_results				r_temp;
+		xr_vector<ISpatial*>			r_spatial;
+	};
+
 private:
 	// Debug
-	xrCriticalSection					Lock;
+	xrCriticalSection					Lock;				// dynamic part of the ray queries : collision forms update their state lazily
 	CDB::MODEL							Static;
 	Fbox								m_BoundingVolume;
 	xrXRC								xrc;				// MT: dangerous
@@ -39,11 +49,12 @@ public:
 #endif
 
 private:
-	BOOL								_RayTest			( const Fvector &start, const Fvector &dir, float range, collide::rq_target tgt, collide::ray_cache* cache, CObject* ignore_object);
-	BOOL								_RayPick			( const Fvector &start, const Fvector &dir, float range, collide::rq_target tgt, collide::rq_result& R, CObject* ignore_object );
-	BOOL								_RayQuery			( collide::rq_results& dest, const collide::ray_defs& rq, collide::rq_callback* cb, LPVOID user_data, collide::test_callback* tb, CObject* ignore_object);
-	BOOL								_RayQuery2			( collide::rq_results& dest, const collide::ray_defs& rq, collide::rq_callback* cb, LPVOID user_data, collide::test_callback* tb, CObject* ignore_object);
-	BOOL								_RayQuery3			( collide::rq_results& dest, const collide::ray_defs& rq, collide::rq_callback* cb, LPVOID user_data, collide::test_callback* tb, CObject* ignore_object);
+	BOOL								_RayTest			(query_context& C, const Fvector &start, const Fvector &dir, float range, collide::rq_target tgt, collide::ray_cache* cache, CObject* ignore_object);
+	BOOL								_RayPick			(query_context& C, const Fvector &start, const Fvector &dir, float range, collide::rq_target tgt, collide::rq_result& R, CObject* ignore_object );
+	BOOL								_RayQuery			(query_context& C, collide::rq_results& dest, const collide::ray_defs& rq, collide::rq_callback* cb, LPVOID user_data, collide::test_callback* tb, CObject* ignore_object);
+	BOOL								_RayQuery2			(query_context& C, collide::rq_results& dest, const collide::ray_defs& rq, collide::rq_callback* cb, LPVOID user_data, collide::test_callback* tb, CObject* ignore_object);
+	BOOL								_RayQuery3			(query_context& C, collide::rq_results& dest, const collide::ray_defs& rq, collide::rq_callback* cb, LPVOID user_data, collide::test_callback* tb, CObject* ignore_object);
+	static	query_context&				context				();
 public:
 										CObjectSpace		( );
 										~CObjectSpace		( );
@@ -78,6 +89,13 @@ public:
 
 	const Fbox&							GetBoundingVolume	() { return m_BoundingVolume;}
 
+	// frees the ray query context of the calling thread
+	static	void						release_context		();
+	// random static rays inside the level bounds, traced from 1..max_threads threads and checked against the serial run
+	void								ray_benchmark		(u32 ray_count, u32 max_threads);
+	// ray_query vs ray_packet_query over the static model, for the coherent (shared origin) and random ray sets
+	void								ray_packet_benchmark(u32 ray_count);
+
 	// Debugging
 #ifdef DEBUG
 	void								dbgRender			();
@@ -18,39 +18,56 @@ bool bDebug()
 #endif
 using namespace	collide;
 
+// CObjectSpace::query_context of the thread, created on its first ray query
+static __declspec(thread) void*	s_query_context = 0;
+
+CObjectSpace::query_context& CObjectSpace::context	()
+{
+	if (!s_query_context)
+		s_query_context	= xr_new<query_context>();
+	return				*(query_context*)s_query_context;
+}
+
+void CObjectSpace::release_context	()
+{
+	query_context*		C = (query_context*)s_query_context;
+	xr_delete			(C);
+	s_query_context		= 0;
+}
+
 //--------------------------------------------------------------------------------
 // RayTest - Occluded/No
 //--------------------------------------------------------------------------------
 BOOL CObjectSpace::RayTest	( const Fvector &start, const Fvector &dir, float range, collide::rq_target tgt, collide::ray_cache* cache, CObject* ignore_object)
 {
-	Lock.Enter		();
-	BOOL	_ret	= _RayTest(start,dir,range,tgt,cache,ignore_object);
-	r_spatial.clear	();
-	Lock.Leave		();
+	query_context&	C	= context();
+	BOOL	_ret	= _RayTest(C,start,dir,range,tgt,cache,ignore_object);
+	C.r_spatial.clear	();
 	return			_ret;
 }
-BOOL CObjectSpace::_RayTest	( const Fvector &start, const Fvector &dir, float range, collide::rq_target tgt, collide::ray_cache* cache, CObject* ignore_object)
+BOOL CObjectSpace::_RayTest	(query_context& C, const Fvector &start, const Fvector &dir, float range, collide::rq_target tgt, collide::ray_cache* cache, CObject* ignore_object)
 {
 	VERIFY					(_abs(dir.magnitude()-1)<EPS);
-	r_temp.r_clear			();
+	C.r_temp.r_clear			();
 
-	xrc.ray_options			(CDB::OPT_ONLYFIRST);
+	C.xrc.ray_options			(CDB::OPT_ONLYFIRST);
 	collide::ray_defs	Q	(start,dir,range,CDB::OPT_ONLYFIRST,tgt);
 
 	// dynamic test
 	if (tgt&rqtDyn){
+		xrCriticalSection::raii	lock(&Lock);
 		u32			d_flags =	STYPE_COLLIDEABLE|((tgt&rqtObstacle)?STYPE_OBSTACLE:0)|((tgt&rqtShape)?STYPE_SHAPE:0);
 		// traverse object database
-		g_SpatialSpace->q_ray	(r_spatial,0,d_flags,start,dir,range);
+		g_SpatialSpace->q_ray	(C.r_spatial,0,d_flags,start,dir,range);
 		// Determine visibility for dynamic part of scene
-		for (u32 o_it=0; o_it<r_spatial.size(); o_it++)
+		for (u32 o_it=0; o_it<C.r_spatial.size(); o_it++)
 		{
-			ISpatial*	spatial			= r_spatial[o_it];
+			ISpatial*	spatial			= C.r_spatial[o_it];
 			CObject*	collidable		= spatial->dcast_CObject	();
 			if (collidable && (collidable!=ignore_object))	{
 				ECollisionFormType tp	= collidable->collidable.model->Type();
-				if ((tgt&(rqtObject|rqtObstacle))&&(tp==cftObject)&&collidable->collidable.model->_RayQuery(Q,r_temp))	return TRUE;
-				if ((tgt&rqtShape)&&(tp==cftShape)&&collidable->collidable.model->_RayQuery(Q,r_temp))		return TRUE;
+				if ((tgt&(rqtObject|rqtObstacle))&&(tp==cftObject)&&collidable->collidable.model->_RayQuery(Q,C.r_temp))	return TRUE;
+				if ((tgt&rqtShape)&&(tp==cftShape)&&collidable->collidable.model->_RayQuery(Q,C.r_temp))		return TRUE;
 			}
 		}
 	}
@@ -72,14 +89,14 @@ BOOL CObjectSpace::_RayTest	( const Fvector &start, const Fvector &dir, float ra
 			}
 			
 			// 2. Polygon doesn't pick - real database query
-			xrc.ray_query	(&Static,start,dir,range);
-			if (0==xrc.r_count()) {
+			C.xrc.ray_query	(&Static,start,dir,range);
+			if (0==C.xrc.r_count()) {
 				cache->set		(start,dir,range,FALSE);
 				return FALSE;
 			} else {
 				// cache polygon
 				cache->set		(start,dir,range,TRUE);
-				CDB::RESULT*	R	= xrc.r_begin();
+				CDB::RESULT*	R	= C.xrc.r_begin();
 				CDB::TRI&		T	= Static.get_tris() [ R->id ];
 				Fvector*		V	= Static.get_verts();
 				cache->verts[0].set	(V[T.verts[0]]);
@@ -88,8 +105,8 @@ BOOL CObjectSpace::_RayTest	( const Fvector &start, const Fvector &dir, float ra
 				return TRUE;
 			}
 		} else {
-			xrc.ray_query		(&Static,start,dir,range);
-			return xrc.r_count	();
+			C.xrc.ray_query		(&Static,start,dir,range);
+			return C.xrc.r_count	();
 		}
 	}
 	return FALSE;
@@ -100,46 +117,46 @@ BOOL CObjectSpace::_RayTest	( const Fvector &start, const Fvector &dir, float ra
 //--------------------------------------------------------------------------------
 BOOL CObjectSpace::RayPick	( const Fvector &start, const Fvector &dir, float range, rq_target tgt, rq_result& R, CObject* ignore_object)
 {
-	Lock.Enter		();
-	BOOL	_res	= _RayPick(start,dir,range,tgt,R,ignore_object);
-	r_spatial.clear	();
-	Lock.Leave		();
+	query_context&	C	= context();
+	BOOL	_res	= _RayPick(C,start,dir,range,tgt,R,ignore_object);
+	C.r_spatial.clear	();
 	return	_res;
 }
-BOOL CObjectSpace::_RayPick	( const Fvector &start, const Fvector &dir, float range, rq_target tgt, rq_result& R, CObject* ignore_object)
+BOOL CObjectSpace::_RayPick	(query_context& C, const Fvector &start, const Fvector &dir, float range, rq_target tgt, rq_result& R, CObject* ignore_object)
 {
-	r_temp.r_clear			();
+	C.r_temp.r_clear			();
 	R.O		= 0; R.range = range; R.element = -1;
 	// static test
 	if (tgt&rqtStatic){ 
-		xrc.ray_options		(CDB::OPT_ONLYNEAREST | CDB::OPT_CULL);
-		xrc.ray_query		(&Static,start,dir,range);
-		if (xrc.r_count())  R.set_if_less(xrc.r_begin());
+		C.xrc.ray_options		(CDB::OPT_ONLYNEAREST | CDB::OPT_CULL);
+		C.xrc.ray_query		(&Static,start,dir,range);
+		if (C.xrc.r_count())  R.set_if_less(C.xrc.r_begin());
 	}
 	// dynamic test
 	if (tgt&rqtDyn){ 
+		xrCriticalSection::raii	lock(&Lock);
 		collide::ray_defs Q		(start,dir,R.range,CDB::OPT_ONLYNEAREST|CDB::OPT_CULL,tgt);
 		// traverse object database
 		u32			d_flags =	STYPE_COLLIDEABLE|((tgt&rqtObstacle)?STYPE_OBSTACLE:0)|((tgt&rqtShape)?STYPE_SHAPE:0);
-		g_SpatialSpace->q_ray	(r_spatial,0,d_flags,start,dir,range);
+		g_SpatialSpace->q_ray	(C.r_spatial,0,d_flags,start,dir,range);
 		// Determine visibility for dynamic part of scene
-		for (u32 o_it=0; o_it<r_spatial.size(); o_it++){
-			ISpatial*	spatial			= r_spatial[o_it];
+		for (u32 o_it=0; o_it<C.r_spatial.size(); o_it++){
+			ISpatial*	spatial			= C.r_spatial[o_it];
 			CObject*	collidable		= spatial->dcast_CObject();
 			if			(0==collidable)				continue;
 			if			(collidable==ignore_object)	continue;
 			ECollisionFormType tp		= collidable->collidable.model->Type();
 			if (((tgt&(rqtObject|rqtObstacle))&&(tp==cftObject))||((tgt&rqtShape)&&(tp==cftShape))){
-				u32		C	= D3DCOLOR_XRGB	(64,64,64);
+				u32		color	= D3DCOLOR_XRGB	(64,64,64);
 				Q.range		= R.range;
-				if (collidable->collidable.model->_RayQuery(Q,r_temp)){
-					C				= D3DCOLOR_XRGB(128,128,196);
-					R.set_if_less	(r_temp.r_begin());
+				if (collidable->collidable.model->_RayQuery(Q,C.r_temp)){
+					color			= D3DCOLOR_XRGB(128,128,196);
+					R.set_if_less	(C.r_temp.r_begin());
 				}
 #ifdef DEBUG
 				if (bDebug()){
 					Fsphere	S;		S.P = spatial->spatial.sphere.P; S.R = spatial->spatial.sphere.R;
-					(*m_pRender)->dbgAddSphere(S,C);
+					(*m_pRender)->dbgAddSphere(S,color);
 					//dbg_S.push_back	(mk_pair(S,C));
 				}
 #endif
@@ -154,17 +171,16 @@ BOOL CObjectSpace::_RayPick	( const Fvector &start, const Fvector &dir, float ra
 //--------------------------------------------------------------------------------
 BOOL CObjectSpace::RayQuery		(collide::rq_results& dest, const collide::ray_defs& R, collide::rq_callback* CB, LPVOID user_data, collide::test_callback* tb, CObject* ignore_object)
 {
-	Lock.Enter					();
-	BOOL						_res = _RayQuery2(dest,R,CB,user_data,tb,ignore_object);
-	r_spatial.clear_not_free	();
-	Lock.Leave					();
+	query_context&				C = context();
+	BOOL						_res = _RayQuery2(C,dest,R,CB,user_data,tb,ignore_object);
+	C.r_spatial.clear_not_free	();
 	return						(_res);
 }
-BOOL CObjectSpace::_RayQuery2	(collide::rq_results& r_dest, const collide::ray_defs& R, collide::rq_callback* CB, LPVOID user_data, collide::test_callback* tb, CObject* ignore_object)
+BOOL CObjectSpace::_RayQuery2	(query_context& C, collide::rq_results& r_dest, const collide::ray_defs& R, collide::rq_callback* CB, LPVOID user_data, collide::test_callback* tb, CObject* ignore_object)
 {
 	// initialize query
 	r_dest.r_clear		();
-	r_temp.r_clear		();
+	C.r_temp.r_clear		();
 
 	rq_target	s_mask	=	rqtStatic;
 	rq_target	d_mask	=	rq_target(	((R.tgt&rqtObject)	?rqtObject:rqtNone		)|
@@ -174,35 +190,36 @@ BOOL CObjectSpace::_RayQuery2	(collide::rq_results& r_dest, const collide::ray_d
 
 	// Test static
 	if (R.tgt&s_mask){ 
-		xrc.ray_options	(R.flags);
-		xrc.ray_query	(&Static,R.start,R.dir,R.range);
-		if (xrc.r_count()){	
-			CDB::RESULT* _I	= xrc.r_begin();
-			CDB::RESULT* _E = xrc.r_end	();
+		C.xrc.ray_options	(R.flags);
+		C.xrc.ray_query	(&Static,R.start,R.dir,R.range);
+		if (C.xrc.r_count()){	
+			CDB::RESULT* _I	= C.xrc.r_begin();
+			CDB::RESULT* _E = C.xrc.r_end	();
 			for (; _I!=_E; _I++)
-				r_temp.append_result(rq_result().set(0,_I->range,_I->id));
+				C.r_temp.append_result(rq_result().set(0,_I->range,_I->id));
 		}
 	}
 	// Test dynamic
 	if (R.tgt&d_mask){ 
+		xrCriticalSection::raii	lock(&Lock);
 		// Traverse object database
-		g_SpatialSpace->q_ray	(r_spatial,0,d_flags,R.start,R.dir,R.range);
-		for (u32 o_it=0; o_it<r_spatial.size(); o_it++){
-			CObject*	collidable		= r_spatial[o_it]->dcast_CObject();
+		g_SpatialSpace->q_ray	(C.r_spatial,0,d_flags,R.start,R.dir,R.range);
+		for (u32 o_it=0; o_it<C.r_spatial.size(); o_it++){
+			CObject*	collidable		= C.r_spatial[o_it]->dcast_CObject();
 			if			(0==collidable)				continue;
 			if			(collidable==ignore_object)	continue;
 			ICollisionForm*	cform		= collidable->collidable.model;
 			ECollisionFormType tp		= collidable->collidable.model->Type();
 			if (((R.tgt&(rqtObject|rqtObstacle))&&(tp==cftObject))||((R.tgt&rqtShape)&&(tp==cftShape))){
 				if (tb&&!tb(R,collidable,user_data))continue;
-				cform->_RayQuery(R,r_temp);
+				cform->_RayQuery(R,C.r_temp);
 			}
 		}
 	}
-	if (r_temp.r_count()){
-		r_temp.r_sort		();
-		collide::rq_result* _I = r_temp.r_begin	();
-		collide::rq_result* _E = r_temp.r_end	();
+	if (C.r_temp.r_count()){
+		C.r_temp.r_sort		();
+		collide::rq_result* _I = C.r_temp.r_begin	();
+		collide::rq_result* _E = C.r_temp.r_end	();
 		for (; _I!=_E; _I++){
 			r_dest.append_result(*_I);
 			if (!(CB?CB(*_I,user_data):TRUE))						return r_dest.r_count();
@@ -212,7 +229,7 @@ BOOL CObjectSpace::_RayQuery2	(collide::rq_results& r_dest, const collide::ray_d
 	return r_dest.r_count();
 }
 
-BOOL CObjectSpace::_RayQuery3	(collide::rq_results& r_dest, const collide::ray_defs& R, collide::rq_callback* CB, LPVOID user_data, collide::test_callback* tb, CObject* ignore_object)
+BOOL CObjectSpace::_RayQuery3	(query_context& C, collide::rq_results& r_dest, const collide::ray_defs& R, collide::rq_callback* CB, LPVOID user_data, collide::test_callback* tb, CObject* ignore_object)
 {
 	// initialize query
 	r_dest.r_clear			();
@@ -227,45 +244,46 @@ BOOL CObjectSpace::_RayQuery3	(collide::rq_results& r_dest, const collide::ray_d
 	float		d_range		= 0.f;
 
 	do{
-		r_temp.r_clear		();
+		C.r_temp.r_clear		();
 		if (R.tgt&s_mask){
 			// static test allowed
 
 			// test static
-			xrc.ray_options		(s_rd.flags);
-			xrc.ray_query		(&Static,s_rd.start,s_rd.dir,s_rd.range);
+			C.xrc.ray_options		(s_rd.flags);
+			C.xrc.ray_query		(&Static,s_rd.start,s_rd.dir,s_rd.range);
 
-			if (xrc.r_count())	{	
-				VERIFY			(xrc.r_count()==1);
+			if (C.xrc.r_count())	{	
+				VERIFY			(C.xrc.r_count()==1);
 				rq_result		s_res;
-				s_res.set		(0,xrc.r_begin()->range,xrc.r_begin()->id);
+				s_res.set		(0,C.xrc.r_begin()->range,C.xrc.r_begin()->id);
 				// update dynamic test range
 				d_rd.range		= s_res.range;
 				// set next static start & range
 				s_rd.range		-= (s_res.range+EPS_L);
 				s_rd.start.mad	(s_rd.dir,s_res.range+EPS_L);
 				s_res.range		= R.range-s_rd.range-EPS_L;
-				r_temp.append_result(s_res);
+				C.r_temp.append_result(s_res);
 			}else{
 				d_rd.range		= s_rd.range;
 			}
 		}
 		// test dynamic
 		if (R.tgt&d_mask)		{ 
+			xrCriticalSection::raii	lock(&Lock);
 			// Traverse object database
-			g_SpatialSpace->q_ray	(r_spatial,0,d_flags,d_rd.start,d_rd.dir,d_rd.range);
-			for (u32 o_it=0; o_it<r_spatial.size(); o_it++){
-				CObject*	collidable		= r_spatial[o_it]->dcast_CObject();
+			g_SpatialSpace->q_ray	(C.r_spatial,0,d_flags,d_rd.start,d_rd.dir,d_rd.range);
+			for (u32 o_it=0; o_it<C.r_spatial.size(); o_it++){
+				CObject*	collidable		= C.r_spatial[o_it]->dcast_CObject();
 				if			(0==collidable)				continue;
 				if			(collidable==ignore_object)	continue;
 				ICollisionForm*	cform		= collidable->collidable.model;
 				ECollisionFormType tp		= collidable->collidable.model->Type();
 				if (((R.tgt&(rqtObject|rqtObstacle))&&(tp==cftObject))||((R.tgt&rqtShape)&&(tp==cftShape))){
 					if (tb&&!tb(d_rd,collidable,user_data))continue;
-					u32 r_cnt				= r_temp.r_count();
-					cform->_RayQuery		(d_rd,r_temp);
-					for (int k=r_cnt; k<r_temp.r_count(); k++){
-						rq_result& d_res	= *(r_temp.r_begin()+k);
+					u32 r_cnt				= C.r_temp.r_count();
+					cform->_RayQuery		(d_rd,C.r_temp);
+					for (int k=r_cnt; k<C.r_temp.r_count(); k++){
+						rq_result& d_res	= *(C.r_temp.r_begin()+k);
 						d_res.range			+= d_range;
 					}
 				}
@@ -274,10 +292,10 @@ BOOL CObjectSpace::_RayQuery3	(collide::rq_results& r_dest, const collide::ray_d
 		// set dynamic ray def
 		d_rd.start			= s_rd.start;
 		d_range				= R.range-s_rd.range;
-		if (r_temp.r_count()){
-			r_temp.r_sort		();
-			collide::rq_result* _I = r_temp.r_begin	();
-			collide::rq_result* _E = r_temp.r_end	();
+		if (C.r_temp.r_count()){
+			C.r_temp.r_sort		();
+			collide::rq_result* _I = C.r_temp.r_begin	();
+			collide::rq_result* _E = C.r_temp.r_end	();
 			for (; _I!=_E; _I++){
 				r_dest.append_result(*_I);
 				if (!(CB?CB(*_I,user_data):TRUE))	return r_dest.r_count();
@@ -285,11 +303,11 @@ BOOL CObjectSpace::_RayQuery3	(collide::rq_results& r_dest, const collide::ray_d
 			}
 		}
 		if ((R.flags&(CDB::OPT_ONLYNEAREST|CDB::OPT_ONLYFIRST)) && r_dest.r_count()) return r_dest.r_count();
-	}while(r_temp.r_count());
+	}while(C.r_temp.r_count());
 	return r_dest.r_count()	;
 }
 
-BOOL CObjectSpace::_RayQuery	(collide::rq_results& r_dest, const collide::ray_defs& R, collide::rq_callback* CB, LPVOID user_data, collide::test_callback* tb, CObject* ignore_object)
+BOOL CObjectSpace::_RayQuery	(query_context& C, collide::rq_results& r_dest, const collide::ray_defs& R, collide::rq_callback* CB, LPVOID user_data, collide::test_callback* tb, CObject* ignore_object)
 {
 #ifdef DEBUG
 	if (R.range<EPS || !_valid(R.range))
@@ -297,7 +315,7 @@ BOOL CObjectSpace::_RayQuery	(collide::rq_results& r_dest, const collide::ray_de
 #endif
 	// initialize query
 	r_dest.r_clear			();
-	r_temp.r_clear			();
+	C.r_temp.r_clear			();
 
 	Flags32		sd_test;	sd_test.assign	(R.tgt);
 	rq_target	next_test	= R.tgt;
@@ -317,10 +335,10 @@ BOOL CObjectSpace::_RayQuery	(collide::rq_results& r_dest, const collide::ray_de
 			s_res.set		(0,s_rd.range,-1);
 			// Test static model
 			if (s_rd.range>EPS){
-				xrc.ray_options	(s_rd.flags);
-				xrc.ray_query	(&Static,s_rd.start,s_rd.dir,s_rd.range);
-				if (xrc.r_count()){	
-					if (s_res.set_if_less(xrc.r_begin())){
+				C.xrc.ray_options	(s_rd.flags);
+				C.xrc.ray_query	(&Static,s_rd.start,s_rd.dir,s_rd.range);
+				if (C.xrc.r_count()){	
+					if (s_res.set_if_less(C.xrc.r_begin())){
 						// set new static start & range
 						s_rd.range	-=	(s_res.range+EPS_L);
 						s_rd.start.mad	(s_rd.dir,s_res.range+EPS_L);
@@ -335,31 +353,32 @@ BOOL CObjectSpace::_RayQuery	(collide::rq_results& r_dest, const collide::ray_de
 			if (!s_res.valid())	sd_test.set(s_mask,FALSE);
 		}
 		if ((R.tgt&d_mask)&&sd_test.is_any(d_mask)&&(next_test&d_mask)){ 
-			r_temp.r_clear	();
+			C.r_temp.r_clear	();
 
 			if (d_rd.range>EPS){
+				xrCriticalSection::raii	lock(&Lock);
 				// Traverse object database
-				g_SpatialSpace->q_ray		(r_spatial,0,d_flags,d_rd.start,d_rd.dir,d_rd.range);
+				g_SpatialSpace->q_ray		(C.r_spatial,0,d_flags,d_rd.start,d_rd.dir,d_rd.range);
 				// Determine visibility for dynamic part of scene
-				for (u32 o_it=0; o_it<r_spatial.size(); o_it++){
-					CObject*	collidable		= r_spatial[o_it]->dcast_CObject();
+				for (u32 o_it=0; o_it<C.r_spatial.size(); o_it++){
+					CObject*	collidable		= C.r_spatial[o_it]->dcast_CObject();
 					if			(0==collidable)				continue;
 					if			(collidable==ignore_object)	continue;
 					ICollisionForm*	cform		= collidable->collidable.model;
 					ECollisionFormType tp		= collidable->collidable.model->Type();
 					if (((R.tgt&(rqtObject|rqtObstacle))&&(tp==cftObject))||((R.tgt&rqtShape)&&(tp==cftShape))){
 						if (tb&&!tb(d_rd,collidable,user_data))continue;
-						cform->_RayQuery(d_rd,r_temp);
+						cform->_RayQuery(d_rd,C.r_temp);
 					}
 #ifdef DEBUG
-					if (!((0==r_temp.r_count()) || (r_temp.r_count()&&(fis_zero(r_temp.r_begin()->range, EPS)||(r_temp.r_begin()->range>=0.f)))))
-						Debug.fatal(DEBUG_INFO,"Invalid RayQuery dynamic range: %f (%f). /#2/",r_temp.r_begin()->range,d_rd.range);
+					if (!((0==C.r_temp.r_count()) || (C.r_temp.r_count()&&(fis_zero(C.r_temp.r_begin()->range, EPS)||(C.r_temp.r_begin()->range>=0.f)))))
+						Debug.fatal(DEBUG_INFO,"Invalid RayQuery dynamic range: %f (%f). /#2/",C.r_temp.r_begin()->range,d_rd.range);
 #endif
 				}
 			}
-			if (r_temp.r_count()){
+			if (C.r_temp.r_count()){
 				// set new dynamic start & range
-				rq_result& d_res = *r_temp.r_begin();
+				rq_result& d_res = *C.r_temp.r_begin();
 				d_rd.range	-= (d_res.range+EPS_L);
 				d_rd.start.mad(d_rd.dir,d_res.range+EPS_L);
 				d_res.range	= R.range-d_rd.range-EPS_L;
@@ -371,29 +390,29 @@ BOOL CObjectSpace::_RayQuery	(collide::rq_results& r_dest, const collide::ray_de
 				sd_test.set(d_mask,FALSE);
 			}
 		}
-		if (s_res.valid()&&r_temp.r_count()){
+		if (s_res.valid()&&C.r_temp.r_count()){
 			// all test return result
-			if	(s_res.range<r_temp.r_begin()->range){
+			if	(s_res.range<C.r_temp.r_begin()->range){
 				// static nearer
 				BOOL need_calc			= CB?CB(s_res,user_data):TRUE;
 				next_test				= need_calc?s_mask:rqtNone; 
 				r_dest.append_result	(s_res);
 			}else{
 				// dynamic nearer
-				BOOL need_calc			= CB?CB(*r_temp.r_begin(),user_data):TRUE;
+				BOOL need_calc			= CB?CB(*C.r_temp.r_begin(),user_data):TRUE;
 				next_test				= need_calc?d_mask:rqtNone;	
-				r_dest.append_result	(*r_temp.r_begin());
+				r_dest.append_result	(*C.r_temp.r_begin());
 			}
 		}else if (s_res.valid())	{
 			// only static return result
 			BOOL need_calc				= CB?CB(s_res,user_data):TRUE;
 			next_test					= need_calc?s_mask:rqtNone;
 			r_dest.append_result		(s_res);
-		}else if (r_temp.r_count())	{
+		}else if (C.r_temp.r_count())	{
 			// only dynamic return result
-			BOOL need_calc				= CB?CB(*r_temp.r_begin(),user_data):TRUE;
+			BOOL need_calc				= CB?CB(*C.r_temp.r_begin(),user_data):TRUE;
 			next_test					= need_calc?d_mask:rqtNone;
-			r_dest.append_result		(*r_temp.r_begin());
+			r_dest.append_result		(*C.r_temp.r_begin());
 		}else{
 			// nothing selected
 			next_test			= rqtNone;
@@ -409,3 +428,250 @@ BOOL CObjectSpace::RayQuery	(collide::rq_results& r_dest, ICollisionForm* target
 	r_dest.r_clear			();
 	return target->_RayQuery(R,r_dest);
 }
+
+//--------------------------------------------------------------------------------
+// ray_benchmark
+//--------------------------------------------------------------------------------
+struct ray_benchmark_ray
+{
+	Fvector						start;
+	Fvector						dir;
+	float						range;
+	float						hit_range;		// of the serial run, -1 if nothing was hit
+	int							hit_id;
+};
+
+struct ray_benchmark_context
+{
+	CObjectSpace*				space;
+	ray_benchmark_ray*			begin;
+	ray_benchmark_ray*			end;
+	void*						start;
+	volatile LONG*				alive;
+	volatile LONG*				mismatches;
+};
+
+static void	ray_benchmark_thread	(void* param)
+{
+	ray_benchmark_context		&context = *(ray_benchmark_context*)param;
+	WaitForSingleObject			(context.start,INFINITE);
+
+	for (ray_benchmark_ray* I=context.begin; I!=context.end; ++I) {
+		rq_result				R;
+		if (context.space->RayPick(I->start,I->dir,I->range,rqtStatic,R,0)) {
+			if ((R.element != I->hit_id) || !fsimilar(R.range,I->hit_range))
+				InterlockedIncrement	(context.mismatches);
+		}
+		else if (I->hit_id >= 0)
+			InterlockedIncrement		(context.mismatches);
+	}
+
+	CObjectSpace::release_context	();
+	InterlockedDecrement		(context.alive);
+}
+
+void CObjectSpace::ray_benchmark	(u32 ray_count, u32 max_threads)
+{
+	if (!Static.get_tris()) {
+		Msg						("! ray benchmark: no collision model loaded");
+		return;
+	}
+
+	ray_count					= _max(ray_count,u32(1));
+	max_threads					= _max(max_threads,u32(1));
+
+	// rays from random points of the level bounds, as long as a quarter of its diagonal
+	CRandom						random(0x5eed);
+	Fvector						size;
+	m_BoundingVolume.getsize	(size);
+	float						range = size.magnitude()*.25f;
+	xr_vector<ray_benchmark_ray>	rays(ray_count);
+	for (u32 i=0; i<ray_count; ++i) {
+		ray_benchmark_ray		&ray = rays[i];
+		ray.start.set			(
+			m_BoundingVolume.min.x + random.randF(size.x),
+			m_BoundingVolume.min.y + random.randF(size.y),
+			m_BoundingVolume.min.z + random.randF(size.z)
+		);
+		ray.dir.random_dir		(random);
+		ray.range				= range;
+	}
+
+	// reference results
+	u32							hits = 0;
+	CTimer						timer;
+	timer.Start					();
+	for (u32 i=0; i<ray_count; ++i) {
+		ray_benchmark_ray		&ray = rays[i];
+		rq_result				R;
+		if (RayPick(ray.start,ray.dir,ray.range,rqtStatic,R,0)) {
+			ray.hit_range		= R.range;
+			ray.hit_id			= R.element;
+			++hits;
+		}
+		else {
+			ray.hit_range		= -1.f;
+			ray.hit_id			= -1;
+		}
+	}
+	float						serial_time = timer.GetElapsed_sec();
+
+	Msg							("* ray benchmark: %d static ray(s), %.1fm long, %d hit(s)",ray_count,range,hits);
+	Msg							("*   serial        : %10.0f rays/s",serial_time > 0.f ? float(ray_count)/serial_time : 0.f);
+
+	for (u32 thread_count=1; ; thread_count=_min(thread_count*2,max_threads)) {
+		xr_vector<ray_benchmark_context>	contexts(thread_count);
+		void*					start = CreateEvent(NULL,TRUE,FALSE,NULL);
+		volatile LONG			alive = LONG(thread_count);
+		volatile LONG			mismatches = 0;
+		for (u32 i=0; i<thread_count; ++i) {
+			contexts[i].space	= this;
+			contexts[i].begin	= &*rays.begin() + i*ray_count/thread_count;
+			contexts[i].end		= &*rays.begin() + (i + 1)*ray_count/thread_count;
+			contexts[i].start	= start;
+			contexts[i].alive	= &alive;
+			contexts[i].mismatches	= &mismatches;
+			thread_spawn		(ray_benchmark_thread,"X-RAY ray benchmark",0,&contexts[i]);
+		}
+
+		timer.Start				();
+		SetEvent				(start);
+		while (alive)
+			SwitchToThread		();
+		float					time = timer.GetElapsed_sec();
+		CloseHandle				(start);
+
+		Msg						(
+			"*   %2d thread(s) : %10.0f rays/s, x%.2f, %d mismatch(es)",
+			thread_count,
+			time > 0.f ? float(ray_count)/time : 0.f,
+			time > 0.f ? serial_time/time : 0.f,
+			mismatches
+		);
+
+		if (thread_count == max_threads)
+			break;
+	}
+}
+
+//--------------------------------------------------------------------------------
+// ray_packet_benchmark
+//--------------------------------------------------------------------------------
+static float ray_packet_benchmark_run	(CDB::MODEL& model, const xr_vector<CDB::RAY>& rays, u32 options, u32 packet_size, float& packet_time)
+{
+	CDB::COLLIDER				single;
+	CDB::COLLIDER				packet;
+	single.ray_options			(options);
+	packet.ray_options			(options);
+
+	// single rays, the results are kept to be checked against the packets
+	xr_vector<CDB::RESULT>		results;
+	xr_vector<u32>				offsets;
+	offsets.push_back			(0);
+	CTimer						timer;
+	timer.Start					();
+	for (u32 i=0, n=rays.size(); i<n; ++i) {
+		single.ray_query		(&model,rays[i].start,rays[i].dir,rays[i].range);
+		results.insert			(results.end(),single.r_begin(),single.r_end());
+		offsets.push_back		(results.size());
+	}
+	float						single_time = timer.GetElapsed_sec();
+
+	u32							mismatches = 0;
+	packet_time					= 0.f;
+	for (u32 i=0, n=rays.size(); i<n; i+=packet_size) {
+		u32						count = _min(n - i,packet_size);
+		timer.Start				();
+		packet.ray_packet_query	(&model,&rays[i],count);
+		packet_time				+= timer.GetElapsed_sec();
+
+		for (u32 j=0; j<count; ++j) {
+			u32					first = offsets[i + j];
+			if (u32(packet.r_packet_count(j)) != offsets[i + j + 1] - first) {
+				++mismatches;
+				continue;
+			}
+
+			CDB::RESULT*		R = packet.r_packet_begin(j);
+			for (CDB::RESULT* E = packet.r_packet_end(j); R != E; ++R, ++first)
+				if ((R->id != results[first].id) || !fsimilar(R->range,results[first].range))
+					break;
+			if (R != packet.r_packet_end(j))
+				++mismatches;
+		}
+	}
+
+	if (mismatches)
+		Msg						("! ray packet benchmark: %d ray(s) differ from ray_query",mismatches);
+
+	return						(single_time);
+}
+
+void CObjectSpace::ray_packet_benchmark	(u32 ray_count)
+{
+	if (!Static.get_tris()) {
+		Msg						("! ray packet benchmark: no collision model loaded");
+		return;
+	}
+
+	enum {
+		packet_size				= 64,
+	};
+	ray_count					= _max(ray_count,u32(packet_size));
+
+	CRandom						random(0x5eed);
+	Fvector						size;
+	m_BoundingVolume.getsize	(size);
+	float						range = size.magnitude()*.25f;
+
+	// coherent : every packet starts at one point and looks into a 10 degrees cone, as the hemisphere samples do
+	// random : every ray has its own start and direction
+	xr_vector<CDB::RAY>			sets[2];
+	LPCSTR						set_names[2] = { "coherent", "random" };
+	for (u32 s=0; s<2; ++s) {
+		sets[s].resize			(ray_count);
+		Fvector					start, axis;
+		for (u32 i=0; i<ray_count; ++i) {
+			if (s || !(i % packet_size)) {
+				start.set		(
+					m_BoundingVolume.min.x + random.randF(size.x),
+					m_BoundingVolume.min.y + random.randF(size.y),
+					m_BoundingVolume.min.z + random.randF(size.z)
+				);
+				axis.random_dir	(random);
+			}
+
+			CDB::RAY&			ray = sets[s][i];
+			ray.start			= start;
+			if (s)				ray.dir	= axis;
+			else				ray.dir.random_dir	(axis,deg2rad(10.f),random);
+			ray.dir.normalize	();
+			ray.range			= range;
+		}
+	}
+
+	struct {
+		u32						options;
+		LPCSTR					name;
+	} modes[] = {
+		{ CDB::OPT_CULL|CDB::OPT_ONLYNEAREST,	"nearest"	},
+		{ CDB::OPT_ONLYFIRST,					"first"		},
+		{ 0,									"all hits"	},
+	};
+
+	Msg							("* ray packet benchmark: %d ray(s), %.1fm long, %d per packet",ray_count,range,packet_size);
+	for (u32 s=0; s<2; ++s) {
+		for (u32 m=0; m<sizeof(modes)/sizeof(modes[0]); ++m) {
+			float				packet_time;
+			float				single_time = ray_packet_benchmark_run(Static,sets[s],modes[m].options,packet_size,packet_time);
+			Msg					(
+				"*   %-8s %-8s : single %10.0f rays/s, packets %10.0f rays/s, x%.2f",
+				set_names[s],
+				modes[m].name,
+				single_time > 0.f ? float(ray_count)/single_time : 0.f,
+				packet_time > 0.f ? float(ray_count)/packet_time : 0.f,
+				packet_time > 0.f ? single_time/packet_time : 0.f
+			);
+		}
+	}
+}
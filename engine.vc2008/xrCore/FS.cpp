@@ -22,9 +22,11 @@
 	u32								g_file_mapped_count	= 0;
 	typedef xr_map<u32,std::pair<u32,shared_str> >	FILE_MAPPINGS;
 	FILE_MAPPINGS					g_file_mappings;
+	xrCriticalSection				g_file_mappings_lock;	// archive entries are mapped by the FS I/O threads too
 
 void register_file_mapping			(void *address, const u32 &size, LPCSTR file_name)
 {
+	xrCriticalSection::raii			lock(&g_file_mappings_lock);
 	FILE_MAPPINGS::const_iterator	I = g_file_mappings.find(*(u32*)&address);
 	VERIFY							(I == g_file_mappings.end());
 	g_file_mappings.insert			(std::make_pair(*(u32*)&address,std::make_pair(size,shared_str(file_name))));
@@ -43,6 +45,7 @@ void register_file_mapping			(void *address, const u32 &size, LPCSTR file_name)
 
 void unregister_file_mapping		(void *address, const u32 &size)
 {
+	xrCriticalSection::raii			lock(&g_file_mappings_lock);
 	FILE_MAPPINGS::iterator			I = g_file_mappings.find(*(u32*)&address);
 	VERIFY							(I != g_file_mappings.end());
 //	VERIFY2							((*I).second.first == size,make_string("file mapping sizes are different: %d -> %d",(*I).second.first,size));
@@ -60,6 +63,7 @@ void unregister_file_mapping		(void *address, const u32 &size)
 
 XRCORE_API void dump_file_mappings	()
 {
+	xrCriticalSection::raii			lock(&g_file_mappings_lock);
 	Msg								("* active file mappings (%d):",g_file_mappings.size());
 
 	FILE_MAPPINGS::const_iterator	I = g_file_mappings.begin();
@@ -185,6 +185,7 @@ CLocatorAPI::CLocatorAPI()
 	dwAllocGranularity	= sys_inf.dwAllocationGranularity;
     m_iLockRescan		= 0; 
 	dwOpenCounter		= 0;
+	m_async				= 0;
 }
 
 CLocatorAPI::~CLocatorAPI()
@@ -212,7 +213,7 @@ void CLocatorAPI::Register		(LPCSTR name, u32 vfs, u32 crc, u32 ptr, u32 size_re
     desc.modif			= modif & (~u32(0x3));
 //	Msg("registering file %s - %d", name, size_real);
 //	if file already exist - update info
-	files_it			I = m_files.find(desc);
+	files_it			I = file_find(desc.name);
 	if (I != m_files.end()) {
 //.		Msg("-- file already scanned [%s]", I->name);
 		desc.name		= I->name;
@@ -227,7 +228,7 @@ void CLocatorAPI::Register		(LPCSTR name, u32 vfs, u32 crc, u32 ptr, u32 size_re
 	}
 
 	// otherwise insert file
-	m_files.insert		(desc); 
+	file_insert			(desc); 
 	
 	// Try to register folder(s)
 	string_path			temp;	
@@ -246,7 +247,7 @@ void CLocatorAPI::Register		(LPCSTR name, u32 vfs, u32 crc, u32 ptr, u32 size_re
 			desc.size_real		= 0;
 			desc.size_compressed= 0;
             desc.modif			= u32(-1);
-            std::pair<files_it,bool> I = m_files.insert(desc); 
+            std::pair<files_it,bool> I = file_insert(desc); 
 
             R_ASSERT(I.second);
 		}
@@ -468,8 +469,8 @@ void CLocatorAPI::unload_archive(CLocatorAPI::archive& A)
 			Msg("unregistering file [%s]", I->name);
 #endif // #ifndef MASTER_GOLD
 			char* str		= LPSTR(I->name);
+			file_erase		(I);
 			xr_free			(str);
-			m_files.erase	(I);
 			break;
 		}
 	}	
@@ -812,6 +813,7 @@ void CLocatorAPI::_initialize	(u32 flags, LPCSTR target_folder, LPCSTR fs_name)
 	Msg				("FS: %d files cached %d archives, %dKb memory used.",m_files.size(),m_archives.size(), (M2-M1)/1024);
 
 	m_Flags.set		(flReady,TRUE);
+	m_Flags.set		(flTraceLookups,0!=strstr(Core.Params,"-fs_trace_lookups"));
 
 	Msg("Init FileSystem %f sec",t.GetElapsed_sec());
 	//-----------------------------------------------------------
@@ -843,6 +845,8 @@ void CLocatorAPI::_initialize	(u32 flags, LPCSTR target_folder, LPCSTR fs_name)
 
 void CLocatorAPI::_destroy		()
 {
+	xr_delete		(m_async);
+
 	CloseLog		();
 
 	for				(files_it I=m_files.begin(); I!=m_files.end(); I++)
@@ -850,7 +854,11 @@ void CLocatorAPI::_destroy		()
 		char* str	= LPSTR(I->name);
 		xr_free		(str);
 	}
+	m_files_index.clear	();
 	m_files.clear		();
+	for				(xr_vector<LPSTR>::iterator I=m_lookup_trace.begin(); I!=m_lookup_trace.end(); ++I)
+		xr_free		(*I);
+	m_lookup_trace.clear_and_free	();
 	for				(PathPairIt p_it=pathes.begin(); p_it!=pathes.end(); p_it++)
     {
 		char* str	= LPSTR(p_it->first);
@@ -916,9 +924,7 @@ xr_vector<char*>* CLocatorAPI::file_list_open			(const char* _path, u32 flags)
 	else					
 		xr_strcpy(N,sizeof(N), _path);
 
-	file			desc;
-	desc.name		= N;
-	files_it	I 	= m_files.find(desc);
+	files_it	I 	= file_find(N);
 	if (I==m_files.end())	return 0;
 	
 	xr_vector<char*>*	dest	= xr_new<xr_vector<char*> > ();
@@ -974,9 +980,7 @@ int CLocatorAPI::file_list(FS_FileSet& dest, LPCSTR path, u32 flags, LPCSTR mask
     else			
 		xr_strcpy(N,sizeof(N),path);
 
-	file			desc;
-	desc.name		= N;
-	files_it	I 	= m_files.find(desc);
+	files_it	I 	= file_find(N);
 	if (I==m_files.end())	return 0;
 
 	SStringVec 		masks;
@@ -1130,16 +1134,22 @@ void CLocatorAPI::file_from_archive	(IReader *&R, LPCSTR fname, const file &desc
 {
 	// Archived one
 	archive& A					= m_archives[desc.vfs];
+	file_from_archive			(R,fname,desc,A.hSrcMap,A.size,*A.path);
+}
+
+// does not touch the file set and the archive list, so the I/O threads can use it
+void CLocatorAPI::file_from_archive	(IReader *&R, LPCSTR fname, const file &desc, void *archive_map, u32 archive_size, LPCSTR archive_path)
+{
 	u32 start					= (desc.ptr/dwAllocGranularity)*dwAllocGranularity;
 	u32 end						= (desc.ptr+desc.size_compressed)/dwAllocGranularity;
 	if ((desc.ptr+desc.size_compressed)%dwAllocGranularity)	end+=1;
 	end							*= dwAllocGranularity;
-	if (end>A.size)				end = A.size;
+	if (end>archive_size)		end = archive_size;
 	u32 sz						= (end-start);
-	u8* ptr						= (u8*)MapViewOfFile(A.hSrcMap, FILE_MAP_READ, 0, start, sz); VERIFY3(ptr,"cannot create file mapping on file",fname);
+	u8* ptr						= (u8*)MapViewOfFile(archive_map, FILE_MAP_READ, 0, start, sz); VERIFY3(ptr,"cannot create file mapping on file",fname);
 
 	string512					temp;
-	xr_sprintf					(temp, sizeof(temp),"%s:%s",*A.path,fname);
+	xr_sprintf					(temp, sizeof(temp),"%s:%s",archive_path,fname);
 
 #ifdef DEBUG
 	register_file_mapping		(ptr,sz,temp);
@@ -1162,6 +1172,101 @@ void CLocatorAPI::file_from_archive	(IReader *&R, LPCSTR fname, const file &desc
 #endif // DEBUG
 }
 
+namespace {
+
+// a decompressed archive entry in a section backed by the page file : the section is named after
+// the compressed data, so the processes of the box, which open the same entry, share its pages
+class CSharedEntryReader : public IReader
+{
+public:
+	enum {
+		header_size				= 16,	// the ready flag, the data stays aligned
+		wait_time				= 30000,
+	};
+
+private:
+	HANDLE						m_section;
+	void						*m_view;
+
+public:
+								CSharedEntryReader	(HANDLE section, void *view, u32 size) :
+									IReader((u8*)view + header_size,size,0),
+									m_section(section),
+									m_view(view)
+	{
+	}
+
+	virtual						~CSharedEntryReader	()
+	{
+		UnmapViewOfFile			(m_view);
+		CloseHandle				(m_section);
+	}
+};
+
+} // namespace
+
+// the first process decompresses the entry into the section, the others wait for it to be ready;
+// returns 0 if the section cannot be created, so the caller decompresses into the heap
+IReader *CLocatorAPI::file_from_archive_shared	(LPCSTR fname, const file &desc)
+{
+	VERIFY						(desc.size_real != desc.size_compressed);
+
+	archive						&A = m_archives[desc.vfs];
+	u32 start					= (desc.ptr/dwAllocGranularity)*dwAllocGranularity;
+	u32 end						= (desc.ptr+desc.size_compressed)/dwAllocGranularity;
+	if ((desc.ptr+desc.size_compressed)%dwAllocGranularity)	end+=1;
+	end							*= dwAllocGranularity;
+	if (end>A.size)				end = A.size;
+	u32 sz						= (end-start);
+	u8* ptr						= (u8*)MapViewOfFile(A.hSrcMap, FILE_MAP_READ, 0, start, sz); VERIFY3(ptr,"cannot create file mapping on file",fname);
+
+#ifdef DEBUG
+	string512					temp;
+	xr_sprintf					(temp, sizeof(temp),"%s:%s",*A.path,fname);
+	register_file_mapping		(ptr,sz,temp);
+#endif // DEBUG
+
+	const u8					*source = ptr + desc.ptr - start;
+	string64					name;
+	xr_sprintf					(name,sizeof(name),"Local\\xray_fs_%08x_%08x_%08x",crc32(source,desc.size_compressed),desc.size_compressed,desc.size_real);
+
+	IReader						*R = 0;
+	HANDLE						section = CreateFileMapping(INVALID_HANDLE_VALUE,0,PAGE_READWRITE,0,CSharedEntryReader::header_size + desc.size_real,name);
+	bool						created = (GetLastError() != ERROR_ALREADY_EXISTS);
+	void						*view = section ? MapViewOfFile(section,FILE_MAP_ALL_ACCESS,0,0,0) : 0;
+	if (view) {
+		volatile LONG			*ready = (volatile LONG*)view;
+		if (created) {
+			rtc_decompress		((u8*)view + CSharedEntryReader::header_size,desc.size_real,source,desc.size_compressed);
+			InterlockedExchange	((LONG*)ready,1);
+		}
+		else {
+			CTimer				timer;
+			timer.Start			();
+			while (!*ready && (timer.GetElapsed_ms() < CSharedEntryReader::wait_time))
+				Sleep			(1);
+		}
+
+		if (*ready)
+			R					= xr_new<CSharedEntryReader>(section,view,desc.size_real);
+		else {
+			Msg					("! the shared copy of %s is not ready in time",fname);
+			UnmapViewOfFile		(view);
+		}
+	}
+
+	if (!R && section)
+		CloseHandle				(section);
+
+	UnmapViewOfFile				(ptr);
+
+#ifdef DEBUG
+	unregister_file_mapping		(ptr,sz);
+#endif // DEBUG
+
+	return						(R);
+}
+
 void CLocatorAPI::file_from_archive	(CStreamReader *&R, LPCSTR fname, const file &desc)
 {
 	archive						&A = m_archives[desc.vfs];
@@ -1283,10 +1388,7 @@ bool CLocatorAPI::check_for_file	(LPCSTR path, LPCSTR _fname, string_path& fname
 		update_path			(fname,path,fname);
 
 	// Search entry
-	file					desc_f;
-	desc_f.name				= fname;
-
-	files_it				I = m_files.find(desc_f);
+	files_it				I = file_find(fname);
 	if (I == m_files.end())
 		return				(false);
 
@@ -1330,9 +1432,56 @@ CStreamReader* CLocatorAPI::rs_open	(LPCSTR path, LPCSTR _fname)
 
 IReader *CLocatorAPI::r_open	(LPCSTR path, LPCSTR _fname)
 {
+	if (m_async && m_async->prefetched()) {
+		string_path			fname;
+		xr_strcpy			(fname,_fname);
+		xr_strlwr			(fname);
+		if (path&&path[0])
+			update_path		(fname,path,fname);
+
+		IReader				*R = m_async->take_prefetched(fname);
+		if (R) {
+			if (m_Flags.test(flDumpFileActivity))
+				_register_open_file	(R,fname);
+			return			(R);
+		}
+	}
+
 	return					(r_open_impl<IReader>(path,_fname));
 }
 
+IReader *CLocatorAPI::r_open_mapped	(LPCSTR path, LPCSTR _fname)
+{
+	IReader					*R = 0;
+	string_path				fname;
+	const file				*desc = 0;
+
+	if (!check_for_file(path,_fname,fname,desc))
+		return				(0);
+
+	if (0xffffffff == desc->vfs) {
+		if (desc->size_real)
+			R				= xr_new<CVirtualFileReader>(fname);
+		else
+			file_from_cache_impl(R,fname,*desc);
+	}
+	else {
+		if (desc->size_real != desc->size_compressed)
+			R				= file_from_archive_shared(fname,*desc);
+
+		if (!R) {
+			if (desc->size_real != desc->size_compressed)
+				Msg			("~ file %s is compressed in archive, it is loaded into the heap",fname);
+			file_from_archive	(R,fname,*desc);
+		}
+	}
+
+	if (m_Flags.test(flDumpFileActivity))
+		_register_open_file	(R,fname);
+
+	return					(R);
+}
+
 void	CLocatorAPI::r_close	(IReader* &fs)
 {
 	if( m_Flags.test(flDumpFileActivity) )
@@ -1349,6 +1498,94 @@ void	CLocatorAPI::r_close	(CStreamReader* &fs)
 	fs->close					();
 }
 
+CFS_AsyncReader &CLocatorAPI::async	()
+{
+	if (m_async)
+		return					(*m_async);
+
+	xrCriticalSection::raii		lock(&m_async_lock);
+	if (!m_async) {
+		// the threads mostly wait for the disk, a few of them are enough to keep it busy
+		u32						thread_count = _max(u32(1),_min(u32(CPU::ID.n_threads/2),u32(CFS_AsyncReader::max_thread_count)));
+		if (strstr(Core.Params,"-fs_async_threads ")) {
+			sscanf				(strstr(Core.Params,"-fs_async_threads ")+18,"%d",&thread_count);
+			clamp				(thread_count,u32(1),u32(16));
+		}
+		m_async					= xr_new<CFS_AsyncReader>(*this,thread_count);
+	}
+	return						(*m_async);
+}
+
+FS_AsyncRequest *CLocatorAPI::async_request	(LPCSTR fname, const file &desc, FS_AsyncPriority priority, const FS_AsyncRequest::callback_type &callback)
+{
+	FS_AsyncRequest				*request = async().create(fname,priority,callback);
+	request->m_vfs				= desc.vfs;
+	request->m_ptr				= desc.ptr;
+	request->m_size_real		= desc.size_real;
+	request->m_size_compressed	= desc.size_compressed;
+	if (0xffffffff != desc.vfs) {
+		archive					&A = m_archives[desc.vfs];
+		request->m_archive_map	= A.hSrcMap;
+		request->m_archive_size	= A.size;
+		request->m_archive_path	= *A.path;
+	}
+	return						(request);
+}
+
+FS_AsyncRequest *CLocatorAPI::r_open_async	(LPCSTR path, LPCSTR _fname, FS_AsyncPriority priority, const FS_AsyncRequest::callback_type &callback)
+{
+	string_path					fname;
+	const file					*desc = 0;
+	if (!check_for_file(path,_fname,fname,desc))
+		return					(0);
+
+	FS_AsyncRequest				*request = async_request(fname,*desc,priority,callback);
+	m_async->push				(request);
+	return						(request);
+}
+
+IReader *CLocatorAPI::r_wait	(FS_AsyncRequest* &request)
+{
+	VERIFY						(request && m_async);
+	string_path					fname;
+	if (m_Flags.test(flDumpFileActivity))
+		xr_strcpy				(fname,request->name());
+
+	IReader						*R = m_async->wait(request);
+	request						= 0;
+
+	if (R && m_Flags.test(flDumpFileActivity))
+		_register_open_file		(R,fname);
+
+	return						(R);
+}
+
+void CLocatorAPI::r_cancel		(FS_AsyncRequest* &request)
+{
+	VERIFY						(request && m_async);
+	m_async->cancel				(request);
+	request						= 0;
+}
+
+void CLocatorAPI::r_prefetch	(LPCSTR path, LPCSTR _fname)
+{
+	string_path					fname;
+	const file					*desc = 0;
+	if (!check_for_file(path,_fname,fname,desc))
+		return;
+
+	if (async().prefetched(fname))
+		return;
+
+	m_async->prefetch			(async_request(fname,*desc,FS_AsyncPrefetch,FS_AsyncRequest::callback_type()));
+}
+
+void CLocatorAPI::r_prefetch_release	()
+{
+	if (m_async)
+		m_async->release_prefetched	();
+}
+
 IWriter* CLocatorAPI::w_open	(LPCSTR path, LPCSTR _fname)
 {
 	string_path	fname;
@@ -1398,15 +1635,32 @@ CLocatorAPI::files_it CLocatorAPI::file_find_it(LPCSTR fname)
 	//     
     check_pathes	();
 
-	file			desc_f;
-	string_path		file_name;
-	VERIFY			(xr_strlen(fname)*sizeof(char) < sizeof(file_name));
-	xr_strcpy		(file_name,sizeof(file_name),fname);
-	desc_f.name		= file_name;
-//	desc_f.name		= xr_strlwr(xr_strdup(fname));
-    files_it I		= m_files.find(desc_f);
-//	xr_free			(desc_f.name);
-	return			(I);
+	VERIFY			(xr_strlen(fname)*sizeof(char) < sizeof(string_path));
+	return			(file_find(fname));
+}
+
+CLocatorAPI::files_it CLocatorAPI::file_find(LPCSTR name)
+{
+	if (m_Flags.test(flTraceLookups)) {
+		xrCriticalSection::raii	lock(&m_trace_lock);
+		m_lookup_trace.push_back(xr_strdup(name));
+	}
+
+	return			(m_files_index.find(name,m_files.end()));
+}
+
+std::pair<CLocatorAPI::files_it,bool> CLocatorAPI::file_insert(const file& desc)
+{
+	std::pair<files_it,bool>	result = m_files.insert(desc);
+	if (result.second)
+		m_files_index.insert	(result.first);
+	return			(result);
+}
+
+void CLocatorAPI::file_erase(files_it I)
+{
+	m_files_index.erase	(I);
+	m_files.erase	(I);
 }
 
 BOOL CLocatorAPI::dir_delete(LPCSTR path,LPCSTR nm,BOOL remove_files)
@@ -1431,7 +1685,7 @@ BOOL CLocatorAPI::dir_delete(LPCSTR path,LPCSTR nm,BOOL remove_files)
 //		        const char* entry_begin = entry.name+base_len;
 				if (!remove_files) return FALSE;
 		    	unlink		(entry.name);
-				m_files.erase	(cur_item);
+				file_erase	(cur_item);
 	        }else{
             	folders.insert(entry);
             }
@@ -1443,7 +1697,9 @@ BOOL CLocatorAPI::dir_delete(LPCSTR path,LPCSTR nm,BOOL remove_files)
 	    const char* end_symbol = r_it->name+xr_strlen(r_it->name)-1;
     	if ((*end_symbol) =='\\'){
         	_rmdir		(r_it->name);
-            m_files.erase	(*r_it);
+            files_it I	= file_find(r_it->name);
+            if (I!=m_files.end())
+                file_erase	(I);
         }
     }
     return TRUE;
@@ -1460,8 +1716,8 @@ void CLocatorAPI::file_delete(LPCSTR path, LPCSTR nm)
 	    // remove file
     	unlink			(I->name);
 		char* str		= LPSTR(I->name);
+	    file_erase		(I);
 		xr_free			(str);
-	    m_files.erase		(I);
     }
 }
 
@@ -1489,18 +1745,18 @@ void CLocatorAPI::file_rename(LPCSTR src, LPCSTR dest, bool bOwerwrite)
 	        if (!bOwerwrite) return;
             unlink		(D->name);
 			char* str	= LPSTR(D->name);
+			file_erase	(D);
 			xr_free		(str);
-			m_files.erase	(D);
         }
 
         file new_desc	= *S;
 		// remove existing item
 		char* str		= LPSTR(S->name);
+		file_erase		(S);
 		xr_free			(str);
-		m_files.erase		(S);
 		// insert updated item
         new_desc.name	= xr_strlwr(xr_strdup(dest));
-		m_files.insert	(new_desc); 
+		file_insert		(new_desc); 
         
         // physically rename file
         VerifyPath		(dest);
@@ -1597,8 +1853,8 @@ void CLocatorAPI::rescan_path(LPCSTR full_path, BOOL bRecurse)
         if (!bRecurse&&strstr(entry_begin,"\\"))		continue;
         // erase item
 		char* str		= LPSTR(cur_item->name);
+		file_erase		(cur_item);
 		xr_free			(str);
-		m_files.erase		(cur_item);
 	}
     bNoRecurse	= !bRecurse;
     Recurse		(full_path);
@@ -1680,3 +1936,133 @@ BOOL CLocatorAPI::can_modify_file(LPCSTR path, LPCSTR name)
     update_path			(temp,path,name);
 	return can_modify_file(temp);
 }
+
+void CLocatorAPI::lookup_benchmark	()
+{
+	xr_vector<LPCSTR>		trace;
+	{
+		xrCriticalSection::raii	lock(&m_trace_lock);
+		trace.assign		(m_lookup_trace.begin(),m_lookup_trace.end());
+	}
+
+	// nothing recorded : every known name plus the same amount of misses, shuffled
+	bool					recorded = !trace.empty();
+	xr_vector<xr_string>	misses;
+	if (!recorded) {
+		misses.reserve		(m_files.size());
+		for (files_it I=m_files.begin(); I!=m_files.end(); ++I) {
+			trace.push_back	(I->name);
+			misses.push_back(xr_string(I->name) + ".missing");
+		}
+		for (xr_vector<xr_string>::const_iterator I=misses.begin(); I!=misses.end(); ++I)
+			trace.push_back	((*I).c_str());
+		std::random_shuffle	(trace.begin(),trace.end());
+	}
+
+	if (trace.empty()) {
+		Msg					("! there is nothing to look up");
+		return;
+	}
+
+	u32						pass_count = _max(u32(1),u32(1000000/trace.size()));
+	u32						lookup_count = pass_count*trace.size();
+	u32						set_found = 0, index_found = 0;
+	CTimer					timer;
+
+	file					desc;
+	timer.Start				();
+	for (u32 pass=0; pass<pass_count; ++pass) {
+		for (xr_vector<LPCSTR>::const_iterator I=trace.begin(), E=trace.end(); I!=E; ++I) {
+			desc.name		= *I;
+			if (m_files.find(desc) != m_files.end())
+				++set_found;
+		}
+	}
+	float					set_time = timer.GetElapsed_sec();
+
+	timer.Start				();
+	for (u32 pass=0; pass<pass_count; ++pass) {
+		for (xr_vector<LPCSTR>::const_iterator I=trace.begin(), E=trace.end(); I!=E; ++I) {
+			if (m_files_index.find(*I,m_files.end()) != m_files.end())
+				++index_found;
+		}
+	}
+	float					index_time = timer.GetElapsed_sec();
+
+	// tree node : the value, three links and two flags, plus the heap block header
+	u32						set_memory = m_files.size()*(sizeof(file) + 3*sizeof(void*) + 2*sizeof(char) + 2*sizeof(void*));
+
+	Msg						("* FS lookup benchmark: %d %s lookup(s) x %d pass(es), %d file(s)",trace.size(),recorded ? "recorded" : "synthetic",pass_count,m_files.size());
+	Msg						("*   ordered set : %10.0f lookups/s, ~%d Kb",set_time > 0.f ? float(lookup_count)/set_time : 0.f,set_memory/1024);
+	Msg						("*   hash index  : %10.0f lookups/s, %d Kb for %d entries",index_time > 0.f ? float(lookup_count)/index_time : 0.f,m_files_index.memory_usage()/1024,m_files_index.size());
+	if (set_found != index_found)
+		Msg					("! results differ : %d found in the set, %d in the index",set_found,index_found);
+}
+
+void CLocatorAPI::async_benchmark	(LPCSTR path, LPCSTR folder)
+{
+	xr_vector<LPSTR>		*list = file_list_open(path,folder,FS_ListFiles);
+	if (!list || list->empty()) {
+		Msg					("! there are no files in %s %s",path,folder);
+		if (list)
+			file_list_close	(list);
+		return;
+	}
+
+	string_path				root;
+	update_path				(root,path,folder);
+
+	xr_vector<xr_string>	names;
+	names.reserve			(list->size());
+	for (xr_vector<LPSTR>::const_iterator I=list->begin(); I!=list->end(); ++I) {
+		string_path			fname;
+		strconcat			(sizeof(fname),fname,root,*I);
+		names.push_back		(fname);
+	}
+	file_list_close			(list);
+
+	u32						count = names.size();
+	xr_vector<u32>			serial_crc(count), async_crc(count);
+	xr_vector<FS_AsyncRequest*>	requests(count);
+	u64						total_size = 0;
+
+	// the first rounds pay for the cold page cache, take the best of each path
+	float					serial_time = flt_max, async_time = flt_max;
+	CTimer					timer;
+	for (u32 round=0; round<2; ++round) {
+		total_size			= 0;
+		timer.Start			();
+		for (u32 i=0; i<count; ++i) {
+			IReader			*R = r_open(names[i].c_str());
+			serial_crc[i]	= R ? crc32(R->pointer(),R->length()) : 0;
+			total_size		+= R ? R->length() : 0;
+			if (R)
+				r_close		(R);
+		}
+		serial_time			= _min(serial_time,timer.GetElapsed_sec());
+
+		// consumer checksums the files in order, while the I/O threads read the following ones
+		timer.Start			();
+		for (u32 i=0; i<count; ++i)
+			requests[i]		= r_open_async(names[i].c_str());
+		for (u32 i=0; i<count; ++i) {
+			IReader			*R = requests[i] ? r_wait(requests[i]) : 0;
+			async_crc[i]	= R ? crc32(R->pointer(),R->length()) : 0;
+			if (R)
+				r_close		(R);
+		}
+		async_time			= _min(async_time,timer.GetElapsed_sec());
+	}
+
+	u32						mismatch_count = 0;
+	for (u32 i=0; i<count; ++i)
+		if (serial_crc[i] != async_crc[i])
+			++mismatch_count;
+
+	float					size_mb = float(total_size)/(1024.f*1024.f);
+	Msg						("* FS async benchmark: %d file(s), %.1f Mb in %s, %d I/O thread(s)",count,size_mb,root,async().thread_count());
+	Msg						("*   serial : %.3f s, %.1f Mb/s",serial_time,serial_time > 0.f ? size_mb/serial_time : 0.f);
+	Msg						("*   async  : %.3f s, %.1f Mb/s",async_time,async_time > 0.f ? size_mb/async_time : 0.f);
+	if (mismatch_count)
+		Msg					("! %d file(s) differ from the serial read",mismatch_count);
+}
@@ -12,12 +12,15 @@
 #pragma warning(pop)
 
 #include "LocatorAPI_defs.h"
+#include "LocatorAPI_index.h"
+#include "LocatorAPI_async.h"
 
 class XRCORE_API CStreamReader;
 
 class XRCORE_API CLocatorAPI  
 {
 	friend class FS_Path;
+	friend class CFS_AsyncReader;
 public:
 	struct	file
 	{
@@ -54,6 +57,7 @@ private:
 	PathMap						pathes;
 
 	DEFINE_SET_PRED				(file,files_set,files_it,file_pred);
+	typedef fs_file_index<files_it>	files_index;
 
 	DEFINE_VECTOR				(_finddata_t,FFVec,FFIt);
 	FFVec						rec_files;
@@ -62,17 +66,26 @@ private:
     void						check_pathes	();
 
 	files_set					m_files			;
+	files_index					m_files_index	;	// name lookups, m_files is for the ordered walks
+	xrCriticalSection			m_trace_lock	;
+	xr_vector<LPSTR>			m_lookup_trace	;
 	BOOL						bNoRecurse		;
 
 	xrCriticalSection			m_auth_lock		;
 	u64							m_auth_code		;
 
+	xrCriticalSection			m_async_lock	;
+	CFS_AsyncReader*			m_async			;	// created on the first asynchronous request
+
 	void						Register		(LPCSTR name, u32 vfs, u32 crc, u32 ptr, u32 size_real, u32 size_compressed, u32 modif);
 	void						ProcessArchive	(LPCSTR path);
 	void						ProcessOne		(LPCSTR path, void* F);
 	bool						Recurse			(LPCSTR path);	
 
 	files_it					file_find_it	(LPCSTR n);
+	files_it					file_find		(LPCSTR name);
+	std::pair<files_it,bool>	file_insert		(const file& desc);
+	void						file_erase		(files_it I);
 public:
 	enum{
 		flNeedRescan			= (1<<0),
@@ -85,6 +98,7 @@ public:
 		flScanAppRoot			= (1<<7),
 		flNeedCheck				= (1<<8),
 		flDumpFileActivity		= (1<<9),
+		flTraceLookups			= (1<<11),
 	};    
 	Flags32						m_Flags			;
 	u32							dwAllocGranularity;
@@ -99,7 +113,9 @@ private:
 			void				file_from_cache		(T *&R, LPSTR fname, const u32 &fname_size, const file &desc, LPCSTR &source_name);
 			
 			void				file_from_archive	(IReader *&R, LPCSTR fname, const file &desc);
+			void				file_from_archive	(IReader *&R, LPCSTR fname, const file &desc, void *archive_map, u32 archive_size, LPCSTR archive_path);
 			void				file_from_archive	(CStreamReader *&R, LPCSTR fname, const file &desc);
+			IReader*			file_from_archive_shared(LPCSTR fname, const file &desc);
 
 			void				copy_file_to_build	(IWriter *W, IReader *r);
 			void				copy_file_to_build	(IWriter *W, CStreamReader *r);
@@ -111,6 +127,9 @@ private:
 	template <typename T>
 	IC		T					*r_open_impl		(LPCSTR path, LPCSTR _fname);
 
+			CFS_AsyncReader&	async				();
+			FS_AsyncRequest*	async_request		(LPCSTR fname, const file &desc, FS_AsyncPriority priority, const FS_AsyncRequest::callback_type &callback);
+
 private:
 			void				setup_fs_path		(LPCSTR fs_name, string_path &fs_path);
 			void				setup_fs_path		(LPCSTR fs_name);
@@ -125,9 +144,29 @@ public:
 	CStreamReader*				rs_open				(LPCSTR initial, LPCSTR N);
 	IReader*					r_open				(LPCSTR initial, LPCSTR N);
 	IC IReader*					r_open				(LPCSTR N){return r_open(0,N);}
+	// read-only view, shared between the processes of the box : loose files are mapped whatever the
+	// size (r_open reads the small ones into the heap), uncompressed archive entries are viewed through
+	// the archive mapping as r_open does, compressed ones are decompressed once into a named section
+	// backed by the page file (into the heap, if the section cannot be created)
+	IReader*					r_open_mapped		(LPCSTR initial, LPCSTR N);
+	IC IReader*					r_open_mapped		(LPCSTR N){return r_open_mapped(0,N);}
 	void						r_close				(IReader* &S);
 	void						r_close				(CStreamReader* &fs);
 
+	// asynchronous reads : the name is resolved right away (0 if there is no such file), the file is read,
+	// mapped and decompressed by the I/O threads. r_wait hands the reader over (close it with r_close),
+	// r_cancel drops it, either one must be called for every request. the callback, if any, is called
+	// on the thread which has read the file, before the request becomes ready
+	FS_AsyncRequest*			r_open_async		(LPCSTR initial, LPCSTR N, FS_AsyncPriority priority=FS_AsyncNormal, const FS_AsyncRequest::callback_type &callback=FS_AsyncRequest::callback_type());
+	IC FS_AsyncRequest*			r_open_async		(LPCSTR N, FS_AsyncPriority priority=FS_AsyncNormal){return r_open_async(0,N,priority);}
+	IReader*					r_wait				(FS_AsyncRequest* &request);
+	void						r_cancel			(FS_AsyncRequest* &request);
+	// prefetch hints : the file is read at the lowest priority and handed to the first r_open of the same name,
+	// hints nobody has asked for are dropped with r_prefetch_release
+	void						r_prefetch			(LPCSTR initial, LPCSTR N);
+	IC void						r_prefetch			(LPCSTR N){r_prefetch(0,N);}
+	void						r_prefetch_release	();
+
 	IWriter*					w_open				(LPCSTR initial, LPCSTR N);
 	IC IWriter*					w_open				(LPCSTR N){return w_open(0,N);}
 	IWriter*					w_open_ex			(LPCSTR initial, LPCSTR N);
@@ -152,6 +191,11 @@ public:
 	void 						file_rename			(LPCSTR src, LPCSTR dest,bool bOwerwrite=true);
     int							file_length			(LPCSTR src);
 
+	// replays the lookups recorded with -fs_trace_lookups (or all the known names) against the set and the index
+	void						lookup_benchmark	();
+	// reads all the files of the folder serially with r_open and through the I/O threads
+	void						async_benchmark		(LPCSTR initial, LPCSTR folder);
+
     u32  						get_file_age		(LPCSTR nm);
     void 						set_file_age		(LPCSTR nm, u32 age);
 
@@ -0,0 +1,307 @@
+#include "stdafx.h"
+#pragma hdrstop
+
+#include "LocatorAPI_async.h"
+
+CFS_AsyncReader::CFS_AsyncReader	(CLocatorAPI &fs, u32 thread_count) :
+	m_fs				(fs),
+	m_prefetched_count	(0),
+	m_prefetched_size	(0),
+	m_thread_count		(thread_count),
+	m_alive				(thread_count),
+	m_must_exit			(FALSE)
+{
+	VERIFY				(thread_count);
+	m_wake				= CreateSemaphore(NULL,0,0x7fffffff,NULL);
+	R_ASSERT			(m_wake);
+
+	for (u32 i=0; i<thread_count; ++i)
+		thread_spawn	(&CFS_AsyncReader::thread_entry,"X-RAY FS I/O",0,this);
+
+	Msg					("* FS async reader: %d I/O thread(s)",thread_count);
+}
+
+CFS_AsyncReader::~CFS_AsyncReader	()
+{
+	release_prefetched	();
+
+	m_must_exit			= TRUE;
+	ReleaseSemaphore	(m_wake,m_thread_count,NULL);
+	while (m_alive)
+		Sleep			(0);
+
+	CloseHandle			(m_wake);
+
+	// nobody is going to wait for these anymore
+	for (u32 i=0; i<FS_AsyncPriorityCount; ++i) {
+		for (QUEUE::iterator I=m_queues[i].begin(), E=m_queues[i].end(); I!=E; ++I) {
+			CloseHandle	((*I)->m_event);
+			xr_delete	(*I);
+		}
+		m_queues[i].clear	();
+	}
+
+	for (REQUESTS_IT I=m_free.begin(), E=m_free.end(); I!=E; ++I) {
+		CloseHandle		((*I)->m_event);
+		xr_delete		(*I);
+	}
+	m_free.clear		();
+}
+
+void CFS_AsyncReader::thread_entry	(void *self)
+{
+	((CFS_AsyncReader*)self)->thread_loop	();
+}
+
+void CFS_AsyncReader::thread_loop	()
+{
+	for (;;) {
+		WaitForSingleObject	(m_wake,INFINITE);
+		if (m_must_exit)
+			break;
+
+		// the request may have been taken by its waiter already, then there is nothing to do
+		FS_AsyncRequest	*request = 0;
+		{
+			xrCriticalSection::raii	lock(&m_lock);
+			for (u32 i=0; i<FS_AsyncPriorityCount; ++i) {
+				if (m_queues[i].empty())
+					continue;
+
+				request	= m_queues[i].front();
+				m_queues[i].pop_front	();
+				request->m_state	= FS_AsyncRequest::stateRunning;
+				break;
+			}
+		}
+
+		if (request)
+			process		(*request);
+	}
+
+	InterlockedDecrement	(&m_alive);
+}
+
+void CFS_AsyncReader::process		(FS_AsyncRequest &request)
+{
+	CLocatorAPI::file	desc;
+	desc.name			= request.m_name;
+	desc.vfs			= request.m_vfs;
+	desc.crc			= 0;
+	desc.ptr			= request.m_ptr;
+	desc.size_real		= request.m_size_real;
+	desc.size_compressed= request.m_size_compressed;
+	desc.modif			= 0;
+
+	IReader				*R = 0;
+	if (0xffffffff == desc.vfs)
+		m_fs.file_from_cache_impl	(R,request.m_name,desc);
+	else
+		m_fs.file_from_archive		(R,request.m_name,desc,request.m_archive_map,request.m_archive_size,request.m_archive_path);
+
+	// mapped views are only promises, fault every page in here and not on the consumer thread
+	if (R) {
+		const u8		*data = (const u8*)R->pointer();
+		volatile u8		sink;
+		for (int i=0, n=R->length(); i<n; i+=4096)
+			sink		= data[i];
+	}
+
+	// prefetched data waits for its consumer, which may never come, so it is bounded
+	if (R && (request.m_priority == FS_AsyncPrefetch)) {
+		bool			drop;
+		{
+			xrCriticalSection::raii	lock(&m_lock);
+			drop		= (m_prefetched_size + request.m_size_real > prefetch_budget);
+			if (!drop)
+				m_prefetched_size	+= request.m_size_real;
+		}
+
+		// the page cache stays warm anyway
+		if (drop)
+			xr_delete	(R);
+	}
+
+	request.m_reader	= R;
+	if (request.m_callback)
+		request.m_callback	(request);
+
+	InterlockedExchange	(&request.m_state,FS_AsyncRequest::stateDone);
+	SetEvent			(request.m_event);
+}
+
+FS_AsyncRequest *CFS_AsyncReader::create	(LPCSTR name, FS_AsyncPriority priority, const FS_AsyncRequest::callback_type &callback)
+{
+	VERIFY				(priority < FS_AsyncPriorityCount);
+
+	FS_AsyncRequest		*request = 0;
+	{
+		xrCriticalSection::raii	lock(&m_lock);
+		if (!m_free.empty()) {
+			request		= m_free.back();
+			m_free.pop_back	();
+		}
+	}
+
+	if (!request) {
+		request			= xr_new<FS_AsyncRequest>();
+		request->m_event= CreateEvent(NULL,TRUE,FALSE,NULL);
+		R_ASSERT		(request->m_event);
+	}
+
+	xr_strcpy			(request->m_name,name);
+	request->m_vfs		= 0xffffffff;
+	request->m_ptr		= 0;
+	request->m_size_real		= 0;
+	request->m_size_compressed	= 0;
+	request->m_archive_map		= 0;
+	request->m_archive_size		= 0;
+	request->m_archive_path		= 0;
+	request->m_priority	= priority;
+	request->m_callback	= callback;
+	request->m_reader	= 0;
+	request->m_state	= FS_AsyncRequest::stateQueued;
+	return				(request);
+}
+
+void CFS_AsyncReader::recycle		(FS_AsyncRequest *request)
+{
+	ResetEvent			(request->m_event);
+	request->m_callback.clear	();
+	request->m_reader	= 0;
+
+	xrCriticalSection::raii	lock(&m_lock);
+	m_free.push_back	(request);
+}
+
+void CFS_AsyncReader::push			(FS_AsyncRequest *request)
+{
+	{
+		xrCriticalSection::raii	lock(&m_lock);
+		m_queues[request->m_priority].push_back	(request);
+	}
+	ReleaseSemaphore	(m_wake,1,NULL);
+}
+
+bool CFS_AsyncReader::unqueue		(FS_AsyncRequest &request)
+{
+	if (request.m_state != FS_AsyncRequest::stateQueued)
+		return			(false);
+
+	xrCriticalSection::raii	lock(&m_lock);
+	if (request.m_state != FS_AsyncRequest::stateQueued)
+		return			(false);
+
+	QUEUE				&queue = m_queues[request.m_priority];
+	QUEUE::iterator		I = std::find(queue.begin(),queue.end(),&request);
+	VERIFY				(I != queue.end());
+	queue.erase			(I);
+	request.m_state		= FS_AsyncRequest::stateRunning;
+	return				(true);
+}
+
+IReader *CFS_AsyncReader::complete	(FS_AsyncRequest &request)
+{
+	// nobody has picked it yet : it is cheaper to read it here, than to wait for an I/O thread
+	if (unqueue(request)) {
+		// the consumer is here, so it is not a prefetch anymore and does not count against the budget
+		request.m_priority	= FS_AsyncHigh;
+		process			(request);
+	}
+	else
+		WaitForSingleObject	(request.m_event,INFINITE);
+
+	VERIFY				(request.ready());
+	return				(request.m_reader);
+}
+
+IReader *CFS_AsyncReader::wait		(FS_AsyncRequest *request)
+{
+	IReader				*R = complete(*request);
+	recycle			(request);
+	return				(R);
+}
+
+void CFS_AsyncReader::cancel		(FS_AsyncRequest *request)
+{
+	if (!unqueue(*request)) {
+		IReader			*R = complete(*request);
+		xr_delete		(R);
+	}
+	else
+		request->m_state= FS_AsyncRequest::stateDone;
+
+	recycle			(request);
+}
+
+bool CFS_AsyncReader::prefetched	(LPCSTR name)
+{
+	xrCriticalSection::raii	lock(&m_lock);
+	return				(m_prefetched.find(name) != m_prefetched.end());
+}
+
+void CFS_AsyncReader::prefetch		(FS_AsyncRequest *request)
+{
+	VERIFY				(request->m_priority == FS_AsyncPrefetch);
+	{
+		xrCriticalSection::raii	lock(&m_lock);
+		VERIFY			(m_prefetched.find(request->m_name) == m_prefetched.end());
+		m_prefetched.insert	(mk_pair(LPCSTR(request->m_name),request));
+		InterlockedIncrement	(&m_prefetched_count);
+	}
+	push				(request);
+}
+
+IReader *CFS_AsyncReader::take_prefetched	(LPCSTR name)
+{
+	FS_AsyncRequest		*request;
+	{
+		xrCriticalSection::raii	lock(&m_lock);
+		PREFETCHED_IT	I = m_prefetched.find(name);
+		if (I == m_prefetched.end())
+			return		(0);
+
+		request			= (*I).second;
+		m_prefetched.erase	(I);
+		InterlockedDecrement	(&m_prefetched_count);
+	}
+
+	IReader				*R = complete(*request);
+	if (R && (request->m_priority == FS_AsyncPrefetch)) {
+		xrCriticalSection::raii	lock(&m_lock);
+		VERIFY			(m_prefetched_size >= request->m_size_real);
+		m_prefetched_size	-= request->m_size_real;
+	}
+
+	recycle			(request);
+	return				(R);
+}
+
+void CFS_AsyncReader::release_prefetched	()
+{
+	PREFETCHED			prefetched;
+	{
+		xrCriticalSection::raii	lock(&m_lock);
+		prefetched.swap	(m_prefetched);
+		m_prefetched_count	= 0;
+	}
+
+	for (PREFETCHED_IT I=prefetched.begin(), E=prefetched.end(); I!=E; ++I) {
+		FS_AsyncRequest	*request = (*I).second;
+		if (unqueue(*request)) {
+			request->m_state	= FS_AsyncRequest::stateDone;
+			recycle	(request);
+			continue;
+		}
+
+		IReader			*R = complete(*request);
+		if (R) {
+			xrCriticalSection::raii	lock(&m_lock);
+			VERIFY		(m_prefetched_size >= request->m_size_real);
+			m_prefetched_size	-= request->m_size_real;
+		}
+
+		xr_delete		(R);
+		recycle		(request);
+	}
+}
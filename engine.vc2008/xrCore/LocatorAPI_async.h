@@ -0,0 +1,117 @@
+#ifndef LocatorAPI_asyncH
+#define LocatorAPI_asyncH
+#pragma once
+
+#include "fastdelegate.h"
+
+class CLocatorAPI;
+class CFS_AsyncReader;
+
+enum FS_AsyncPriority
+{
+	FS_AsyncHigh		= 0,	// somebody is going to wait for it right now
+	FS_AsyncNormal,
+	FS_AsyncPrefetch,			// read ahead hints
+	FS_AsyncPriorityCount
+};
+
+// handle of the asynchronous read, owned by the file system until r_wait/r_cancel
+class XRCORE_API FS_AsyncRequest
+{
+public:
+	typedef fastdelegate::FastDelegate1<FS_AsyncRequest&>	callback_type;
+
+	enum {
+		stateQueued		= 0,
+		stateRunning,
+		stateDone,
+	};
+
+private:
+	friend class CFS_AsyncReader;
+	friend class CLocatorAPI;
+
+	string_path				m_name;				// resolved low-case name
+	u32						m_vfs;				// the file descriptor is copied when the request is made,
+	u32						m_ptr;				// so the I/O threads never touch the file set
+	u32						m_size_real;
+	u32						m_size_compressed;
+	void*					m_archive_map;
+	u32						m_archive_size;
+	LPCSTR					m_archive_path;
+	FS_AsyncPriority		m_priority;
+	callback_type			m_callback;
+	IReader*				m_reader;
+	void*					m_event;			// manual reset, signalled in stateDone
+	volatile LONG			m_state;
+
+public:
+	IC		LPCSTR			name				() const	{ return m_name; }
+	IC		u32				size				() const	{ return m_size_real; }
+	IC		FS_AsyncPriority priority			() const	{ return m_priority; }
+	IC		bool			ready				() const	{ return m_state == stateDone; }
+};
+
+// pool of the I/O threads : archive entries are mapped and decompressed there,
+// loose files are opened/mapped, pages of the mapped files are touched, so
+// the consumer gets the data which is already in memory
+class CFS_AsyncReader
+{
+public:
+	enum {
+		max_thread_count	= 4,
+		prefetch_budget		= 128*1024*1024,	// data held by the not yet consumed prefetched readers
+	};
+
+private:
+	DEFINE_VECTOR			(FS_AsyncRequest*,REQUESTS,REQUESTS_IT);
+	DEFINE_MAP_PRED			(LPCSTR,FS_AsyncRequest*,PREFETCHED,PREFETCHED_IT,pred_str);
+	typedef xr_deque<FS_AsyncRequest*>	QUEUE;
+
+private:
+	CLocatorAPI&			m_fs;
+	xrCriticalSection		m_lock;
+	QUEUE					m_queues[FS_AsyncPriorityCount];
+	REQUESTS				m_free;
+	PREFETCHED				m_prefetched;
+	volatile LONG			m_prefetched_count;	// checked on every r_open without the lock
+	u32						m_prefetched_size;
+	void*					m_wake;				// semaphore
+	u32						m_thread_count;
+	volatile LONG			m_alive;
+	volatile BOOL			m_must_exit;
+
+private:
+	static	void			thread_entry		(void *self);
+			void			thread_loop			();
+			void			process				(FS_AsyncRequest &request);
+			bool			unqueue				(FS_AsyncRequest &request);
+			IReader*		complete			(FS_AsyncRequest &request);
+			void			recycle				(FS_AsyncRequest *request);
+
+public:
+							CFS_AsyncReader		(CLocatorAPI &fs, u32 thread_count);
+							~CFS_AsyncReader	();
+	IC		u32				thread_count		() const	{ return m_thread_count; }
+
+public:
+	// the file descriptor fields are filled by the file system before the request is pushed
+			FS_AsyncRequest*create				(LPCSTR name, FS_AsyncPriority priority, const FS_AsyncRequest::callback_type &callback);
+			void			push				(FS_AsyncRequest *request);
+	// blocks until the request is done (runs it on the calling thread if nobody has picked it yet),
+	// hands the reader over to the caller and releases the request
+			IReader*		wait				(FS_AsyncRequest *request);
+	// drops the request, closes the reader if it has been read already
+			void			cancel				(FS_AsyncRequest *request);
+
+public:
+	IC		bool			prefetched			() const	{ return !!m_prefetched_count; }
+			bool			prefetched			(LPCSTR name);
+	// pushes the request and remembers it until the first take_prefetched of the same name
+			void			prefetch			(FS_AsyncRequest *request);
+	// 0 if the name has not been prefetched or its data did not fit into the budget
+			IReader*		take_prefetched		(LPCSTR name);
+			void			release_prefetched	();
+};
+
+#endif // LocatorAPI_asyncH
@@ -0,0 +1,139 @@
+#ifndef LocatorAPI_indexH
+#define LocatorAPI_indexH
+#pragma once
+
+// open addressing (linear probing) hash index over the names of the file set
+// the set is still kept for the ordered walks (folder listings, rescans),
+// the index only answers "where is the file with exactly this name"
+template <typename _iterator>
+class fs_file_index
+{
+private:
+	enum {
+		slot_empty		= 0,
+		slot_deleted	= 1,
+		min_slot_count	= 1024,
+	};
+
+	struct slot
+	{
+		u32				hash;		// slot_empty, slot_deleted or the name hash
+		_iterator		it;
+	};
+	typedef xr_vector<slot>					SLOTS;
+	typedef typename SLOTS::iterator		SLOTS_IT;
+
+	SLOTS				m_slots;
+	u32					m_count;	// live entries
+	u32					m_used;		// live entries + deleted ones
+
+private:
+	static IC u32		hash			(LPCSTR name)
+	{
+		// FNV-1a, the low values are reserved for the slot states
+		u32				result = 2166136261u;
+		for ( ; *name; ++name) {
+			result		^= u8(*name);
+			result		*= 16777619u;
+		}
+		return			(result > slot_deleted ? result : result + slot_deleted + 1);
+	}
+
+	IC void				rehash			(u32 slot_count)
+	{
+		SLOTS			slots;
+		slots.swap		(m_slots);
+
+		slot			empty;
+		empty.hash		= slot_empty;
+		m_slots.assign	(slot_count,empty);
+		m_used			= m_count;
+
+		u32				mask = slot_count - 1;
+		for (SLOTS_IT I = slots.begin(), E = slots.end(); I != E; ++I) {
+			if ((*I).hash <= slot_deleted)
+				continue;
+
+			u32			i = (*I).hash & mask;
+			while (m_slots[i].hash != slot_empty)
+				i		= (i + 1) & mask;
+			m_slots[i]	= *I;
+		}
+	}
+
+public:
+	IC					fs_file_index	() : m_count(0), m_used(0) {}
+
+	IC void				clear			()
+	{
+		m_slots.clear_and_free	();
+		m_count			= 0;
+		m_used			= 0;
+	}
+
+	IC u32				size			() const	{ return m_count; }
+	IC u32				memory_usage	() const	{ return m_slots.capacity()*sizeof(slot); }
+
+	IC _iterator		find			(LPCSTR name, const _iterator &none) const
+	{
+		if (m_slots.empty())
+			return		(none);
+
+		u32				h = hash(name);
+		u32				mask = m_slots.size() - 1;
+		for (u32 i = h & mask; ; i = (i + 1) & mask) {
+			const slot	&s = m_slots[i];
+			if (s.hash == slot_empty)
+				return	(none);
+
+			if ((s.hash == h) && !xr_strcmp(s.it->name,name))
+				return	(s.it);
+		}
+	}
+
+	// the name must not be in the index yet
+	IC void				insert			(const _iterator &it)
+	{
+		// keep the load factor (deleted slots included) under 1/2
+		if ((m_used + 1)*2 > m_slots.size()) {
+			u32			slot_count = min_slot_count;
+			while (slot_count < (m_count + 1)*4)
+				slot_count	<<= 1;
+			rehash		(slot_count);
+		}
+
+		u32				h = hash(it->name);
+		u32				mask = m_slots.size() - 1;
+		u32				i = h & mask;
+		while (m_slots[i].hash > slot_deleted)
+			i			= (i + 1) & mask;
+
+		if (m_slots[i].hash == slot_empty)
+			++m_used;
+
+		m_slots[i].hash	= h;
+		m_slots[i].it	= it;
+		++m_count;
+	}
+
+	IC void				erase			(const _iterator &it)
+	{
+		VERIFY			(!m_slots.empty());
+
+		u32				h = hash(it->name);
+		u32				mask = m_slots.size() - 1;
+		for (u32 i = h & mask; m_slots[i].hash != slot_empty; i = (i + 1) & mask) {
+			slot		&s = m_slots[i];
+			if ((s.hash != h) || (s.it != it))
+				continue;
+
+			s.hash		= slot_deleted;
+			--m_count;
+			return;
+		}
+
+		NODEFAULT;
+	}
+};
+
+#endif // LocatorAPI_indexH
@@ -2,6 +2,7 @@
 #pragma hdrstop
 
 #include <process.h>
+#include "trace_profiler.h"
 
 // mmsystem.h
 #define MMNOSOUND
@@ -319,6 +320,8 @@ void	thread_name	(const char* name)
 	__except(EXCEPTION_CONTINUE_EXECUTION)
 	{
 	}
+
+	trace_thread_name	(name);
 }
 #pragma pack(pop)
 
@@ -339,6 +342,11 @@ void	__cdecl			thread_entry	(void*	_params )	{
 
 	// call
 	entry				(arglist);
+
+#ifndef __BORLANDC__
+	// static builds have no DLL_THREAD_DETACH to do it
+	mem_thread_cache_flush		();
+#endif // __BORLANDC__
 }
 
 void	thread_spawn	(thread_t*	entry, const char*	name, unsigned	stack, void* arglist )
@@ -0,0 +1,346 @@
+#include "stdafx.h"
+#pragma hdrstop
+
+#include "task_scheduler.h"
+#include "trace_profiler.h"
+
+XRCORE_API task_scheduler	TaskScheduler;
+
+static __declspec(thread) void*	s_current_worker	= 0;
+static __declspec(thread) u32	s_steal_seed		= 0;
+
+task_scheduler::task_scheduler	() :
+	m_wake			(0),
+	m_queued		(0),
+	m_sleeping		(0),
+	m_alive			(0),
+	m_must_exit		(FALSE)
+{
+}
+
+task_scheduler::~task_scheduler	()
+{
+	VERIFY			(!initialized());
+}
+
+void task_scheduler::initialize	(u32 worker_count)
+{
+	VERIFY			(!initialized());
+
+	if (worker_count == u32(-1))
+		worker_count	= (CPU::ID.n_threads > 1) ? (CPU::ID.n_threads - 1) : 0;
+
+	if (!worker_count)
+		return;
+
+	m_must_exit		= FALSE;
+	m_queued		= 0;
+	m_sleeping		= 0;
+	m_alive			= worker_count;
+	m_wake			= CreateSemaphore(NULL,0,worker_count,NULL);
+	R_ASSERT		(m_wake);
+
+	// the last one is the shared deque for the threads outside of the pool
+	m_workers.resize(worker_count + 1);
+	for (u32 i=0; i<=worker_count; ++i)
+		m_workers[i]	= xr_new<worker>(this,i);
+
+	for (u32 i=0; i<worker_count; ++i)
+		thread_spawn	(&task_scheduler::worker_entry,"X-RAY Task worker",0,m_workers[i]);
+
+	Msg				("* Task scheduler: %d worker thread(s)",worker_count);
+}
+
+void task_scheduler::destroy	()
+{
+	if (!initialized())
+		return;
+
+	// drain everything what is left, then release workers
+	while (help())	;
+
+	m_must_exit		= TRUE;
+	ReleaseSemaphore(m_wake,worker_count(),NULL);
+	while (m_alive)
+		Sleep		(0);
+
+	CloseHandle		(m_wake);
+	m_wake			= 0;
+
+	WORKERS::iterator	I = m_workers.begin();
+	WORKERS::iterator	E = m_workers.end();
+	for ( ; I != E; ++I) {
+		VERIFY		((*I)->m_tasks.empty());
+		xr_delete	(*I);
+	}
+	m_workers.clear	();
+}
+
+void task_scheduler::worker_entry	(void *worker_ptr)
+{
+	worker			&self = *(worker*)worker_ptr;
+	s_current_worker= worker_ptr;
+	s_steal_seed	= self.m_steal_seed;
+	self.m_owner->worker_loop(self);
+}
+
+void task_scheduler::worker_loop	(worker &self)
+{
+	task			current;
+	for (;;) {
+		if (pop(self,current) || steal(self,current)) {
+			execute	(current);
+			continue;
+		}
+
+		if (m_must_exit)
+			break;
+
+		// we must re-check queue after we are counted as sleeping
+		// otherwise pusher may miss us and we would sleep with pending work
+		InterlockedIncrement	(&m_sleeping);
+		if (!m_queued && !m_must_exit)
+			WaitForSingleObject	(m_wake,INFINITE);
+		InterlockedDecrement	(&m_sleeping);
+	}
+
+	InterlockedDecrement	(&m_alive);
+}
+
+task_scheduler::worker &task_scheduler::current	()
+{
+	VERIFY			(initialized());
+	worker			*result = (worker*)s_current_worker;
+	if (result && (result->m_owner == this))
+		return		(*result);
+
+	return			(*m_workers.back());
+}
+
+bool task_scheduler::pop		(worker &self, task &result)
+{
+	if (self.m_tasks.empty())
+		return		(false);
+
+	xrCriticalSection::raii	lock(&self.m_cs);
+	if (self.m_tasks.empty())
+		return		(false);
+
+	result			= self.m_tasks.back();
+	self.m_tasks.pop_back	();
+	InterlockedDecrement	(&m_queued);
+	return			(true);
+}
+
+bool task_scheduler::steal		(worker &self, task &result)
+{
+	if (!m_queued)
+		return		(false);
+
+	u32				&seed = s_steal_seed;
+	seed			^= seed << 13;
+	seed			^= seed >> 17;
+	seed			^= seed << 5;
+
+	u32				count = m_workers.size();
+	u32				start = seed % count;
+	for (u32 i=0; i<count; ++i) {
+		worker		&victim = *m_workers[(start + i) % count];
+		if (victim.m_tasks.empty())
+			continue;
+
+		xrCriticalSection::raii	lock(&victim.m_cs);
+		if (victim.m_tasks.empty())
+			continue;
+
+		result		= victim.m_tasks.front();
+		victim.m_tasks.pop_front();
+		InterlockedDecrement	(&m_queued);
+		return		(true);
+	}
+
+	return			(false);
+}
+
+bool task_scheduler::pick		(task &result)
+{
+	worker			&self = current();
+	if (&self == m_workers.back())
+		return		(steal(self,result));
+
+	return			(pop(self,result) || steal(self,result));
+}
+
+void task_scheduler::execute	(task &current)
+{
+	{
+		TRACE_ZONE		("Task");
+		current.m_delegate	();
+	}
+
+	task_group		&group = *current.m_group;
+	for (;;) {
+		LONG		pending = group.m_pending;
+		VERIFY		(pending > 0);
+		if ((pending == 1) && group.m_continuation) {
+			// we are the last one : keep group pending while continuation runs,
+			// so it may push more tasks into the same group and waiters are not released too early
+			task_group::delegate_type	continuation = group.m_continuation;
+			continuation();
+			InterlockedDecrement	(&group.m_pending);
+			return;
+		}
+
+		if (InterlockedCompareExchange(&group.m_pending,pending - 1,pending) == pending)
+			return;
+	}
+}
+
+void task_scheduler::wake		()
+{
+	if (m_sleeping)
+		ReleaseSemaphore	(m_wake,1,NULL);
+}
+
+void task_scheduler::push		(task_group &group, delegate_type const &delegate)
+{
+	VERIFY			(delegate);
+
+	task			new_task;
+	new_task.m_delegate	= delegate;
+	new_task.m_group	= &group;
+
+	InterlockedIncrement	(&group.m_pending);
+
+	if (!initialized()) {
+		// no workers : the single-thread drain
+		execute		(new_task);
+		return;
+	}
+
+	worker			&self = current();
+	{
+		xrCriticalSection::raii	lock(&self.m_cs);
+		self.m_tasks.push_back	(new_task);
+	}
+
+	InterlockedIncrement	(&m_queued);
+	wake			();
+}
+
+bool task_scheduler::help		()
+{
+	if (!initialized())
+		return		(false);
+
+	task			current;
+	if (!pick(current))
+		return		(false);
+
+	execute			(current);
+	return			(true);
+}
+
+void task_scheduler::wait		(task_group &group)
+{
+	while (!group.done()) {
+		if (!help())
+			Sleep	(0);
+	}
+}
+
+void task_scheduler::frame_begin	(u32 frame)
+{
+	VERIFY2			(m_frame.done(),"previous frame fence is not synchronized");
+	m_frame.m_frame	= frame;
+}
+
+void task_scheduler::frame_push		(delegate_type const &delegate)
+{
+	push			(m_frame,delegate);
+}
+
+void task_scheduler::frame_sync		()
+{
+	wait			(m_frame);
+}
+
+// benchmark
+namespace task_scheduler_detail {
+
+struct synthetic_task {
+	u32				m_cost;
+	float			m_result;
+
+	void			run				()
+	{
+		float		accumulator = 0.f;
+		for (u32 i=0; i<m_cost; ++i)
+			accumulator	+= _sqrt(float(i) + accumulator*.5f);
+		m_result	= accumulator;
+	}
+};
+
+struct frame_stats {
+	float			m_total;
+	float			m_min;
+	float			m_max;
+
+	IC				frame_stats		() : m_total(0.f), m_min(flt_max), m_max(0.f) {}
+	IC	void		add				(float time)
+	{
+		m_total		+= time;
+		m_min		= _min(m_min,time);
+		m_max		= _max(m_max,time);
+	}
+};
+
+} // namespace task_scheduler_detail
+
+void task_scheduler_benchmark	(u32 frame_count, u32 tasks_per_frame)
+{
+	using namespace task_scheduler_detail;
+
+	VERIFY			(frame_count && tasks_per_frame);
+
+	xr_vector<synthetic_task>	tasks(tasks_per_frame);
+	frame_stats		serial;
+	frame_stats		parallel;
+	CRandom			random(0x1234567);
+	CTimer			timer;
+
+	for (u32 frame = 0; frame < frame_count; ++frame) {
+		// 70% light, 25% medium, 5% heavy - roughly what seqParallel gets in a populated level
+		xr_vector<synthetic_task>::iterator	I = tasks.begin();
+		xr_vector<synthetic_task>::iterator	E = tasks.end();
+		for ( ; I != E; ++I) {
+			s32		kind = random.randI(100);
+			if (kind < 70)
+				(*I).m_cost	= 2000 + random.randI(2000);
+			else if (kind < 95)
+				(*I).m_cost	= 20000 + random.randI(20000);
+			else
+				(*I).m_cost	= 200000 + random.randI(200000);
+		}
+
+		timer.Start	();
+		for (I = tasks.begin(); I != E; ++I)
+			(*I).run();
+		serial.add	(timer.GetElapsed_sec()*1000.f);
+
+		// own group : the frame fence belongs to the engine frame, the command may run inside it
+		task_group	group;
+		timer.Start	();
+		for (I = tasks.begin(); I != E; ++I)
+			TaskScheduler.push	(group,task_group::delegate_type(&*I,&synthetic_task::run));
+		TaskScheduler.wait	(group);
+		parallel.add(timer.GetElapsed_sec()*1000.f);
+	}
+
+	float			serial_avg = serial.m_total/float(frame_count);
+	float			parallel_avg = parallel.m_total/float(frame_count);
+	Msg				("* Task scheduler benchmark: %d frame(s), %d task(s) per frame, %d worker thread(s)",frame_count,tasks_per_frame,TaskScheduler.worker_count());
+	Msg				("*   serial drain  : avg %.3f ms, min %.3f ms, max %.3f ms",serial_avg,serial.m_min,serial.m_max);
+	Msg				("*   work-stealing : avg %.3f ms, min %.3f ms, max %.3f ms",parallel_avg,parallel.m_min,parallel.m_max);
+	Msg				("*   speedup       : %.2fx",parallel_avg > 0.f ? serial_avg/parallel_avg : 0.f);
+}
@@ -0,0 +1,130 @@
+#ifndef TASK_SCHEDULER_H_INCLUDED
+#define TASK_SCHEDULER_H_INCLUDED
+
+#include "fastdelegate.h"
+
+class task_scheduler;
+
+// Desc: set of tasks which may be waited for as a whole
+//		 continuation (if any) is executed every time the group drains,
+//		 on the thread which completed the last task, before waiters are released
+class XRCORE_API task_group
+{
+public:
+	typedef fastdelegate::FastDelegate0<>	delegate_type;
+
+private:
+	friend class task_scheduler;
+
+private:
+	volatile LONG			m_pending;
+	delegate_type			m_continuation;
+
+private:
+	task_group				(task_group const & copy) {}; //noncopyable
+
+public:
+	IC						task_group			() : m_pending(0) {}
+	IC		void			continuation		(delegate_type const &callback)	{ VERIFY(!m_pending); m_continuation = callback; }
+	IC		bool			done				() const						{ return !m_pending; }
+	IC		u32				pending				() const						{ return u32(m_pending); }
+};
+
+// Desc: frame-scoped fence - task group bound to the frame it was opened in
+class XRCORE_API task_fence : public task_group
+{
+private:
+	u32						m_frame;
+
+public:
+	IC						task_fence			() : m_frame(u32(-1)) {}
+	IC		u32				frame				() const						{ return m_frame; }
+
+private:
+	friend class task_scheduler;
+};
+
+// Desc: work-stealing scheduler
+//		 every worker owns a deque: it pushes/pops its own tasks at the back (LIFO, cache-warm)
+//		 and steals from the front of the other deques (FIFO, oldest and usually biggest work first)
+//		 threads outside of the pool push into the shared deque, which is stolen by everybody
+//		 waiting never blocks while there is work : waiter executes pending tasks itself
+class XRCORE_API task_scheduler
+{
+public:
+	typedef task_group::delegate_type	delegate_type;
+
+private:
+	struct task {
+		delegate_type		m_delegate;
+		task_group*			m_group;
+	};
+
+	struct worker {
+		xrCriticalSection	m_cs;
+		xr_deque<task>		m_tasks;
+		task_scheduler*		m_owner;
+		u32					m_index;
+		u32					m_steal_seed;
+
+		IC					worker				(task_scheduler *owner, u32 index) :
+#ifdef PROFILE_CRITICAL_SECTIONS
+			m_cs			(MUTEX_PROFILE_ID(task_scheduler::worker::m_cs)),
+#endif // PROFILE_CRITICAL_SECTIONS
+			m_owner			(owner),
+			m_index			(index),
+			m_steal_seed	(index*0x9E3779B9 + 1)
+		{
+		}
+	};
+
+	typedef xr_vector<worker*>	WORKERS;
+
+private:
+	WORKERS					m_workers;			// [0..worker_count) - pool, [worker_count] - shared deque for outer threads
+	void*					m_wake;				// semaphore
+	volatile LONG			m_queued;
+	volatile LONG			m_sleeping;
+	volatile LONG			m_alive;
+	volatile BOOL			m_must_exit;
+	task_fence				m_frame;
+
+private:
+	static	void			worker_entry		(void *worker);
+			void			worker_loop			(worker &self);
+			bool			pop					(worker &self, task &result);
+			bool			steal				(worker &self, task &result);
+			bool			pick				(task &result);
+			void			execute				(task &task);
+			worker&			current				();
+			void			wake				();
+
+public:
+							task_scheduler		();
+							~task_scheduler		();
+			void			initialize			(u32 worker_count = u32(-1));
+			void			destroy				();
+	IC		u32				worker_count		() const	{ return m_workers.empty() ? 0 : (m_workers.size() - 1); }
+	IC		bool			initialized			() const	{ return !m_workers.empty(); }
+
+public:
+			void			push				(task_group &group, delegate_type const &delegate);
+			void			wait				(task_group &group);
+			// executes one pending task, if any, on the calling thread
+			bool			help				();
+
+public:
+	// frame fence : tasks of the current frame, synchronized once per frame
+			void			frame_begin			(u32 frame);
+			void			frame_push			(delegate_type const &delegate);
+			void			frame_sync			();
+	IC		task_fence&		frame_fence			()			{ return m_frame; }
+};
+
+extern XRCORE_API task_scheduler	TaskScheduler;
+
+// Desc: headless benchmark : synthetic delegates of varying cost,
+//		 per-frame makespan of serial drain versus the scheduler
+extern XRCORE_API void	task_scheduler_benchmark	(u32 frame_count, u32 tasks_per_frame);
+
+#endif // TASK_SCHEDULER_H_INCLUDED
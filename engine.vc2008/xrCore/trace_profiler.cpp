@@ -0,0 +1,411 @@
+#include "stdafx.h"
+#pragma hdrstop
+
+#include "trace_profiler.h"
+
+XRCORE_API volatile BOOL	g_trace_enabled		= FALSE;
+
+namespace trace_profiler {
+
+enum event_type {
+	event_begin		= 0,
+	event_end,
+	event_frame,
+};
+
+struct event {
+	u64				time;
+	LPCSTR			name;
+	u32				type;
+	u32				data;
+};
+
+typedef xr_vector<event>	EVENTS;
+
+// single producer (the owning thread), single consumer (the drain thread or the one stopping the capture)
+struct ring {
+	enum {
+		size		= 32*1024,
+		mask		= size - 1,
+	};
+
+	event			events[size];
+	volatile u32	write;
+	volatile u32	read;
+	// producer side only : outstanding recorded zones, each of them has a slot reserved for its end
+	u32				depth;
+	volatile u32	dropped;
+	// consumer side only
+	u32				dropped_at_start;
+	EVENTS			capture;
+	LPCSTR			name;
+	u32				thread_id;
+};
+
+typedef xr_vector<ring*>	RINGS;
+
+static __declspec(thread) ring*		s_ring			= 0;
+static __declspec(thread) LPCSTR	s_thread_name	= 0;
+
+static xrCriticalSection	s_rings_lock;
+static RINGS				s_rings;
+static u64					s_start_time	= 0;
+static u32					s_max_events	= 0;
+static u32					s_event_count	= 0;
+static volatile BOOL		s_capturing		= FALSE;
+static volatile BOOL		s_drain_exit	= FALSE;
+static volatile LONG		s_drain_alive	= 0;
+
+static ring* create_ring	()
+{
+	ring*			result = xr_new<ring>();
+	result->write	= 0;
+	result->read	= 0;
+	result->depth	= 0;
+	result->dropped	= 0;
+	result->dropped_at_start	= 0;
+	result->name	= s_thread_name;
+	result->thread_id	= GetCurrentThreadId();
+
+	// the ring lives till the process exits, a thread may be recording into it at any moment
+	xrCriticalSection::raii	guard(&s_rings_lock);
+	s_rings.push_back	(result);
+	s_ring			= result;
+	return			(result);
+}
+
+IC	ring& current_ring	()
+{
+	return			(s_ring ? *s_ring : *create_ring());
+}
+
+IC	void push		(ring& self, LPCSTR name, u32 type, u32 data)
+{
+	event&			e = self.events[self.write & ring::mask];
+	e.time			= CPU::GetCLK();
+	e.name			= name;
+	e.type			= type;
+	e.data			= data;
+
+	// the event must be complete before the consumer sees it
+	_ReadWriteBarrier	();
+	self.write		= self.write + 1;
+}
+
+IC	u32 free_space	(const ring& self)
+{
+	return			(ring::size - (self.write - self.read));
+}
+
+static void drain	(ring& self)
+{
+	u32				write = self.write;
+	_ReadWriteBarrier	();
+
+	for (u32 read = self.read; read != write; ++read)
+		self.capture.push_back	(self.events[read & ring::mask]);
+
+	s_event_count	+= write - self.read;
+	_ReadWriteBarrier	();
+	self.read		= write;
+}
+
+static void drain_all	()
+{
+	xrCriticalSection::raii	guard(&s_rings_lock);
+	RINGS::iterator	I = s_rings.begin();
+	RINGS::iterator	E = s_rings.end();
+	for ( ; I != E; ++I)
+		drain		(**I);
+}
+
+static void __cdecl drain_entry	(void*)
+{
+	while (!s_drain_exit) {
+		drain_all	();
+
+		// stops recording, the capture is kept till trace_stop writes it
+		if (s_event_count >= s_max_events) {
+			if (g_trace_enabled)
+				Msg	("* Trace: %d events captured, recording stopped",s_event_count);
+			g_trace_enabled	= FALSE;
+		}
+
+		Sleep		(5);
+	}
+
+	InterlockedExchange	(&s_drain_alive,0);
+}
+
+struct zone_statistics {
+	u32				count;
+	u64				total;
+	u64				max;
+};
+
+typedef xr_map<LPCSTR,zone_statistics,pred_str>	STATISTICS;
+typedef std::pair<LPCSTR,zone_statistics>		STATISTICS_ITEM;
+typedef xr_vector<STATISTICS_ITEM>				STATISTICS_ITEMS;
+
+static bool total_greater	(const STATISTICS_ITEM& _1, const STATISTICS_ITEM& _2)
+{
+	return			(_1.second.total > _2.second.total);
+}
+
+static void escape	(LPSTR result, u32 result_size, LPCSTR name)
+{
+	u32				j = 0;
+	for (LPCSTR i = name; *i && (j + 2 < result_size); ++i) {
+		if ((*i == '"') || (*i == '\\'))
+			result[j++]	= '\\';
+		result[j++]	= (u8(*i) < 0x20) ? ' ' : *i;
+	}
+	result[j]		= 0;
+}
+
+IC	double microseconds	(u64 time)
+{
+	return			(double(s64(time - s_start_time))*double(CPU::clk_to_microsec));
+}
+
+static void write_event	(IWriter* F, bool& first, LPCSTR name, LPCSTR phase, u32 thread_id, u64 time)
+{
+	string256		escaped;
+	escape			(escaped,sizeof(escaped),name);
+	F->w_printf		("%s\n{\"name\":\"%s\",\"ph\":\"%s\",\"pid\":0,\"tid\":%d,\"ts\":%.3f}",first ? "" : ",",escaped,phase,thread_id,microseconds(time));
+	first			= false;
+}
+
+static void export_capture	(IWriter* F, STATISTICS& statistics)
+{
+	xr_vector<u32>	stack;
+	bool			first = true;
+	u64				last_time = s_start_time;
+
+	if (F)
+		F->w_printf	("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+	RINGS::iterator	I = s_rings.begin();
+	RINGS::iterator	E = s_rings.end();
+	for ( ; I != E; ++I) {
+		EVENTS&		events = (*I)->capture;
+		if (!events.empty() && (events.back().time > last_time))
+			last_time	= events.back().time;
+	}
+
+	for (I = s_rings.begin(); I != E; ++I) {
+		ring&		self = **I;
+		if (self.capture.empty())
+			continue;
+
+		if (F) {
+			string256	name;
+			if (self.name)
+				escape	(name,sizeof(name),self.name);
+			else
+				xr_sprintf	(name,"thread %d",self.thread_id);
+			F->w_printf	("%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",first ? "" : ",",self.thread_id,name);
+			first	= false;
+		}
+
+		stack.clear	();
+		EVENTS::const_iterator	i = self.capture.begin();
+		EVENTS::const_iterator	e = self.capture.end();
+		for ( ; i != e; ++i) {
+			const event&	current = *i;
+			switch (current.type) {
+				case event_begin : {
+					stack.push_back	(u32(i - self.capture.begin()));
+					if (F)
+						write_event	(F,first,current.name,"B",self.thread_id,current.time);
+					break;
+				}
+				case event_end : {
+					// the zone has been opened before the capture started
+					if (stack.empty())
+						break;
+
+					const event&	begin = self.capture[stack.back()];
+					stack.pop_back	();
+
+					zone_statistics&	zone = statistics.insert(mk_pair(begin.name,zone_statistics())).first->second;
+					u64		duration = current.time - begin.time;
+					++zone.count;
+					zone.total	+= duration;
+					zone.max	= _max(zone.max,duration);
+
+					if (F)
+						write_event	(F,first,begin.name,"E",self.thread_id,current.time);
+					break;
+				}
+				case event_frame : {
+					if (!F)
+						break;
+
+					F->w_printf	("%s\n{\"name\":\"frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"args\":{\"frame\":%d}}",first ? "" : ",",self.thread_id,microseconds(current.time),current.data);
+					first	= false;
+					break;
+				}
+				default : NODEFAULT;
+			}
+		}
+
+		// the zones still open when the capture stopped
+		if (F) {
+			while (!stack.empty()) {
+				write_event	(F,first,self.capture[stack.back()].name,"E",self.thread_id,last_time);
+				stack.pop_back	();
+			}
+		}
+	}
+
+	if (F)
+		F->w_printf	("\n]}\n");
+}
+
+}; // namespace trace_profiler
+
+using namespace trace_profiler;
+
+bool trace_begin	(LPCSTR name)
+{
+	if (!g_trace_enabled)
+		return		(false);
+
+	ring&			self = current_ring();
+
+	// the end of every outstanding zone must still fit
+	if (free_space(self) < self.depth + 2) {
+		self.dropped= self.dropped + 1;
+		return		(false);
+	}
+
+	++self.depth;
+	push			(self,name,event_begin,0);
+	return			(true);
+}
+
+void trace_end		()
+{
+	ring&			self = current_ring();
+	VERIFY			(self.depth);
+	--self.depth;
+	push			(self,0,event_end,0);
+}
+
+void trace_frame	(u32 frame)
+{
+	if (!g_trace_enabled)
+		return;
+
+	ring&			self = current_ring();
+	if (free_space(self) < self.depth + 1) {
+		self.dropped= self.dropped + 1;
+		return;
+	}
+
+	push			(self,0,event_frame,frame);
+}
+
+void trace_thread_name	(LPCSTR name)
+{
+	s_thread_name	= name;
+	if (s_ring)
+		s_ring->name= name;
+}
+
+bool trace_capturing	()
+{
+	return			(!!s_capturing);
+}
+
+void trace_start	(u32 max_event_count)
+{
+	if (s_capturing) {
+		Msg			("! Trace: capture is in progress already");
+		return;
+	}
+
+	{
+		// nobody consumes the rings now, the events recorded since the last capture are discarded
+		xrCriticalSection::raii	guard(&s_rings_lock);
+		RINGS::iterator	I = s_rings.begin();
+		RINGS::iterator	E = s_rings.end();
+		for ( ; I != E; ++I) {
+			(*I)->read		= (*I)->write;
+			(*I)->dropped_at_start	= (*I)->dropped;
+			EVENTS().swap	((*I)->capture);
+		}
+	}
+
+	s_max_events	= max_event_count;
+	s_event_count	= 0;
+	s_start_time	= CPU::GetCLK();
+	s_capturing		= TRUE;
+	s_drain_exit	= FALSE;
+	s_drain_alive	= 1;
+	g_trace_enabled	= TRUE;
+	thread_spawn	(drain_entry,"X-RAY Trace drain",0,0);
+
+	Msg				("* Trace: capture started (%d events at most)",max_event_count);
+}
+
+void trace_stop		(LPCSTR file_name)
+{
+	if (!s_capturing) {
+		Msg			("! Trace: there is no capture in progress");
+		return;
+	}
+
+	g_trace_enabled	= FALSE;
+	s_drain_exit	= TRUE;
+	while (s_drain_alive)
+		Sleep		(1);
+
+	// the zones recorded after this point are left in the rings till the next capture
+	drain_all		();
+	s_capturing		= FALSE;
+
+	float			duration = float(CPU::GetCLK() - s_start_time)*CPU::clk_to_milisec;
+
+	STATISTICS		statistics;
+	IWriter*		F = 0;
+	string_path		full_name;
+	if (file_name && file_name[0]) {
+		FS.update_path	(full_name,"$logs$",file_name);
+		F			= FS.w_open(full_name);
+		if (!F)
+			Msg		("! Trace: cannot open file [%s]",full_name);
+	}
+
+	{
+		xrCriticalSection::raii	guard(&s_rings_lock);
+		export_capture	(F,statistics);
+
+		u32			dropped = 0;
+		RINGS::iterator	I = s_rings.begin();
+		RINGS::iterator	E = s_rings.end();
+		for ( ; I != E; ++I) {
+			dropped	+= (*I)->dropped - (*I)->dropped_at_start;
+			EVENTS().swap	((*I)->capture);
+		}
+
+		Msg			("* Trace: %d events in %.1f ms, %d zones dropped on full rings",s_event_count,duration,dropped);
+	}
+
+	if (F) {
+		FS.w_close	(F);
+		Msg			("* Trace: written to [%s]",full_name);
+	}
+
+	STATISTICS_ITEMS	items(statistics.begin(),statistics.end());
+	std::sort		(items.begin(),items.end(),total_greater);
+	if (items.size() > 20)
+		items.resize(20);
+
+	Msg				("* Trace: zones by the total time");
+	STATISTICS_ITEMS::const_iterator	I = items.begin();
+	STATISTICS_ITEMS::const_iterator	E = items.end();
+	for ( ; I != E; ++I)
+		Msg			("*   %-40s : %7d calls, %10.3f ms total, %8.3f ms max",(*I).first,(*I).second.count,float((*I).second.total)*CPU::clk_to_milisec,float((*I).second.max)*CPU::clk_to_milisec);
+}
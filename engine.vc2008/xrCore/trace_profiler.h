@@ -0,0 +1,40 @@
+#ifndef TRACE_PROFILER_H_INCLUDED
+#define TRACE_PROFILER_H_INCLUDED
+
+// Desc: always available instrumentation
+//		 scoped zones and frame marks are recorded with the cpu clock into per-thread rings,
+//		 every ring has a single producer (its thread) and a single consumer (the drain thread),
+//		 so recording takes no locks; nothing at all is recorded while there is no capture.
+//		 the drain thread moves the events out of the rings during the capture,
+//		 the capture is written as a chrome trace (chrome://tracing, perfetto) when it stops
+
+extern XRCORE_API volatile BOOL	g_trace_enabled;
+
+// false if the zone has not been recorded (no capture, or the ring is full), then it must not be ended
+extern XRCORE_API	bool	trace_begin			(LPCSTR name);
+extern XRCORE_API	void	trace_end			();
+extern XRCORE_API	void	trace_frame			(u32 frame);
+// the name of the calling thread in the captures, the string must outlive the thread
+extern XRCORE_API	void	trace_thread_name	(LPCSTR name);
+
+extern XRCORE_API	void	trace_start			(u32 max_event_count);
+// writes the capture into the file (if any) and logs the zones taking the most time
+extern XRCORE_API	void	trace_stop			(LPCSTR file_name);
+extern XRCORE_API	bool	trace_capturing		();
+
+// zone names are not copied : string literals or other strings living till the capture stops
+class trace_zone
+{
+private:
+	bool					m_recorded;
+
+public:
+	IC						trace_zone			(LPCSTR name) : m_recorded(g_trace_enabled && trace_begin(name)) {}
+	IC						~trace_zone			()	{ if (m_recorded) trace_end(); }
+};
+
+#define TRACE_ZONE_CONCAT2(a,b)		a##b
+#define TRACE_ZONE_CONCAT(a,b)		TRACE_ZONE_CONCAT2(a,b)
+#define TRACE_ZONE(name)			trace_zone TRACE_ZONE_CONCAT(__trace_zone_,__LINE__)(name)
+
+#endif // TRACE_PROFILER_H_INCLUDED
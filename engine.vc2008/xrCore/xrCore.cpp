@@ -179,6 +179,9 @@ void xrCore::_destroy		()
 		timeBeginPeriod	(1);
 		break;
 	case DLL_THREAD_DETACH:
+#ifndef __BORLANDC__
+		mem_thread_cache_flush	();
+#endif // __BORLANDC__
 		break;
 	case DLL_PROCESS_DETACH:
 #ifdef USE_MEMORY_MONITOR
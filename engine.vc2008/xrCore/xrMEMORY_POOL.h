@@ -4,6 +4,23 @@
 
 class xrMemory;
 
+// per-thread front of the pool : a magazine of free elements, refilled from and
+// returned to the shared list in batches, so the pool lock is taken once per batch
+struct	mempool_cache
+{
+	u8*					list;
+	u32					count;
+	u32					hits;			// served without the lock since the last visit to the pool
+};
+
+struct	mempool_statistic
+{
+	u64					hits;			// thread cache operations, folded in on every visit to the pool
+	u32					misses;			// thread cache refills
+	u32					returns;		// batches returned from the thread caches
+	u32					contentions;	// visits which had to wait for the lock
+};
+
 class	MEMPOOL
 {
 #ifdef DEBUG_MEMORY_MANAGER
@@ -15,20 +32,25 @@ private:
 	u32					s_element;		// element size, for example 32
 	u32					s_count;		// element count = [s_sector/s_element]
 	u32					s_offset;		// header size
+	u32					s_batch;		// elements moved between the thread cache and the list at once
 	u32					block_count;	// block count
 	u8*					list;
+	mempool_statistic	stats;
 private:
 	ICF void**			access			(void* P)	{ return (void**) ((void*)(P));	}
 	void				block_create	();
+	void				lock			();
+	void				refill			(mempool_cache& cache);
 public:
 	void				_initialize		(u32 _element, u32 _sector, u32 _header);
 
 #ifdef PROFILE_CRITICAL_SECTIONS
 	ICF					MEMPOOL			(): cs(MUTEX_PROFILE_ID(memory_pool)){}
 #endif // PROFILE_CRITICAL_SECTIONS
-	
+
 	ICF u32				get_block_count	()	{ return block_count; }
 	ICF u32				get_element		()	{ return s_element; }
+	void				get_statistic	(mempool_statistic& result);
 
 	ICF void*			create			()
 	{
@@ -47,5 +69,27 @@ public:
 		list			= (u8*)P;
 		cs.Leave		();
 	}
+
+	// through the thread cache
+	ICF void*			create			(mempool_cache& cache)
+	{
+		if (0==cache.count)	refill(cache);
+		else				++cache.hits;
+
+		void* E			= cache.list;
+		cache.list		= (u8*)*access(E);
+		--cache.count;
+		return			E;
+	}
+	ICF void			destroy			(mempool_cache& cache, void* &P)
+	{
+		*access(P)		= cache.list;
+		cache.list		= (u8*)P;
+		++cache.hits;
+		if (++cache.count > 2*s_batch)
+			flush		(cache,s_batch);
+	}
+	// returns all but keep elements of the thread cache to the list
+	void				flush			(mempool_cache& cache, u32 keep);
 };
 #endif
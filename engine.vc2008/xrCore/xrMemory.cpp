@@ -87,6 +87,7 @@ void	xrMemory::_initialize	(BOOL bDebug)
 			mem_pools[pid]._initialize(element,sector,0x1);
 			element		+=	mem_pools_ebase;
 		}
+		mem_pools_cached	= !strstr(Core.Params,"-mem_no_thread_cache");
 	}
 #endif // M_BORLAND
 
@@ -196,6 +197,14 @@ void	xrMemory::mem_statistic	(LPCSTR fn)
 		}
 	}
 
+	// the pool statistics follow the free lists, which are still the records of chunk #2
+	fprintf					(Fa,"$BEGIN CHUNK #4\n");
+	for (u32 k=0; k<mem_pools_count; ++k) {
+		mempool_statistic	stats;
+		mem_pools[k].get_statistic	(stats);
+		fprintf				(Fa,"%2d: %db hits %I64u misses %d returns %d contentions %d\n",k,(k+1)*16,stats.hits,stats.misses,stats.returns,stats.contentions);
+	}
+
 	/*
 	fprintf					(Fa,"$BEGIN CHUNK #3\n");
 	for (u32 it=0; it<debug_info.size(); it++)
@@ -282,3 +291,124 @@ XRCORE_API		BOOL			is_stack_ptr		( void* _ptr)
 	ptrdiff_t	difference		= (ptrdiff_t)_abs(s64(ptrdiff_t(ptr_local) - ptrdiff_t(ptr_refsound)));
 	return		(difference < (512*1024));
 }
+
+#ifndef M_BORLAND
+void	mem_pool_statistic	()
+{
+	Msg						("* memory pools: thread caches are %s",mem_pools_cached ? "on" : "off");
+	for (u32 k=0; k<mem_pools_count; ++k) {
+		MEMPOOL				&pool = mem_pools[k];
+		if (!pool.get_block_count())
+			continue;
+
+		mempool_statistic	stats;
+		pool.get_statistic	(stats);
+		u64					total = stats.hits + stats.misses;
+		Msg					(
+			"*   %3db : %4d block(s), hits %10I64u (%5.1f%%), misses %8d, returns %8d, contentions %6d",
+			pool.get_element(),
+			pool.get_block_count(),
+			stats.hits,
+			total ? 100.f*float(stats.hits)/float(total) : 0.f,
+			stats.misses,
+			stats.returns,
+			stats.contentions
+		);
+	}
+}
+
+struct mem_benchmark_context
+{
+	u32						seed;
+	u32						operation_count;
+	void*					start;
+	volatile LONG*			alive;
+};
+
+static void	mem_benchmark_thread	(void* param)
+{
+	mem_benchmark_context	&context = *(mem_benchmark_context*)param;
+	enum {
+		live_count			= 1024,
+	};
+	void*					live[live_count];
+	ZeroMemory				(live,sizeof(live));
+
+	WaitForSingleObject		(context.start,INFINITE);
+
+	// the mix leans to the small sizes, as the real one does
+	u32						seed = context.seed;
+	for (u32 i=0; i<context.operation_count; ++i) {
+		seed				= seed*1664525 + 1013904223;
+		u32					slot = (seed >> 8) % live_count;
+		u32					size = ((seed >> 20) & 3) ? (8 + (seed >> 24)) : (8 + ((seed >> 16) % 800));
+		xr_free				(live[slot]);
+		live[slot]			= xr_malloc(size);
+		*(u32*)live[slot]	= i;
+	}
+
+	for (u32 i=0; i<live_count; ++i)
+		xr_free				(live[i]);
+
+	InterlockedDecrement	(context.alive);
+}
+
+static float mem_benchmark_run	(u32 thread_count, u32 operation_count)
+{
+	xr_vector<mem_benchmark_context>	contexts(thread_count);
+	void*					start = CreateEvent(NULL,TRUE,FALSE,NULL);
+	volatile LONG			alive = LONG(thread_count);
+	for (u32 i=0; i<thread_count; ++i) {
+		contexts[i].seed	= 0x5eed + i*7919;
+		contexts[i].operation_count	= operation_count;
+		contexts[i].start	= start;
+		contexts[i].alive	= &alive;
+		thread_spawn		(mem_benchmark_thread,"X-RAY memory benchmark",0,&contexts[i]);
+	}
+
+	CTimer					timer;
+	timer.Start				();
+	SetEvent				(start);
+	while (alive)
+		SwitchToThread		();
+	float					time = timer.GetElapsed_sec();
+	CloseHandle				(start);
+	return					(time);
+}
+
+void	mem_pool_benchmark	(u32 max_thread_count)
+{
+	if (!mem_pools[0].get_element()) {
+		Msg					("! memory pools are off (-pure_alloc)");
+		return;
+	}
+
+	max_thread_count		= _max(max_thread_count,u32(1));
+	u32						operation_count = 1000000;
+	BOOL					cached = mem_pools_cached;
+
+	Msg						("* memory pool benchmark: %d alloc/free pair(s) per thread",operation_count);
+	for (u32 thread_count=1; ; thread_count=_min(thread_count*2,max_thread_count)) {
+		// switching is safe at any time : both paths keep the pools consistent
+		mem_pools_cached	= FALSE;
+		float				locked_time = mem_benchmark_run(thread_count,operation_count);
+		mem_pools_cached	= TRUE;
+		float				cached_time = mem_benchmark_run(thread_count,operation_count);
+
+		float				pairs = float(thread_count*operation_count);
+		Msg					(
+			"*   %2d thread(s) : locked %10.0f pairs/s, cached %10.0f pairs/s, x%.2f",
+			thread_count,
+			locked_time > 0.f ? pairs/locked_time : 0.f,
+			cached_time > 0.f ? pairs/cached_time : 0.f,
+			cached_time > 0.f ? locked_time/cached_time : 0.f
+		);
+
+		if (thread_count == max_thread_count)
+			break;
+	}
+	mem_pools_cached		= cached;
+
+	mem_pool_statistic		();
+}
+#endif // M_BORLAND
@@ -138,7 +138,13 @@ const		u32			mem_pools_count			=	54;
 const		u32			mem_pools_ebase			=	16;
 const		u32			mem_generic				=	mem_pools_count+1;
 extern		MEMPOOL		mem_pools				[mem_pools_count];
+extern		BOOL		mem_pools_cached;		// pooled allocations go through the per-thread caches
 extern		BOOL		mem_initialized;
+extern		void		mem_thread_cache_flush	();
+
+XRCORE_API void mem_pool_statistic	();
+// mixed size allocations/deallocations from 1..max_thread_count threads, with and without the thread caches
+XRCORE_API void mem_pool_benchmark	(u32 max_thread_count);
 
 XRCORE_API void vminfo			(size_t *_free, size_t *reserved, size_t *committed);
 XRCORE_API void log_vminfo		();
@@ -27,6 +27,83 @@ void	MEMPOOL::_initialize	(u32 _element, u32 _sector, u32 _header)
 	s_element		= _element;
 	s_count			= s_sector/s_element;
 	s_offset		= _header;
+	s_batch			= _max(u32(4),_min(u32(32),u32(4096/s_element)));
+	cs.set_name		("MEMPOOL::cs");
 	list			= NULL;
 	block_count		= 0;
+	ZeroMemory		(&stats,sizeof(stats));
+}
+
+void	MEMPOOL::lock			()
+{
+	if (cs.TryEnter())
+		return;
+
+	cs.Enter		();
+	++stats.contentions;
+}
+
+void	MEMPOOL::refill			(mempool_cache& cache)
+{
+	VERIFY			(0==cache.count);
+
+	lock			();
+	stats.hits		+= cache.hits;
+	cache.hits		= 0;
+	++stats.misses;
+
+	if (0==list)	block_create();
+
+	// detach up to a batch from the head of the list
+	u8*	first		= list;
+	u8*	last		= list;
+	u32	count		= 1;
+	for ( ; (count < s_batch) && *access(last); ++count)
+		last		= (u8*)*access(last);
+
+	list			= (u8*)*access(last);
+	cs.Leave		();
+
+	*access(last)	= NULL;
+	cache.list		= first;
+	cache.count		= count;
+}
+
+void	MEMPOOL::flush			(mempool_cache& cache, u32 keep)
+{
+	if (cache.count <= keep)
+		return;
+
+	// the head of the cache is the most recently freed memory, it is kept, the tail is returned
+	u8*	first		= cache.list;
+	if (keep) {
+		u8*	kept	= cache.list;
+		for (u32 i=1; i<keep; ++i)
+			kept	= (u8*)*access(kept);
+		first		= (u8*)*access(kept);
+		*access(kept)	= NULL;
+	}
+	else
+		cache.list	= NULL;
+
+	u8*	last		= first;
+	while (*access(last))
+		last		= (u8*)*access(last);
+
+	cache.count		= keep;
+
+	lock			();
+	*access(last)	= list;
+	list			= first;
+	stats.hits		+= cache.hits;
+	cache.hits		= 0;
+	++stats.returns;
+	cs.Leave		();
+}
+
+void	MEMPOOL::get_statistic	(mempool_statistic& result)
+{
+	cs.Enter		();
+	result			= stats;
+	cs.Leave		();
 }
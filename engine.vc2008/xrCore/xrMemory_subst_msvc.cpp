@@ -19,6 +19,17 @@
 #endif // DEBUG_MEMORY_MANAGER
 
 MEMPOOL		mem_pools			[mem_pools_count];
+BOOL		mem_pools_cached	= TRUE;
+
+static __declspec(thread) mempool_cache	s_mem_pool_caches	[mem_pools_count];
+
+// the elements cached by the exiting thread go back to the pools
+void	mem_thread_cache_flush	()
+{
+	for (u32 pid=0; pid<mem_pools_count; ++pid)
+		if (s_mem_pool_caches[pid].count)
+			mem_pools[pid].flush	(s_mem_pool_caches[pid],0);
+}
 
 // MSVC
 ICF	u8*		acc_header			(void* P)	{	u8*		_P		= (u8*)P;	return	_P-1;	}
@@ -100,7 +111,7 @@ void*	xrMemory::mem_alloc		(size_t size
 			// pooled
 			//	Igor: Reserve 1 byte for xrMemory header
 			//	Already reserved when getting pool id
-			void*	_real		=	mem_pools[pool].create();
+			void*	_real		=	mem_pools_cached ? mem_pools[pool].create(s_mem_pool_caches[pool]) : mem_pools[pool].create();
 			_ptr				=	(void*)(((u8*)_real)+1);
 			*acc_header(_ptr)	=	(u8)pool;
 		}
@@ -155,7 +166,8 @@ void	xrMemory::mem_free		(void* P)
 	} else {
 		// pooled
 		VERIFY2					(pool<mem_pools_count,"Memory corruption");
-		mem_pools[pool].destroy	(_real);
+		if (mem_pools_cached)	mem_pools[pool].destroy	(s_mem_pool_caches[pool],_real);
+		else					mem_pools[pool].destroy	(_real);
 	}
 #ifdef DEBUG_MEMORY_MANAGER
 	if (mem_initialized)		debug_cs.Leave	();
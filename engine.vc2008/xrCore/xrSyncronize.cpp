@@ -31,10 +31,154 @@ struct profiler {
 };
 #endif // PROFILE_CRITICAL_SECTIONS
 
+#ifndef _EDITOR
+	extern "C" void * _ReturnAddress(void);
+#	pragma intrinsic(_ReturnAddress)
+#	define LOCK_CALL_SITE()			_ReturnAddress()
+#else // _EDITOR
+#	define LOCK_CALL_SITE()			0
+#endif // _EDITOR
+
+XRCORE_API BOOL	g_lock_profile		= FALSE;
+
+struct lock_site {
+	void*					m_address;		// 0 for the sites, which do not fit the table
+	u32						m_acquisitions;
+	u32						m_contended;
+	u64						m_wait;
+	u32						m_blocking;		// times the others waited while it held the section
+	u64						m_blocked;
+	u64						m_hold;
+	u64						m_hold_max;
+};
+
+// allocated from the process heap : the memory pools are guarded by sections themselves
+struct lock_statistics {
+	enum {
+		site_count			= 32,
+		histogram_size		= 16,			// wait time in microseconds : [0,1), [1,2), [2,4) ... [2^14,...)
+	};
+
+	// the counters are written by the owner of the section and read by the dump
+	CRITICAL_SECTION		m_guard;
+	xrCriticalSection*		m_section;
+	lock_statistics*		m_next;
+
+	u32						m_acquisitions;
+	u32						m_contended;
+	u64						m_wait;
+	u64						m_wait_max;
+	u32						m_histogram[histogram_size];
+	lock_site				m_sites[site_count + 1];
+
+	// the owner of the section only
+	u32						m_depth;
+	void* volatile			m_holder;
+	u64						m_hold_start;
+
+	lock_site&				site		(void* address)
+	{
+		u32					hash = (u32(size_t(address)) >> 2)*2654435761u;
+		for (u32 i=0; i<site_count; ++i) {
+			lock_site&		result = m_sites[(hash + i) % site_count];
+			if (result.m_address == address)
+				return		(result);
+
+			if (!result.m_address) {
+				result.m_address	= address;
+				return		(result);
+			}
+		}
+
+		return				(m_sites[site_count]);
+	}
+
+	void					reset		()
+	{
+		m_acquisitions		= 0;
+		m_contended			= 0;
+		m_wait				= 0;
+		m_wait_max			= 0;
+		ZeroMemory			(m_histogram,sizeof(m_histogram));
+		ZeroMemory			(m_sites,sizeof(m_sites));
+	}
+};
+
+// never destroyed : sections are being released till the very process exit
+struct lock_registry {
+	CRITICAL_SECTION		m_lock;
+	lock_statistics*		m_first;
+	u32						m_count;
+
+							lock_registry	()
+	{
+		InitializeCriticalSection	(&m_lock);
+		m_first				= 0;
+		m_count				= 0;
+	}
+};
+
+static lock_registry		s_lock_registry;
+
+static void lock_acquired	(lock_statistics& self, void* site, bool contended, u64 wait, void* holder)
+{
+	// recursive acquisitions are not counted
+	if (self.m_depth++)
+		return;
+
+	EnterCriticalSection	(&self.m_guard);
+
+	++self.m_acquisitions;
+	lock_site&				current = self.site(site);
+	++current.m_acquisitions;
+
+	if (contended) {
+		++self.m_contended;
+		self.m_wait			+= wait;
+		self.m_wait_max		= _max(self.m_wait_max,wait);
+		++current.m_contended;
+		current.m_wait		+= wait;
+
+		u32					microseconds = u32(wait/CPU::clk_per_microsec);
+		u32					bucket = 0;
+		for ( ; microseconds && (bucket < lock_statistics::histogram_size - 1); microseconds >>= 1)
+			++bucket;
+		++self.m_histogram[bucket];
+
+		// the holder could have left before we looked at it
+		if (holder) {
+			lock_site&		blocking = self.site(holder);
+			++blocking.m_blocking;
+			blocking.m_blocked	+= wait;
+		}
+	}
+
+	LeaveCriticalSection	(&self.m_guard);
+
+	self.m_holder			= site;
+	self.m_hold_start		= CPU::GetCLK();
+}
+
+static void lock_released	(lock_statistics& self)
+{
+	if (--self.m_depth)
+		return;
+
+	u64						hold = CPU::GetCLK() - self.m_hold_start;
+
+	EnterCriticalSection	(&self.m_guard);
+	lock_site&				current = self.site(self.m_holder);
+	current.m_hold			+= hold;
+	current.m_hold_max		= _max(current.m_hold_max,hold);
+	LeaveCriticalSection	(&self.m_guard);
+
+	self.m_holder			= 0;
+}
+
 #ifdef PROFILE_CRITICAL_SECTIONS
-xrCriticalSection::xrCriticalSection	(LPCSTR id) : m_id(id)
+xrCriticalSection::xrCriticalSection	(LPCSTR id) : m_id(id), m_name(id), m_statistics(0)
 #else // PROFILE_CRITICAL_SECTIONS
-xrCriticalSection::xrCriticalSection	()
+xrCriticalSection::xrCriticalSection	() : m_name(0), m_statistics(0)
 #endif // PROFILE_CRITICAL_SECTIONS
 {
 	pmutex							= xr_alloc<CRITICAL_SECTION>(1);
@@ -43,15 +187,52 @@ xrCriticalSection::xrCriticalSection	()
 
 xrCriticalSection::~xrCriticalSection	()
 {
+	if (m_statistics) {
+		EnterCriticalSection		(&s_lock_registry.m_lock);
+		lock_statistics**			I = &s_lock_registry.m_first;
+		while (*I != m_statistics)
+			I						= &(*I)->m_next;
+		*I							= m_statistics->m_next;
+		--s_lock_registry.m_count;
+		LeaveCriticalSection		(&s_lock_registry.m_lock);
+
+		DeleteCriticalSection		(&m_statistics->m_guard);
+		HeapFree					(GetProcessHeap(),0,m_statistics);
+	}
+
 	DeleteCriticalSection			( (CRITICAL_SECTION*)pmutex	);
 	xr_free							( pmutex		);
 }
 
+lock_statistics& xrCriticalSection::statistics	()
+{
+	if (m_statistics)
+		return						(*m_statistics);
+
+	lock_statistics*				result = (lock_statistics*)HeapAlloc(GetProcessHeap(),HEAP_ZERO_MEMORY,sizeof(lock_statistics));
+	R_ASSERT						(result);
+	InitializeCriticalSection		(&result->m_guard);
+	result->m_section				= this;
+
+	if (InterlockedCompareExchangePointer((void* volatile*)&m_statistics,result,0)) {
+		DeleteCriticalSection		(&result->m_guard);
+		HeapFree					(GetProcessHeap(),0,result);
+		return						(*m_statistics);
+	}
+
+	EnterCriticalSection			(&s_lock_registry.m_lock);
+	result->m_next					= s_lock_registry.m_first;
+	s_lock_registry.m_first			= result;
+	++s_lock_registry.m_count;
+	LeaveCriticalSection			(&s_lock_registry.m_lock);
+	return							(*result);
+}
+
 #ifdef DEBUG
 	extern void OutputDebugStackTrace	(const char *header);
 #endif // DEBUG
 
-void	xrCriticalSection::Enter	()
+void	xrCriticalSection::enter	(void* site)
 {
 #ifdef PROFILE_CRITICAL_SECTIONS
 #	if 0//def DEBUG
@@ -61,27 +242,348 @@ void	xrCriticalSection::Enter	()
 #	endif // DEBUG
 	profiler						temp(m_id);
 #endif // PROFILE_CRITICAL_SECTIONS
+	if (!g_lock_profile) {
+		EnterCriticalSection		( (CRITICAL_SECTION*)pmutex );
+
+		// a recursive acquisition of the profiled one keeps the depth right
+		if (m_statistics && m_statistics->m_depth)
+			++m_statistics->m_depth;
+		return;
+	}
+
+	lock_statistics&				self = statistics();
+	if (TryEnterCriticalSection( (CRITICAL_SECTION*)pmutex )) {
+		lock_acquired				(self,site,false,0,0);
+		return;
+	}
+
+	void*							holder = self.m_holder;
+	u64								start = CPU::GetCLK();
 	EnterCriticalSection			( (CRITICAL_SECTION*)pmutex );
+	lock_acquired					(self,site,true,CPU::GetCLK() - start,holder);
+}
+
+BOOL	xrCriticalSection::try_enter	(void* site)
+{
+	if (!TryEnterCriticalSection( (CRITICAL_SECTION*)pmutex ))
+		return						(FALSE);
+
+	if (g_lock_profile)
+		lock_acquired				(statistics(),site,false,0,0);
+	else if (m_statistics && m_statistics->m_depth)
+		++m_statistics->m_depth;
+
+	return							(TRUE);
+}
+
+void	xrCriticalSection::Enter	()
+{
+	enter							(LOCK_CALL_SITE());
 }
 
 void	xrCriticalSection::Leave	()
 {
+	if (m_statistics && m_statistics->m_depth)
+		lock_released				(*m_statistics);
+
 	LeaveCriticalSection			( (CRITICAL_SECTION*)pmutex );
 }
 
 BOOL	xrCriticalSection::TryEnter	()
 {
-	return TryEnterCriticalSection	( (CRITICAL_SECTION*)pmutex );
+	return							(try_enter(LOCK_CALL_SITE()));
 }
 
 xrCriticalSection::raii::raii		(xrCriticalSection* critical_section) 
 									: critical_section(critical_section) 
 {
 	VERIFY(critical_section);
-	critical_section->Enter();
+	critical_section->enter(LOCK_CALL_SITE());
 }
 
 xrCriticalSection::raii::~raii		()
 { 
 	critical_section->Leave(); 
 }
+
+// reporting
+
+struct lock_snapshot {
+	const xrCriticalSection*	m_section;
+	LPCSTR					m_name;
+	u32						m_acquisitions;
+	u32						m_contended;
+	u64						m_wait;
+	u64						m_wait_max;
+	u32						m_histogram[lock_statistics::histogram_size];
+	lock_site				m_sites[lock_statistics::site_count + 1];
+};
+
+typedef xr_vector<lock_snapshot>	LOCK_SNAPSHOTS;
+
+static void lock_profile_snapshot	(LOCK_SNAPSHOTS& result, const xrCriticalSection* section)
+{
+	// no allocations under the registry lock and the guards : the allocator takes sections too,
+	// so the room is reserved before, and again if more sections were registered meanwhile
+	for (;;) {
+		EnterCriticalSection		(&s_lock_registry.m_lock);
+		u32							count = section ? 1 : s_lock_registry.m_count;
+		if (result.size() + count <= result.capacity())
+			break;
+
+		LeaveCriticalSection		(&s_lock_registry.m_lock);
+		result.reserve				(result.size() + count + 16);
+	}
+
+	for (lock_statistics* I = s_lock_registry.m_first; I; I = I->m_next) {
+		if (section && (I->m_section != section))
+			continue;
+
+		lock_snapshot				snapshot;
+		EnterCriticalSection		(&I->m_guard);
+		snapshot.m_section			= I->m_section;
+		snapshot.m_name				= I->m_section->name();
+		snapshot.m_acquisitions		= I->m_acquisitions;
+		snapshot.m_contended		= I->m_contended;
+		snapshot.m_wait				= I->m_wait;
+		snapshot.m_wait_max			= I->m_wait_max;
+		CopyMemory					(snapshot.m_histogram,I->m_histogram,sizeof(snapshot.m_histogram));
+		CopyMemory					(snapshot.m_sites,I->m_sites,sizeof(snapshot.m_sites));
+		LeaveCriticalSection		(&I->m_guard);
+
+		if (snapshot.m_acquisitions)
+			result.push_back		(snapshot);
+	}
+
+	LeaveCriticalSection			(&s_lock_registry.m_lock);
+}
+
+static bool lock_wait_greater		(const lock_snapshot& _1, const lock_snapshot& _2)
+{
+	if (_1.m_wait != _2.m_wait)
+		return						(_1.m_wait > _2.m_wait);
+	return							(_1.m_acquisitions > _2.m_acquisitions);
+}
+
+static bool lock_site_greater		(const lock_site& _1, const lock_site& _2)
+{
+	return							((_1.m_wait + _1.m_blocked) > (_2.m_wait + _2.m_blocked));
+}
+
+static void lock_site_name			(LPSTR result, u32 result_size, void* address)
+{
+	if (!address) {
+		xr_strcpy					(result,result_size,"<other sites>");
+		return;
+	}
+
+	// module relative, so it could be resolved against the map or the pdb
+	MEMORY_BASIC_INFORMATION		info;
+	string_path						module_name;
+	if (!VirtualQuery(address,&info,sizeof(info)) || !GetModuleFileName((HMODULE)info.AllocationBase,module_name,sizeof(module_name))) {
+		xr_sprintf					(result,result_size,"0x%08x",u32(size_t(address)));
+		return;
+	}
+
+	LPCSTR							file_name = strrchr(module_name,'\\');
+	xr_sprintf						(result,result_size,"%s+0x%x",file_name ? file_name + 1 : module_name,u32(size_t(address) - size_t(info.AllocationBase)));
+}
+
+static void lock_profile_line		(IWriter* F, LPCSTR format, ...)
+{
+	string1024						line;
+	va_list							mark;
+	va_start						(mark,format);
+	_vsnprintf						(line,sizeof(line)-1,format,mark); line[sizeof(line)-1] = 0;
+	va_end							(mark);
+
+	Msg								("%s",line);
+	if (F)
+		F->w_printf					("%s\r\n",line);
+}
+
+static void lock_profile_report		(IWriter* F, LOCK_SNAPSHOTS& snapshots)
+{
+	std::sort						(snapshots.begin(),snapshots.end(),lock_wait_greater);
+
+	lock_profile_line				(F,"* Lock profile : %d sections acquired",snapshots.size());
+
+	LOCK_SNAPSHOTS::iterator		I = snapshots.begin();
+	LOCK_SNAPSHOTS::iterator		E = snapshots.end();
+	for ( ; I != E; ++I) {
+		lock_snapshot&				self = *I;
+		lock_profile_line			(F,"*   %s [0x%08x] : %d acquisitions, %d contended (%.2f%%), %.3f ms waited, %.1f us max",
+			self.m_name ? self.m_name : "<unnamed>",
+			u32(size_t(self.m_section)),
+			self.m_acquisitions,
+			self.m_contended,
+			100.f*float(self.m_contended)/float(self.m_acquisitions),
+			float(self.m_wait)*CPU::clk_to_milisec,
+			float(self.m_wait_max)*CPU::clk_to_microsec
+		);
+
+		if (self.m_contended) {
+			string256				histogram = "";
+			for (u32 i=0; i<lock_statistics::histogram_size; ++i) {
+				if (!self.m_histogram[i])
+					continue;
+
+				string32			bucket;
+				xr_sprintf			(bucket,"%s%d:%d",i ? " " : " <",i ? (1 << (i - 1)) : 1,self.m_histogram[i]);
+				xr_strcat			(histogram,bucket);
+			}
+			lock_profile_line		(F,"*     wait us :%s",histogram);
+		}
+
+		lock_site*					sites = self.m_sites;
+		lock_site*					sites_end = sites + lock_statistics::site_count + 1;
+		std::sort					(sites,sites_end,lock_site_greater);
+
+		u32							shown = 0;
+		for (lock_site* i = sites; (i != sites_end) && (shown < 8); ++i) {
+			if (!i->m_acquisitions && !i->m_blocking)
+				continue;
+
+			string_path				name;
+			lock_site_name			(name,sizeof(name),i->m_address);
+			lock_profile_line		(F,"*     %-32s : %d acquisitions, %d contended, %.3f ms waited, held while %d waited %.3f ms, %.1f us held max",
+				name,
+				i->m_acquisitions,
+				i->m_contended,
+				float(i->m_wait)*CPU::clk_to_milisec,
+				i->m_blocking,
+				float(i->m_blocked)*CPU::clk_to_milisec,
+				float(i->m_hold_max)*CPU::clk_to_microsec
+			);
+			++shown;
+		}
+	}
+}
+
+void lock_profile_dump				(LPCSTR file_name)
+{
+	LOCK_SNAPSHOTS					snapshots;
+	lock_profile_snapshot			(snapshots,0);
+
+	IWriter*						F = 0;
+	string_path						full_name;
+	if (file_name && file_name[0]) {
+		FS.update_path				(full_name,"$logs$",file_name);
+		F							= FS.w_open(full_name);
+		if (!F)
+			Msg						("! Lock profile : cannot open file [%s]",full_name);
+	}
+
+	lock_profile_report				(F,snapshots);
+
+	if (F) {
+		FS.w_close					(F);
+		Msg							("* Lock profile : written to [%s]",full_name);
+	}
+}
+
+void lock_profile_reset				()
+{
+	EnterCriticalSection			(&s_lock_registry.m_lock);
+	for (lock_statistics* I = s_lock_registry.m_first; I; I = I->m_next) {
+		EnterCriticalSection		(&I->m_guard);
+		I->reset					();
+		LeaveCriticalSection		(&I->m_guard);
+	}
+	LeaveCriticalSection			(&s_lock_registry.m_lock);
+}
+
+struct lock_profile_test_context {
+	xrCriticalSection				m_section;
+	u32								m_iteration_count;
+	volatile LONG					m_started;
+	volatile LONG					m_finished;
+	volatile u32					m_counter;
+};
+
+static void __cdecl lock_profile_test_entry	(void* context_ptr)
+{
+	lock_profile_test_context&		context = *(lock_profile_test_context*)context_ptr;
+
+	// everybody starts at once, to collide from the very beginning
+	InterlockedDecrement			(&context.m_started);
+	while (context.m_started)
+		Sleep						(0);
+
+	for (u32 i=0; i<context.m_iteration_count; ++i) {
+		xrCriticalSection::raii		lock(&context.m_section);
+
+		// a couple of microseconds inside
+		u64							finish = CPU::GetCLK() + 2*CPU::clk_per_microsec;
+		while (CPU::GetCLK() < finish)
+			;
+		++context.m_counter;
+	}
+
+	InterlockedIncrement			(&context.m_finished);
+}
+
+bool lock_profile_test				(u32 thread_count, u32 iteration_count)
+{
+	BOOL							enabled = g_lock_profile;
+	g_lock_profile					= TRUE;
+
+	lock_profile_test_context		context;
+	context.m_section.set_name		("lock_profile_test");
+	context.m_iteration_count		= iteration_count;
+	context.m_started				= thread_count;
+	context.m_finished				= 0;
+	context.m_counter				= 0;
+
+	for (u32 i=0; i<thread_count; ++i)
+		thread_spawn				(lock_profile_test_entry,"X-RAY Lock profile test",0,&context);
+
+	while (u32(context.m_finished) < thread_count)
+		Sleep						(1);
+
+	LOCK_SNAPSHOTS					snapshots;
+	lock_profile_snapshot			(snapshots,&context.m_section);
+	g_lock_profile					= enabled;
+
+	u32								expected = thread_count*iteration_count;
+	bool							result = (snapshots.size() == 1);
+	if (!result)
+		Msg							("! Lock profile test : the section has not been profiled");
+	else {
+		lock_snapshot&				self = snapshots.front();
+
+		u32							histogram = 0;
+		for (u32 i=0; i<lock_statistics::histogram_size; ++i)
+			histogram				+= self.m_histogram[i];
+
+		u32							acquisitions = 0, contended = 0, blocking = 0;
+		u64							wait = 0;
+		for (u32 i=0; i<=lock_statistics::site_count; ++i) {
+			acquisitions			+= self.m_sites[i].m_acquisitions;
+			contended				+= self.m_sites[i].m_contended;
+			blocking				+= self.m_sites[i].m_blocking;
+			wait					+= self.m_sites[i].m_wait;
+		}
+
+		if ((context.m_counter != expected) || (self.m_acquisitions != expected)) {
+			Msg						("! Lock profile test : %d acquisitions counted, %d expected, %d made",self.m_acquisitions,expected,context.m_counter);
+			result					= false;
+		}
+
+		if ((histogram != self.m_contended) || (contended != self.m_contended) || (acquisitions != self.m_acquisitions) || (wait != self.m_wait) || (blocking > self.m_contended)) {
+			Msg						("! Lock profile test : the totals do not match the histogram and the call sites");
+			result					= false;
+		}
+
+		// a single hardware thread may still run them one after another
+		if ((thread_count > 1) && (CPU::ID.n_threads > 1) && !self.m_contended) {
+			Msg						("! Lock profile test : %d threads have never collided",thread_count);
+			result					= false;
+		}
+
+		lock_profile_report			(0,snapshots);
+	}
+
+	Msg								("%s Lock profile test : %d threads, %d iterations each",result ? "*" : "!",thread_count,iteration_count);
+	return							(result);
+}
@@ -17,6 +17,16 @@
 #	define MUTEX_PROFILE_ID(a)		STRINGIZER(CONCATENIZE(MUTEX_PROFILE_PREFIX_ID,a))
 #endif // PROFILE_CRITICAL_SECTIONS
 
+// runtime lock profiling : acquisitions, contended ones, wait times and call sites of every section,
+// switched on and off at any moment, costs a flag test per Enter while off
+extern XRCORE_API BOOL	g_lock_profile;
+XRCORE_API void			lock_profile_dump	(LPCSTR file_name);
+XRCORE_API void			lock_profile_reset	();
+// forces contention on a section and checks the profile it gets
+XRCORE_API bool			lock_profile_test	(u32 thread_count, u32 iteration_count);
+
+struct lock_statistics;
+
 // Desc: Simple wrapper for critical section
 class XRCORE_API xrCriticalSection
 {
@@ -37,6 +47,13 @@ private:
 #ifdef PROFILE_CRITICAL_SECTIONS
 	LPCSTR				m_id;
 #endif // PROFILE_CRITICAL_SECTIONS
+	LPCSTR				m_name;
+	lock_statistics* volatile	m_statistics;
+
+private:
+	lock_statistics&	statistics	();
+	void				enter		(void* site);
+	BOOL				try_enter	(void* site);
 
 public:
 #ifdef PROFILE_CRITICAL_SECTIONS
@@ -49,6 +66,10 @@ public:
     void				Enter	();
     void				Leave	();
 	BOOL				TryEnter();
+
+	// the name in the lock profile, the string must outlive the section
+	void				set_name(LPCSTR name)	{ m_name = name; }
+	LPCSTR				name	() const		{ return m_name; }
 };
 
 #endif // xrSyncronizeH
\ No newline at end of file
@@ -8,18 +8,44 @@
 XRCORE_API	extern		str_container*	g_pStringContainer	= NULL;
 #define		HEADER		16			// ref + len + crc + next
 
-#if 1
-
 struct str_container_impl
 {
 	static const u32 buffer_size = 1024*256;
+	static const u32 stripe_count = 64;		// bucket i is guarded by stripe i % stripe_count
+
+	struct stripe
+	{
+		xrCriticalSection	cs;
+		volatile LONG		retired;		// strings lost their last reference since the last sweep
+		char				padding[64];	// keeps the neighbours off the cache line
+	};
+
 	str_value*		 buffer[buffer_size];
+	stripe			 stripes[stripe_count];
 	int              num_docs;
 
 	str_container_impl ()
 	{
 		num_docs = 0;
 		ZeroMemory(buffer, sizeof(buffer));
+		for ( u32 i=0; i<stripe_count; ++i ) {
+			stripes[i].retired = 0;
+			stripes[i].cs.set_name	("str_container::cs");
+		}
+	}
+
+	IC stripe&		 stripe_of	(u32 crc)	{ return stripes[crc % stripe_count]; }
+
+	void			 lock_all	()
+	{
+		for ( u32 i=0; i<stripe_count; ++i )
+			stripes[i].cs.Enter	();
+	}
+
+	void			 unlock_all	()
+	{
+		for ( u32 i=stripe_count; i; --i )
+			stripes[i - 1].cs.Leave	();
 	}
 
 	str_value*       find   (str_value* value, const char* str)
@@ -47,9 +73,10 @@ struct str_container_impl
 		*element = value;
 	}
 
-	void			 clean ()
+	// stripe lock must be held
+	void			 clean (u32 stripe_id)
 	{
-		for ( u32 i=0; i<buffer_size; ++i )
+		for ( u32 i=stripe_id; i<buffer_size; i+=stripe_count )
 		{
 			str_value** current = &buffer[i];
 
@@ -142,8 +169,6 @@ str_value*	str_container::dock		(str_c value)
 {
 	if (0==value)				return 0;
 
-	cs.Enter					();
-
 #ifdef DEBUG_MEMORY_MANAGER
 	Memory.stat_strdock			++	;
 #endif // DEBUG_MEMORY_MANAGER
@@ -162,6 +187,8 @@ str_value*	str_container::dock		(str_c value)
 	sv->dwLength				= s_len;
 	sv->dwCRC					= crc32	(value,s_len);
 
+	xrCriticalSection::raii		lock(&impl->stripe_of(sv->dwCRC).cs);
+
 	// search
 	result						= impl->find	(sv, value);
 	
@@ -198,48 +225,63 @@ str_value*	str_container::dock		(str_c value)
 
 		impl->insert (result);
 	}
-	cs.Leave					();
+
+	// counted under the lock, so clean never sees it unreferenced
+	InterlockedIncrement		((LONG volatile*)&result->dwReference);
 
 	return	result;
 }
 
+void		str_container::retire	(u32 crc)
+{
+	InterlockedIncrement		(&impl->stripe_of(crc).retired);
+}
+
 void		str_container::clean	()
 {
-	cs.Enter	();
-	impl->clean ();
-	cs.Leave	();
+	// stripe by stripe, docking into the other ones goes on meanwhile
+	for ( u32 i=0; i<str_container_impl::stripe_count; ++i )
+	{
+		str_container_impl::stripe&	S = impl->stripes[i];
+		if ( !S.retired )
+			continue;
+
+		xrCriticalSection::raii		lock(&S.cs);
+		S.retired	= 0;
+		impl->clean (i);
+	}
 }
 
 void		str_container::verify	()
 {
-	cs.Enter	();
-	impl->verify();
-	cs.Leave	();
+	impl->lock_all	();
+	impl->verify	();
+	impl->unlock_all();
 }
 
 void		str_container::dump	()
 {
- 	cs.Enter	();
+ 	impl->lock_all	();
  	FILE* F		= fopen("d:\\$str_dump$.txt","w");
  	impl->dump  (F);
  	fclose		(F);
- 	cs.Leave	();
+ 	impl->unlock_all();
 }
 
 void		str_container::dump	(IWriter* W)
 {
- 	cs.Enter	();
+ 	impl->lock_all	();
  	impl->dump  (W);
- 	cs.Leave	();
+ 	impl->unlock_all();
 }
 
 u32			str_container::stat_economy		()
 {
- 	cs.Enter	();
+ 	impl->lock_all	();
  	int				counter	= 0;
  	counter			-= sizeof(*this);
 	counter			+= impl->stat_economy();
- 	cs.Leave		(); 
+ 	impl->unlock_all(); 
  	return			u32(counter);
 }
 
@@ -250,184 +292,105 @@ str_container::~str_container		()
 	xr_delete(impl);
 }
 
-#else
-
-struct str_container_impl
+struct str_benchmark_context
 {
-	typedef xr_multiset<str_value*, str_value_cmp>	cdb;
-	int num_docs;
-	str_container_impl () {num_docs=0;}
-
-
-	cdb	container;
+	xr_vector<LPCSTR> const*	strings;
+	u32							first;
+	u32							rounds;
+	void*						start;
+	volatile LONG*				alive;
 };
 
-str_container::str_container ()
+static void	str_benchmark_thread	(void* param)
 {
-	impl = xr_new<str_container_impl>();
-}
-
-str_value*	str_container::dock		(str_c value)
-{
-	if (0==value)				return 0;
-
-	cs.Enter					();
-
-// 	++impl->num_docs;
-// 	if ( impl->num_docs == 10000000 )
-// 	{
-// 		Msg("shared_strings");
-// 		g_find_chunk_counter.flush();
-// 	}
-// 
-// 	//#ifdef FIND_CHUNK_BENCHMARK_ENABLE
-// 	find_chunk_auto_timer timer;
-// 	//#endif // FIND_CHUNK_BENCHMARK_ENABLE
-
-#ifdef DEBUG_MEMORY_MANAGER
-	Memory.stat_strdock			++	;
-#endif // DEBUG_MEMORY_MANAGER
+	str_benchmark_context&	context = *(str_benchmark_context*)param;
+	xr_vector<LPCSTR> const&	strings = *context.strings;
+	u32						count	= strings.size();
 
-	str_value*	result			= 0	;
-
-	// calc len
-	u32		s_len				= xr_strlen(value);
-	u32		s_len_with_zero		= (u32)s_len+1;
-	VERIFY	(HEADER+s_len_with_zero < 4096);
-
-	// setup find structure
-	char	header[sizeof(str_value)];
-	str_value*	sv				= (str_value*)header;
-	sv->dwReference				= 0;
-	sv->dwLength				= s_len;
-	sv->dwCRC					= crc32	(value,s_len);
-	sv->next					= NULL;
-	
-	// search
-	str_container_impl::cdb::iterator	I			= impl->container.find	(sv);	// only integer compares :)
-	if (I!=impl->container.end())		{
-		// something found - verify, it is exactly our string
-		str_container_impl::cdb::iterator	save	= I;
-		for (; I!=impl->container.end() && (*I)->dwCRC == sv->dwCRC; ++I)	{
-			str_value*	V		= (*I);
-			if	(V->dwLength!=sv->dwLength)			continue;
-			if	(0!=memcmp(V->value,value,s_len))	continue;
-			result				= V;				// found
-			break;
+	WaitForSingleObject		(context.start,INFINITE);
+	for ( u32 r=0; r<context.rounds; ++r )
+	{
+		// every thread walks the list from its own place, as the real users do not go in step
+		for ( u32 i=0; i<count; ++i )
+		{
+			shared_str		docked	= strings[(context.first + i) % count];
+			shared_str		copy	= docked;
 		}
 	}
+	InterlockedDecrement	(context.alive);
+}
 
-	bool is_leaked_string = !xr_strcmp(value, "enter leaked string here");
-
-	// it may be the case, string is not found or has "non-exact" match
-	if (0==result || is_leaked_string)				{
-		// Insert string
-//		DUMP_PHASE;
-
-		result					= (str_value*)Memory.mem_alloc(HEADER+s_len_with_zero
-#ifdef DEBUG_MEMORY_NAME
-			, "storage: sstring"
-#endif // DEBUG_MEMORY_NAME
-			);
-
-		static int num11 = 0;
-		
-		if ( is_leaked_string )
+void		str_container_benchmark	(CInifile const &ini, u32 max_thread_count)
+{
+	xr_vector<shared_str>	holder;
+	CInifile::Root const&	sections = ini.sections();
+	for ( CInifile::RootCIt I=sections.begin(); I!=sections.end(); ++I )
+	{
+		holder.push_back	((*I)->Name);
+		for ( CInifile::SectCIt J=(*I)->Data.begin(); J!=(*I)->Data.end(); ++J )
 		{
-			++num11;
-			Msg("leaked_string: %d 0x%08x", num11, result);
+			holder.push_back(J->first);
+			if ( J->second.size() )
+				holder.push_back(J->second);
 		}
+	}
 
-//		DUMP_PHASE;
-
-		result->dwReference		= 0;
-		result->dwLength		= sv->dwLength;
-		result->dwCRC			= sv->dwCRC;
-		result->next			= NULL;
+	// plain copies : the benchmark has to dock them, not to copy the references
+	xr_vector<xr_string>	copies;
+	copies.reserve			(holder.size());
+	for ( xr_vector<shared_str>::const_iterator I=holder.begin(); I!=holder.end(); ++I )
+		copies.push_back	(**I);
+	holder.clear			();
 
-		CopyMemory				(result->value,value,s_len_with_zero);
+	xr_vector<LPCSTR>		strings;
+	strings.reserve			(copies.size());
+	for ( xr_vector<xr_string>::const_iterator I=copies.begin(); I!=copies.end(); ++I )
+		strings.push_back	((*I).c_str());
 
-		impl->container.insert (result);
+	if ( strings.empty() )
+	{
+		Msg					("! there are no strings in the config");
+		return;
 	}
 
-	cs.Leave					();
+	max_thread_count		= _max(max_thread_count,u32(1));
+	u32						rounds = _max(u32(1),u32(1000000/strings.size()));
+	Msg						("* shared_str benchmark: %d string(s) x %d round(s), %d stripe(s)",strings.size(),rounds,str_container_impl::stripe_count);
 
-	return	result;
-}
-
-void		str_container::clean	()
-{
-	cs.Enter	();
-	str_container_impl::cdb::iterator	it	= impl->container.begin	();
-	str_container_impl::cdb::iterator	end	= impl->container.end		();
-	for (; it!=end; )	{
-		str_value*	sv = *it;
-		if (0==sv->dwReference)	
+	float					single_rate = 0.f;
+	for ( u32 thread_count=1; ; thread_count=_min(thread_count*2,max_thread_count) )
+	{
+		xr_vector<str_benchmark_context>	contexts(thread_count);
+		void*				start	= CreateEvent(NULL,TRUE,FALSE,NULL);
+		volatile LONG		alive	= LONG(thread_count);
+		for ( u32 i=0; i<thread_count; ++i )
 		{
-			str_container_impl::cdb::iterator	i_current	= it;
-			str_container_impl::cdb::iterator	i_next		= ++it;
-			xr_free			(sv);
-			impl->container.erase	(i_current);
-			it							= i_next;
-		} else {
-			it++;
+			contexts[i].strings	= &strings;
+			contexts[i].first	= i*strings.size()/thread_count;
+			contexts[i].rounds	= rounds;
+			contexts[i].start	= start;
+			contexts[i].alive	= &alive;
+			thread_spawn	(str_benchmark_thread,"X-RAY shared_str benchmark",0,&contexts[i]);
 		}
-	}
-	if (impl->container.empty())	impl->container.clear	();
-	cs.Leave	();
-}
-
-void		str_container::verify	()
-{
-	cs.Enter	();
-	str_container_impl::cdb::iterator	it	= impl->container.begin	();
-	str_container_impl::cdb::iterator	end	= impl->container.end		();
-	for (; it!=end; ++it)	{
-		str_value*	sv		= *it;
-		u32			crc		= crc32	(sv->value,sv->dwLength);
-		string32	crc_str;
-		R_ASSERT3	(crc==sv->dwCRC, "CorePanic: read-only memory corruption (shared_strings)", itoa(sv->dwCRC,crc_str,16));
-		R_ASSERT3	(sv->dwLength == xr_strlen(sv->value), "CorePanic: read-only memory corruption (shared_strings, internal structures)", sv->value);
-	}
-	cs.Leave	();
-}
 
-void		str_container::dump	()
-{
-	cs.Enter	();
-	str_container_impl::cdb::iterator	it	= impl->container.begin	();
-	str_container_impl::cdb::iterator	end	= impl->container.end		();
-	FILE* F		= fopen("d:\\$str_dump$.txt","w");
-	for (; it!=end; it++)
-		fprintf		(F,"ref[%4d]-len[%3d]-crc[%8X] : %s\n",(*it)->dwReference,(*it)->dwLength,(*it)->dwCRC,(*it)->value);
-	fclose		(F);
-	cs.Leave	();
-}
-
-u32			str_container::stat_economy		()
-{
-	cs.Enter	();
-	str_container_impl::cdb::iterator	it		= impl->container.begin	();
-	str_container_impl::cdb::iterator	end		= impl->container.end		();
-	int				counter	= 0;
-	counter			-= sizeof(*this);
-	counter			-= sizeof(str_container_impl::cdb::allocator_type);
-	const int		node_size = 20;
-	for (; it!=end; it++)	{
-		counter		-= HEADER;
-		counter		-= node_size;
-		counter		+= int((int((*it)->dwReference) - 1)*int((*it)->dwLength + 1));
+		CTimer				timer;
+		timer.Start			();
+		SetEvent			(start);
+		while ( alive )
+			SwitchToThread	();
+		float				time	= timer.GetElapsed_sec();
+		CloseHandle			(start);
+
+		// one dock and one reference copy per string
+		float				rate	= time > 0.f ? float(2*thread_count*rounds*strings.size())/time : 0.f;
+		if ( thread_count == 1 )
+			single_rate		= rate;
+		Msg					("*   %2d thread(s) : %.3f s, %10.0f ops/s, x%.2f",thread_count,time,rate,single_rate > 0.f ? rate/single_rate : 0.f);
+
+		if ( thread_count == max_thread_count )
+			break;
 	}
-	cs.Leave		();
 
-	return			u32(counter);
+	g_pStringContainer->clean	();
 }
 
-str_container::~str_container		()
-{
-	clean	();
-	//dump ();
-	xr_delete(impl);
-	//R_ASSERT(impl->container.empty());
-}
-#endif
\ No newline at end of file
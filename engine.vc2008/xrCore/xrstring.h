@@ -10,7 +10,7 @@ typedef const char*		str_c;
 #pragma warning(disable : 4200)
 struct		XRCORE_API	str_value
 {
-	u32					dwReference		;
+	volatile u32		dwReference		;	// interlocked
 	u32					dwLength		;
 	u32					dwCRC			;
 	str_value*          next            ;
@@ -29,28 +29,33 @@ struct		XRCORE_API	str_hash_function {
 
 struct str_container_impl;
 class IWriter;
+class CInifile;
 //////////////////////////////////////////////////////////////////////////
+// buckets are guarded by a set of locks (lock striping), so threads docking different strings do not
+// meet on the same lock; the reference returned by dock is already counted, so a string is never seen
+// with zero references outside of the lock of its stripe and clean sweeps the stripes one by one,
+// only those where some string has lost its last reference since the previous sweep
 class		XRCORE_API	str_container
 {
 private:
-	xrCriticalSection					cs;
 	str_container_impl*                 impl;
 public:
 						str_container	();
 						~str_container  ();
 
 	str_value*			dock			(str_c value);
+	void				retire			(u32 crc);		// a string with this crc has lost its last reference
 	void				clean			();
 	void				dump			();
 	void				dump			(IWriter* W);
 	void				verify			();
 	u32					stat_economy	();
-#ifdef PROFILE_CRITICAL_SECTIONS
-						str_container	():cs(MUTEX_PROFILE_ID(str_container)){}
-#endif // PROFILE_CRITICAL_SECTIONS
 };
 XRCORE_API	extern		str_container*	g_pStringContainer;
 
+// interns the strings of the config from 1..max_thread_count threads at once
+XRCORE_API	void		str_container_benchmark	(CInifile const &ini, u32 max_thread_count);
+
 //////////////////////////////////////////////////////////////////////////
 class					shared_str
 {
@@ -58,10 +63,10 @@ private:
 	str_value*			p_;
 protected:
 	// ref-counting
-	void				_dec		()								{	if (0==p_) return;	p_->dwReference--; 	if (0==p_->dwReference)	p_=0;						}
+	void				_dec		()								{	if (0==p_) return;	u32 crc = p_->dwCRC; if (0==InterlockedDecrement((LONG volatile*)&p_->dwReference)) { g_pStringContainer->retire(crc); p_=0; }	}
 public:
-	void				_set		(str_c rhs) 					{	str_value* v = g_pStringContainer->dock(rhs); if (0!=v) v->dwReference++; _dec(); p_ = v;	}
-	void				_set		(shared_str const &rhs)			{	str_value* v = rhs.p_; if (0!=v) v->dwReference++; _dec(); p_ = v;							}
+	void				_set		(str_c rhs) 					{	str_value* v = g_pStringContainer->dock(rhs); _dec(); p_ = v;								}
+	void				_set		(shared_str const &rhs)			{	str_value* v = rhs.p_; if (0!=v) InterlockedIncrement((LONG volatile*)&v->dwReference); _dec(); p_ = v;	}
 //	void				_set		(shared_str const &rhs)			{	str_value* v = g_pStringContainer->dock(rhs.c_str()); if (0!=v) v->dwReference++; _dec(); p_ = v;							}
 	
 
@@ -45,6 +45,7 @@ void CRenderDevice::Destroy	(void) {
 	seqFrameMT.R.clear			();
 	seqDeviceReset.R.clear		();
 	seqParallel.clear			();
+	seqParallelTasks.clear		();
 
 	RenderFactory->DestroyRenderDeviceRender(m_pRender);
 	m_pRender = 0;
@@ -259,6 +259,8 @@ public:
 
 	// Models
 	virtual IRenderVisual*			model_CreateParticles	(LPCSTR name)								= 0;
+	// the particle visuals of the frame at once, the same as OnFrame of every one of them
+	virtual void					models_UpdateParticles	(IRenderVisual* const* V, const u32* dt, u32 count)	= 0;
 //	virtual IRender_DetailModel*	model_CreateDM			(IReader*	F)								= 0;
 	//virtual IRenderDetailModel*		model_CreateDM			(IReader*	F)								= 0;
 	//virtual IRenderVisual*			model_Create			(LPCSTR name, IReader*	data=0)				= 0;
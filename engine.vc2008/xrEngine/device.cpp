@@ -27,6 +27,8 @@
 
 #include "xrSash.h"
 #include "igame_persistent.h"
+#include "../xrCore/task_scheduler.h"
+#include "../xrCore/trace_profiler.h"
 
 #pragma comment( lib, "d3dx9.lib"		)
 
@@ -175,6 +177,38 @@ void CRenderDevice::End		(void)
 }
 
 
+void CRenderDevice::mt_ProcessSeqParallel	()
+{
+	for (u32 pit=0; pit<seqParallel.size(); pit++)
+		seqParallel[pit]		();
+	seqParallel.clear_not_free	();
+}
+
+void CRenderDevice::mt_ProcessParallel	()
+{
+	if (!TaskScheduler.initialized()) {
+		mt_ProcessSeqParallel		();
+		for (u32 pit=0; pit<seqParallelTasks.size(); pit++)
+			seqParallelTasks[pit]	();
+		seqParallelTasks.clear_not_free	();
+		return;
+	}
+
+	// seqParallel keeps its order, so it is drained as a single task,
+	// independent tasks are spread over all the workers
+	TaskScheduler.frame_begin		(dwFrame);
+	if (!seqParallel.empty())
+		TaskScheduler.frame_push	(fastdelegate::FastDelegate0<>(this,&CRenderDevice::mt_ProcessSeqParallel));
+	for (u32 pit=0; pit<seqParallelTasks.size(); pit++)
+		TaskScheduler.frame_push	(seqParallelTasks[pit]);
+	TaskScheduler.frame_sync		();
+	seqParallelTasks.clear_not_free	();
+
+	// something could be added while we were waiting
+	if (!seqParallel.empty())
+		mt_ProcessSeqParallel		();
+}
+
 volatile u32	mt_Thread_marker		= 0x12345678;
 void 			mt_Thread	(void *ptr)	{
 	while (true) {
@@ -189,10 +223,11 @@ void 			mt_Thread	(void *ptr)	{
 		// we has granted permission to execute
 		mt_Thread_marker			= Device.dwFrame;
  
-		for (u32 pit=0; pit<Device.seqParallel.size(); pit++)
-			Device.seqParallel[pit]	();
-		Device.seqParallel.clear_not_free	();
-		Device.seqFrameMT.Process	(rp_Frame);
+		{
+			TRACE_ZONE				("Device: secondary frame");
+			Device.mt_ProcessParallel	();
+			Device.seqFrameMT.Process	(rp_Frame);
+		}
 
 		// now we give control to device - signals that we are ended our work
 		Device.mt_csEnter.Leave	();
@@ -295,6 +330,7 @@ void CRenderDevice::on_idle		()
 	Statistic->RenderTOTAL_Real.Begin		();
 	if (b_is_Active)							{
 		if (Begin())				{
+			TRACE_ZONE								("Device: render");
 
 			seqRender.Process						(rp_Render);
 			if (psDeviceFlags.test(rsCameraPos) || psDeviceFlags.test(rsStatistic) || Statistic->errors.size())	
@@ -317,9 +353,7 @@ void CRenderDevice::on_idle		()
 
 	// Ensure, that second thread gets chance to execute anyway
 	if (dwFrame!=mt_Thread_marker)			{
-		for (u32 pit=0; pit<Device.seqParallel.size(); pit++)
-			Device.seqParallel[pit]			();
-		Device.seqParallel.clear_not_free	();
+		mt_ProcessParallel					();
 		seqFrameMT.Process					(rp_Frame);
 	}
 
@@ -409,6 +443,11 @@ void CRenderDevice::Run			()
 	// Start all threads
 //	InitializeCriticalSection	(&mt_csEnter);
 //	InitializeCriticalSection	(&mt_csLeave);
+	u32 task_workers			= u32(-1);
+	if (strstr(Core.Params,"-task_workers "))
+		sscanf					(strstr(Core.Params,"-task_workers ")+14,"%d",&task_workers);
+	TaskScheduler.initialize	(task_workers);
+
 	mt_csEnter.Enter			();
 	mt_bMustExit				= FALSE;
 	thread_spawn				(mt_Thread,"X-RAY Secondary thread",0,0);
@@ -427,6 +466,8 @@ void CRenderDevice::Run			()
 	mt_bMustExit			= TRUE;
 	mt_csEnter.Leave		();
 	while (mt_bMustExit)	Sleep(0);
+
+	TaskScheduler.destroy	();
 //	DeleteCriticalSection	(&mt_csEnter);
 //	DeleteCriticalSection	(&mt_csLeave);
 }
@@ -440,6 +481,7 @@ void CRenderDevice::FrameMove()
 	dwFrame			++;
 
 	Core.dwFrame = dwFrame;
+	trace_frame		(dwFrame);
 
 	dwTimeContinual	= TimerMM.GetElapsed_ms() - app_inactive_time;
 
@@ -480,7 +522,10 @@ void CRenderDevice::FrameMove()
 
 	//	TODO: HACK to test loading screen.
 	//if(!g_bLoaded) 
+	{
+		TRACE_ZONE					("Device: frame");
 		ProcessLoading				(rp_Frame);
+	}
 	//else
 	//	seqFrame.Process			(rp_Frame);
 	Statistic->EngineTOTAL.End	();
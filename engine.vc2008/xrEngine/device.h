@@ -171,6 +171,8 @@ public:
 	CRegistrator	<pureFrame			>			seqFrameMT;
 	CRegistrator	<pureDeviceReset	>			seqDeviceReset;
 	xr_vector		<fastdelegate::FastDelegate0<> >	seqParallel;
+	// independent tasks : may run on any task worker, concurrently with each other and with seqParallel
+	xr_vector		<fastdelegate::FastDelegate0<> >	seqParallelTasks;
 
 	// Dependent classes
 	//CResourceManager*						Resources;
@@ -277,8 +279,20 @@ public:
 		);
 		if (I != seqParallel.end())
 			seqParallel.erase	(I);
+
+		I							= std::find(
+			seqParallelTasks.begin(),
+			seqParallelTasks.end(),
+			delegate
+		);
+		if (I != seqParallelTasks.end())
+			seqParallelTasks.erase	(I);
 	}
 
+			void			mt_ProcessParallel			();
+private:
+			void			mt_ProcessSeqParallel		();
+
 public:
 			void xr_stdcall		on_idle				();
 			bool xr_stdcall		on_message			(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam, LRESULT &result);
@@ -14,6 +14,8 @@
 #include "../Include/xrRender/RenderDeviceRender.h"
 
 #include "xr_object.h"
+#include "../xrCore/task_scheduler.h"
+#include "../xrCore/trace_profiler.h"
 
 xr_token*							vid_quality_token = NULL;
 
@@ -105,6 +107,245 @@ public:
 	virtual void Execute(LPCSTR args) { g_pStringContainer->dump();}
 };
 
+class CCC_TaskSchedulerBenchmark : public IConsole_Command
+{
+public:
+	CCC_TaskSchedulerBenchmark(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		u32		frame_count = 100, tasks_per_frame = 64;
+		if (args && args[0])
+			sscanf	(args,"%d %d",&frame_count,&tasks_per_frame);
+		if (!frame_count || !tasks_per_frame) {
+			Msg	("! usage: %s [frame_count] [tasks_per_frame]",cName);
+			return;
+		}
+		task_scheduler_benchmark	(frame_count,tasks_per_frame);
+	}
+	virtual void Info	(TInfo& I)
+	{
+		xr_strcpy(I,"[frame_count] [tasks_per_frame] - synthetic per-frame makespan : serial drain vs task scheduler"); 
+	}
+};
+
+class CCC_TraceStart : public IConsole_Command
+{
+public:
+	CCC_TraceStart(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		u32		max_event_count = 1024*1024;
+		if (args && args[0])
+			sscanf	(args,"%d",&max_event_count);
+		if (!max_event_count) {
+			Msg	("! usage: %s [max_event_count]",cName);
+			return;
+		}
+		trace_start	(max_event_count);
+	}
+	virtual void Info	(TInfo& I)
+	{
+		xr_strcpy(I,"[max_event_count] - starts recording the profile zones of all the threads"); 
+	}
+};
+
+class CCC_TraceStop : public IConsole_Command
+{
+public:
+	CCC_TraceStop(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		string_path		file_name;
+		xr_strcpy		(file_name,(args && args[0]) ? args : "trace.json");
+		trace_stop		(file_name);
+	}
+	virtual void Info	(TInfo& I)
+	{
+		xr_strcpy(I,"[file_name] - stops recording, writes the chrome trace into $logs$ and logs the most expensive zones"); 
+	}
+};
+
+class CCC_LockProfileDump : public IConsole_Command
+{
+public:
+	CCC_LockProfileDump(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		string_path		file_name;
+		xr_strcpy		(file_name,(args && args[0]) ? args : "lock_profile.log");
+		lock_profile_dump	(file_name);
+	}
+	virtual void Info	(TInfo& I)
+	{
+		xr_strcpy(I,"[file_name] - logs the lock profile (see lock_profile) and writes it into $logs$"); 
+	}
+};
+
+class CCC_LockProfileReset : public IConsole_Command
+{
+public:
+	CCC_LockProfileReset(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		lock_profile_reset	();
+	}
+	virtual void Info	(TInfo& I)
+	{
+		xr_strcpy(I,"clears the lock profile counters"); 
+	}
+};
+
+class CCC_LockProfileTest : public IConsole_Command
+{
+public:
+	CCC_LockProfileTest(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		u32		thread_count = 4, iteration_count = 10000;
+		if (args && args[0])
+			sscanf	(args,"%d %d",&thread_count,&iteration_count);
+		if (!thread_count || !iteration_count) {
+			Msg	("! usage: %s [thread_count] [iteration_count]",cName);
+			return;
+		}
+		lock_profile_test	(thread_count,iteration_count);
+	}
+	virtual void Info	(TInfo& I)
+	{
+		xr_strcpy(I,"[thread_count] [iteration_count] - forces contention on a section and checks its lock profile"); 
+	}
+};
+
+class CCC_FSLookupBenchmark : public IConsole_Command
+{
+public:
+	CCC_FSLookupBenchmark(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		FS.lookup_benchmark	();
+	}
+	virtual void Info	(TInfo& I)
+	{
+		xr_strcpy(I,"file system lookups (recorded with -fs_trace_lookups) : ordered set vs hash index"); 
+	}
+};
+
+class CCC_FSAsyncBenchmark : public IConsole_Command
+{
+public:
+	CCC_FSAsyncBenchmark(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = FALSE; };
+	virtual void Execute(LPCSTR args) {
+		string_path		folder;
+		strconcat		(sizeof(folder),folder,args,"\\");
+		FS.async_benchmark	("$game_levels$",folder);
+	}
+	virtual void Info	(TInfo& I)
+	{
+		xr_strcpy(I,"level name : reads the level files serially and through the FS I/O threads"); 
+	}
+};
+
+class CCC_StrContainerBenchmark : public IConsole_Command
+{
+public:
+	CCC_StrContainerBenchmark(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		u32				thread_count = CPU::ID.n_threads;
+		if (args && args[0])
+			sscanf		(args,"%d",&thread_count);
+		str_container_benchmark	(*pSettings,thread_count);
+	}
+	virtual void Info	(TInfo& I)
+	{
+		xr_strcpy(I,"[max thread count] : docks system.ltx strings into shared_str from 1..N threads"); 
+	}
+};
+
+class CCC_MemPoolStat : public IConsole_Command
+{
+public:
+	CCC_MemPoolStat(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		mem_pool_statistic	();
+	}
+	virtual void Info	(TInfo& I)
+	{
+		xr_strcpy(I,"memory pools : thread cache hits/misses and lock contentions per size class"); 
+	}
+};
+
+class CCC_MemPoolBenchmark : public IConsole_Command
+{
+public:
+	CCC_MemPoolBenchmark(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		u32				thread_count = CPU::ID.n_threads;
+		if (args && args[0])
+			sscanf		(args,"%d",&thread_count);
+		mem_pool_benchmark	(thread_count);
+	}
+	virtual void Info	(TInfo& I)
+	{
+		xr_strcpy(I,"[max thread count] : mixed size allocations, locked pools vs thread caches"); 
+	}
+};
+
+class CCC_SpatialBenchmark : public IConsole_Command
+{
+public:
+	CCC_SpatialBenchmark(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		u32				thread_count = _max(CPU::ID.n_threads,u32(2)) - 1;
+		u32				object_count = 4096;
+		u32				milliseconds = 1000;
+		if (args && args[0])
+			sscanf		(args,"%d %d %d",&thread_count,&object_count,&milliseconds);
+		if (!thread_count || !object_count || !milliseconds) {
+			Msg			("! usage: %s [query thread count] [object count] [milliseconds]",cName);
+			return;
+		}
+		spatial_benchmark	(thread_count,object_count,milliseconds);
+	}
+	virtual void Info	(TInfo& I)
+	{
+		xr_strcpy(I,"[query thread count] [object count] [milliseconds] : spatial queries against one mover thread, single lock vs reader/writer"); 
+	}
+};
+
+class CCC_RayBenchmark : public IConsole_Command
+{
+public:
+	CCC_RayBenchmark(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		if (!g_pGameLevel) {
+			Msg			("! ray_bench: no level loaded");
+			return;
+		}
+		u32				thread_count = CPU::ID.n_threads;
+		u32				ray_count = 100000;
+		if (args && args[0])
+			sscanf		(args,"%d %d",&thread_count,&ray_count);
+		g_pGameLevel->ObjectSpace.ray_benchmark	(ray_count,thread_count);
+	}
+	virtual void Info	(TInfo& I)
+	{
+		xr_strcpy(I,"[max thread count] [ray count] : static ray picks over the level collision model"); 
+	}
+};
+
+class CCC_RayPacketBenchmark : public IConsole_Command
+{
+public:
+	CCC_RayPacketBenchmark(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		if (!g_pGameLevel) {
+			Msg			("! ray_packet_bench: no level loaded");
+			return;
+		}
+		u32				ray_count = 100000;
+		if (args && args[0])
+			sscanf		(args,"%d",&ray_count);
+		g_pGameLevel->ObjectSpace.ray_packet_benchmark	(ray_count);
+	}
+	virtual void Info	(TInfo& I)
+	{
+		xr_strcpy(I,"[ray count] : single rays vs ray packets over the level collision model"); 
+	}
+};
+
 //-----------------------------------------------------------------------
 class CCC_MotionsStat : public IConsole_Command
 {
@@ -690,6 +931,21 @@ void CCC_Register()
 	CMD1(CCC_Disconnect,"disconnect"			);
 	CMD1(CCC_SaveCFG,	"cfg_save"				);
 	CMD1(CCC_LoadCFG,	"cfg_load"				);
+	CMD1(CCC_TaskSchedulerBenchmark,"mt_task_bench"	);
+	CMD1(CCC_TraceStart,	"trace_start"		);
+	CMD1(CCC_TraceStop,		"trace_stop"		);
+	CMD4(CCC_Integer,		"lock_profile",		&g_lock_profile, FALSE, TRUE);
+	CMD1(CCC_LockProfileDump,"lock_profile_dump"	);
+	CMD1(CCC_LockProfileReset,"lock_profile_reset"	);
+	CMD1(CCC_LockProfileTest,"lock_profile_test"	);
+	CMD1(CCC_FSLookupBenchmark,"fs_lookup_bench"	);
+	CMD1(CCC_FSAsyncBenchmark,"fs_async_bench"	);
+	CMD1(CCC_StrContainerBenchmark,"str_container_bench"	);
+	CMD1(CCC_MemPoolStat,	"mem_pool_stat"		);
+	CMD1(CCC_MemPoolBenchmark,"mem_pool_bench"	);
+	CMD1(CCC_RayBenchmark,	"ray_bench"			);
+	CMD1(CCC_SpatialBenchmark,"spatial_bench"		);
+	CMD1(CCC_RayPacketBenchmark,"ray_packet_bench"	);
 
 #ifdef DEBUG
 	CMD1(CCC_MotionsStat,	"stat_motions"		);
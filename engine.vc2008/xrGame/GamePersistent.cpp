@@ -656,7 +656,10 @@ void CGamePersistent::OnFrame	()
 	__super::OnFrame			();
 
 	if(!Device.Paused())
+	{
 		Engine.Sheduler.Update		();
+		CParticlesObject::UpdateQueued	();
+	}
 
 	// update weathers ambient
 	if(!Device.Paused())
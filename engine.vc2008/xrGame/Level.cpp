@@ -31,6 +31,7 @@
 #include "autosave_manager.h"
 #include "ClimableObject.h"
 #include "level_graph.h"
+#include "path_request_queue.h"
 #include "mt_config.h"
 #include "phcommander.h"
 #include "map_manager.h"
@@ -172,6 +173,7 @@ CLevel::CLevel():IPureClient	(Device.GetTimerGlobal())
 
 	//---------------------------------------------------------	
 	m_writer = NULL;
+	m_client_writer = NULL;
 	m_reader = NULL;
 	m_DemoPlay = FALSE;
 	m_DemoPlayStarted	= FALSE;
@@ -639,6 +641,10 @@ void CLevel::OnFrame	()
 				GameTaskManager().UpdateTasks();
 		}
 	}
+	// level graph path requests : frame sync point
+	if (ai().get_level_graph())
+		ai().graph_engine().path_requests().deliver();
+
 	// Inherited update
 	inherited::OnFrame		();
 
@@ -266,6 +266,8 @@ public:
 	void						ProcessGameEvents		( );
 	void						ProcessGameSpawns		( );
 	void						ProcessCompressedUpdate	(NET_Packet& P, u8 const compression_type);
+	void						ProcessDeltaUpdate		(NET_Packet& P);
+	void						SyncUpdateSteps			(u32 const time_receive);
 
 	// Input
 	virtual	void				IR_OnKeyboardPress		( int btn );
@@ -382,6 +384,7 @@ public:
 	//alligned to 16 bytes m_lzo_working_buffer
 	u8*											m_lzo_working_memory;
 	u8*											m_lzo_working_buffer;
+	client_updates::update_receiver				m_update_receiver;
 	
 	void			init_compression			();
 	void			deinit_compression			();
@@ -286,6 +286,8 @@ extern					BOOL		g_SV_Disable_Auth_Check;
 void CLevel::Send		(NET_Packet& P, u32 dwFlags, u32 dwTimeout)
 {
 	if (IsDemoPlayStarted() || IsDemoPlayFinished()) return;
+	if (IsDemoSaveStarted())
+		SaveClientPacket	(P);
 	// optimize the case when server located in our memory
 	if(psNET_direct_connect){
 		ClientID	_clid;
@@ -12,15 +12,17 @@
 #include "DemoPlay_Control.h"
 #include "DemoInfo.h"
 #include "../xrEngine/CameraManager.h"
+#include "demo_load_test.h"
 
 void CLevel::PrepareToSaveDemo		()
 {
 	R_ASSERT(!m_DemoPlay);
+	string_path demo_base = "";
 	string_path demo_name = "";
 	string_path demo_path;
 	SYSTEMTIME Time;
 	GetLocalTime		(&Time);
-	xr_sprintf			(demo_name, "xray_%02d-%02d-%02d_%02d-%02d-%02d.demo",
+	xr_sprintf			(demo_base, "xray_%02d-%02d-%02d_%02d-%02d-%02d",
 		Time.wMonth,
 		Time.wDay,
 		Time.wYear,
@@ -28,9 +30,13 @@ void CLevel::PrepareToSaveDemo		()
 		Time.wMinute,
 		Time.wSecond
 	);
+	xr_sprintf			(demo_name, "%s.demo", demo_base);
 	Msg					("Demo would be stored in - %s", demo_name);
 	FS.update_path      (demo_path, "$logs$", demo_name);
 	m_writer			= FS.w_open(demo_path);
+	xr_sprintf			(demo_name, "%s.cdemo", demo_base);
+	FS.update_path      (demo_path, "$logs$", demo_name);
+	m_client_writer		= FS.w_open(demo_path);
 	m_DemoSave			= TRUE;
 }
 
@@ -58,6 +64,10 @@ void CLevel::StopSaveDemo()
 	{
 		FS.w_close(m_writer);
 	}
+	if (m_client_writer)
+	{
+		FS.w_close(m_client_writer);
+	}
 }
 
 
@@ -177,6 +187,24 @@ void CLevel::SavePacket(NET_Packet& packet)
 	m_writer->w		(packet.B.data, packet.B.count);
 }
 
+void CLevel::SaveClientPacket(NET_Packet& packet)
+{
+	if (!m_client_writer)
+		return;
+
+	// the remote admin login is in plain text, only the packets the bots replay are kept
+	u32 const pos			= packet.r_pos;
+	bool const replay		= demo_load_test::replayable(packet);
+	packet.r_pos			= pos;
+	if (!replay)
+		return;
+
+	m_client_writer->w_u32	(Device.dwTimeGlobal - m_demo_header.m_time_global);
+	m_client_writer->w_u32	(timeServer());
+	m_client_writer->w_u32	(packet.B.count);
+	m_client_writer->w		(packet.B.data, packet.B.count);
+}
+
 bool CLevel::LoadDemoHeader	()
 {
 	R_ASSERT(m_reader);
@@ -54,6 +54,9 @@ public:
 	};
 #pragma pack(pop)
 	void						SavePacket				(NET_Packet& packet);
+	// the packets this client sends, in the same format, into <demo name>.cdemo
+	// (the load test replays them against a server, see demo_load_test.h)
+	void						SaveClientPacket		(NET_Packet& packet);
 private:
 
 	void						StartSaveDemo			(shared_str const & server_options);
@@ -77,6 +80,7 @@ private:
 	demo_info*					m_demo_info;	//if instance of this class exist, then the demo info have saved or loaded...
 	u32							m_demo_info_file_pos;
 	IWriter*					m_writer;
+	IWriter*					m_client_writer;
 	CStreamReader*				m_reader;
 	
 	u32							m_prev_packet_pos;
@@ -3,6 +3,7 @@
 #include "../xrCore/ppmd_compressor.h"
 #include "../xrphysics/iphworld.h"
 #include "xrServer_updates_compressor.h"
+#include "xrServer_client_updates.h"
 
 void CLevel::ProcessCompressedUpdate(NET_Packet& P, u8 const compress_type)
 {
@@ -12,55 +13,85 @@ void CLevel::ProcessCompressedUpdate(NET_Packet& P, u8 const compress_type)
 	Device.Statistic->netClientCompressor.Begin();
 	while (next_size)
 	{
-		if (compress_type & eto_ppmd_compression)
-		{
-			R_ASSERT(m_trained_stream);			
-			uncompressed_packet.B.count = ppmd_trained_decompress(
-				uncompressed_packet.B.data,
-				sizeof(uncompressed_packet.B.data),
-				P.B.data + P.r_tell(),
-				next_size,
-				m_trained_stream
-			);
-		} else if (compress_type & eto_lzo_compression)
-		{
-			R_ASSERT(m_lzo_dictionary.data);
-			uncompressed_packet.B.count = sizeof(uncompressed_packet.B.data);
-			lzo_decompress_dict(
-				P.B.data + P.r_tell(),
-				next_size,
-				uncompressed_packet.B.data,
-				(lzo_uint*)&uncompressed_packet.B.count,
-				m_lzo_working_memory,
-				m_lzo_dictionary.data,
-				m_lzo_dictionary.size
-			);
-		} else
-		{
-			NODEFAULT;
-		}
-		
-		VERIFY2(uncompressed_packet.B.count <= sizeof(uncompressed_packet.B.data),
-			"stack owerflow after decompressing");
+		VERIFY(compress_type & (eto_ppmd_compression | eto_lzo_compression));
+		client_updates::decompress_block(
+			compress_type,
+			P.B.data + P.r_tell(),
+			next_size,
+			uncompressed_packet,
+			m_trained_stream,
+			m_lzo_dictionary,
+			m_lzo_working_memory
+		);
 
 		P.r_seek(P.r_tell() + next_size);
-		uncompressed_packet.r_seek(0);
 		Objects.net_Import(&uncompressed_packet);
 		P.r_u16(next_size);
 	}
 	Device.Statistic->netClientCompressor.End();
 
+	SyncUpdateSteps(P.timeReceive);
+}
+
+void CLevel::ProcessDeltaUpdate(NET_Packet& P)
+{
+	u8 const	compress_type	= P.r_u8();
+	u16			sequence;
+	P.r_u16		(sequence);
+	P.r_u8		();			//part
+	u8 const	part_count		= P.r_u8();
+
+	NET_Packet	uncompressed_packet;
+	NET_Packet	record;
+	u16 next_size;
+	P.r_u16(next_size);
+	Device.Statistic->netClientCompressor.Begin();
+	while (next_size)
+	{
+		client_updates::decompress_block(
+			compress_type,
+			P.B.data + P.r_tell(),
+			next_size,
+			uncompressed_packet,
+			m_trained_stream,
+			m_lzo_dictionary,
+			m_lzo_working_memory
+		);
+		P.r_seek(P.r_tell() + next_size);
+
+		while (!uncompressed_packet.r_eof())
+		{
+			if (m_update_receiver.decode(sequence, uncompressed_packet, record) == client_updates::update_receiver::record_apply)
+				Objects.net_Import(&record);
+		}
+		P.r_u16(next_size);
+	}
+	Device.Statistic->netClientCompressor.End();
+
+	if (m_update_receiver.receive_part(sequence, part_count))
+	{
+		NET_Packet	ack;
+		ack.w_begin	(M_CL_UPDATES_ACK);
+		m_update_receiver.write_ack(ack);
+		Send		(ack, net_flags(FALSE));
+	}
+
+	SyncUpdateSteps(P.timeReceive);
+}
+
+void CLevel::SyncUpdateSteps(u32 const time_receive)
+{
 	if (OnClient()) UpdateDeltaUpd(timeServer());
 	IClientStatistic pStat = Level().GetStatistic();
 	u32 dTime = 0;
 	
-	if ((Level().timeServer() + pStat.getPing()) < P.timeReceive)
+	if ((Level().timeServer() + pStat.getPing()) < time_receive)
 	{
 		dTime = pStat.getPing();
 	}
 	else
 	{
-		dTime = Level().timeServer() - P.timeReceive + pStat.getPing();
+		dTime = Level().timeServer() - time_receive + pStat.getPing();
 	}
 	u32 NumSteps = physics_world()->CalcNumSteps(dTime);
 	SetNumCrSteps(NumSteps);
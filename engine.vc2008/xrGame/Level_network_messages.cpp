@@ -158,6 +158,10 @@ void CLevel::ClientReceive()
 				u8 compression_type = P->r_u8();
 				ProcessCompressedUpdate(*P, compression_type);
 			}break;
+		case M_UPDATE_OBJECTS_DELTA:
+			{
+				ProcessDeltaUpdate(*P);
+			}break;
 		case M_CL_UPDATE:
 			{
 				/*if (!game_configured)
@@ -14,6 +14,9 @@
 
 const Fvector zero_vel		= {0.f,0.f,0.f};
 
+// updated by the scheduler this frame, the render updates them at once in UpdateQueued
+static xr_vector<CParticlesObject*>	g_queued;
+
 CParticlesObject::CParticlesObject	(LPCSTR p_name, BOOL bAutoRemove, bool destroy_on_game_load) :
 	inherited				(destroy_on_game_load)
 {
@@ -73,7 +76,8 @@ void CParticlesObject::Init	(LPCSTR p_name, IRender_Sector* S, BOOL bAutoRemove)
 //----------------------------------------------------
 CParticlesObject::~CParticlesObject()
 {
-	VERIFY					(0==mt_dt);
+	// destroyed with the update queued, e.g. with the level
+	g_queued.erase			(std::remove(g_queued.begin(),g_queued.end(),this),g_queued.end());
 
 //	we do not need this since CPS_Instance does it
 //	shedule_unregister		();
@@ -164,20 +168,46 @@ void CParticlesObject::shedule_Update	(u32 _dt)
 	if (m_bDead)					return;
 	u32 dt							= Device.dwTimeGlobal - dwLastTime;
 	if (dt)							{
-		if (0){//.psDeviceFlags.test(mtParticles))	{    //. AlexMX comment this line// NO UNCOMMENT - DON'T WORK PROPERLY
-			mt_dt					= dt;
-			fastdelegate::FastDelegate0<>		delegate	(this,&CParticlesObject::PerformAllTheWork_mt);
-			Device.seqParallel.push_back		(delegate);
-		} else {
-			mt_dt					= 0;
-			IParticleCustom* V		= smart_cast<IParticleCustom*>(renderable.visual); VERIFY(V);
-			V->OnFrame				(dt);
-		}
+		// the particles of all the objects of the frame are updated together, right after the scheduler
+		if (0==mt_dt)
+			g_queued.push_back		(this);
+		mt_dt						+= dt;
 		dwLastTime					= Device.dwTimeGlobal;
+		return;
 	}
 	UpdateSpatial					();
 }
 
+void CParticlesObject::UpdateQueued()
+{
+	if (g_queued.empty())			return;
+
+	xr_vector<CParticlesObject*>	objects;
+	objects.swap					(g_queued);
+
+	// Play in the meantime has done the update already
+	xr_vector<IRenderVisual*>		visuals;
+	xr_vector<u32>					dt;
+	visuals.reserve					(objects.size());
+	dt.reserve						(objects.size());
+	u32 count						= 0;
+	for (u32 i=0; i<objects.size(); ++i) {
+		CParticlesObject* O			= objects[i];
+		if (0==O->mt_dt)			continue;
+		visuals.push_back			(O->renderable.visual);
+		dt.push_back				(O->mt_dt);
+		O->mt_dt					= 0;
+		objects[count++]			= O;
+	}
+	objects.resize					(count);
+
+	if (count)
+		::Render->models_UpdateParticles	(&*visuals.begin(),&*dt.begin(),count);
+
+	for (u32 i=0; i<objects.size(); ++i)
+		objects[i]->UpdateSpatial	();
+}
+
 void CParticlesObject::PerformAllTheWork(u32 _dt)
 {
 	if(g_dedicated_server)		return;
@@ -192,16 +222,6 @@ void CParticlesObject::PerformAllTheWork(u32 _dt)
 	UpdateSpatial					();
 }
 
-void CParticlesObject::PerformAllTheWork_mt()
-{
-	if(g_dedicated_server)		return;
-
-	if (0==mt_dt)			return;	//???
-	IParticleCustom* V		= smart_cast<IParticleCustom*>(renderable.visual); VERIFY(V);
-	V->OnFrame				(mt_dt);
-	mt_dt					= 0;
-}
-
 void CParticlesObject::SetXFORM			(const Fmatrix& m)
 {
 	if(g_dedicated_server)		return;
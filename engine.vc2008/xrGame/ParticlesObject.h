@@ -31,7 +31,8 @@ public:
 	virtual void		shedule_Update		(u32 dt);
 	virtual void		renderable_Render	();
 	void				PerformAllTheWork	(u32 dt);
-	void	__stdcall	PerformAllTheWork_mt();
+	// the particles of the objects the scheduler has updated this frame
+	static void			UpdateQueued		();
 
 	Fvector&			Position			();
 	void				SetXFORM			(const Fmatrix& m);
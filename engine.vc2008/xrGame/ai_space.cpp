@@ -20,6 +20,7 @@
 #include "alife_simulator.h"
 #include "moving_objects.h"
 #include "doors_manager.h"
+#include "level_graph_hierarchy.h"
 #include "../xrEngine/dedicated_server_only.h"
 #include "../xrEngine/no_single.h"
 
@@ -39,6 +40,7 @@ CAI_Space::CAI_Space				()
 	m_script_engine			= 0;
 	m_moving_objects		= 0;
 	m_doors_manager			= 0;
+	m_level_graph_hierarchy	= 0;
 }
 
 void CAI_Space::init				()
@@ -127,6 +129,9 @@ void CAI_Space::load				(LPCSTR level_name)
 #endif
 
 	level_graph().level_id	(current_level.id());
+	// built with the level : every level path search may go through it
+	VERIFY					(!m_level_graph_hierarchy);
+	m_level_graph_hierarchy	= xr_new<CLevelGraphHierarchy>(level_graph());
 	m_cover_manager->compute_static_cover	();
 	m_moving_objects->on_level_load			();
 
@@ -146,6 +151,7 @@ void CAI_Space::unload				(bool reload)
 	script_engine().unload	();
 
 	xr_delete				(m_doors_manager);
+	xr_delete				(m_level_graph_hierarchy);
 	xr_delete				(m_graph_engine);
 	xr_delete				(m_level_graph);
 
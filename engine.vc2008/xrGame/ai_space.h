@@ -18,6 +18,7 @@ class CCoverManager;
 class CScriptEngine;
 class CPatrolPathStorage;
 class moving_objects;
+class CLevelGraphHierarchy;
 
 namespace doors {
 	class manager;
@@ -42,6 +43,7 @@ private:
 	CPatrolPathStorage					*m_patrol_path_storage;
 	moving_objects						*m_moving_objects;
 	doors::manager						*m_doors_manager;
+	CLevelGraphHierarchy				*m_level_graph_hierarchy;
 
 private:
 			void						load					(LPCSTR level_name);
@@ -70,6 +72,7 @@ public:
 	IC		CScriptEngine				&script_engine			() const;
 	IC		moving_objects				&moving_objects			() const;
 	IC		doors::manager&				doors					() const;
+	IC		CLevelGraphHierarchy		&level_graph_hierarchy	() const;
 
 #ifdef DEBUG
 			void						validate				(const u32			level_id) const;
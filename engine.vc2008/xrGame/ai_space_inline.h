@@ -30,6 +30,12 @@ IC	const CLevelGraph	*CAI_Space::get_level_graph					() const
 	return					(m_level_graph);
 }
 
+IC	CLevelGraphHierarchy	&CAI_Space::level_graph_hierarchy			() const
+{
+	VERIFY					(m_level_graph_hierarchy);
+	return					(*m_level_graph_hierarchy);
+}
+
 IC	CEF_Storage					&CAI_Space::ef_storage				() const
 {
 	VERIFY					(m_ef_storage);
@@ -69,6 +69,8 @@ public:
 			void						add						(CSE_ALifeDynamicObject		*object,	GameGraph::_GRAPH_ID		game_vertex_id,	bool				bUpdateSwitchObjects = true);
 			void						remove					(CSE_ALifeDynamicObject		*object,	GameGraph::_GRAPH_ID		game_vertex_id,	bool				bUpdateSwitchObjects = true);
 	IC		void						change					(CSE_ALifeDynamicObject		*object,	GameGraph::_GRAPH_ID		game_vertex_id,	GameGraph::_GRAPH_ID	next_game_vertex_id);
+	// to be called when the position of an object on the current level has been changed
+	IC		void						move					(CSE_ALifeDynamicObject		*object);
 	IC		CALifeLevelRegistry			&level					() const;
 	IC		void						set_process_time		(const float &process_time);
 	IC		CSE_ALifeCreatureActor		*actor					() const;
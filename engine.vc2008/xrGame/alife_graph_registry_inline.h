@@ -22,6 +22,13 @@ IC	void CALifeGraphRegistry::change	(CSE_ALifeDynamicObject *object, GameGraph::
 	object->m_tGraphID			= tNextGraphPointID;
 	object->o_Position			= ai().game_graph().vertex(object->m_tGraphID)->level_point();
 	object->m_tNodeID			= ai().game_graph().vertex(object->m_tGraphID)->level_vertex_id();
+	move						(object);
+}
+
+IC	void CALifeGraphRegistry::move		(CSE_ALifeDynamicObject *object)
+{
+	if (m_level)
+		level().move			(object);
 }
 
 IC	void CALifeGraphRegistry::assign	(CSE_ALifeMonsterAbstract *monster)
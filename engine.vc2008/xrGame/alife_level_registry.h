@@ -12,6 +12,7 @@
 #include "xrServer_Objects_ALife.h"
 #include "game_graph.h"
 #include "ai_debug.h"
+#include "alife_switch_grid.h"
 
 //#define FULL_LEVEL_UPDATE
 
@@ -23,15 +24,18 @@ protected:
 
 protected:
 	GameGraph::_LEVEL_ID			m_level_id;
+	CALifeSwitchGrid				m_grid;
 
 public:
 	IC								CALifeLevelRegistry	(const GameGraph::_LEVEL_ID &level_id);
 	IC		void					add					(CSE_ALifeDynamicObject *tpALifeDynamicObject);
 	IC		void					remove				(CSE_ALifeDynamicObject *tpALifeDynamicObject, bool no_assert = false);
+	IC		void					move				(CSE_ALifeDynamicObject *tpALifeDynamicObject);
 	template <typename _update_predicate>
-	IC		void					update				(const _update_predicate &predicate, bool const iterate_as_first_time_next_time);
+	IC		void					update				(const _update_predicate &predicate, bool const iterate_as_first_time_next_time, bool const restart_timer = true);
 	IC		GameGraph::_LEVEL_ID	level_id			() const;
 	IC		CSE_ALifeDynamicObject	*object				(const ALife::_OBJECT_ID &id, bool no_assert = false) const;
+	IC		const CALifeSwitchGrid	&grid				() const;
 };
 
 #include "alife_level_registry_inline.h"
\ No newline at end of file
@@ -31,6 +31,7 @@ IC	void CALifeLevelRegistry::add				(CSE_ALifeDynamicObject *object)
 	}
 #endif
 	inherited::add		(object->ID,object);
+	m_grid.add			(object);
 }
 
 IC	void CALifeLevelRegistry::remove			(CSE_ALifeDynamicObject *object, bool no_assert)
@@ -41,13 +42,19 @@ IC	void CALifeLevelRegistry::remove			(CSE_ALifeDynamicObject *object, bool no_a
 	}
 #endif
 	inherited::remove	(object->ID,no_assert);
+	m_grid.remove		(object);
+}
+
+IC	void CALifeLevelRegistry::move				(CSE_ALifeDynamicObject *object)
+{
+	m_grid.move			(object);
 }
 
 template <typename _update_predicate>
-IC	void CALifeLevelRegistry::update			(const _update_predicate &predicate, bool const iterate_as_first_time_next_time)
+IC	void CALifeLevelRegistry::update			(const _update_predicate &predicate, bool const iterate_as_first_time_next_time, bool const restart_timer)
 {
 //	u32					object_count = 
-		inherited::update(predicate,iterate_as_first_time_next_time);
+		inherited::update(predicate,iterate_as_first_time_next_time,restart_timer);
 #ifdef FULL_LEVEL_UPDATE
 	m_first_update		= true;
 #endif
@@ -67,3 +74,8 @@ IC	CSE_ALifeDynamicObject *CALifeLevelRegistry::object	(const ALife::_OBJECT_ID
 	}
 	return				((*I).second);
 }
+
+IC	const CALifeSwitchGrid &CALifeLevelRegistry::grid	() const
+{
+	return				(m_grid);
+}
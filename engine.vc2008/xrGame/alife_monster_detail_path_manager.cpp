@@ -29,6 +29,8 @@ CALifeMonsterDetailPathManager::CALifeMonsterDetailPathManager	(object_type *obj
 	m_destination.m_level_vertex_id	= this->object().get_object().m_tNodeID;
 	m_destination.m_position		= this->object().get_object().o_Position;
 	m_walked_distance				= 0.f;
+	m_failed_start_vertex_id		= GameGraph::_GRAPH_ID(-1);
+	m_failed_dest_vertex_id			= GameGraph::_GRAPH_ID(-1);
 }
 
 void CALifeMonsterDetailPathManager::target					(const GameGraph::_GRAPH_ID &game_vertex_id, const u32 &level_vertex_id, const Fvector &position)
@@ -163,6 +165,11 @@ void CALifeMonsterDetailPathManager::actualize				()
 	if (failed)
 		return;
 
+	accept_path						();
+}
+
+void CALifeMonsterDetailPathManager::accept_path				()
+{
 	VERIFY							(!m_path.empty());
 
 	if (m_path.size() == 1) {
@@ -175,6 +182,39 @@ void CALifeMonsterDetailPathManager::actualize				()
 	VERIFY							(m_path.back() == object().get_object().m_tGraphID);
 }
 
+bool CALifeMonsterDetailPathManager::plan_needed				() const
+{
+	// the same conditions the next update checks before it calls actualize
+	if (!m_last_update_time)
+		return						(false);
+
+	if (ai().alife().time_manager().game_time() <= m_last_update_time)
+		return						(false);
+
+	if (completed())
+		return						(false);
+
+	return							(!actual());
+}
+
+void CALifeMonsterDetailPathManager::plan						(PATH &path)
+{
+	// the path has been searched from the current vertex to the current destination,
+	// so the update finds it actual, unless the brain picks another destination first
+	m_path.swap						(path);
+	if (m_path.empty()) {
+		// the update is not going to search the same path again
+		m_failed_start_vertex_id	= object().get_object().m_tGraphID;
+		m_failed_dest_vertex_id		= m_destination.m_game_vertex_id;
+#ifdef DEBUG
+		Msg							("! %s couldn't build game path from [%d] to [%d]",object().get_object().name_replace(),m_failed_start_vertex_id,m_failed_dest_vertex_id);
+#endif
+		return;
+	}
+
+	accept_path						();
+}
+
 void CALifeMonsterDetailPathManager::update					(const ALife::_TIME_ID &time_delta)
 {
 	// first update has enormous time delta, therefore just skip it
@@ -185,6 +225,15 @@ void CALifeMonsterDetailPathManager::update					(const ALife::_TIME_ID &time_del
 		return;
 
 	if (!actual()) {
+		bool						failed_ahead = 
+			(m_failed_start_vertex_id == object().get_object().m_tGraphID) &&
+			(m_failed_dest_vertex_id == m_destination.m_game_vertex_id);
+		m_failed_start_vertex_id	= GameGraph::_GRAPH_ID(-1);
+		m_failed_dest_vertex_id		= GameGraph::_GRAPH_ID(-1);
+
+		if (failed_ahead)
+			return;
+
 		actualize					();
 
 		if (failed())
@@ -217,6 +266,7 @@ void CALifeMonsterDetailPathManager::follow_path				(const ALife::_TIME_ID &time
 		m_walked_distance			= 0.f;
 		object().get_object().m_tNodeID			= m_destination.m_level_vertex_id;
 		object().get_object().o_Position			= m_destination.m_position;
+		object().get_object().alife().graph().move	(&object().get_object());
 #ifdef DEBUG
 		object().m_fDistanceFromPoint	= 0.f;
 		object().m_fDistanceToPoint		= 0.f;
@@ -33,6 +33,9 @@ private:
 	parameters							m_destination;
 	float								m_walked_distance;
 	float								m_speed;
+	// the search of the next update, which has already failed ahead
+	GameGraph::_GRAPH_ID				m_failed_start_vertex_id;
+	GameGraph::_GRAPH_ID				m_failed_dest_vertex_id;
 
 private:
 	PATH								m_path;						
@@ -47,6 +50,7 @@ private:
 
 private:
 			void		actualize						();
+			void		accept_path						();
 			void		setup_current_speed				();
 			void		follow_path						(const ALife::_TIME_ID &time_delta);
 			void		update							(const ALife::_TIME_ID &time_delta);
@@ -75,6 +79,12 @@ public:
 			bool		failed							() const;
 	IC		const PATH	&path							() const;
 	IC		const float	&walked_distance				() const;
+	IC		const GameGraph::_GRAPH_ID &destination_game_vertex_id	() const;
+
+public:
+	// the game graph search of the next update, done ahead by the offline path planner
+			bool		plan_needed						() const;
+			void		plan							(PATH &path);
 			Fvector		draw_level_position				() const;
 
 	DECLARE_SCRIPT_REGISTER_FUNCTION
@@ -36,3 +36,8 @@ IC	const float	&CALifeMonsterDetailPathManager::walked_distance					() const
 	VERIFY		(path().size() > 1);
 	return		(m_walked_distance);
 }
+
+IC	const GameGraph::_GRAPH_ID &CALifeMonsterDetailPathManager::destination_game_vertex_id	() const
+{
+	return		(m_destination.m_game_vertex_id);
+}
@@ -66,8 +66,22 @@ void CALifeObjectRegistry::save				(IWriter &memory_stream)
 	memory_stream.w_u32			(u32(-1));
 
 	u32							object_count = 0;
-	OBJECT_REGISTRY::iterator	I = m_objects.begin();
-	OBJECT_REGISTRY::iterator	E = m_objects.end();
+	save						(memory_stream,0,ALife::_OBJECT_ID(-1),object_count);
+	
+	u32							last_position = memory_stream.tell();
+	memory_stream.seek			(position);
+	memory_stream.w_u32			(object_count);
+	memory_stream.seek			(last_position);
+
+	memory_stream.close_chunk	();
+	
+	Msg							("* %d objects are successfully saved",object_count);
+}
+
+void CALifeObjectRegistry::save				(IWriter &memory_stream, ALife::_OBJECT_ID first, ALife::_OBJECT_ID last, u32 &object_count)
+{
+	OBJECT_REGISTRY::iterator	I = m_objects.lower_bound(first);
+	OBJECT_REGISTRY::iterator	E = m_objects.upper_bound(last);
 	for ( ; I != E; ++I) {
 		if (!(*I).second->can_save())
 			continue;
@@ -80,15 +94,6 @@ void CALifeObjectRegistry::save				(IWriter &memory_stream)
 
 		save					(memory_stream,(*I).second, object_count);
 	}
-	
-	u32							last_position = memory_stream.tell();
-	memory_stream.seek			(position);
-	memory_stream.w_u32			(object_count);
-	memory_stream.seek			(last_position);
-
-	memory_stream.close_chunk	();
-	
-	Msg							("* %d objects are successfully saved",object_count);
 }
 
 CSE_ALifeDynamicObject *CALifeObjectRegistry::get_object		(IReader &file_stream)
@@ -33,6 +33,8 @@ public:
 									CALifeObjectRegistry	(LPCSTR section);
 	virtual							~CALifeObjectRegistry	();
 	virtual	void					save					(IWriter &memory_stream);
+	// the top level objects with the ids in [first,last], with their children
+			void					save					(IWriter &memory_stream, ALife::_OBJECT_ID first, ALife::_OBJECT_ID last, u32 &object_count);
 			void					load					(IReader &file_stream);
 	IC		void					add						(CSE_ALifeDynamicObject *object);
 	IC		void					remove					(const ALife::_OBJECT_ID &id, bool no_assert = false);
@@ -0,0 +1,218 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: alife_offline_path_planner.cpp
+//	Created 	: 16.10.2026
+//  Modified 	: 16.10.2026
+//	Description : Game graph paths of the scheduled offline objects, searched ahead in parallel
+////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "alife_offline_path_planner.h"
+#include "ai_space.h"
+#include "game_graph.h"
+#include "xrServer_Objects_ALife_Monsters.h"
+#include "alife_monster_brain.h"
+#include "alife_online_offline_group_brain.h"
+#include "alife_monster_movement_manager.h"
+#include "alife_monster_detail_path_manager.h"
+#include "movement_manager_space.h"
+
+CALifeOfflinePathPlanner::CALifeOfflinePathPlanner	() :
+	m_next_shard		(0),
+	m_planned_count		(0)
+{
+}
+
+CALifeOfflinePathPlanner::~CALifeOfflinePathPlanner	()
+{
+	CONTEXTS::iterator	I = m_contexts.begin();
+	CONTEXTS::iterator	E = m_contexts.end();
+	for ( ; I != E; ++I) {
+		xr_delete		((*I)->m_algorithm);
+		xr_delete		(*I);
+	}
+}
+
+void CALifeOfflinePathPlanner::create_contexts	()
+{
+	VERIFY				(m_contexts.empty());
+
+	u32					vertex_count = ai().game_graph().header().vertex_count();
+	u32					count = _min(TaskScheduler.worker_count() + 1, u32(max_search_context_count));
+	m_contexts.resize	(count);
+	for (u32 i=0; i<count; ++i) {
+		CSearchContext	*context = xr_new<CSearchContext>();
+		context->m_owner	= this;
+		context->m_algorithm= xr_new<CGraphEngine::CAlgorithm>(vertex_count);
+		context->m_algorithm->data_storage().set_min_bucket_value	(_dist_type(0));
+		context->m_algorithm->data_storage().set_max_bucket_value	(_dist_type(2000));
+		m_contexts[i]	= context;
+	}
+}
+
+bool CALifeOfflinePathPlanner::request_predicate	(const CRequest &_1, const CRequest &_2)
+{
+	return				(_1.m_level_id < _2.m_level_id);
+}
+
+bool CALifeOfflinePathPlanner::shard_predicate		(const CShard &_1, const CShard &_2)
+{
+	return				((_1.m_end - _1.m_begin) > (_2.m_end - _2.m_begin));
+}
+
+void CALifeOfflinePathPlanner::search				(CGraphEngine::CAlgorithm &algorithm, CRequest &request) const
+{
+	typedef GraphEngineSpace::CGameVertexParams	CParameters;
+	typedef CPathManager<
+		CGameGraph,
+		CGraphEngine::CAlgorithm::CDataStorage,
+		CParameters,
+		_dist_type,
+		_index_type,
+		_iteration_type
+	>					CGamePathManager;
+
+	// the same search as CALifeMonsterDetailPathManager::actualize does through the shared graph engine
+	CParameters			parameters(*request.m_terrain);
+	CGamePathManager	path_manager;
+	path_manager.setup	(
+		&ai().game_graph(),
+		&algorithm.data_storage(),
+		&request.m_path,
+		request.m_start_vertex_id,
+		request.m_dest_vertex_id,
+		parameters
+	);
+
+	if (!algorithm.find(path_manager))
+		request.m_path.clear	();
+}
+
+void CALifeOfflinePathPlanner::CSearchContext::process	()
+{
+	LONG				count = LONG(m_owner->m_shards.size());
+	for (;;) {
+		LONG			index = InterlockedIncrement(&m_owner->m_next_shard) - 1;
+		if (index >= count)
+			break;
+
+		const CShard	&shard = m_owner->m_shards[index];
+		for (u32 i=shard.m_begin; i<shard.m_end; ++i)
+			m_owner->search	(*m_algorithm,m_owner->m_requests[i]);
+	}
+}
+
+CALifeMonsterMovementManager *CALifeOfflinePathPlanner::movement	(CSE_ALifeSchedulable *schedulable)
+{
+	CSE_ALifeMonsterAbstract	*monster = smart_cast<CSE_ALifeMonsterAbstract*>(schedulable->base());
+	if (monster)
+		return			(&monster->brain().movement());
+
+	CSE_ALifeOnlineOfflineGroup	*group = smart_cast<CSE_ALifeOnlineOfflineGroup*>(schedulable->base());
+	if (group)
+		return			(&group->brain().movement());
+
+	return				(0);
+}
+
+void CALifeOfflinePathPlanner::plan				(const OBJECTS &objects)
+{
+	m_requests.clear_not_free	();
+	m_shards.clear_not_free		();
+	m_planned_count		= 0;
+
+	OBJECTS::const_iterator	I = objects.begin();
+	OBJECTS::const_iterator	E = objects.end();
+	for ( ; I != E; ++I) {
+		CALifeMonsterMovementManager	*manager = movement(*I);
+		if (!manager)
+			continue;
+
+		// patrol paths pick their target in the update itself
+		if (manager->path_type() != MovementManager::ePathTypeGamePath)
+			continue;
+
+		CALifeMonsterDetailPathManager	&detail = manager->detail();
+		const CSE_ALifeDynamicObject	&object = detail.object().get_object();
+		if (object.m_bOnline || !detail.plan_needed())
+			continue;
+
+		m_requests.push_back	(CRequest());
+		CRequest		&request = m_requests.back();
+		request.m_manager			= &detail;
+		request.m_start_vertex_id	= object.m_tGraphID;
+		request.m_dest_vertex_id	= detail.destination_game_vertex_id();
+		request.m_terrain			= &detail.object().m_tpaTerrain;
+		request.m_level_id			= ai().game_graph().vertex(object.m_tGraphID)->level_id();
+	}
+
+	if (m_requests.empty())
+		return;
+
+	search_requests		();
+
+	// merge : the paths go to their owners on the calling thread
+	REQUESTS::iterator	i = m_requests.begin();
+	REQUESTS::iterator	e = m_requests.end();
+	for ( ; i != e; ++i)
+		(*i).m_manager->plan	((*i).m_path);
+
+	m_planned_count		= m_requests.size();
+}
+
+u32 CALifeOfflinePathPlanner::search				(const QUERIES &queries)
+{
+	m_requests.clear_not_free	();
+	m_shards.clear_not_free		();
+
+	QUERIES::const_iterator	I = queries.begin();
+	QUERIES::const_iterator	E = queries.end();
+	for ( ; I != E; ++I) {
+		m_requests.push_back	(CRequest());
+		CRequest		&request = m_requests.back();
+		request.m_manager			= 0;
+		request.m_start_vertex_id	= (*I).m_start_vertex_id;
+		request.m_dest_vertex_id	= (*I).m_dest_vertex_id;
+		request.m_terrain			= (*I).m_terrain;
+		request.m_level_id			= ai().game_graph().vertex((*I).m_start_vertex_id)->level_id();
+	}
+
+	if (m_requests.empty())
+		return			(0);
+
+	search_requests		();
+
+	u32					result = 0;
+	REQUESTS::const_iterator	i = m_requests.begin();
+	REQUESTS::const_iterator	e = m_requests.end();
+	for ( ; i != e; ++i)
+		if (!(*i).m_path.empty())
+			++result;
+
+	return				(result);
+}
+
+void CALifeOfflinePathPlanner::search_requests	()
+{
+	if (m_contexts.empty())
+		create_contexts	();
+
+	// stable, so the requests of a shard keep the update order;
+	// a crowded level is cut into regions, so one level does not end up on one worker
+	std::stable_sort	(m_requests.begin(),m_requests.end(),request_predicate);
+	u32					n = m_requests.size();
+	u32					region_size = _max(u32(1),(n + 4*m_contexts.size() - 1)/(4*m_contexts.size()));
+	for (u32 i=0; i<n; ) {
+		CShard			shard;
+		shard.m_begin	= i;
+		for (++i; (i < n) && (i - shard.m_begin < region_size) && (m_requests[i].m_level_id == m_requests[shard.m_begin].m_level_id); ++i);
+		shard.m_end		= i;
+		m_shards.push_back	(shard);
+	}
+	std::sort			(m_shards.begin(),m_shards.end(),shard_predicate);
+
+	m_next_shard		= 0;
+	u32					count = _min(u32(m_contexts.size()),u32(m_shards.size()));
+	for (u32 i=0; i<count; ++i)
+		TaskScheduler.push	(m_group,fastdelegate::FastDelegate0<>(m_contexts[i],&CSearchContext::process));
+	TaskScheduler.wait	(m_group);
+}
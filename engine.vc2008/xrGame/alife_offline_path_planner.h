@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: alife_offline_path_planner.h
+//	Created 	: 16.10.2026
+//  Modified 	: 16.10.2026
+//	Description : Game graph paths of the scheduled offline objects, searched ahead in parallel
+////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "graph_engine.h"
+#include "../xrCore/task_scheduler.h"
+
+class CSE_ALifeSchedulable;
+class CALifeMonsterDetailPathManager;
+class CALifeMonsterMovementManager;
+
+// the scheduled objects of an update are split into shards by the level of their game vertex
+// (crowded levels into several regions), the shards are searched by the task workers, each with its own A* storage;
+// the search reads nothing but the game graph and writes nothing but the path of its object,
+// everything else the brains do (smart terrains, scripts, registries) stays in the serial update,
+// which runs afterwards in the object id order and finds its paths actual
+class CALifeOfflinePathPlanner {
+public:
+	typedef xr_vector<CSE_ALifeSchedulable*>			OBJECTS;
+
+	struct CQuery {
+		GameGraph::_GRAPH_ID			m_start_vertex_id;
+		GameGraph::_GRAPH_ID			m_dest_vertex_id;
+		const GameGraph::TERRAIN_VECTOR	*m_terrain;
+	};
+
+	typedef xr_vector<CQuery>							QUERIES;
+
+private:
+	struct CRequest {
+		CALifeMonsterDetailPathManager	*m_manager;
+		GameGraph::_GRAPH_ID			m_start_vertex_id;
+		GameGraph::_GRAPH_ID			m_dest_vertex_id;
+		const GameGraph::TERRAIN_VECTOR	*m_terrain;
+		u32								m_level_id;
+		xr_vector<u32>					m_path;
+	};
+
+	struct CShard {
+		u32								m_begin;
+		u32								m_end;
+	};
+
+	struct CSearchContext {
+		CALifeOfflinePathPlanner		*m_owner;
+		CGraphEngine::CAlgorithm		*m_algorithm;
+
+		void							process				();
+	};
+
+	typedef xr_vector<CRequest>							REQUESTS;
+	typedef xr_vector<CShard>							SHARDS;
+	typedef xr_vector<CSearchContext*>					CONTEXTS;
+
+private:
+	enum {
+		max_search_context_count		= 8,
+	};
+
+private:
+	REQUESTS							m_requests;
+	SHARDS								m_shards;
+	CONTEXTS							m_contexts;
+	task_group							m_group;
+	volatile LONG						m_next_shard;
+	u32									m_planned_count;
+
+private:
+	static	bool						request_predicate	(const CRequest &_1, const CRequest &_2);
+	static	bool						shard_predicate		(const CShard &_1, const CShard &_2);
+			void						create_contexts		();
+			void						search				(CGraphEngine::CAlgorithm &algorithm, CRequest &request) const;
+			void						search_requests		();
+
+public:
+										CALifeOfflinePathPlanner	();
+										~CALifeOfflinePathPlanner	();
+	// searches the paths the objects are going to need in their next update
+			void						plan				(const OBJECTS &objects);
+	IC		u32							planned_count		() const	{ return m_planned_count; }
+	// searches the paths the same way, but hands them to nobody; returns the number of the paths found
+			u32							search				(const QUERIES &queries);
+
+public:
+	// the movement of the monsters and the groups, 0 for the rest
+	static	CALifeMonsterMovementManager*	movement		(CSE_ALifeSchedulable *schedulable);
+};
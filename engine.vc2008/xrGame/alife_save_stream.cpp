@@ -0,0 +1,343 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: alife_save_stream.cpp
+//	Created 	: 16.10.2026
+//  Modified 	: 16.10.2026
+//	Description : ALife saved game stream, cut into independently compressed blocks
+////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "alife_save_stream.h"
+
+CALifeSaveCache::~CALifeSaveCache	()
+{
+	clear							();
+}
+
+void CALifeSaveCache::clear			()
+{
+	BLOCKS::iterator				I = m_blocks.begin();
+	BLOCKS::iterator				E = m_blocks.end();
+	for ( ; I != E; ++I)
+		xr_free						((*I).second.m_data);
+
+	m_blocks.clear					();
+}
+
+u32 CALifeSaveCache::memory_usage	() const
+{
+	u32								result = 0;
+	BLOCKS::const_iterator			I = m_blocks.begin();
+	BLOCKS::const_iterator			E = m_blocks.end();
+	for ( ; I != E; ++I)
+		result						+= (*I).second.m_compressed_size;
+	return							(result);
+}
+
+void CALifeSaveWriter::CBlock::compress	()
+{
+	if (m_cached_data) {
+		// the same crc and size, but the contents are reused only when they are the same indeed
+		u8							*cached = (u8*)xr_malloc(m_size);
+		m_owner->account			(m_size);
+		u32							size = rtc_decompress(cached,m_size,m_cached_data,m_cached_compressed_size);
+		bool						same = (size == m_size) && !memcmp(cached,m_source.pointer(),m_size);
+		xr_free						(cached);
+		m_owner->account			(-LONG(m_size));
+
+		if (same) {
+			m_reused				= true;
+			m_data					= (u8*)m_cached_data;
+			m_compressed_size		= m_cached_compressed_size;
+			m_source.free			();
+			m_owner->account		(-LONG(m_size));
+			InterlockedExchange		(&m_done,1);
+			return;
+		}
+	}
+
+	m_capacity						= rtc_csize(m_size);
+	m_data							= (u8*)xr_malloc(m_capacity);
+	m_owner->account				(m_capacity);
+	m_compressed_size				= rtc_compress(m_data,m_capacity,m_source.pointer(),m_size);
+
+	m_source.free					();
+	m_owner->account				(-LONG(m_size));
+	InterlockedExchange				(&m_done,1);
+}
+
+CALifeSaveWriter::CALifeSaveWriter	(IWriter &file, CALifeSaveCache *cache) :
+	m_file							(file),
+	m_cache							(cache),
+	m_written						(0),
+	m_memory						(0),
+	m_peak_memory					(0)
+{
+	ZeroMemory						(&m_statistics,sizeof(m_statistics));
+
+	m_file.w_u32					(u32(-1));
+	m_file.w_u32					(ALIFE_CHUNKED_VERSION);
+
+	// stream size and block count are known at the end only
+	m_header_position				= m_file.tell();
+	m_file.w_u32					(0);
+	m_file.w_u32					(0);
+}
+
+CALifeSaveWriter::~CALifeSaveWriter	()
+{
+	TaskScheduler.wait				(m_tasks);
+
+	BLOCKS::iterator				I = m_blocks.begin();
+	BLOCKS::iterator				E = m_blocks.end();
+	for ( ; I != E; ++I) {
+		if (!(*I)->m_reused)
+			xr_free					((*I)->m_data);
+		xr_delete					(*I);
+	}
+}
+
+void CALifeSaveWriter::account		(LONG delta)
+{
+	LONG							current = InterlockedExchangeAdd(&m_memory,delta) + delta;
+	for (;;) {
+		LONG						peak = m_peak_memory;
+		if (current <= peak)
+			return;
+
+		if (InterlockedCompareExchange(&m_peak_memory,current,peak) == peak)
+			return;
+	}
+}
+
+u32 CALifeSaveWriter::open			(u32 key)
+{
+	CBlock							*block = xr_new<CBlock>();
+	block->m_owner					= this;
+	block->m_key					= key;
+	block->m_size					= 0;
+	block->m_crc					= 0;
+	block->m_data					= 0;
+	block->m_capacity				= 0;
+	block->m_compressed_size		= 0;
+	block->m_cached_data			= 0;
+	block->m_cached_compressed_size	= 0;
+	block->m_position				= u32(-1);
+	block->m_closed					= false;
+	block->m_reserved				= false;
+	block->m_reused					= false;
+	block->m_done					= 0;
+	m_blocks.push_back				(block);
+	return							(m_blocks.size() - 1);
+}
+
+u32 CALifeSaveWriter::reserve		(u32 size)
+{
+	VERIFY							(size);
+	u32								index = open(u32(-1));
+	CBlock							&block = *m_blocks[index];
+	block.m_reserved				= true;
+	block.m_size					= size;
+	m_statistics.m_source_size		+= size;
+	flush							(false);
+	return							(index);
+}
+
+IWriter &CALifeSaveWriter::stream	(u32 block)
+{
+	VERIFY							(!m_blocks[block]->m_closed);
+	return							(m_blocks[block]->m_source);
+}
+
+void CALifeSaveWriter::close		(u32 index)
+{
+	CBlock							&block = *m_blocks[index];
+	VERIFY							(!block.m_closed);
+	block.m_closed					= true;
+
+	if (block.m_reserved) {
+		R_ASSERT					(block.m_source.size() == block.m_size);
+		block.m_done				= 1;
+		if (block.m_position == u32(-1)) {
+			flush					(false);
+			return;
+		}
+
+		u32							position = m_file.tell();
+		m_file.seek					(block.m_position);
+		m_file.w					(block.m_source.pointer(),block.m_size);
+		m_file.seek					(position);
+		block.m_source.free			();
+		return;
+	}
+
+	block.m_size					= block.m_source.size();
+	m_statistics.m_source_size		+= block.m_size;
+
+	if (!block.m_size) {
+		block.m_done				= 1;
+		flush						(false);
+		return;
+	}
+
+	account							(block.m_size);
+
+	if (m_cache) {
+		block.m_crc					= crc32(block.m_source.pointer(),block.m_size);
+
+		CALifeSaveCache::BLOCKS::const_iterator	I = m_cache->m_blocks.find(block.m_key);
+		if ((I != m_cache->m_blocks.end()) && ((*I).second.m_crc == block.m_crc) && ((*I).second.m_size == block.m_size)) {
+			block.m_cached_data		= (*I).second.m_data;
+			block.m_cached_compressed_size	= (*I).second.m_compressed_size;
+		}
+	}
+
+	TaskScheduler.push				(m_tasks,task_group::delegate_type(&block,&CBlock::compress));
+	flush							(false);
+}
+
+void CALifeSaveWriter::flush		(bool wait)
+{
+	for ( ; m_written < m_blocks.size(); ++m_written) {
+		CBlock						&block = *m_blocks[m_written];
+		if (block.m_reserved) {
+			m_file.w_u32			(block.m_size);
+			m_file.w_u32			(0);
+			m_statistics.m_compressed_size	+= 2*sizeof(u32) + block.m_size;
+			++m_statistics.m_block_count;
+			if (block.m_closed) {
+				m_file.w			(block.m_source.pointer(),block.m_size);
+				block.m_source.free	();
+				continue;
+			}
+
+			// patched in by close
+			block.m_position		= m_file.tell();
+			for (u32 i=0; i<block.m_size; ++i)
+				m_file.w_u8			(0);
+			continue;
+		}
+
+		if (!block.m_closed) {
+			VERIFY					(!wait);
+			return;
+		}
+
+		if (!block.m_done) {
+			if (!wait)
+				return;
+
+			while (!block.m_done)
+				if (!TaskScheduler.help())
+					Sleep			(0);
+		}
+
+		if (!block.m_size)
+			continue;
+
+		m_file.w_u32				(block.m_size);
+		m_file.w_u32				(block.m_compressed_size);
+		m_file.w					(block.m_data,block.m_compressed_size);
+		m_statistics.m_compressed_size	+= 2*sizeof(u32) + block.m_compressed_size;
+		++m_statistics.m_block_count;
+		if (block.m_reused)
+			++m_statistics.m_reused_count;
+
+		// the cache takes the data over at the end
+		if (block.m_reused || m_cache)
+			continue;
+
+		xr_free						(block.m_data);
+		account						(-LONG(block.m_capacity));
+	}
+}
+
+void CALifeSaveWriter::finish		(CALifeSaveStatistics &statistics)
+{
+#ifdef DEBUG
+	for (BLOCKS::const_iterator I = m_blocks.begin(); I != m_blocks.end(); ++I)
+		VERIFY						((*I)->m_closed);
+#endif // DEBUG
+	flush							(true);
+	TaskScheduler.wait				(m_tasks);
+
+	u32								position = m_file.tell();
+	m_file.seek						(m_header_position);
+	m_file.w_u32					(m_statistics.m_source_size);
+	m_file.w_u32					(m_statistics.m_block_count);
+	m_file.seek						(position);
+
+	if (m_cache) {
+		CALifeSaveCache::BLOCKS		blocks;
+		BLOCKS::iterator			I = m_blocks.begin();
+		BLOCKS::iterator			E = m_blocks.end();
+		for ( ; I != E; ++I) {
+			CBlock					&block = **I;
+			if (!block.m_size || block.m_reserved)
+				continue;
+
+			if (block.m_reused)
+				m_cache->m_blocks.erase	(block.m_key);
+
+			CALifeSaveCache::CBlock	&cached = blocks[block.m_key];
+			cached.m_crc			= block.m_crc;
+			cached.m_size			= block.m_size;
+			cached.m_data			= block.m_data;
+			cached.m_compressed_size= block.m_compressed_size;
+			block.m_data			= 0;
+			block.m_reused			= true;
+		}
+
+		// the blocks, which are not in the stream anymore
+		m_cache->clear				();
+		m_cache->m_blocks.swap		(blocks);
+	}
+
+	m_statistics.m_peak_memory		= u32(m_peak_memory);
+	statistics						= m_statistics;
+}
+
+void CALifeSaveReader::CBlock::decompress	()
+{
+	if (!m_compressed_size) {
+		CopyMemory					(m_destination,m_source,m_size);
+		return;
+	}
+
+	u32								size = rtc_decompress(m_destination,m_size,m_source,m_compressed_size);
+	R_ASSERT2						(size == m_size,"Saved game is corrupted");
+}
+
+void *CALifeSaveReader::decompress	(IReader &file, u32 &size)
+{
+	file.seek						(sizeof(u32));
+	u32								version = file.r_u32();
+	size							= file.r_u32();
+	u8								*result = (u8*)xr_malloc(size);
+
+	if (version < ALIFE_CHUNKED_VERSION) {
+		rtc_decompress				(result,size,file.pointer(),file.length() - 3*sizeof(u32));
+		return						(result);
+	}
+
+	xr_vector<CBlock>				blocks(file.r_u32());
+	u32								offset = 0;
+	xr_vector<CBlock>::iterator		I = blocks.begin();
+	xr_vector<CBlock>::iterator		E = blocks.end();
+	for ( ; I != E; ++I) {
+		(*I).m_size					= file.r_u32();
+		(*I).m_compressed_size		= file.r_u32();
+		(*I).m_source				= file.pointer();
+		file.advance				((*I).m_compressed_size ? (*I).m_compressed_size : (*I).m_size);
+		(*I).m_destination			= result + offset;
+		offset						+= (*I).m_size;
+		R_ASSERT2					(offset <= size,"Saved game is corrupted");
+	}
+	R_ASSERT2						(offset == size,"Saved game is corrupted");
+
+	task_group						tasks;
+	for (I = blocks.begin(); I != E; ++I)
+		TaskScheduler.push			(tasks,task_group::delegate_type(&*I,&CBlock::decompress));
+	TaskScheduler.wait				(tasks);
+
+	return							(result);
+}
@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: alife_save_stream.h
+//	Created 	: 16.10.2026
+//  Modified 	: 16.10.2026
+//	Description : ALife saved game stream, cut into independently compressed blocks
+////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../xrCore/task_scheduler.h"
+
+// file : u32(-1), ALIFE_CHUNKED_VERSION, u32 stream size, u32 block count, block count * { u32 size, u32 compressed size, data }
+// compressed size 0 : the block is stored as is, size bytes
+// the decompressed blocks put together are exactly the stream the monolithic saves compress as a whole,
+// so the registries load it the same way
+
+struct CALifeSaveStatistics {
+	u32						m_source_size;
+	u32						m_compressed_size;
+	u32						m_block_count;
+	u32						m_reused_count;
+	u32						m_peak_memory;		// serialized and compressed data alive at once
+};
+
+// compressed blocks of the last save by their keys, reused while their contents stay the same :
+// the crc picks the candidate, the decompressed candidate is compared to the new contents
+class CALifeSaveCache {
+private:
+	friend class CALifeSaveWriter;
+
+private:
+	struct CBlock {
+		u32					m_crc;
+		u32					m_size;
+		u8					*m_data;
+		u32					m_compressed_size;
+	};
+
+	typedef xr_map<u32,CBlock>	BLOCKS;
+
+private:
+	BLOCKS					m_blocks;
+
+public:
+							~CALifeSaveCache	();
+			void			clear				();
+			u32				memory_usage		() const;
+};
+
+// blocks are serialized on the calling thread in the stream order, compressed by the task workers
+// and written to the file as soon as all the blocks before them are written
+class CALifeSaveWriter {
+private:
+	struct CBlock {
+		CALifeSaveWriter	*m_owner;
+		u32					m_key;
+		CMemoryWriter		m_source;
+		u32					m_size;
+		u32					m_crc;
+		u8					*m_data;
+		u32					m_capacity;
+		u32					m_compressed_size;
+		const u8			*m_cached_data;
+		u32					m_cached_compressed_size;
+		u32					m_position;			// of the data of the reserved block in the file
+		bool				m_closed;
+		bool				m_reserved;
+		bool				m_reused;
+		volatile LONG		m_done;
+
+				void		compress			();
+	};
+
+	typedef xr_vector<CBlock*>	BLOCKS;
+
+private:
+	IWriter					&m_file;
+	CALifeSaveCache			*m_cache;
+	BLOCKS					m_blocks;
+	u32						m_written;
+	u32						m_header_position;
+	task_group				m_tasks;
+	volatile LONG			m_memory;
+	volatile LONG			m_peak_memory;
+	CALifeSaveStatistics	m_statistics;
+
+private:
+			void			account				(LONG delta);
+			void			flush				(bool wait);
+
+public:
+							CALifeSaveWriter	(IWriter &file, CALifeSaveCache *cache);
+							~CALifeSaveWriter	();
+	// appends a block to the stream, it may be filled and closed later than the blocks after it
+			u32				open				(u32 key);
+	// appends a block of the given size, which is stored as is : the file space is taken at once,
+	// so the blocks after it are written while it is open, it is patched in when closed
+			u32				reserve				(u32 size);
+			IWriter			&stream				(u32 block);
+			void			close				(u32 block);
+			void			finish				(CALifeSaveStatistics &statistics);
+};
+
+class CALifeSaveReader {
+private:
+	struct CBlock {
+		const void			*m_source;
+		u32					m_compressed_size;
+		void				*m_destination;
+		u32					m_size;
+
+				void		decompress			();
+	};
+
+public:
+	// the stream of the valid saved game of any version, to be freed with xr_free
+	static	void			*decompress			(IReader &file, u32 &size);
+};
@@ -8,9 +8,11 @@
 
 #include "stdafx.h"
 #include "alife_schedule_registry.h"
+#include "alife_offline_path_planner.h"
 
 CALifeScheduleRegistry::~CALifeScheduleRegistry	()
 {
+	xr_delete					(m_planner);
 }
 
 void CALifeScheduleRegistry::add		(CSE_ALifeDynamicObject *object)
@@ -34,3 +36,44 @@ void CALifeScheduleRegistry::remove	(CSE_ALifeDynamicObject *object, bool no_ass
 	inherited::remove			(object->ID,no_assert || !schedulable->need_update(object));
 }
 
+void CALifeScheduleRegistry::update		()
+{
+	m_updated_count				= 0;
+	if (objects().empty())
+		return;
+
+	m_objects.clear_not_free	();
+	m_ids.clear_not_free		();
+	inherited::update			(CUpdatePredicate(m_objects_per_update,m_objects,m_ids), false);
+
+	// the only part of the brains, which touches nothing shared, is the game graph search
+	if (m_plan_paths && (m_objects.size() > 1) && TaskScheduler.worker_count()) {
+		START_PROFILE("ALife/scheduled/plan")
+		if (!m_planner)
+			m_planner			= xr_new<CALifeOfflinePathPlanner>();
+		m_planner->plan			(m_objects);
+		STOP_PROFILE
+	}
+
+	// an update may unregister (and even destroy) the objects picked after it
+	for (u32 i=0, n=m_ids.size(); i<n; ++i) {
+		_const_iterator			J = objects().find(m_ids[i]);
+		if ((J == objects().end()) || ((*J).second != m_objects[i]))
+			continue;
+
+		START_PROFILE("ALife/scheduled/update")
+		m_objects[i]->update	();
+		STOP_PROFILE
+		++m_updated_count;
+	}
+#ifdef DEBUG
+	if (psAI_Flags.test(aiALife)) {
+//		Msg						("[LSS][SU][%d : %d]",m_updated_count, objects().size());
+	}
+#endif
+}
+
+u32 CALifeScheduleRegistry::planned_count	() const
+{
+	return						(m_planner ? m_planner->planned_count() : 0);
+}
@@ -13,16 +13,26 @@
 #include "ai_debug.h"
 #include "profiler.h"
 
+class CALifeOfflinePathPlanner;
+
 class CALifeScheduleRegistry : public CSafeMapIterator<ALife::_OBJECT_ID,CSE_ALifeSchedulable,std::less<ALife::_OBJECT_ID>,false> {
 private:
+	typedef xr_vector<CSE_ALifeSchedulable*>	OBJECTS;
+	typedef xr_vector<ALife::_OBJECT_ID>		IDS;
+
+	// picks the objects of the update, they are updated after the iteration
 	struct CUpdatePredicate {
 		u32								m_count;
 		mutable u32						m_current;
+		OBJECTS							*m_objects;
+		IDS								*m_ids;
 
-		IC			CUpdatePredicate	(const u32 &count)
+		IC			CUpdatePredicate	(const u32 &count, OBJECTS &objects, IDS &ids)
 		{
 			m_count						= count;
 			m_current					= 0;
+			m_objects					= &objects;
+			m_ids						= &ids;
 		}
 
 		IC	bool	operator()			(_iterator &i, u64 cycle_count, bool) const
@@ -41,9 +51,8 @@ private:
 
 		IC	void	operator()			(_iterator &i, u64 cycle_count) const
 		{
-			START_PROFILE("ALife/scheduled/update")
-			(*i).second->update			();
-			STOP_PROFILE
+			m_objects->push_back		((*i).second);
+			m_ids->push_back			((*i).first);
 		}
 	};
 
@@ -51,17 +60,29 @@ protected:
 	typedef CSafeMapIterator<ALife::_OBJECT_ID,CSE_ALifeSchedulable,std::less<ALife::_OBJECT_ID>,false> inherited;
 
 protected:
-	u32		m_objects_per_update;
+	u32							m_objects_per_update;
+	OBJECTS						m_objects;
+	IDS							m_ids;
+	CALifeOfflinePathPlanner	*m_planner;
+	bool						m_plan_paths;
+	u32							m_updated_count;
 
 public:
 	IC								CALifeScheduleRegistry	();
 	virtual							~CALifeScheduleRegistry	();
 			void					add						(CSE_ALifeDynamicObject *object);
 			void					remove					(CSE_ALifeDynamicObject *object, bool no_assert = false);
-	IC		void					update					();
+			void					update					();
 	IC		CSE_ALifeSchedulable	*object					(const ALife::_OBJECT_ID &id, bool no_assert = false) const;
 	IC		const u32				&objects_per_update		() const;
 	IC		void					objects_per_update		(const u32 &objects_per_update);
+	// game graph paths of the picked objects are searched in parallel before they are updated
+	IC		bool					plan_paths				() const;
+	IC		void					plan_paths				(bool value);
+	// objects updated by the last update
+	IC		u32						updated_count			() const;
+	// paths searched ahead by the last update
+			u32						planned_count			() const;
 };
 
 #include "alife_schedule_registry_inline.h"
\ No newline at end of file
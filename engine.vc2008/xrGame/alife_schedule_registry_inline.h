@@ -11,6 +11,9 @@
 IC	CALifeScheduleRegistry::CALifeScheduleRegistry			()
 {
 	m_objects_per_update		= 1;
+	m_planner					= 0;
+	m_plan_paths				= true;
+	m_updated_count				= 0;
 }
 
 IC	const u32 &CALifeScheduleRegistry::objects_per_update	() const
@@ -23,15 +26,19 @@ IC	void CALifeScheduleRegistry::objects_per_update			(const u32 &objects_per_upd
 	m_objects_per_update		= objects_per_update;
 }
 
-IC	void CALifeScheduleRegistry::update						()
+IC	bool CALifeScheduleRegistry::plan_paths					() const
 {
-//	u32							count = 
-		objects().empty() ? 0 : inherited::update( CUpdatePredicate(m_objects_per_update), false );
-#ifdef DEBUG
-	if (psAI_Flags.test(aiALife)) {
-//		Msg						("[LSS][SU][%d : %d]",count, objects().size());
-	}
-#endif
+	return						(m_plan_paths);
+}
+
+IC	void CALifeScheduleRegistry::plan_paths					(bool value)
+{
+	m_plan_paths				= value;
+}
+
+IC	u32 CALifeScheduleRegistry::updated_count				() const
+{
+	return						(m_updated_count);
 }
 
 IC	CSE_ALifeSchedulable *CALifeScheduleRegistry::object	(const ALife::_OBJECT_ID &id, bool no_assert) const
@@ -72,7 +72,7 @@ void CALifeSpawnRegistry::load				(IReader &file_stream, LPCSTR game_name)
 	R_ASSERT3					(file_exists,"Can't find spawn file:",*m_spawn_name);
 	
 	VERIFY						(!m_file);
-	m_file						= FS.r_open(file_name);
+	m_file						= FS.r_open_mapped(file_name);
 	load						(*m_file,&guid);
 
 	chunk0->close				();
@@ -86,7 +86,7 @@ void CALifeSpawnRegistry::load				(LPCSTR spawn_name)
 	R_ASSERT3					(FS.exist(file_name, "$game_spawn$", *m_spawn_name, ".spawn"),"Can't find spawn file:",*m_spawn_name);
 	
 	VERIFY						(!m_file);
-	m_file						= FS.r_open(file_name);
+	m_file						= FS.r_open_mapped(file_name);
 	load						(*m_file);
 }
 
@@ -22,9 +22,13 @@
 #include "string_table.h"
 #include "../xrEngine/igame_persistent.h"
 #include "autosave_manager.h"
+#include "alife_save_stream.h"
 
 XRCORE_API string_path g_bug_report_file;
 
+BOOL	g_alife_save_chunked		= TRUE;
+BOOL	g_alife_save_incremental	= TRUE;
+
 using namespace ALife;
 
 extern string_path g_last_saved_game;
@@ -32,6 +36,81 @@ extern string_path g_last_saved_game;
 CALifeStorageManager::~CALifeStorageManager	()
 {
 	*g_last_saved_game			= 0;
+	xr_delete					(m_save_cache);
+}
+
+void CALifeStorageManager::save	(IWriter &file, bool chunked, CALifeSaveCache *cache, CALifeSaveStatistics &statistics)
+{
+	if (!chunked) {
+		CMemoryWriter			stream;
+		header().save			(stream);
+		time_manager().save		(stream);
+		spawns().save			(stream);
+		objects().save			(stream);
+		registry().save			(stream);
+
+		u32						source_count = stream.tell();
+		void					*source_data = stream.pointer();
+		u32						dest_count = rtc_csize(source_count);
+		void					*dest_data = xr_malloc(dest_count);
+		statistics.m_peak_memory= source_count + dest_count;
+		dest_count				= rtc_compress(dest_data,dest_count,source_data,source_count);
+
+		file.w_u32				(u32(-1));
+		file.w_u32				(ALIFE_VERSION);
+		file.w_u32				(source_count);
+		file.w					(dest_data,dest_count);
+		xr_free					(dest_data);
+
+		statistics.m_source_size		= source_count;
+		statistics.m_compressed_size	= dest_count + sizeof(u32);
+		statistics.m_block_count		= 1;
+		statistics.m_reused_count		= 0;
+		return;
+	}
+
+	// the same stream, cut into the blocks, which are compressed while the next ones are serialized
+	CALifeSaveWriter			writer(file,cache);
+
+	u32							block = writer.open(0);
+	header().save				(writer.stream(block));
+	time_manager().save			(writer.stream(block));
+	spawns().save				(writer.stream(block));
+	writer.close				(block);
+
+	// the chunk header goes before the objects, but is known after them only :
+	// its place is reserved, the object blocks are written to the file meanwhile
+	Msg							("* Saving objects...");
+	u32							objects_header = writer.reserve(3*sizeof(u32));
+	u32							objects_size = sizeof(u32);
+	u32							object_count = 0;
+
+	// by the id ranges, so an object added or removed changes one block only
+	const u32					range_size = 256;
+	CALifeObjectRegistry::OBJECT_REGISTRY::const_iterator	I = objects().objects().begin();
+	CALifeObjectRegistry::OBJECT_REGISTRY::const_iterator	E = objects().objects().end();
+	while (I != E) {
+		u32						range = u32((*I).first)/range_size;
+		ALife::_OBJECT_ID		last = ALife::_OBJECT_ID((range + 1)*range_size - 1);
+		block					= writer.open(0x100 + range);
+		objects().save			(writer.stream(block),ALife::_OBJECT_ID(range*range_size),last,object_count);
+		objects_size			+= writer.stream(block).tell();
+		writer.close			(block);
+		I						= objects().objects().upper_bound(last);
+	}
+
+	IWriter						&head = writer.stream(objects_header);
+	head.w_u32					(OBJECT_CHUNK_DATA);
+	head.w_u32					(objects_size);
+	head.w_u32					(object_count);
+	writer.close				(objects_header);
+	Msg							("* %d objects are successfully saved",object_count);
+
+	block						= writer.open(2);
+	registry().save				(writer.stream(block));
+	writer.close				(block);
+
+	writer.finish				(statistics);
 }
 
 void CALifeStorageManager::save	(LPCSTR save_name_no_check, bool update_name)
@@ -56,36 +135,21 @@ void CALifeStorageManager::save	(LPCSTR save_name_no_check, bool update_name)
 		}
 	}
 
-	u32							source_count;
-	u32							dest_count;
-	void						*dest_data;
-	{
-		CMemoryWriter			stream;
-		header().save			(stream);
-		time_manager().save		(stream);
-		spawns().save			(stream);
-		objects().save			(stream);
-		registry().save			(stream);
-
-		source_count			= stream.tell();
-		void					*source_data = stream.pointer();
-		dest_count				= rtc_csize(source_count);
-		dest_data				= xr_malloc(dest_count);
-		dest_count				= rtc_compress(dest_data,dest_count,source_data,source_count);
+	if (g_alife_save_chunked && g_alife_save_incremental) {
+		if (!m_save_cache)
+			m_save_cache		= xr_new<CALifeSaveCache>();
 	}
+	else
+		xr_delete				(m_save_cache);
 
 	string_path					temp;
 	FS.update_path				(temp,"$game_saves$",m_save_name);
 	IWriter						*writer = FS.w_open(temp);
-	writer->w_u32				(u32(-1));
-	writer->w_u32				(ALIFE_VERSION);
-	
-	writer->w_u32				(source_count);
-	writer->w					(dest_data,dest_count);
-	xr_free						(dest_data);
+	CALifeSaveStatistics		statistics;
+	save						(*writer,!!g_alife_save_chunked,m_save_cache,statistics);
 	FS.w_close					(writer);
 #ifdef DEBUG
-	Msg							("* Game %s is successfully saved to file '%s' (%d bytes compressed to %d)",m_save_name,temp,source_count,dest_count + 4);
+	Msg							("* Game %s is successfully saved to file '%s' (%d bytes compressed to %d, %d of %d block(s) reused)",m_save_name,temp,statistics.m_source_size,statistics.m_compressed_size,statistics.m_reused_count,statistics.m_block_count);
 #else // DEBUG
 	Msg							("* Game %s is successfully saved to file '%s'",m_save_name,temp);
 #endif // DEBUG
@@ -173,9 +237,8 @@ bool CALifeStorageManager::load	(LPCSTR save_name_no_check)
 	unload						();
 	reload						(m_section);
 
-	u32							source_count = stream->r_u32();
-	void						*source_data = xr_malloc(source_count);
-	rtc_decompress				(source_data,source_count,stream->pointer(),stream->length() - 3*sizeof(u32));
+	u32							source_count;
+	void						*source_data = CALifeSaveReader::decompress(*stream,source_count);
 	FS.r_close					(stream);
 	load						(source_data, source_count, file_name);
 	xr_free						(source_data);
@@ -198,6 +261,60 @@ void CALifeStorageManager::save	(NET_Packet &net_packet)
 	save						(*game_name,!!net_packet.r_u8());
 }
 
+void CALifeStorageManager::save_benchmark	(u32 iteration_count)
+{
+	prepare_objects_for_save	();
+
+	Msg							("* ALife save benchmark: %d object(s), %d iteration(s), %d task worker(s)",objects().objects().size(),iteration_count,TaskScheduler.worker_count());
+
+	LPCSTR						names[] = {"monolithic", "chunked", "incremental"};
+	CALifeSaveCache				cache;
+	void						*reference = 0;
+	u32							reference_size = 0;
+	for (u32 mode=0; mode<3; ++mode) {
+		string_path				file_name, temp;
+		strconcat				(sizeof(temp),temp,"save_benchmark.",names[mode]);
+		FS.update_path			(file_name,"$game_saves$",temp);
+
+		float					save_time = 0.f, load_time = 0.f;
+		CALifeSaveStatistics	statistics;
+		u32						peak_memory = 0;
+		CTimer					timer;
+		for (u32 i=0; i<iteration_count; ++i) {
+			timer.Start			();
+			IWriter				*writer = FS.w_open(file_name);
+			save				(*writer,mode != 0,(mode == 2) ? &cache : 0,statistics);
+			FS.w_close			(writer);
+			save_time			+= timer.GetElapsed_sec();
+			peak_memory			= _max(peak_memory,statistics.m_peak_memory);
+
+			timer.Start			();
+			IReader				*reader = FS.r_open(file_name);
+			R_ASSERT			(reader && CSavedGameWrapper::valid_saved_game(*reader));
+			u32					source_count;
+			void				*source_data = CALifeSaveReader::decompress(*reader,source_count);
+			FS.r_close			(reader);
+			load_time			+= timer.GetElapsed_sec();
+
+			if (!reference) {
+				reference		= source_data;
+				reference_size	= source_count;
+				continue;
+			}
+
+			if ((source_count != reference_size) || memcmp(source_data,reference,source_count))
+				Msg				("! ALife save benchmark: %s stream differs from the monolithic one",names[mode]);
+			xr_free				(source_data);
+		}
+		FS.file_delete			(file_name);
+
+		Msg						("*   %-11s : save %8.3f ms, read %8.3f ms, peak %6d KB, %d bytes compressed to %d in %d block(s), %d reused by the last save",names[mode],1000.f*save_time/float(iteration_count),1000.f*load_time/float(iteration_count),peak_memory/1024,statistics.m_source_size,statistics.m_compressed_size,statistics.m_block_count,statistics.m_reused_count);
+	}
+	Msg							("*   the incremental cache holds %d KB between the saves",cache.memory_usage()/1024);
+
+	xr_free						(reference);
+}
+
 void CALifeStorageManager::prepare_objects_for_save	()
 {
 	Level().ClientSend			();
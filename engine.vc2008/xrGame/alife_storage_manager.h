@@ -11,6 +11,8 @@
 #include "alife_simulator_base.h"
 
 class NET_Packet;
+class CALifeSaveCache;
+struct CALifeSaveStatistics;
 
 class CALifeStorageManager : public virtual CALifeSimulatorBase {
 	friend class CALifeUpdatePredicate;
@@ -20,10 +22,12 @@ protected:
 protected:
 	string_path		m_save_name;
 	LPCSTR			m_section;
+	CALifeSaveCache	*m_save_cache;
 
 private:
 			void	prepare_objects_for_save();
 			void	load					(void *buffer, const u32 &buffer_size, LPCSTR file_name);
+			void	save					(IWriter &file, bool chunked, CALifeSaveCache *cache, CALifeSaveStatistics &statistics);
 
 public:
 	IC				CALifeStorageManager	(xrServer *server, LPCSTR section);
@@ -31,6 +35,9 @@ public:
 			bool	load					(LPCSTR	save_name = 0);
 			void	save					(LPCSTR	save_name = 0, bool update_name = true);
 			void	save					(NET_Packet &net_packet);
+	// saves the game into temporary files over and over in the monolithic, chunked and incremental chunked formats,
+	// reads them back (without loading) and compares the streams
+			void	save_benchmark			(u32 iteration_count);
 };
 
 #include "alife_storage_manager_inline.h"
\ No newline at end of file
@@ -12,5 +12,6 @@ IC	CALifeStorageManager::CALifeStorageManager			(xrServer *server, LPCSTR sectio
 	inherited	(server,section)
 {
 	m_section				= section;
+	m_save_cache			= 0;
 	xr_strcpy					(m_save_name,"");
 }
@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: alife_switch_grid.cpp
+//	Created 	: 16.10.2026
+//  Modified 	: 16.10.2026
+//	Description : Uniform grid over the positions of the current level objects for the switch pass
+////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "alife_switch_grid.h"
+#include "xrServer_Objects_ALife.h"
+
+CALifeSwitchGrid::CALifeSwitchGrid	()
+{
+	m_count					= 0;
+}
+
+u32 CALifeSwitchGrid::cell			(int x, int z)
+{
+	return					((u32(x) & 0xffff) | (u32(z) << 16));
+}
+
+u32 CALifeSwitchGrid::cell			(const Fvector &position)
+{
+	return					(cell(iFloor(position.x/float(cell_size)),iFloor(position.z/float(cell_size))));
+}
+
+bool CALifeSwitchGrid::always		(CSE_ALifeDynamicObject *object)
+{
+	// an offline object, which can't stay offline, is switched online wherever it is
+	return					(object->m_bOnline || (!object->can_switch_offline() && object->can_switch_online()));
+}
+
+void CALifeSwitchGrid::insert		(CSE_ALifeDynamicObject *object, CLocation &location)
+{
+	location.m_always		= always(object);
+	OBJECTS					&objects = location.m_always ? m_always : m_cells[location.m_cell = cell(object->o_Position)];
+	location.m_index		= objects.size();
+	objects.push_back		(object);
+}
+
+void CALifeSwitchGrid::erase		(CSE_ALifeDynamicObject *object, CLocation &location)
+{
+	OBJECTS					&objects = location.m_always ? m_always : m_cells[location.m_cell];
+	VERIFY					(objects[location.m_index] == object);
+
+	// the last one takes the place of the removed one
+	CSE_ALifeDynamicObject	*last = objects.back();
+	objects[location.m_index]	= last;
+	m_locations[last->ID].m_index	= location.m_index;
+	objects.pop_back		();
+}
+
+void CALifeSwitchGrid::add			(CSE_ALifeDynamicObject *object)
+{
+	if (object->ID >= m_locations.size()) {
+		CLocation			location;
+		location.m_tracked	= false;
+		m_locations.resize	(object->ID + 1,location);
+	}
+
+	CLocation				&location = m_locations[object->ID];
+	if (location.m_tracked) {
+		move				(object);
+		return;
+	}
+
+	location.m_tracked		= true;
+	insert					(object,location);
+	++m_count;
+}
+
+void CALifeSwitchGrid::remove		(CSE_ALifeDynamicObject *object)
+{
+	if (object->ID >= m_locations.size())
+		return;
+
+	CLocation				&location = m_locations[object->ID];
+	if (!location.m_tracked)
+		return;
+
+	erase					(object,location);
+	location.m_tracked		= false;
+	--m_count;
+}
+
+void CALifeSwitchGrid::move			(CSE_ALifeDynamicObject *object)
+{
+	if (object->ID >= m_locations.size())
+		return;
+
+	CLocation				&location = m_locations[object->ID];
+	if (!location.m_tracked)
+		return;
+
+	if (always(object) == location.m_always) {
+		if (location.m_always)
+			return;
+
+		if (cell(object->o_Position) == location.m_cell)
+			return;
+	}
+
+	erase					(object,location);
+	insert					(object,location);
+}
+
+void CALifeSwitchGrid::select		(const Fvector &center, float radius, OBJECTS &result) const
+{
+	result.insert			(result.end(),m_always.begin(),m_always.end());
+
+	// one more cell around for the objects, which have moved since their last rebucketing
+	int						x0 = iFloor((center.x - radius)/float(cell_size)) - 1;
+	int						x1 = iFloor((center.x + radius)/float(cell_size)) + 1;
+	int						z0 = iFloor((center.z - radius)/float(cell_size)) - 1;
+	int						z1 = iFloor((center.z + radius)/float(cell_size)) + 1;
+	for (int x=x0; x<=x1; ++x) {
+		for (int z=z0; z<=z1; ++z) {
+			CELLS::const_iterator	I = m_cells.find(cell(x,z));
+			if (I == m_cells.end())
+				continue;
+
+			OBJECTS::const_iterator	i = (*I).second.begin();
+			OBJECTS::const_iterator	e = (*I).second.end();
+			for ( ; i != e; ++i)
+				if (center.distance_to((*i)->o_Position) <= radius)
+					result.push_back(*i);
+		}
+	}
+}
@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: alife_switch_grid.h
+//	Created 	: 16.10.2026
+//  Modified 	: 16.10.2026
+//	Description : Uniform grid over the positions of the current level objects for the switch pass
+////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+class CSE_ALifeDynamicObject;
+
+// offline objects, which may be switched online by the distance to the actor, are bucketed
+// by their level position, so the switch pass visits only the cells around the actor;
+// every other object (online ones, the ones forced online) is kept in a list visited every pass.
+// positions change in many places, the buckets follow them through move,
+// an object found in a neighbour cell of its real one is still selected
+class CALifeSwitchGrid {
+public:
+	typedef xr_vector<CSE_ALifeDynamicObject*>	OBJECTS;
+
+public:
+	enum {
+		cell_size				= 64,
+	};
+
+private:
+	struct CLocation {
+		u32						m_cell;
+		u32						m_index;
+		bool					m_tracked;
+		bool					m_always;
+	};
+
+	typedef xr_map<u32,OBJECTS>					CELLS;
+	typedef xr_vector<CLocation>				LOCATIONS;
+
+private:
+	CELLS						m_cells;
+	OBJECTS						m_always;
+	LOCATIONS					m_locations;
+	u32							m_count;
+
+private:
+	static	u32					cell			(int x, int z);
+	static	u32					cell			(const Fvector &position);
+	static	bool				always			(CSE_ALifeDynamicObject *object);
+			void				insert			(CSE_ALifeDynamicObject *object, CLocation &location);
+			void				erase			(CSE_ALifeDynamicObject *object, CLocation &location);
+
+public:
+								CALifeSwitchGrid();
+			void				add				(CSE_ALifeDynamicObject *object);
+			void				remove			(CSE_ALifeDynamicObject *object);
+	// rebuckets the object by its current position and online state, ignores the objects not in the grid
+			void				move			(CSE_ALifeDynamicObject *object);
+	// appends the objects of the list and the bucketed ones not farther than radius from the center
+			void				select			(const Fvector &center, float radius, OBJECTS &result) const;
+	IC		u32					size			() const	{ return m_count; }
+	IC		u32					always_count	() const	{ return m_always.size(); }
+};
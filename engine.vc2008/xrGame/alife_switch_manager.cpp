@@ -240,6 +240,11 @@ void CALifeSwitchManager::switch_object	(CSE_ALifeDynamicObject	*I)
 	else
 		try_switch_online	(I);
 
-	if (I->redundant())
+	if (I->redundant()) {
 		release				(I);
+		return;
+	}
+
+	// the object may have been switched or moved by the location synchronization
+	graph().level().move	(I);
 }
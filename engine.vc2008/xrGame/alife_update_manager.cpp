@@ -22,6 +22,12 @@
 #include "restriction_space.h"
 #include "profiler.h"
 #include "mt_config.h"
+#include "../xrCore/task_scheduler.h"
+#include "alife_offline_path_planner.h"
+#include "alife_monster_movement_manager.h"
+#include "alife_monster_detail_path_manager.h"
+#include "movement_manager_space.h"
+#include "xrServer_Objects_ALife_Monsters.h"
 
 using namespace ALife;
 
@@ -30,11 +36,15 @@ extern string_path g_last_saved_game;
 class CSwitchPredicate {
 private:
 	CALifeSwitchManager *m_switch_manager;
+	u32					m_count;
+	mutable u32			m_current;
 
 public:
-	IC			CSwitchPredicate(CALifeSwitchManager *switch_manager)
+	IC			CSwitchPredicate(CALifeSwitchManager *switch_manager, u32 count)
 	{
 		m_switch_manager			= switch_manager;
+		m_count						= count;
+		m_current					= 0;
 	}
 
 	IC	bool	operator()		(CALifeLevelRegistry::_iterator &i, u64 cycle_count, bool) const
@@ -42,6 +52,10 @@ public:
 		if ((*i).second->m_switch_counter	== cycle_count)
 			return					(false);
 
+		if (m_current >= m_count)
+			return					(false);
+
+		++m_current;
 		(*i).second->m_switch_counter	= cycle_count;
 		return						(true);
 	}
@@ -65,6 +79,8 @@ CALifeUpdateManager::CALifeUpdateManager	(xrServer *server, LPCSTR section) :
 	m_max_process_time		= pSettings->r_s32	(section,"process_time");
 	m_update_monster_factor	= pSettings->r_float(section,"update_monster_factor");
 	m_objects_per_update	= pSettings->r_u32	(section,"objects_per_update");
+	m_switch_sweep_count	= READ_IF_EXISTS(pSettings,r_u32,section,"switch_sweep_count",64);
+	m_switch_near_start		= 0;
 	m_changing_level		= false;
 	m_first_time			= true;
 }
@@ -90,7 +106,42 @@ void CALifeUpdateManager::update_switch	()
 	init_ef_storage						();
 
 	START_PROFILE("ALife/switch");
-	graph().level().update				( CSwitchPredicate(this), Device.dwPrecacheFrame > 0 );
+	// the near pass and the sweep share the process time of the level registry
+	graph().level().start_timer			();
+
+	// everything, which may be switched by the distance to the actor, is near the actor
+	START_PROFILE("ALife/switch/near")
+	m_switch_objects.clear_not_free		();
+	m_switch_ids.clear_not_free			();
+	graph().level().grid().select		(graph().actor()->o_Position,online_distance(),m_switch_objects);
+	for (u32 i=0, n=m_switch_objects.size(); i<n; ++i)
+		m_switch_ids.push_back			(m_switch_objects[i]->ID);
+
+	// the pass cut by the time goes on from where it stopped next update
+	u32									count = m_switch_objects.size();
+	if (m_switch_near_start >= count)
+		m_switch_near_start				= 0;
+
+	for (u32 i=0; i<count; ++i) {
+		u32								index = (m_switch_near_start + i) % count;
+		if (graph().level().time_over()) {
+			m_switch_near_start			= index;
+			break;
+		}
+
+		// a switch may release (and even destroy) the objects selected after it
+		if (graph().level().object(m_switch_ids[index],true) != m_switch_objects[index])
+			continue;
+
+		switch_object					(m_switch_objects[index]);
+	}
+	STOP_PROFILE
+
+	// the rest of the level is walked round robin a few objects per update : 
+	// the objects forced to switch by scripts, the groups to release, the positions not followed
+	START_PROFILE("ALife/switch/sweep")
+	graph().level().update				( CSwitchPredicate(this,m_switch_sweep_count), Device.dwPrecacheFrame > 0, false );
+	STOP_PROFILE
 	STOP_PROFILE
 }
 
@@ -134,6 +185,162 @@ void CALifeUpdateManager::shedule_Update	(u32 dt)
 	STOP_PROFILE
 }
 
+void CALifeUpdateManager::soak_benchmark	(u32 update_count, u32 objects_per_update)
+{
+	typedef CALifeOfflinePathPlanner::QUERIES		QUERIES;
+	typedef GraphEngineSpace::CGameVertexParams		CGameVertexParams;
+
+	// the live game is not touched : the game paths of the scheduled objects are taken as they are now
+	// (an object, which has arrived, goes to a random vertex of its level), then the same queries
+	// in the same batches are searched serially, as the updates do, and by the planner
+	xr_vector<xr_vector<GameGraph::_GRAPH_ID> >	level_vertices;
+	for (GameGraph::_GRAPH_ID i=0, n=(GameGraph::_GRAPH_ID)ai().game_graph().header().vertex_count(); i<n; ++i) {
+		u32						level_id = ai().game_graph().vertex(i)->level_id();
+		if (level_vertices.size() <= level_id)
+			level_vertices.resize	(level_id + 1);
+		level_vertices[level_id].push_back	(i);
+	}
+
+	QUERIES						snapshot;
+	CRandom						random(0x5a17);
+	CALifeScheduleRegistry::_REGISTRY::const_iterator	I = scheduled().objects().begin();
+	CALifeScheduleRegistry::_REGISTRY::const_iterator	E = scheduled().objects().end();
+	for ( ; I != E; ++I) {
+		CALifeMonsterMovementManager	*manager = CALifeOfflinePathPlanner::movement((*I).second);
+		if (!manager || (manager->path_type() != MovementManager::ePathTypeGamePath))
+			continue;
+
+		CALifeMonsterDetailPathManager	&detail = manager->detail();
+		CALifeOfflinePathPlanner::CQuery	query;
+		query.m_start_vertex_id	= detail.object().get_object().m_tGraphID;
+		query.m_dest_vertex_id	= detail.destination_game_vertex_id();
+		query.m_terrain			= &detail.object().m_tpaTerrain;
+		if (query.m_dest_vertex_id == query.m_start_vertex_id) {
+			const xr_vector<GameGraph::_GRAPH_ID>	&vertices = level_vertices[ai().game_graph().vertex(query.m_start_vertex_id)->level_id()];
+			query.m_dest_vertex_id	= vertices[random.randI(vertices.size())];
+		}
+		snapshot.push_back		(query);
+	}
+
+	if (snapshot.empty()) {
+		Msg						("! ALife soak benchmark: no scheduled object moves along the game graph");
+		return;
+	}
+
+	// the batches of the updates go round the snapshot
+	xr_vector<QUERIES>			batches(update_count);
+	for (u32 i=0, j=0; i<update_count; ++i) {
+		batches[i].reserve		(objects_per_update);
+		for (u32 k=0; k<objects_per_update; ++k, j = (j + 1) % snapshot.size())
+			batches[i].push_back(snapshot[j]);
+	}
+
+	Msg							("* ALife soak benchmark: %d scheduled object(s), %d on game paths, %d update(s) of %d path(s), %d task worker(s)",scheduled().objects().size(),snapshot.size(),update_count,objects_per_update,TaskScheduler.worker_count());
+
+	xr_vector<u32>				path;
+	u32							serial_found = 0;
+	CTimer						timer;
+	timer.Start					();
+	xr_vector<QUERIES>::const_iterator	i = batches.begin();
+	xr_vector<QUERIES>::const_iterator	e = batches.end();
+	for ( ; i != e; ++i) {
+		QUERIES::const_iterator	J = (*i).begin();
+		QUERIES::const_iterator	K = (*i).end();
+		for ( ; J != K; ++J) {
+			CGameVertexParams	parameters(*(*J).m_terrain);
+			if (ai().graph_engine().search(ai().game_graph(),(*J).m_start_vertex_id,(*J).m_dest_vertex_id,&path,parameters))
+				++serial_found;
+		}
+	}
+	float						serial_time = timer.GetElapsed_sec();
+
+	CALifeOfflinePathPlanner	planner;
+	u32							planned_found = 0;
+	timer.Start					();
+	for (i = batches.begin(); i != e; ++i)
+		planned_found			+= planner.search(*i);
+	float						planned_time = timer.GetElapsed_sec();
+
+	float						path_count = float(update_count)*float(objects_per_update);
+	Msg							("*   serial  : %10.1f path(s)/s, %d found",serial_time > 0.f ? path_count/serial_time : 0.f,serial_found);
+	Msg							("*   planned : %10.1f path(s)/s, %d found",planned_time > 0.f ? path_count/planned_time : 0.f,planned_found);
+	if (serial_found != planned_found)
+		Msg						("! ALife soak benchmark: the serial search and the planner disagree");
+}
+
+static bool switch_needed					(CSE_ALifeDynamicObject *object, const Fvector &actor_position, float online_distance, float offline_distance)
+{
+	// the same decisions as try_switch_online/try_switch_offline make
+	if (0xffff != object->ID_Parent)
+		return					(false);
+
+	if (object->m_bOnline)
+		return					(object->can_switch_offline() && (!object->can_switch_online() || (actor_position.distance_to(object->o_Position) > offline_distance)));
+
+	return						(object->can_switch_online() && (!object->can_switch_offline() || (actor_position.distance_to(object->o_Position) <= online_distance)));
+}
+
+void CALifeUpdateManager::switch_benchmark	(u32 step_count)
+{
+	xr_vector<Fvector>			path;
+	for (GameGraph::_GRAPH_ID i=0, n=(GameGraph::_GRAPH_ID)ai().game_graph().header().vertex_count(); i<n; ++i)
+		if (ai().game_graph().vertex(i)->level_id() == graph().level().level_id())
+			path.push_back		(ai().game_graph().vertex(i)->level_point());
+
+	if (path.size() < 2) {
+		Msg						("! ALife switch benchmark: not enough game vertices on the current level");
+		return;
+	}
+
+	const CALifeLevelRegistry::_REGISTRY	&objects = graph().level().objects();
+	Msg							("* ALife switch benchmark: %d object(s) on the level, %d always visited, %d step(s) through %d game vertices",objects.size(),graph().level().grid().always_count(),step_count,path.size());
+
+	u64							scan_visited = 0, scan_found = 0;
+	u64							grid_visited = 0, grid_found = 0;
+	u32							mismatches = 0;
+	float						scan_time = 0.f, grid_time = 0.f;
+	CTimer						timer;
+	for (u32 step=0; step<step_count; ++step) {
+		// along the polyline through the vertices, the steps are spread over the whole of it
+		float					t = float(step)*float(path.size() - 1)/float(step_count);
+		u32						segment = iFloor(t);
+		Fvector					position;
+		position.lerp			(path[segment],path[segment + 1],t - float(segment));
+
+		u32						scan_step_found = 0;
+		timer.Start				();
+		CALifeLevelRegistry::_REGISTRY::const_iterator	I = objects.begin();
+		CALifeLevelRegistry::_REGISTRY::const_iterator	E = objects.end();
+		for ( ; I != E; ++I)
+			if (switch_needed((*I).second,position,online_distance(),offline_distance()))
+				++scan_step_found;
+		scan_time				+= timer.GetElapsed_sec();
+		scan_visited			+= objects.size();
+		scan_found				+= scan_step_found;
+
+		u32						grid_step_found = 0;
+		timer.Start				();
+		m_switch_objects.clear_not_free	();
+		graph().level().grid().select	(position,online_distance(),m_switch_objects);
+		CALifeSwitchGrid::OBJECTS::const_iterator	i = m_switch_objects.begin();
+		CALifeSwitchGrid::OBJECTS::const_iterator	e = m_switch_objects.end();
+		for ( ; i != e; ++i)
+			if (switch_needed(*i,position,online_distance(),offline_distance()))
+				++grid_step_found;
+		grid_time				+= timer.GetElapsed_sec();
+		grid_visited			+= m_switch_objects.size();
+		grid_found				+= grid_step_found;
+
+		if (grid_step_found != scan_step_found)
+			++mismatches;
+	}
+
+	Msg							("*   scan : %8.3f ms/pass, %10.1f object(s) visited/pass, %I64u switch(es) found",1000.f*scan_time/float(step_count),float(scan_visited)/float(step_count),scan_found);
+	Msg							("*   grid : %8.3f ms/pass, %10.1f object(s) visited/pass, %I64u switch(es) found",1000.f*grid_time/float(step_count),float(grid_visited)/float(step_count),grid_found);
+	if (mismatches)
+		Msg						("! ALife switch benchmark: %d step(s) where the grid and the scan disagree",mismatches);
+}
+
 void CALifeUpdateManager::set_process_time	(int microseconds)
 {
 	graph().set_process_time		(float(microseconds) - float(microseconds)*update_monster_factor()/1000000.f);
@@ -401,6 +608,7 @@ void CALifeUpdateManager::teleport_object	(ALife::_OBJECT_ID id, GameGraph::_GRA
 	graph().change							(object,object->m_tGraphID,game_vertex_id);
 	object->m_tNodeID						= level_vertex_id;
 	object->o_Position						= position;
+	graph().move							(object);
 	CSE_ALifeMonsterAbstract				*monster_abstract = smart_cast<CSE_ALifeMonsterAbstract*>(object);
 	if (monster_abstract)
 		monster_abstract->m_tNextGraphID	= object->m_tGraphID;
@@ -11,6 +11,7 @@
 #include "alife_switch_manager.h"
 #include "alife_surge_manager.h"
 #include "alife_storage_manager.h"
+#include "alife_switch_grid.h"
 
 namespace RestrictionSpace {
 	enum ERestrictorTypes;
@@ -30,6 +31,10 @@ protected:
 	float				m_update_monster_factor;
 	u32					m_objects_per_update;
 	bool				m_changing_level;
+	u32					m_switch_sweep_count;
+	u32					m_switch_near_start;
+	CALifeSwitchGrid::OBJECTS	m_switch_objects;
+	ALife::OBJECT_VECTOR		m_switch_ids;
 
 public:
 			void __stdcall	update				();
@@ -62,6 +67,12 @@ public:
 			void		add_restriction			(ALife::_OBJECT_ID id, ALife::_OBJECT_ID restriction_id, const RestrictionSpace::ERestrictorTypes &restriction_type);
 			void		remove_restriction		(ALife::_OBJECT_ID id, ALife::_OBJECT_ID restriction_id, const RestrictionSpace::ERestrictorTypes &restriction_type);
 			void		remove_all_restrictions	(ALife::_OBJECT_ID id, const RestrictionSpace::ERestrictorTypes &restriction_type);
+	// takes the game paths of the scheduled objects and searches them in the update batches,
+	// serially and by the offline path planner; the game is not changed
+			void		soak_benchmark			(u32 update_count, u32 objects_per_update);
+	// walks a synthetic actor through the game vertices of the current level and finds the objects to switch,
+	// scanning the whole level and selecting from the switch grid; nothing is switched
+			void		switch_benchmark		(u32 step_count);
 };
 
 #include "alife_update_manager_inline.h"
\ No newline at end of file
@@ -40,6 +40,8 @@
 #include "MainMenu.h"
 #include "saved_game_wrapper.h"
 #include "level_graph.h"
+#include "path_request_queue.h"
+#include "level_graph_hierarchy.h"
 //#include "../xrEngine/resourcemanager.h"
 #include "../xrEngine/doug_lea_memory_allocator.h"
 #include "cameralook.h"
@@ -98,6 +100,8 @@ extern int		g_upgrades_log;
 extern float	g_smart_cover_animation_speed_factor;
 
 extern	BOOL	g_ai_use_old_vision;
+extern	BOOL	g_alife_save_chunked;
+extern	BOOL	g_alife_save_incremental;
 float			g_aim_predict_time = 0.44f;
 int				g_keypress_on_start	= 1;
 
@@ -270,6 +274,56 @@ public:
 };
 #endif // DEBUG
 
+class CCC_PathBenchmark : public IConsole_Command {
+public:
+	CCC_PathBenchmark(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		int path_count = 1000;
+		if (args && *args)
+			sscanf					(args,"%d",&path_count);
+		if (path_count <= 0) {
+			Msg						("! invalid path count");
+			return;
+		}
+		path_request_queue_benchmark(u32(path_count));
+	}
+	virtual void	Info	(TInfo& I)
+	{
+		xr_strcpy(I,"[path_count] - random level graph paths : serial search vs batched parallel search"); 
+	}
+};
+
+class CCC_HierarchicalPathBenchmark : public IConsole_Command {
+public:
+	CCC_HierarchicalPathBenchmark(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		int path_count = 1000;
+		if (args && *args)
+			sscanf					(args,"%d",&path_count);
+		if (path_count <= 0) {
+			Msg						("! invalid path count");
+			return;
+		}
+		level_graph_hierarchy_benchmark(u32(path_count));
+	}
+	virtual void	Info	(TInfo& I)
+	{
+		xr_strcpy(I,"[path_count] - random level graph paths : flat search vs hierarchical (region) search"); 
+	}
+};
+
+class CCC_GraphLoadBenchmark : public IConsole_Command {
+public:
+	CCC_GraphLoadBenchmark(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		level_graph_load_benchmark	();
+	}
+	virtual void	Info	(TInfo& I)
+	{
+		xr_strcpy(I,"level graphs and spawns : r_open vs r_open_mapped load time and memory"); 
+	}
+};
+
 class CCC_ALifeTimeFactor : public IConsole_Command {
 public:
 	CCC_ALifeTimeFactor(LPCSTR N) : IConsole_Command(N)  { };
@@ -371,6 +425,81 @@ public:
 	}
 };
 
+class CCC_ALifeSoakBenchmark : public IConsole_Command {
+public:
+	CCC_ALifeSoakBenchmark(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		if ((GameID() == eGameIDSingle)  &&ai().get_alife()) {
+			game_sv_Single	*tpGame = smart_cast<game_sv_Single *>(Level().Server->game);
+			VERIFY			(tpGame);
+			int update_count = 1000, objects_per_update = 100;
+			if (args && *args)
+				sscanf		(args,"%d %d",&update_count,&objects_per_update);
+			if ((update_count <= 0) || (objects_per_update <= 0)) {
+				Msg			("! invalid parameters");
+				return;
+			}
+			tpGame->alife().soak_benchmark(u32(update_count),u32(objects_per_update));
+		}
+		else
+			Log("!Not a single player game!");
+	}
+	virtual void	Info	(TInfo& I)
+	{
+		xr_strcpy(I,"[updates] [objects_per_update] - game paths of the scheduled offline objects : serial search vs searched ahead in parallel"); 
+	}
+};
+
+class CCC_ALifeSwitchBenchmark : public IConsole_Command {
+public:
+	CCC_ALifeSwitchBenchmark(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		if ((GameID() == eGameIDSingle)  &&ai().get_alife()) {
+			game_sv_Single	*tpGame = smart_cast<game_sv_Single *>(Level().Server->game);
+			VERIFY			(tpGame);
+			int step_count = 10000;
+			if (args && *args)
+				sscanf		(args,"%d",&step_count);
+			if (step_count <= 0) {
+				Msg			("! invalid parameters");
+				return;
+			}
+			tpGame->alife().switch_benchmark(u32(step_count));
+		}
+		else
+			Log("!Not a single player game!");
+	}
+	virtual void	Info	(TInfo& I)
+	{
+		xr_strcpy(I,"[steps] - switch decisions for an actor walking through the level game vertices : level scan vs switch grid"); 
+	}
+};
+
+class CCC_ALifeSaveBenchmark : public IConsole_Command {
+public:
+	CCC_ALifeSaveBenchmark(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = TRUE; };
+	virtual void Execute(LPCSTR args) {
+		if ((GameID() == eGameIDSingle)  &&ai().get_alife()) {
+			game_sv_Single	*tpGame = smart_cast<game_sv_Single *>(Level().Server->game);
+			VERIFY			(tpGame);
+			int iteration_count = 4;
+			if (args && *args)
+				sscanf		(args,"%d",&iteration_count);
+			if (iteration_count <= 0) {
+				Msg			("! invalid parameters");
+				return;
+			}
+			tpGame->alife().save_benchmark(u32(iteration_count));
+		}
+		else
+			Log("!Not a single player game!");
+	}
+	virtual void	Info	(TInfo& I)
+	{
+		xr_strcpy(I,"[iterations] - save and read back the current game : monolithic vs chunked vs incremental chunked"); 
+	}
+};
+
 class CCC_ALifeSwitchFactor : public IConsole_Command {
 public:
 	CCC_ALifeSwitchFactor(LPCSTR N) : IConsole_Command(N)  { };
@@ -1807,7 +1936,16 @@ void CCC_RegisterCommands()
 
 #endif // DEBUG
 	
+	CMD1(CCC_PathBenchmark,		"ai_path_bench"			);		// level graph path throughput
+	CMD1(CCC_HierarchicalPathBenchmark,"ai_hpa_bench"		);		// flat vs hierarchical level graph search
+	CMD1(CCC_GraphLoadBenchmark,"ai_load_bench"			);		// r_open vs r_open_mapped graph loading
+	CMD1(CCC_ALifeSoakBenchmark,"al_soak_bench"			);		// offline alife path search throughput
+	CMD1(CCC_ALifeSwitchBenchmark,"al_switch_bench"		);		// online/offline switch pass cost
+	CMD1(CCC_ALifeSaveBenchmark,"al_save_bench"			);		// saved game formats
+
 	CMD1(CCC_ALifeSave,			"save"					);		// save game
+	CMD4(CCC_Integer,			"al_save_chunked",		&g_alife_save_chunked,		FALSE,	TRUE);	// compress the saved games by blocks
+	CMD4(CCC_Integer,			"al_save_incremental",	&g_alife_save_incremental,	FALSE,	TRUE);	// reuse the blocks unchanged since the last save
 	CMD1(CCC_ALifeLoadFrom,		"load"					);		// load game from ...
 	CMD1(CCC_LoadLastSave,		"load_last_save"		);		// load last saved game from ...
 
@@ -21,6 +21,7 @@
 #include "DemoPlay_Control.h"
 #include "account_manager_console.h"
 #include "gamespy/GameSpy_GP.h"
+#include "demo_load_test.h"
 
 EGameIDs	ParseStringToGameType	(LPCSTR str);
 LPCSTR		GameTypeToString		(EGameIDs gt, bool bShort);
@@ -1958,6 +1959,77 @@ public:
 	virtual void	Info	(TInfo& I){xr_strcpy(I,"valid arguments is [info info_full on off]"); }
 };
 
+class CCC_ClientUpdatesBench : public IConsole_Command {
+public:
+					CCC_ClientUpdatesBench(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = true; };
+	virtual void	Execute(LPCSTR args) 
+	{
+		u32		client_count	= 32;
+		u32		entity_count	= 2000;
+		u32		seconds			= 10;
+		if (args && args[0])
+			sscanf	(args, "%d %d %d", &client_count, &entity_count, &seconds);
+		if (!client_count || (client_count > entity_count) || (entity_count > 60000) || !seconds)
+		{
+			Msg		("! usage: %s [client count] [entity count] [seconds]", cName);
+			return;
+		}
+		client_updates::benchmark	(client_count, entity_count, seconds, _max(psNET_ServerUpdate, 1));
+	}
+	virtual void	Info	(TInfo& I){xr_strcpy(I,"[client count] [entity count] [seconds] : broadcast vs per-client updates with synthetic clients, using sv_traffic_optimization_level compression"); }
+};
+
+class CCC_NetLoadTest : public IConsole_Command {
+public:
+					CCC_NetLoadTest(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = true; };
+	virtual void	Execute(LPCSTR args) 
+	{
+		if (g_pGameLevel)
+		{
+			Msg		("! %s : disconnect first", cName);
+			return;
+		}
+		u32		client_count	= 100;
+		u32		seconds			= 10;
+		if (args && args[0])
+			sscanf	(args, "%d %d", &client_count, &seconds);
+		if (!client_count || (client_count > 1000) || !seconds)
+		{
+			Msg		("! usage: %s [client count] [seconds]", cName);
+			return;
+		}
+		net_load_test	(client_count, seconds);
+	}
+	virtual void	Info	(TInfo& I){xr_strcpy(I,"[client count] [seconds] : a server and its clients in this process, DirectPlay vs UDP transport"); }
+};
+
+class CCC_DemoLoadTest : public IConsole_Command {
+public:
+					CCC_DemoLoadTest(LPCSTR N) : IConsole_Command(N)  { bEmptyArgsHandled = false; };
+	virtual void	Execute(LPCSTR args) 
+	{
+		string_path	file_name	= "";
+		u32			bot_count	= 32;
+		u32			seconds		= 60;
+		float		time_scale	= 1.f;
+		u32			jitter		= 0;
+		sscanf		(args, "%s %d %d %f %d", file_name, &bot_count, &seconds, &time_scale, &jitter);
+		if (!file_name[0] || !bot_count || (bot_count > 256) || !seconds || (time_scale <= 0.f))
+		{
+			Msg		("! usage: %s <client demo file> [bot count] [seconds] [time scale] [jitter ms]", cName);
+			return;
+		}
+		demo_load_test::settings	params;
+		params.file_name	= file_name;
+		params.bot_count	= bot_count;
+		params.seconds		= seconds;
+		params.time_scale	= time_scale;
+		params.jitter		= jitter;
+		demo_load_test::start	(params);
+	}
+	virtual void	Info	(TInfo& I){xr_strcpy(I,"<xray_*.cdemo file in $logs$> [bot count] [seconds] [time scale] [jitter ms] : bots replay the recorded client packets against this server, the tick times, message costs and outbound traffic are logged"); }
+};
+
 void register_mp_console_commands()
 {
 	CMD1(CCC_Restart,				"g_restart"				);
@@ -1983,6 +2055,9 @@ void register_mp_console_commands()
 	CMD4(CCC_Integer,	"net_sv_gpmode",	    &psNET_GuaranteedPacketMode,0, 2)	;
 	CMD3(CCC_Mask,		"net_sv_log_data",		&psNET_Flags,		NETFLAG_LOG_SV_PACKETS	);
 	CMD3(CCC_Mask,		"net_cl_log_data",		&psNET_Flags,		NETFLAG_LOG_CL_PACKETS	);
+	CMD3(CCC_Mask,		"net_udp_transport",	&psNET_Flags,		NETFLAG_UDP_TRANSPORT	);
+	CMD1(CCC_NetLoadTest,	"net_load_test"			);
+	CMD1(CCC_DemoLoadTest,	"sv_demo_load_test"		);
 #ifdef DEBUG
 	CMD3(CCC_Mask,		"net_dump_size",		&psNET_Flags,		NETFLAG_DBG_DUMPSIZE	);
 	CMD1(CCC_Dbg_NumObjects,"net_dbg_objects"				);
@@ -2165,5 +2240,6 @@ void register_mp_console_commands()
 	CMD1(CCC_GameSpyRegisterUniqueNick,		"gs_register_unique_nick");
 	CMD1(CCC_GameSpyProfile,				"gs_profile");
 	CMD4(CCC_Integer,						"sv_write_update_bin",				&g_sv_write_updates_bin, 0, 1);
-	CMD4(CCC_Integer,						"sv_traffic_optimization_level",	(int*)&g_sv_traffic_optimization_level, 0, 7);
+	CMD4(CCC_Integer,						"sv_traffic_optimization_level",	(int*)&g_sv_traffic_optimization_level, 0, 31);
+	CMD1(CCC_ClientUpdatesBench,			"sv_client_updates_bench");
 }
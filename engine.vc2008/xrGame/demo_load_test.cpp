@@ -0,0 +1,662 @@
+#include "stdafx.h"
+#include "demo_load_test.h"
+#include "Level.h"
+#include "xrServer.h"
+#include "xrServer_load_profile.h"
+#include "xrServer_Objects_ALife_Monsters.h"
+#include "xrMessages.h"
+#include "NET_Queue.h"
+#include "../xrEngine/mp_logging.h"
+
+namespace demo_load_test {
+
+u32 const	connect_timeout		= 30000;
+// a bot, which is not in the game (a spectator or dead), asks to respawn this often
+u32 const	ready_interval		= 1000;
+
+// the replayable packets of a client recording, CLevel::DemoPacket records
+class stream : private boost::noncopyable
+{
+public:
+	struct record
+	{
+		u32				time;
+		u32				offset;
+		u32				size;
+	};
+
+						stream			() : m_duration(1), m_dropped(0) {}
+
+	bool				load			(LPCSTR file_name);
+
+	u32					size			() const				{ return m_records.size(); }
+	record const &		operator[]		(u32 const index) const	{ return m_records[index]; }
+	u8 const*			data			(record const & R) const{ return &*m_data.begin() + R.offset; }
+	// in ms, from the first replayable packet till the end of the recording
+	u32					duration		() const				{ return m_duration; }
+	u32					dropped			() const				{ return m_dropped; }
+private:
+	xr_vector<record>	m_records;
+	xr_vector<u8>		m_data;
+	u32					m_duration;
+	u32					m_dropped;
+}; //class stream
+
+bool stream::load(LPCSTR file_name)
+{
+	IReader* F			= FS.r_open("$logs$", file_name);
+	if (!F)
+		return			false;
+
+	u32 first_time		= 0;
+	u32 last_time		= 0;
+	NET_Packet			P;
+	while (F->elapsed() >= sizeof(CLevel::DemoPacket))
+	{
+		CLevel::DemoPacket	header;
+		F->r			(&header, sizeof(header));
+		if ((header.m_packet_size > NET_PacketSizeLimit) || (u32(F->elapsed()) < header.m_packet_size))
+			break;
+
+		P.B.count		= header.m_packet_size;
+		P.r_pos			= 0;
+		F->r			(P.B.data, P.B.count);
+		last_time		= header.m_time_global_delta;
+		if (!replayable(P))
+		{
+			++m_dropped;
+			continue;
+		}
+
+		if (m_records.empty())
+			first_time	= header.m_time_global_delta;
+
+		record			R;
+		R.time			= header.m_time_global_delta - first_time;
+		R.offset		= m_data.size();
+		R.size			= P.B.count;
+		m_records.push_back	(R);
+		m_data.insert	(m_data.end(), P.B.data, P.B.data + P.B.count);
+	}
+	FS.r_close			(F);
+
+	m_duration			= _max(last_time - first_time, u32(1));
+	return				!m_records.empty();
+}
+
+// the handshake is done by the bots themselves, the rest of the messages and events
+// refer to the entities and to the state of the recorded session
+bool replayable(NET_Packet & P)
+{
+	if (P.B.count < sizeof(u16))
+		return			false;
+
+	u16					type;
+	P.r_begin			(type);
+	switch (type)
+	{
+	case M_CL_UPDATE:
+		// u16 actor id, u32 ping, the actor export
+		return			(P.B.count > sizeof(u16)*2 + sizeof(u32));
+	case M_CHAT_MESSAGE:
+		return			true;
+	case M_EVENT:
+		{
+			// u32 timestamp, u16 type, u16 destination, u16 game event
+			if (P.B.count < sizeof(u16)*4 + sizeof(u32))
+				return	false;
+			P.r_u32		();
+			u16			event_type;
+			P.r_u16		(event_type);
+			P.r_u16		();
+			if (event_type != GE_GAME_EVENT)
+				return	false;
+			u16			game_event;
+			P.r_u16		(game_event);
+			switch (game_event)
+			{
+			case GAME_EVENT_PLAYER_READY:
+			case GAME_EVENT_PLAYER_KILL:
+			case GAME_EVENT_PLAYER_BUYMENU_OPEN:
+			case GAME_EVENT_PLAYER_BUYMENU_CLOSE:
+			case GAME_EVENT_GET_ACTIVE_VOTE:
+			case GAME_EVENT_SPEECH_MESSAGE:
+				return	true;
+			}
+		}break;
+	}
+	return				false;
+}
+
+//==============================================================================
+
+class bot : public IPureClient
+{
+public:
+						bot				(stream const & replay, settings const & params, u32 const index);
+
+	void				update			(xrServer* server, u32 const now);
+	bool				playing			() const	{ return m_state == state_playing; }
+	bool				failed			() const	{ return m_state == state_failed; }
+	u32					replayed		() const	{ return m_replayed; }
+	u32					received		() const	{ return u32(m_received); }
+
+	virtual void		OnMessage		(void* data, u32 size)
+	{
+		InterlockedExchangeAdd	(&m_received, LONG(size));
+		IPureClient::OnMessage	(data, size);
+	}
+private:
+	enum bot_state
+	{
+		state_verifying,		// till M_CLIENT_CONNECT_RESULT
+		state_player_state,		// till the server creates the player state
+		state_accepting,		// till the server accepts the connection
+		state_playing,
+		state_failed,
+	};
+
+	void				process_messages();
+	void				secure_send		(NET_Packet & P, u32 const flags);
+	void				send_profile	();
+	void				begin_game_event(NET_Packet & P, u16 const destination, u16 const game_event);
+	// the entity of the bot on the server, 0xffff if it has none yet
+	u16					owner			(xrServer* server, bool & alive_actor) const;
+
+	void				start_replay	(u32 const now);
+	void				next_record		();
+	void				schedule_record	();
+	void				replay			(xrServer* server, u32 const now);
+	void				send_record		(xrServer* server, stream::record const & R);
+
+	stream const &		m_stream;
+	settings const &	m_params;
+	u32					m_index;
+	bot_state			m_state;
+	ClientID			m_id;
+	secure_messaging::key_t	m_secret_key;
+	bool				m_profile_sent;
+	client_updates::update_receiver	m_update_receiver;
+
+	CRandom				m_random;
+	u32					m_cursor;
+	u32					m_loop;
+	u32					m_replay_start;
+	u32					m_next_time;
+	u32					m_ready_time;
+	u32					m_replayed;
+	volatile LONG		m_received;
+}; //class bot
+
+bot::bot(stream const & replay, settings const & params, u32 const index) :
+	IPureClient			(Device.GetTimerGlobal()),
+	m_stream			(replay),
+	m_params			(params),
+	m_index				(index),
+	m_state				(state_verifying),
+	m_profile_sent		(false),
+	m_random			(s32(index)),
+	m_cursor			(0),
+	m_loop				(0),
+	m_replay_start		(0),
+	m_next_time			(0),
+	m_ready_time		(0),
+	m_replayed			(0),
+	m_received			(0)
+{
+	ZeroMemory			(&m_secret_key, sizeof(m_secret_key));
+}
+
+void bot::secure_send(NET_Packet & P, u32 const flags)
+{
+	NET_Packet			enc_packet;
+	enc_packet.w_begin	(M_SECURE_MESSAGE);
+	u32 checksum		= secure_messaging::encrypt(P.B.data, P.B.count, m_secret_key);
+	enc_packet.w		(P.B.data, P.B.count);
+	enc_packet.w_u32	(checksum);
+	Send				(enc_packet, flags);
+}
+
+void bot::send_profile()
+{
+	if (m_profile_sent)
+		return;
+	m_profile_sent		= true;
+
+	NET_Packet			P;
+	P.w_begin			(M_CREATE_PLAYER_STATE);
+	game_PlayerState	tmp_player_state(NULL);
+	tmp_player_state.net_Export	(P, TRUE);
+	secure_send			(P, net_flags(TRUE, TRUE, TRUE, TRUE));
+}
+
+void bot::begin_game_event(NET_Packet & P, u16 const destination, u16 const game_event)
+{
+	P.w_begin			(M_EVENT);
+	P.w_u32				(timeServer());
+	P.w_u16				(GE_GAME_EVENT);
+	P.w_u16				(destination);
+	P.w_u16				(game_event);
+}
+
+u16 bot::owner(xrServer* server, bool & alive_actor) const
+{
+	alive_actor			= false;
+	xrClientData* CL	= server->ID_to_client(m_id);
+	if (!CL || !CL->owner)
+		return			u16(-1);
+
+	CSE_ALifeCreatureActor* actor = smart_cast<CSE_ALifeCreatureActor*>(CL->owner);
+	alive_actor			= actor && actor->g_Alive();
+	return				CL->owner->ID;
+}
+
+// the same as the answers of CLevel::ClientReceive
+void bot::process_messages()
+{
+	StartProcessQueue	();
+	for (NET_Packet* P = net_msg_Retreive(); P; P = net_msg_Retreive())
+	{
+		NET_Packet		R;
+		u16				type;
+		P->r_begin		(type);
+		switch (type)
+		{
+		case M_SECURE_KEY_SYNC:
+			{
+				s32 seed			= 0;
+				P->r_s32			(seed);
+				secure_messaging::generate_key	(seed, m_secret_key);
+				R.w_begin			(M_SECURE_KEY_SYNC);
+				R.w_s32				(seed);
+				Send				(R, net_flags(TRUE, TRUE, TRUE));
+			}break;
+		case M_AUTH_CHALLENGE:
+			{
+				send_profile		();
+				R.w_begin			(M_CL_AUTH);
+#ifdef USE_DEBUG_AUTH
+				R.w_u64				(MP_DEBUG_AUTH);
+#else
+				R.w_u64				(FS.auth_get());
+#endif //#ifdef USE_DEBUG_AUTH
+				secure_send			(R, net_flags(TRUE, TRUE, TRUE, TRUE));
+			}break;
+		case M_SV_DIGEST:
+			{
+				string64			digest;
+				xr_sprintf			(digest, "demo_load_test_%d", m_index);
+				R.w_begin			(M_SV_DIGEST);
+				R.w_stringZ			(digest);
+				secure_send			(R, net_flags(TRUE, TRUE, TRUE, TRUE));
+			}break;
+		case M_CLIENT_CONNECT_RESULT:
+			{
+				u8 const result		= P->r_u8();
+				P->r_u8				();
+				string512			reason;
+				P->r_stringZ_s		(reason);
+				P->r_clientID		(m_id);
+				if (!result)
+				{
+					Msg				("! Demo load test : bot %d is rejected : %s", m_index, reason);
+					m_state			= state_failed;
+					break;
+				}
+				send_profile		();
+				if (m_state == state_verifying)
+					m_state			= state_player_state;
+			}break;
+		case M_UPDATE_OBJECTS_DELTA:
+			{
+				// the bots do not decode the updates, the acknowledgements are all the server needs
+				P->r_u8				();		//compression
+				u16					sequence;
+				P->r_u16			(sequence);
+				P->r_u8				();		//part
+				u8 const part_count	= P->r_u8();
+				if (m_update_receiver.receive_part(sequence, part_count))
+				{
+					R.w_begin		(M_CL_UPDATES_ACK);
+					m_update_receiver.write_ack	(R);
+					Send			(R, net_flags(FALSE));
+				}
+			}break;
+		case M_MOVE_PLAYERS:
+			{
+				R.w_begin			(M_MOVE_PLAYERS_RESPOND);
+				Send				(R, net_flags(TRUE, TRUE));
+			}break;
+		}
+		net_msg_Release	();
+	}
+	EndProcessQueue		();
+}
+
+void bot::update(xrServer* server, u32 const now)
+{
+	if (net_isDisconnected())
+		m_state			= state_failed;
+	if (m_state == state_failed)
+		return;
+
+	process_messages	();
+
+	NET_Packet			P;
+	switch (m_state)
+	{
+	case state_player_state:
+		{
+			// M_CLIENT_REQUEST_CONNECTION_DATA would be processed before M_CREATE_PLAYER_STATE
+			// (the delayed packets go first), the clients wait for the map sync till then
+			xrClientData* CL	= server->ID_to_client(m_id);
+			if (!CL || !CL->ps)
+				break;
+			P.w_begin			(M_CLIENT_REQUEST_CONNECTION_DATA);
+			Send				(P, net_flags(TRUE, TRUE, TRUE, TRUE));
+			m_state				= state_accepting;
+		}break;
+	case state_accepting:
+		{
+			xrClientData* CL	= server->ID_to_client(m_id);
+			if (!CL || !CL->net_Accepted)
+				break;
+			P.w_begin			(M_CLIENTREADY);
+			Send				(P, net_flags(TRUE, TRUE));
+
+			begin_game_event	(P, 0, GAME_EVENT_PLAYER_STARTED);
+			P.w_stringZ			(Level().name());
+			Send				(P, net_flags(TRUE, TRUE));
+
+			m_state				= state_playing;
+			start_replay		(now);
+		}break;
+	case state_playing:
+		{
+			replay				(server, now);
+		}break;
+	}
+	Flush_Send_Buffer	();
+}
+
+// the bots start at different points of the recording, so they do not act in step
+void bot::start_replay(u32 const now)
+{
+	u32 const offset	= u32(u64(m_stream.duration())*m_index/_max(m_params.bot_count, u32(1)));
+	m_cursor			= 0;
+	while ((m_cursor < m_stream.size() - 1) && (m_stream[m_cursor].time < offset))
+		++m_cursor;
+	m_loop				= 0;
+	m_replay_start		= now - u32(float(m_stream[m_cursor].time)/m_params.time_scale);
+	schedule_record		();
+}
+
+void bot::next_record()
+{
+	if (++m_cursor == m_stream.size())
+	{
+		m_cursor		= 0;
+		++m_loop;
+	}
+	schedule_record		();
+}
+
+// the recording is replayed in a loop
+void bot::schedule_record()
+{
+	u64 const time		= u64(m_loop)*m_stream.duration() + m_stream[m_cursor].time;
+	m_next_time			= m_replay_start + u32(float(time)/m_params.time_scale);
+	if (m_params.jitter)
+		m_next_time		+= m_random.randI(m_params.jitter + 1);
+}
+
+void bot::replay(xrServer* server, u32 const now)
+{
+	bool				alive_actor;
+	u16 const			owner_id = owner(server, alive_actor);
+	if (!alive_actor && (owner_id != u16(-1)) && (now - m_ready_time >= ready_interval))
+	{
+		NET_Packet		P;
+		begin_game_event(P, owner_id, GAME_EVENT_PLAYER_READY);
+		Send			(P, net_flags(TRUE, TRUE));
+		m_ready_time	= now;
+	}
+
+	// a frame sends the recording once at most, whatever the time scale is
+	for (u32 i = 0; (i < m_stream.size()) && (int(now - m_next_time) >= 0); ++i)
+	{
+		send_record		(server, m_stream[m_cursor]);
+		next_record		();
+	}
+}
+
+void bot::send_record(xrServer* server, stream::record const & R)
+{
+	NET_Packet			P;
+	P.B.count			= R.size;
+	CopyMemory			(P.B.data, m_stream.data(R), R.size);
+
+	bool				alive_actor;
+	u16 const			owner_id = owner(server, alive_actor);
+	u16					type;
+	P.r_begin			(type);
+	switch (type)
+	{
+	case M_CL_UPDATE:
+		{
+			// the recorded actor is replaced with the one of the bot
+			if (!alive_actor)
+				return;
+			P.w_seek		(sizeof(u16), &owner_id, sizeof(owner_id));
+			Send			(P, net_flags(FALSE));
+		}break;
+	case M_EVENT:
+		{
+			if (owner_id == u16(-1))
+				return;
+			u32 const time	= timeServer();
+			P.w_seek		(sizeof(u16), &time, sizeof(time));
+			P.w_seek		(sizeof(u16) + sizeof(u32) + sizeof(u16), &owner_id, sizeof(owner_id));
+			Send			(P, net_flags(TRUE, TRUE));
+		}break;
+	default:
+		{
+			Send			(P, net_flags(TRUE, TRUE));
+		}break;
+	}
+	++m_replayed;
+}
+
+//==============================================================================
+
+class load_test : public pureFrame
+{
+public:
+						load_test		(settings const & params);
+	virtual				~load_test		();
+
+	bool				initialize		();
+	virtual void	_BCL OnFrame		();
+private:
+	void				start_measuring	(u32 const now);
+	void				dump			(u32 const now) const;
+	void				finish			();
+
+	settings			m_params;
+	stream				m_stream;
+	xrServer*			m_server;
+	server_load_profile	m_profile;
+	xr_vector<bot*>		m_bots;
+	xr_vector<u32>		m_received_start;
+	u32					m_connect_failures;
+	u32					m_connect_start;
+	u32					m_measure_start;
+	u32					m_replayed_start;
+	bool				m_measuring;
+}; //class load_test
+
+static load_test*		g_load_test = NULL;
+
+load_test::load_test(settings const & params) :
+	m_params			(params),
+	m_server			(NULL),
+	m_connect_failures	(0),
+	m_connect_start		(0),
+	m_measure_start		(0),
+	m_replayed_start	(0),
+	m_measuring			(false)
+{
+}
+
+load_test::~load_test()
+{
+	if (m_measuring && (g_pGameLevel && (Level().Server == m_server)))
+		m_server->SetLoadProfile	(NULL);
+
+	for (u32 i = 0; i < m_bots.size(); ++i)
+	{
+		m_bots[i]->Disconnect	();
+		xr_delete				(m_bots[i]);
+	}
+}
+
+bool load_test::initialize()
+{
+	if (!g_pGameLevel || !Level().Server || !OnServer() || (GameID() == eGameIDSingle))
+	{
+		Msg				("! Demo load test : start a multiplayer server first");
+		return			false;
+	}
+	if (!m_stream.load(m_params.file_name.c_str()))
+	{
+		Msg				("! Demo load test : no client packets to replay in [%s]", m_params.file_name.c_str());
+		return			false;
+	}
+	m_server			= Level().Server;
+	m_connect_start		= Device.dwTimeGlobal;
+	m_bots.reserve		(m_params.bot_count);
+
+	Msg					("* Demo load test : %d bots, %d s, replaying %d packets of %.1f s at x%.2f, jitter %d ms (%d packets of the recording are not replayable)",
+		m_params.bot_count, m_params.seconds,
+		m_stream.size(), float(m_stream.duration())/1000.f,
+		m_params.time_scale, m_params.jitter, m_stream.dropped());
+	return				true;
+}
+
+void load_test::start_measuring(u32 const now)
+{
+	m_measuring			= true;
+	m_measure_start		= now;
+	m_replayed_start	= 0;
+	m_received_start.resize	(m_bots.size());
+	for (u32 i = 0; i < m_bots.size(); ++i)
+	{
+		m_received_start[i]	= m_bots[i]->received();
+		m_replayed_start	+= m_bots[i]->replayed();
+	}
+	m_server->SetLoadProfile	(&m_profile);
+}
+
+void load_test::dump(u32 const now) const
+{
+	u32 const			duration = _max(now - m_measure_start, u32(1));
+	u32					playing		= 0;
+	u32					replayed	= 0;
+	u64					received	= 0;
+	for (u32 i = 0; i < m_bots.size(); ++i)
+	{
+		playing			+= m_bots[i]->playing() ? 1 : 0;
+		replayed		+= m_bots[i]->replayed();
+		received		+= m_bots[i]->received() - m_received_start[i];
+	}
+	replayed			-= m_replayed_start;
+
+	Msg					("* Demo load test : %d/%d bots playing (%d failed to connect), %.1f s, %d packets replayed",
+		playing, m_params.bot_count, m_connect_failures, float(duration)/1000.f, replayed);
+	m_profile.dump		();
+	Msg					("*   server outbound : %.1f KB/s, %.2f KB/s per bot",
+		float(double(received)*1000.0/(1024.0*duration)),
+		playing ? float(double(received)*1000.0/(1024.0*duration*playing)) : 0.f);
+}
+
+void load_test::finish()
+{
+	Device.seqFrame.Remove	(this);
+	load_test* self		= this;
+	g_load_test			= NULL;
+	xr_delete			(self);
+}
+
+void load_test::OnFrame()
+{
+	if (!g_pGameLevel || (Level().Server != m_server))
+	{
+		Msg				("! Demo load test : the server is gone, the test is aborted");
+		m_measuring		= false;
+		finish			();
+		return;
+	}
+
+	u32 const			now = Device.dwTimeGlobal;
+	// a connection blocks till the transport has established it, one a frame
+	u32 const			bot_index = m_bots.size() + m_connect_failures;
+	if (bot_index < m_params.bot_count)
+	{
+		string256		options;
+		xr_sprintf		(options, "localhost/name=demo_bot_%d/port=%d", bot_index, m_server->GetPort());
+		bot* B			= xr_new<bot>(m_stream, m_params, bot_index);
+		if (B->Connect(options))
+			m_bots.push_back	(B);
+		else
+		{
+			Msg			("! Demo load test : bot %d failed to connect", bot_index);
+			++m_connect_failures;
+			xr_delete	(B);
+		}
+	}
+
+	u32					ready = m_connect_failures;
+	for (u32 i = 0; i < m_bots.size(); ++i)
+	{
+		bot* B			= m_bots[i];
+		if (B->net_isCompleted_Connect())
+			B->update	(m_server, now);
+		ready			+= (B->playing() || B->failed() || B->net_isFails_Connect()) ? 1 : 0;
+	}
+
+	if (!m_measuring)
+	{
+		bool const		timeout = (now - m_connect_start > connect_timeout);
+		if ((ready == m_params.bot_count) || timeout)
+			start_measuring	(now);
+		return;
+	}
+
+	if (now - m_measure_start < m_params.seconds*1000)
+		return;
+
+	m_server->SetLoadProfile	(NULL);
+	m_measuring			= false;
+	dump				(now);
+	finish				();
+}
+
+bool start(settings const & params)
+{
+	if (g_load_test)
+	{
+		Msg				("! Demo load test : a test is running already");
+		return			false;
+	}
+	load_test* test		= xr_new<load_test>(params);
+	if (!test->initialize())
+	{
+		xr_delete		(test);
+		return			false;
+	}
+	g_load_test			= test;
+	Device.seqFrame.Add	(test, REG_PRIORITY_LOW);
+	return				true;
+}
+
+} //namespace demo_load_test
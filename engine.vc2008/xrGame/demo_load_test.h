@@ -0,0 +1,30 @@
+#ifndef DEMO_LOAD_TEST_INCLUDED
+#define DEMO_LOAD_TEST_INCLUDED
+
+// sv_demo_load_test : bots connect to the running server over the loopback and replay
+// the packets a client has sent while a demo was recorded (<demo name>.cdemo in $logs$,
+// see CLevel::SaveClientPacket), then the server tick times, the processing costs of
+// the client messages and the server outbound traffic are reported.
+namespace demo_load_test {
+
+struct settings
+{
+	shared_str		file_name;
+	u32				bot_count;
+	u32				seconds;
+	// 2 replays the recording twice as fast
+	float			time_scale;
+	// in ms, every replayed packet is delayed by a random time up to it
+	u32				jitter;
+}; //struct settings
+
+// the bots connect on the next frames, the report is logged when the test ends
+bool	start		(settings const & params);
+
+// the client packets the bots replay, the read position of P is moved;
+// the rest (the handshake, the remote admin login and commands) is not recorded
+bool	replayable	(NET_Packet & P);
+
+} //namespace demo_load_test
+
+#endif //#ifndef DEMO_LOAD_TEST_INCLUDED
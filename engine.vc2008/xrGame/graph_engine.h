@@ -36,6 +36,10 @@ IC	u32 to_u32	(GraphEngineSpace::CWorldState const &other)
 
 using namespace GraphEngineSpace;
 
+#ifndef AI_COMPILER
+class CPathRequestQueue;
+#endif // AI_COMPILER
+
 class CGraphEngine {
 public:
 #ifndef AI_COMPILER
@@ -101,6 +105,13 @@ public:
 #ifndef AI_COMPILER
 	CSolverAlgorithm		*m_solver_algorithm;
 	CStringAlgorithm		*m_string_algorithm;
+	CPathRequestQueue		*m_path_requests;
+	u32						m_max_vertex_count;
+#endif // AI_COMPILER
+
+#ifndef AI_COMPILER
+private:
+			void			destroy_path_requests	();
 #endif // AI_COMPILER
 
 public:
@@ -109,6 +120,8 @@ public:
 	virtual			~CGraphEngine			();
 #ifndef AI_COMPILER
 	IC		const CSolverAlgorithm &solver_algorithm() const;
+	// batched level graph path requests, resolved concurrently on the task workers
+			CPathRequestQueue &path_requests	();
 #endif // AI_COMPILER
 
 	template <
@@ -17,6 +17,8 @@ IC	CGraphEngine::CGraphEngine		(u32 max_vertex_count)
 #ifndef AI_COMPILER
 	m_solver_algorithm	= xr_new<CSolverAlgorithm>			(16*1024);
 	m_string_algorithm	= xr_new<CStringAlgorithm>			(1024);
+	m_path_requests		= 0;
+	m_max_vertex_count	= max_vertex_count;
 #endif // AI_COMPILER
 }
 
@@ -26,6 +28,7 @@ IC	CGraphEngine::~CGraphEngine			()
 #ifndef AI_COMPILER
 	xr_delete			(m_solver_algorithm);
 	xr_delete			(m_string_algorithm);
+	destroy_path_requests	();
 #endif // AI_COMPILER
 }
 
@@ -10,6 +10,12 @@
 #include "level_graph.h"
 #include "profiler.h"
 
+#ifndef AI_COMPILER
+#	include <psapi.h>
+#	include "../xrEngine/x_ray.h"
+#	pragma comment(lib,"psapi.lib")
+#endif // AI_COMPILER
+
 LPCSTR LEVEL_GRAPH_NAME = "level.ai";
 
 #ifdef AI_COMPILER
@@ -28,12 +34,16 @@ CLevelGraph::CLevelGraph		()
 	string256					file_name;
 	strconcat					(sizeof(file_name), file_name, filename, LEVEL_GRAPH_NAME);
 #endif
-	m_reader					= FS.r_open	(file_name);
+	// vertices are accessed right from the file view, nothing is copied
+	m_reader					= FS.r_open_mapped(file_name);
+	R_ASSERT3					(m_reader,"cannot open level graph",file_name);
+	R_ASSERT3					(u32(m_reader->length()) >= sizeof(CHeader),"level graph is corrupted",file_name);
 
 	// m_header & data
 	m_header					= (CHeader*)m_reader->pointer();
 	R_ASSERT					(header().version() == XRAI_CURRENT_VERSION);
 	m_reader->advance			(sizeof(CHeader));
+	R_ASSERT3					(u32(m_reader->elapsed()) >= header().vertex_count()*sizeof(CVertex),"level graph is truncated",file_name);
 	m_nodes						= (CVertex*)m_reader->pointer();
 	m_row_length				= iFloor((header().box().max.z - header().box().min.z)/header().cell_size() + EPS_L + 1.5f);
 	m_column_length				= iFloor((header().box().max.x - header().box().min.x)/header().cell_size() + EPS_L + 1.5f);
@@ -329,3 +339,142 @@ u32 CLevelGraph::guess_vertex_id	(u32 const &current_vertex_id, Fvector const &p
 
 	return					(result_vertex_id);
 }
+
+#ifndef AI_COMPILER
+namespace level_graph_load_benchmark_detail {
+
+struct load_stats {
+	float			m_time;
+	s64				m_working_set;
+	s64				m_private;
+	u32				m_file_count;
+	u64				m_size;
+
+	IC				load_stats		() : m_time(0.f), m_working_set(0), m_private(0), m_file_count(0), m_size(0) {}
+};
+
+static void memory_usage			(s64 &working_set, s64 &private_usage)
+{
+	PROCESS_MEMORY_COUNTERS_EX	counters;
+	ZeroMemory					(&counters,sizeof(counters));
+	GetProcessMemoryInfo		(GetCurrentProcess(),(PROCESS_MEMORY_COUNTERS*)&counters,sizeof(counters));
+	working_set					= s64(counters.WorkingSetSize);
+	private_usage				= s64(counters.PrivateUsage);
+}
+
+// the file is not ready until its pages are resident, so touch all of them
+static u32 touch					(const IReader &reader)
+{
+	const u8					*I = (const u8*)reader.pointer();
+	const u8					*E = I + reader.elapsed();
+	u32							result = 0;
+	for ( ; I < E; I += 4096)
+		result					+= *I;
+	return						(result);
+}
+
+static void validate_level_graph	(IReader &reader, LPCSTR file_name)
+{
+	R_ASSERT3					(u32(reader.length()) >= sizeof(CLevelGraph::CHeader),"level graph is corrupted",file_name);
+	const CLevelGraph::CHeader	&header = *(const CLevelGraph::CHeader*)reader.pointer();
+	R_ASSERT3					(header.version() == XRAI_CURRENT_VERSION,"level graph version mismatch",file_name);
+	R_ASSERT3					(u32(reader.length()) - sizeof(CLevelGraph::CHeader) >= header.vertex_count()*sizeof(CLevelGraph::CVertex),"level graph is truncated",file_name);
+}
+
+static void load					(const xr_vector<shared_str> &file_names, bool level_graphs, bool mapped, load_stats &stats)
+{
+	xr_vector<IReader*>			readers;
+	u32							dummy = 0;
+	s64							working_set_before, private_before;
+	memory_usage				(working_set_before,private_before);
+
+	// everything is kept open, as server does with the level graph and the spawn
+	CTimer						timer;
+	timer.Start					();
+	xr_vector<shared_str>::const_iterator	I = file_names.begin();
+	xr_vector<shared_str>::const_iterator	E = file_names.end();
+	for ( ; I != E; ++I) {
+		IReader					*reader = mapped ? FS.r_open_mapped(**I) : FS.r_open(**I);
+		if (!reader)
+			continue;
+
+		if (level_graphs)
+			validate_level_graph(*reader,**I);
+
+		dummy					+= touch(*reader);
+		stats.m_size			+= reader->length();
+		++stats.m_file_count;
+		readers.push_back		(reader);
+	}
+	stats.m_time				= timer.GetElapsed_sec();
+
+	s64							working_set_after, private_after;
+	memory_usage				(working_set_after,private_after);
+	stats.m_working_set			= working_set_after - working_set_before;
+	stats.m_private				= private_after - private_before;
+
+	xr_vector<IReader*>::iterator	i = readers.begin();
+	xr_vector<IReader*>::iterator	e = readers.end();
+	for ( ; i != e; ++i)
+		FS.r_close				(*i);
+
+	if (dummy == u32(-1))
+		Msg						("");
+}
+
+static void report					(LPCSTR title, const load_stats &stats)
+{
+	Msg							("*   %-34s: %2d file(s), %7.2f Mb, %8.3f ms, working set %+8.2f Mb, private %+8.2f Mb",
+		title,
+		stats.m_file_count,
+		float(stats.m_size)/1048576.f,
+		stats.m_time*1000.f,
+		float(stats.m_working_set)/1048576.f,
+		float(stats.m_private)/1048576.f
+	);
+}
+
+} // namespace level_graph_load_benchmark_detail
+
+void level_graph_load_benchmark		()
+{
+	using namespace level_graph_load_benchmark_detail;
+
+	xr_vector<shared_str>		level_graphs;
+	for (u32 i=0, n=pApp->Levels.size(); i<n; ++i) {
+		string_path				file_name;
+		if (FS.exist(file_name,"$game_levels$",pApp->Levels[i].folder,LEVEL_GRAPH_NAME))
+			level_graphs.push_back	(file_name);
+	}
+
+	xr_vector<shared_str>		spawns;
+	FS_FileSet					files;
+	FS.file_list				(files,"$game_spawn$",FS_ListFiles,"*.spawn");
+	FS_FileSetIt				I = files.begin();
+	FS_FileSetIt				E = files.end();
+	for ( ; I != E; ++I) {
+		string_path				file_name;
+		FS.update_path			(file_name,"$game_spawn$",(*I).name.c_str());
+		spawns.push_back		(file_name);
+	}
+
+	// warm up the OS file cache, so both modes read from the memory
+	load_stats					warm_up;
+	load						(level_graphs,true,false,warm_up);
+	load						(spawns,false,false,warm_up);
+
+	// r_open is the way the graphs were loaded before
+	load_stats					opened_levels, opened_spawns, mapped_levels, mapped_spawns;
+	load						(level_graphs,true,false,opened_levels);
+	load						(spawns,false,false,opened_spawns);
+
+	load						(level_graphs,true,true,mapped_levels);
+	load						(spawns,false,true,mapped_spawns);
+
+	Msg							("* Graph load benchmark (time to ready : open, validate, touch every page)");
+	report						("level graphs, r_open",opened_levels);
+	report						("level graphs, r_open_mapped",mapped_levels);
+	report						("game graphs (spawn), r_open",opened_spawns);
+	report						("game graphs (spawn), r_open_mapped",mapped_spawns);
+}
+#endif // AI_COMPILER
@@ -279,5 +279,9 @@ IC	bool operator==		(const u32 &vertex_xz, const CLevelGraph::CVertex &vertex);
 #	endif
 #endif
 
+#ifndef AI_COMPILER
+	extern void level_graph_load_benchmark	();
+#endif
+
 #include "level_graph_inline.h"
 #include "level_graph_vertex_inline.h"
\ No newline at end of file
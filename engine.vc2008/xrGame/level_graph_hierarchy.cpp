@@ -0,0 +1,394 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: level_graph_hierarchy.cpp
+//	Created 	: 16.10.2026
+//  Modified 	: 16.10.2026
+//	Description : Hierarchical (cluster/region) abstraction over the level graph
+////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "level_graph_hierarchy.h"
+#include "level_graph.h"
+#include "graph_engine.h"
+#include "ai_space.h"
+
+// level path manager which does not leave the corridor of regions
+template <typename _DataStorage>
+class CCorridorPathManager : public CPathManager<
+		CLevelGraph,
+		_DataStorage,
+		SBaseParameters<_dist_type,_index_type,_iteration_type>,
+		_dist_type,
+		_index_type,
+		_iteration_type
+	>
+{
+private:
+	typedef CPathManager<
+		CLevelGraph,
+		_DataStorage,
+		SBaseParameters<_dist_type,_index_type,_iteration_type>,
+		_dist_type,
+		_index_type,
+		_iteration_type
+	>								inherited;
+
+private:
+	const CLevelGraphHierarchy		*m_hierarchy;
+
+public:
+	IC								CCorridorPathManager	(const CLevelGraphHierarchy *hierarchy) : m_hierarchy(hierarchy) {}
+	IC		bool					is_accessible			(const _index_type &vertex_id) const
+	{
+		return						(inherited::is_accessible(vertex_id) && m_hierarchy->in_corridor(vertex_id));
+	}
+};
+
+CLevelGraphHierarchy::CLevelGraphHierarchy	(const CLevelGraph &graph, u32 cluster_size) :
+	m_graph				(&graph),
+	m_cluster_size		(cluster_size),
+	m_search_stamp		(0),
+	m_corridor_stamp	(0)
+{
+	VERIFY				(m_cluster_size);
+	m_cluster_row_length= graph.row_length()/m_cluster_size + 1;
+	m_statistics.clear	();
+
+	CTimer				timer;
+	timer.Start			();
+	build				();
+	Msg					("* Level graph hierarchy: %d vertices, %d regions, %d abstract edges (%.3fs)",graph.header().vertex_count(),m_regions.size(),m_edges.size(),timer.GetElapsed_sec());
+}
+
+u32 CLevelGraphHierarchy::cluster			(u32 vertex_id) const
+{
+	u32					x, z;
+	m_graph->unpack_xz	(m_graph->vertex(vertex_id),x,z);
+	return				((x/m_cluster_size)*m_cluster_row_length + z/m_cluster_size);
+}
+
+void CLevelGraphHierarchy::build			()
+{
+	const CLevelGraph	&graph = *m_graph;
+	u32					vertex_count = graph.header().vertex_count();
+	m_vertex_regions.assign	(vertex_count,u32(-1));
+	m_regions.clear		();
+	m_edges.clear		();
+
+	// regions : flood fill inside the clusters
+	xr_vector<u32>		stack;
+	xr_vector<u32>		members;
+	for (u32 i=0; i<vertex_count; ++i) {
+		if (m_vertex_regions[i] != u32(-1))
+			continue;
+
+		u32				region_id = m_regions.size();
+		u32				cluster_id = cluster(i);
+		Fvector			center = Fvector().set(0.f,0.f,0.f);
+
+		members.clear_not_free	();
+		stack.push_back	(i);
+		m_vertex_regions[i]		= region_id;
+		while (!stack.empty()) {
+			u32			vertex_id = stack.back();
+			stack.pop_back		();
+			members.push_back	(vertex_id);
+			center.add	(graph.vertex_position(vertex_id));
+
+			CLevelGraph::const_iterator	I, E;
+			graph.begin	(vertex_id,I,E);
+			for ( ; I != E; ++I) {
+				u32		neighbour_id = graph.value(vertex_id,I);
+				if (!graph.valid_vertex_id(neighbour_id))
+					continue;
+				if (m_vertex_regions[neighbour_id] != u32(-1))
+					continue;
+				if (cluster(neighbour_id) != cluster_id)
+					continue;
+
+				m_vertex_regions[neighbour_id]	= region_id;
+				stack.push_back	(neighbour_id);
+			}
+		}
+
+		// representative is the member nearest to the centroid
+		center.div		(float(members.size()));
+		u32				best_vertex_id = members.front();
+		float			best_distance = flt_max;
+		xr_vector<u32>::const_iterator	I = members.begin();
+		xr_vector<u32>::const_iterator	E = members.end();
+		for ( ; I != E; ++I) {
+			float		distance = graph.vertex_position(*I).distance_to_sqr(center);
+			if (distance >= best_distance)
+				continue;
+
+			best_distance		= distance;
+			best_vertex_id		= *I;
+		}
+
+		CRegion			region;
+		region.m_position		= graph.vertex_position(best_vertex_id);
+		region.m_vertex_id		= best_vertex_id;
+		region.m_edge_offset	= 0;
+		region.m_edge_count		= 0;
+		m_regions.push_back		(region);
+	}
+
+	// abstract edges
+	typedef std::pair<u32,u32>	ADJACENCY;
+	xr_vector<ADJACENCY>	adjacency;
+	for (u32 i=0; i<vertex_count; ++i) {
+		u32				region_id = m_vertex_regions[i];
+		CLevelGraph::const_iterator	I, E;
+		graph.begin		(i,I,E);
+		for ( ; I != E; ++I) {
+			u32			neighbour_id = graph.value(i,I);
+			if (!graph.valid_vertex_id(neighbour_id))
+				continue;
+			if (m_vertex_regions[neighbour_id] == region_id)
+				continue;
+
+			adjacency.push_back	(std::make_pair(region_id,m_vertex_regions[neighbour_id]));
+		}
+	}
+
+	std::sort			(adjacency.begin(),adjacency.end());
+	adjacency.erase		(std::unique(adjacency.begin(),adjacency.end()),adjacency.end());
+
+	m_edges.resize		(adjacency.size());
+	xr_vector<ADJACENCY>::const_iterator	I = adjacency.begin();
+	xr_vector<ADJACENCY>::const_iterator	E = adjacency.end();
+	for (u32 j=0; I != E; ++I, ++j) {
+		CRegion			&region = m_regions[(*I).first];
+		if (!region.m_edge_count)
+			region.m_edge_offset	= j;
+		++region.m_edge_count;
+
+		m_edges[j].m_region_id		= (*I).second;
+		m_edges[j].m_weight			= region.m_position.distance_to(m_regions[(*I).second].m_position);
+	}
+
+	m_search.resize		(m_regions.size());
+	m_corridor.assign	(m_regions.size(),0);
+	CSearchVertex		empty = {0.f,u32(-1),0,false};
+	std::fill			(m_search.begin(),m_search.end(),empty);
+}
+
+bool CLevelGraphHierarchy::abstract_path	(u32 start_vertex_id, u32 dest_vertex_id, REGION_PATH &region_path)
+{
+	region_path.clear_not_free	();
+
+	u32					start_region_id = region(start_vertex_id);
+	u32					dest_region_id = region(dest_vertex_id);
+	const Fvector		&goal = m_regions[dest_region_id].m_position;
+
+	if (!++m_search_stamp) {
+		CSearchVertex	empty = {0.f,u32(-1),0,false};
+		std::fill		(m_search.begin(),m_search.end(),empty);
+		m_search_stamp	= 1;
+	}
+
+	std::greater<CHeapItem>	predicate;
+	m_heap.clear_not_free	();
+
+	CSearchVertex		&start = m_search[start_region_id];
+	start.m_g			= 0.f;
+	start.m_parent		= u32(-1);
+	start.m_stamp		= m_search_stamp;
+	start.m_closed		= false;
+	m_heap.push_back	(std::make_pair(m_regions[start_region_id].m_position.distance_to(goal),start_region_id));
+
+	while (!m_heap.empty()) {
+		std::pop_heap	(m_heap.begin(),m_heap.end(),predicate);
+		u32				region_id = m_heap.back().second;
+		m_heap.pop_back	();
+
+		CSearchVertex	&best = m_search[region_id];
+		if (best.m_closed)
+			continue;
+
+		best.m_closed	= true;
+		++m_statistics.m_abstract_expanded;
+
+		if (region_id == dest_region_id) {
+			for (u32 i = region_id; i != u32(-1); i = m_search[i].m_parent)
+				region_path.push_back	(i);
+			std::reverse(region_path.begin(),region_path.end());
+			return		(true);
+		}
+
+		const CRegion	&current = m_regions[region_id];
+		xr_vector<CEdge>::const_iterator	I = m_edges.begin() + current.m_edge_offset;
+		xr_vector<CEdge>::const_iterator	E = I + current.m_edge_count;
+		for ( ; I != E; ++I) {
+			float		g = best.m_g + (*I).m_weight;
+			CSearchVertex	&neighbour = m_search[(*I).m_region_id];
+			if (neighbour.m_stamp == m_search_stamp) {
+				if (neighbour.m_closed || (neighbour.m_g <= g))
+					continue;
+			}
+			else {
+				neighbour.m_stamp	= m_search_stamp;
+				neighbour.m_closed	= false;
+			}
+
+			neighbour.m_g		= g;
+			neighbour.m_parent	= region_id;
+			m_heap.push_back	(std::make_pair(g + m_regions[(*I).m_region_id].m_position.distance_to(goal),(*I).m_region_id));
+			std::push_heap		(m_heap.begin(),m_heap.end(),predicate);
+		}
+	}
+
+	return				(false);
+}
+
+bool CLevelGraphHierarchy::refine			(const REGION_PATH &region_path, u32 first_region, u32 segment_count, u32 start_vertex_id, u32 dest_vertex_id, VERTICES &vertex_path, const CParameters &parameters)
+{
+	VERIFY				(!region_path.empty());
+	VERIFY				(first_region < region_path.size());
+
+	u32					last_region = region_path.size() - 1;
+	if (first_region + segment_count < last_region)
+		last_region		= first_region + segment_count;
+
+	if (!++m_corridor_stamp) {
+		std::fill		(m_corridor.begin(),m_corridor.end(),0);
+		m_corridor_stamp= 1;
+	}
+
+	for (u32 i = first_region; i <= last_region; ++i)
+		m_corridor[region_path[i]]	= m_corridor_stamp;
+
+	u32					target_vertex_id = (last_region == region_path.size() - 1) ? dest_vertex_id : m_regions[region_path[last_region]].m_vertex_id;
+
+	CCorridorPathManager<CGraphEngine::CAlgorithm::CDataStorage>	path_manager(this);
+	bool				result = ai().graph_engine().search(*m_graph,start_vertex_id,target_vertex_id,&vertex_path,parameters,path_manager);
+	m_statistics.m_refined_expanded	+= ai().graph_engine().m_algorithm->data_storage().get_visited_node_count();
+	++m_statistics.m_refine_count;
+	return				(result);
+}
+
+bool CLevelGraphHierarchy::search			(u32 start_vertex_id, u32 dest_vertex_id, VERTICES &vertex_path, REGION_PATH &region_path, u32 segment_count, bool &complete, const CParameters &parameters)
+{
+	complete			= false;
+	if (!abstract_path(start_vertex_id,dest_vertex_id,region_path))
+		return			(false);
+
+	if (!refine(region_path,0,segment_count,start_vertex_id,dest_vertex_id,vertex_path,parameters))
+		return			(false);
+
+	complete			= (segment_count >= region_path.size() - 1);
+	return				(true);
+}
+
+bool CLevelGraphHierarchy::path				(u32 start_vertex_id, u32 dest_vertex_id, VERTICES &vertex_path, const CParameters &parameters)
+{
+	bool				complete;
+	if (!search(start_vertex_id,dest_vertex_id,vertex_path,m_region_path,default_segment_count,complete,parameters))
+		return			(false);
+
+	for (u32 first = default_segment_count; !complete; first += default_segment_count) {
+		if (!refine(m_region_path,first,default_segment_count,vertex_path.back(),dest_vertex_id,m_chunk,parameters))
+			return		(false);
+
+		vertex_path.insert	(vertex_path.end(),m_chunk.begin() + 1,m_chunk.end());
+		complete		= (first + default_segment_count >= m_region_path.size() - 1);
+	}
+
+	return				(true);
+}
+
+bool CLevelGraphHierarchy::applicable		(u32 start_vertex_id, u32 dest_vertex_id) const
+{
+	float				distance = m_graph->vertex_position(start_vertex_id).distance_to_xz(m_graph->vertex_position(dest_vertex_id));
+	return				(distance > float(min_cluster_distance*m_cluster_size)*m_graph->header().cell_size());
+}
+
+void level_graph_hierarchy_benchmark		(u32 path_count)
+{
+	if (!ai().get_level_graph()) {
+		Msg				("! there is no level graph!");
+		return;
+	}
+
+	const CLevelGraph	&graph = ai().level_graph();
+	CLevelGraphHierarchy&hierarchy = ai().level_graph_hierarchy();
+	u32					vertex_count = graph.header().vertex_count();
+	CRandom				random(0x5eed);
+	CLevelGraphHierarchy::CParameters	parameters(type_max(_dist_type),_iteration_type(-1),u32(-1));
+
+	CLevelGraphHierarchy::VERTICES		flat_path;
+	CLevelGraphHierarchy::VERTICES		chunk;
+	CLevelGraphHierarchy::VERTICES		hierarchical_path;
+	CLevelGraphHierarchy::REGION_PATH	region_path;
+
+	// only the paths both the searches completed are accumulated
+	u64					flat_expanded = 0, flat_length = 0;
+	u64					hierarchical_expanded = 0, hierarchical_length = 0;
+	u32					compared_count = 0, failed_count = 0;
+	float				flat_time = 0.f, hierarchical_time = 0.f, first_segments_time = 0.f;
+	CTimer				timer;
+
+	CLevelGraphHierarchy::CStatistics	first_segments;
+	first_segments.clear();
+
+	for (u32 i=0; i<path_count; ++i) {
+		u32				start_vertex_id, dest_vertex_id;
+		do {
+			start_vertex_id	= u32(random.randI(0x7fff)*(0x7fff + 1) + random.randI(0x7fff)) % vertex_count;
+		}
+		while (!graph.is_accessible(start_vertex_id));
+		do {
+			dest_vertex_id	= u32(random.randI(0x7fff)*(0x7fff + 1) + random.randI(0x7fff)) % vertex_count;
+		}
+		while (!graph.is_accessible(dest_vertex_id));
+
+		// flat
+		timer.Start		();
+		bool			flat_result = ai().graph_engine().search(graph,start_vertex_id,dest_vertex_id,&flat_path,parameters);
+		float			flat_path_time = timer.GetElapsed_sec();
+		u32				expanded = ai().graph_engine().m_algorithm->data_storage().get_visited_node_count();
+
+		// hierarchical : what agent pays before it can start moving
+		CLevelGraphHierarchy::CStatistics	before = hierarchy.statistics();
+		bool			complete;
+		timer.Start		();
+		bool			hierarchical_result = hierarchy.search(start_vertex_id,dest_vertex_id,chunk,region_path,CLevelGraphHierarchy::default_segment_count,complete,parameters);
+		float			first_segments_path_time = timer.GetElapsed_sec();
+		CLevelGraphHierarchy::CStatistics	after_first_segments = hierarchy.statistics();
+
+		// hierarchical : the whole path, as the level path manager searches it
+		if (hierarchical_result) {
+			timer.Start	();
+			hierarchical_result	= hierarchy.path(start_vertex_id,dest_vertex_id,hierarchical_path,parameters);
+		}
+		float			hierarchical_path_time = hierarchical_result ? timer.GetElapsed_sec() : 0.f;
+
+		if (!flat_result || !hierarchical_result) {
+			if (flat_result != hierarchical_result)
+				++failed_count;
+			continue;
+		}
+
+		++compared_count;
+		flat_time		+= flat_path_time;
+		flat_expanded	+= expanded;
+		flat_length		+= flat_path.size();
+
+		first_segments_time	+= first_segments_path_time;
+		first_segments.m_abstract_expanded	+= after_first_segments.m_abstract_expanded - before.m_abstract_expanded;
+		first_segments.m_refined_expanded	+= after_first_segments.m_refined_expanded - before.m_refined_expanded;
+
+		hierarchical_time	+= hierarchical_path_time;
+		hierarchical_expanded	+= (hierarchy.statistics().m_abstract_expanded - after_first_segments.m_abstract_expanded) + (hierarchy.statistics().m_refined_expanded - after_first_segments.m_refined_expanded);
+		hierarchical_length	+= hierarchical_path.size();
+	}
+
+	Msg					("* Hierarchical path benchmark: %d path(s), %d compared, %d failed, %d regions over %d vertices",path_count,compared_count,failed_count,hierarchy.region_count(),vertex_count);
+	if (!compared_count)
+		return;
+
+	Msg					("*   flat                  : %.1f expanded/path, %.3f ms/path",float(flat_expanded)/float(compared_count),1000.f*flat_time/float(compared_count));
+	Msg					("*   first %d segments      : %.1f abstract + %.1f refined expanded/path, %.3f ms/path",CLevelGraphHierarchy::default_segment_count,float(first_segments.m_abstract_expanded)/float(compared_count),float(first_segments.m_refined_expanded)/float(compared_count),1000.f*first_segments_time/float(compared_count));
+	Msg					("*   fully refined         : %.1f expanded/path, %.3f ms/path",float(hierarchical_expanded)/float(compared_count),1000.f*hierarchical_time/float(compared_count));
+	Msg					("*   path length (vertices): flat %.1f, hierarchical %.1f (%.1f%% longer)",float(flat_length)/float(compared_count),float(hierarchical_length)/float(compared_count),100.f*(float(hierarchical_length)/float(flat_length) - 1.f));
+}
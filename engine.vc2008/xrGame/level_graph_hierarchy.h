@@ -0,0 +1,112 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: level_graph_hierarchy.h
+//	Created 	: 16.10.2026
+//  Modified 	: 16.10.2026
+//	Description : Hierarchical (cluster/region) abstraction over the level graph
+////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "graph_engine_space.h"
+
+class CLevelGraph;
+
+// level graph is split into square clusters, every cluster into regions -
+// connected components of its vertices, regions are the abstract vertices,
+// abstract edges connect regions which have adjacent level graph vertices.
+// long paths are searched over regions and only the first few abstract segments
+// are refined into level graph vertices, every refinement search is limited to
+// the corridor of regions it has to go through;
+// the level path manager searches the long paths through it, refining them completely
+class CLevelGraphHierarchy {
+public:
+	typedef GraphEngineSpace::CBaseParameters	CParameters;
+
+	enum {
+		default_cluster_size	= 16,
+		default_segment_count	= 4,
+		// closer than this many clusters the flat search is as cheap
+		min_cluster_distance	= 4,
+	};
+
+	struct CRegion {
+		Fvector					m_position;
+		u32						m_vertex_id;
+		u32						m_edge_offset;
+		u32						m_edge_count;
+	};
+
+	struct CEdge {
+		u32						m_region_id;
+		float					m_weight;
+	};
+
+	struct CStatistics {
+		u32						m_abstract_expanded;
+		u32						m_refined_expanded;
+		u32						m_refine_count;
+
+		IC	void				clear				()	{ m_abstract_expanded = m_refined_expanded = m_refine_count = 0; }
+	};
+
+	typedef xr_vector<u32>		VERTICES;
+	typedef xr_vector<u32>		REGION_PATH;
+
+private:
+	struct CSearchVertex {
+		float					m_g;
+		u32						m_parent;
+		u32						m_stamp;
+		bool					m_closed;
+	};
+
+	typedef std::pair<float,u32>	CHeapItem;
+
+private:
+	const CLevelGraph			*m_graph;
+	u32							m_cluster_size;
+	u32							m_cluster_row_length;
+	VERTICES					m_vertex_regions;
+	xr_vector<CRegion>			m_regions;
+	xr_vector<CEdge>			m_edges;
+
+	// search state
+	xr_vector<CSearchVertex>	m_search;
+	xr_vector<CHeapItem>		m_heap;
+	xr_vector<u32>				m_corridor;
+	REGION_PATH					m_region_path;
+	VERTICES					m_chunk;
+	u32							m_search_stamp;
+	u32							m_corridor_stamp;
+	CStatistics					m_statistics;
+
+private:
+			void				build				();
+			u32					cluster				(u32 vertex_id) const;
+
+public:
+								CLevelGraphHierarchy(const CLevelGraph &graph, u32 cluster_size = default_cluster_size);
+	IC		u32					region				(u32 vertex_id) const	{ VERIFY(vertex_id < m_vertex_regions.size()); return m_vertex_regions[vertex_id]; }
+	IC		u32					region_count		() const				{ return m_regions.size(); }
+	IC		u32					edge_count			() const				{ return m_edges.size(); }
+	IC		const CRegion		&region_data		(u32 region_id) const	{ VERIFY(region_id < m_regions.size()); return m_regions[region_id]; }
+	IC		bool				in_corridor			(u32 vertex_id) const	{ return m_corridor[region(vertex_id)] == m_corridor_stamp; }
+	IC		CStatistics			&statistics			()						{ return m_statistics; }
+
+public:
+	// search over regions only
+			bool				abstract_path		(u32 start_vertex_id, u32 dest_vertex_id, REGION_PATH &region_path);
+	// refines region_path[first_region..first_region + segment_count] into level graph vertices,
+	// returns false if level graph became inaccessible in the corridor (restrictors)
+			bool				refine				(const REGION_PATH &region_path, u32 first_region, u32 segment_count, u32 start_vertex_id, u32 dest_vertex_id, VERTICES &vertex_path, const CParameters &parameters);
+	// abstract search plus refinement of the first segment_count segments,
+	// complete is false if vertex_path ends at the intermediate vertex and has to be refined later
+			bool				search				(u32 start_vertex_id, u32 dest_vertex_id, VERTICES &vertex_path, REGION_PATH &region_path, u32 segment_count, bool &complete, const CParameters &parameters);
+	// the whole path, all the segments refined; false if it is not found in the corridor,
+	// then the caller searches the flat graph
+			bool				path				(u32 start_vertex_id, u32 dest_vertex_id, VERTICES &vertex_path, const CParameters &parameters);
+	// the path is long enough to be searched through the regions
+			bool				applicable			(u32 start_vertex_id, u32 dest_vertex_id) const;
+};
+
+extern void level_graph_hierarchy_benchmark		(u32 path_count);
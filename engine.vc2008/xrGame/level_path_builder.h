@@ -11,6 +11,8 @@
 #include "movement_manager.h"
 #include "level_path_manager.h"
 #include "detail_path_builder.h"
+#include "path_request_queue.h"
+#include "restricted_object.h"
 
 class CLevelPathBuilder : public CDetailPathBuilder {
 private:
@@ -22,6 +24,7 @@ private:
 	u32							m_dest_vertex_id;
 	const Fvector				*m_precise_position;
 	u32							m_last_fail_time;
+	u32							m_request_id;
 	bool						m_extrapolate_path;
 	bool						m_use_delay_after_fail;
 
@@ -34,10 +37,16 @@ public:
 	IC						CLevelPathBuilder	(CMovementManager *object) :
 		inherited				( object ),
 		m_last_fail_time		( 0 ),
+		m_request_id			( 0 ),
 		m_use_delay_after_fail	( true )
 	{
 	}
 
+	IC						~CLevelPathBuilder	()
+	{
+		cancel_request			();
+	}
+
 	IC		const u32		&dest_vertex_id		() const
 	{
 		return					(m_dest_vertex_id);
@@ -71,6 +80,19 @@ public:
 		if ( Device.dwTimeGlobal < m_last_fail_time + time_to_wait_after_fail )
 			return;
 
+		// without restrictions nothing is marked in the level graph around the search,
+		// so it goes to the path request queue and is searched along with the others
+		if (unrestricted() && m_object->level_path().search_needed(m_start_vertex_id,m_dest_vertex_id)) {
+			cancel_request				();
+			m_request_id				= ai().graph_engine().path_requests().push(
+				m_start_vertex_id,
+				m_dest_vertex_id,
+				*m_object->level_path().evaluator(),
+				CPathRequestQueue::CALLBACK_TYPE(this,&CLevelPathBuilder::on_request)
+			);
+			return;
+		}
+
 		Device.seqParallel.push_back	(fastdelegate::FastDelegate0<>(this,&CLevelPathBuilder::process));
 	}
 
@@ -78,27 +100,9 @@ public:
 	{
 		m_object->m_wait_for_distributed_computation	= false;
 		m_object->level_path().build_path	(m_start_vertex_id,m_dest_vertex_id);
-
-		if (m_object->level_path().failed()) {
-			if ( m_use_delay_after_fail )
-				m_last_fail_time			= Device.dwTimeGlobal;
-
-			m_object->m_path_state			= CMovementManager::ePathStateBuildLevelPath;
+		if (!on_level_path())
 			return;
-		}
 
-		m_object->level_path().select_intermediate_vertex();
-		
-		m_object->m_path_state				= CMovementManager::ePathStateBuildDetailPath;
-		
-		m_object->detail().set_state_patrol_path(m_extrapolate_path);
-		m_object->detail().set_start_position(m_object->object().Position());
-		m_object->detail().set_start_direction(Fvector().setHP(-m_object->m_body.current.yaw,0));
-		
-		if (m_precise_position)
-			m_object->detail().set_dest_position(*m_precise_position);
-		
-		inherited::setup					(m_object->level_path().path(),m_object->level_path().intermediate_index());
 		inherited::process_impl				(false);
 	}
 
@@ -110,16 +114,73 @@ public:
 		m_object->build_level_path			();
 	}
 
+	// delivered at the frame sync point, the detail path is built by the secondary thread as usual
+			void			on_request			(const CPathRequestQueue::CRequest &request)
+	{
+		VERIFY								(request.m_id == m_request_id);
+		m_request_id						= 0;
+		m_object->m_wait_for_distributed_computation	= false;
+		m_object->level_path().accept_path	(m_start_vertex_id,m_dest_vertex_id,request.m_path,request.m_successful);
+		if (!on_level_path())
+			return;
+
+		inherited::register_to_process		();
+	}
+
 	IC		void			remove			()
 	{
 		if (m_object->m_wait_for_distributed_computation)
 			m_object->m_wait_for_distributed_computation	= false;
 
+		cancel_request					();
+
 		Device.remove_from_seq_parallel	(
 			fastdelegate::FastDelegate0<>(
 				this,
 				&CLevelPathBuilder::process
 			)
 		);
+		inherited::remove				();
+	}
+
+private:
+	IC		bool			unrestricted		() const
+	{
+		return					(!m_object->restrictions().in_restrictions().size() && !m_object->restrictions().out_restrictions().size());
+	}
+
+	IC		void			cancel_request		()
+	{
+		if (!m_request_id)
+			return;
+
+		ai().graph_engine().path_requests().cancel	(m_request_id);
+		m_request_id			= 0;
+	}
+
+	// false if the level path has failed
+			bool			on_level_path		()
+	{
+		if (m_object->level_path().failed()) {
+			if ( m_use_delay_after_fail )
+				m_last_fail_time			= Device.dwTimeGlobal;
+
+			m_object->m_path_state			= CMovementManager::ePathStateBuildLevelPath;
+			return							(false);
+		}
+
+		m_object->level_path().select_intermediate_vertex();
+		
+		m_object->m_path_state				= CMovementManager::ePathStateBuildDetailPath;
+		
+		m_object->detail().set_state_patrol_path(m_extrapolate_path);
+		m_object->detail().set_start_position(m_object->object().Position());
+		m_object->detail().set_start_direction(Fvector().setHP(-m_object->m_body.current.yaw,0));
+		
+		if (m_precise_position)
+			m_object->detail().set_dest_position(*m_precise_position);
+		
+		inherited::setup					(m_object->level_path().path(),m_object->level_path().intermediate_index());
+		return								(true);
 	}
 };
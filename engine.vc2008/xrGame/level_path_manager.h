@@ -50,6 +50,9 @@ public:
 	IC			bool	actual						() const;
 	IC			void	on_restrictions_change		();
 	IC			void	build_path					(const _vertex_id_type start_vertex_id, const _vertex_id_type dest_vertex_id);
+	// the search of build_path, made by the path request queue for the objects without restrictions
+	IC			bool	search_needed				(const _vertex_id_type start_vertex_id, const _vertex_id_type dest_vertex_id) const;
+	IC			void	accept_path					(const _vertex_id_type start_vertex_id, const _vertex_id_type dest_vertex_id, const xr_vector<_vertex_id_type> &path, bool successful);
 };
 
 #include "level_path_manager_inline.h"
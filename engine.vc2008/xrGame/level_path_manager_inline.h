@@ -9,6 +9,7 @@
 #pragma once
 
 #include "profiler.h"
+#include "level_graph_hierarchy.h"
 
 #define TEMPLATE_SPECIALIZATION template <\
 	typename _VertexEvaluator,\
@@ -42,8 +43,29 @@ IC	void CLevelManagerTemplate::build_path	(const _vertex_id_type start_vertex_id
 	START_PROFILE("Build Path/Level Path");
 	
 	THROW						(ai().level_graph().valid_vertex_id(start_vertex_id) && ai().level_graph().valid_vertex_id(dest_vertex_id));
-	
-	inherited::build_path		(start_vertex_id,dest_vertex_id);
+	VERIFY						(evaluator());
+
+	before_search				(start_vertex_id,dest_vertex_id);
+	if (!search_needed(start_vertex_id,dest_vertex_id))
+		m_failed				= true;
+	else {
+		// the long paths are searched through the regions,
+		// the corridor blocked by the restrictions falls back to the flat search
+		CLevelGraphHierarchy	&hierarchy = ai().level_graph_hierarchy();
+		m_failed				= true;
+		if (hierarchy.applicable(start_vertex_id,dest_vertex_id))
+			m_failed			= !hierarchy.path(start_vertex_id,dest_vertex_id,m_path,*evaluator());
+		if (m_failed)
+			m_failed			= !ai().graph_engine().search(ai().level_graph(),start_vertex_id,dest_vertex_id,&m_path,*evaluator());
+		if (m_failed) {
+			m_failed_start_vertex_id	= start_vertex_id;
+			m_failed_dest_vertex_id		= dest_vertex_id;
+		}
+	}
+	after_search				();
+	m_current_index				= _index_type(-1);
+	m_intermediate_index		= _index_type(-1);
+	m_actuality					= !failed();
 
 #ifdef DEBUG
 	if (failed()) {
@@ -54,6 +76,34 @@ IC	void CLevelManagerTemplate::build_path	(const _vertex_id_type start_vertex_id
 	STOP_PROFILE;
 }
 
+TEMPLATE_SPECIALIZATION
+IC	bool CLevelManagerTemplate::search_needed			(const _vertex_id_type start_vertex_id, const _vertex_id_type dest_vertex_id) const
+{
+	return						((m_failed_start_vertex_id != start_vertex_id) || (m_failed_dest_vertex_id != dest_vertex_id));
+}
+
+TEMPLATE_SPECIALIZATION
+IC	void CLevelManagerTemplate::accept_path			(const _vertex_id_type start_vertex_id, const _vertex_id_type dest_vertex_id, const xr_vector<_vertex_id_type> &path, bool successful)
+{
+	VERIFY						(!m_object || !m_object->applied());
+
+	m_path						= path;
+	m_failed					= !successful;
+	m_current_index				= _index_type(-1);
+	m_intermediate_index		= _index_type(-1);
+	m_actuality					= !failed();
+
+	if (!m_failed)
+		return;
+
+#ifdef DEBUG
+	Msg							("! NPC %s couldn't build path from \n~ [%d][%f][%f][%f]\n~ to\n~ [%d][%f][%f][%f]",*m_object->object().cName(),start_vertex_id,VPUSH(ai().level_graph().vertex_position(start_vertex_id)),dest_vertex_id,VPUSH(ai().level_graph().vertex_position(dest_vertex_id)));
+#endif
+
+	m_failed_start_vertex_id	= start_vertex_id;
+	m_failed_dest_vertex_id		= dest_vertex_id;
+}
+
 TEMPLATE_SPECIALIZATION
 IC	void CLevelManagerTemplate::before_search			(const _vertex_id_type start_vertex_id, const _vertex_id_type dest_vertex_id)
 {
@@ -0,0 +1,267 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: path_request_queue.cpp
+//	Created 	: 16.10.2026
+//  Modified 	: 16.10.2026
+//	Description : Batched level graph path requests, resolved concurrently
+////////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "path_request_queue.h"
+#include "ai_space.h"
+#include "level_graph.h"
+#include "object_broker.h"
+
+CPathRequestQueue::CPathRequestQueue	(u32 max_vertex_count) :
+	m_next_request		(0),
+	m_max_vertex_count	(max_vertex_count),
+	m_last_id			(0)
+{
+}
+
+CPathRequestQueue::~CPathRequestQueue	()
+{
+	Device.remove_from_seq_parallel	(
+		fastdelegate::FastDelegate0<>(
+			this,
+			&CPathRequestQueue::process
+		)
+	);
+
+	delete_data			(m_pending);
+	delete_data			(m_processing);
+	delete_data			(m_free);
+
+	CONTEXTS::iterator	I = m_contexts.begin();
+	CONTEXTS::iterator	E = m_contexts.end();
+	for ( ; I != E; ++I) {
+		xr_delete		((*I)->m_algorithm);
+		xr_delete		(*I);
+	}
+}
+
+void CPathRequestQueue::create_contexts	()
+{
+	VERIFY				(m_contexts.empty());
+
+	// every context costs a full vertex manager, so do not go wild on many-core boxes
+	u32					count = _min(TaskScheduler.worker_count() + 1, u32(max_search_context_count));
+	m_contexts.resize	(count);
+	for (u32 i=0; i<count; ++i) {
+		CSearchContext	*context = xr_new<CSearchContext>();
+		context->m_owner	= this;
+		context->m_algorithm= xr_new<CGraphEngine::CAlgorithm>(m_max_vertex_count);
+		context->m_algorithm->data_storage().set_min_bucket_value	(_dist_type(0));
+		context->m_algorithm->data_storage().set_max_bucket_value	(_dist_type(2000));
+		context->m_requests	= 0;
+		m_contexts[i]	= context;
+	}
+}
+
+u32 CPathRequestQueue::push				(const _index_type &start_vertex_id, const _index_type &dest_vertex_id, const CParameters &parameters, const CALLBACK_TYPE &callback)
+{
+	VERIFY				(ai().level_graph().valid_vertex_id(start_vertex_id));
+	VERIFY				(ai().level_graph().valid_vertex_id(dest_vertex_id));
+
+	CRequest			*request;
+	if (m_free.empty())
+		request			= xr_new<CRequest>();
+	else {
+		request			= m_free.back();
+		m_free.pop_back	();
+	}
+
+	request->m_id				= ++m_last_id;
+	request->m_start_vertex_id	= start_vertex_id;
+	request->m_dest_vertex_id	= dest_vertex_id;
+	request->m_parameters		= parameters;
+	request->m_callback			= callback;
+	request->m_successful		= false;
+	request->m_path.clear_not_free	();
+
+	m_pending.push_back	(request);
+	return				(request->m_id);
+}
+
+void CPathRequestQueue::cancel			(u32 request_id)
+{
+	REQUESTS::iterator	I = m_pending.begin();
+	REQUESTS::iterator	E = m_pending.end();
+	for ( ; I != E; ++I) {
+		if ((*I)->m_id != request_id)
+			continue;
+
+		m_free.push_back(*I);
+		m_pending.erase	(I);
+		return;
+	}
+
+	// request is being processed by the secondary thread,
+	// the only thing we can do is to not deliver it
+	I					= m_processing.begin();
+	E					= m_processing.end();
+	for ( ; I != E; ++I) {
+		if ((*I)->m_id == request_id) {
+			(*I)->m_callback.clear	();
+			return;
+		}
+	}
+}
+
+void CPathRequestQueue::deliver			()
+{
+	// secondary thread is suspended here, so all the requests in processing are resolved
+	REQUESTS::iterator	I = m_processing.begin();
+	REQUESTS::iterator	E = m_processing.end();
+	for ( ; I != E; ++I) {
+		if ((*I)->m_callback)
+			(*I)->m_callback	(**I);
+		m_free.push_back	(*I);
+	}
+	m_processing.clear_not_free	();
+
+	if (m_pending.empty())
+		return;
+
+	m_processing.swap	(m_pending);
+	Device.seqParallel.push_back	(fastdelegate::FastDelegate0<>(this,&CPathRequestQueue::process));
+}
+
+void CPathRequestQueue::process			()
+{
+	resolve				(m_processing);
+}
+
+void CPathRequestQueue::search			(CGraphEngine::CAlgorithm &algorithm, CRequest &request) const
+{
+	typedef CPathManager<
+		CLevelGraph,
+		CGraphEngine::CAlgorithm::CDataStorage,
+		CParameters,
+		_dist_type,
+		_index_type,
+		_iteration_type
+	>					CLevelPathManager;
+
+	CLevelPathManager	path_manager;
+	path_manager.setup	(
+		&ai().level_graph(),
+		&algorithm.data_storage(),
+		&request.m_path,
+		request.m_start_vertex_id,
+		request.m_dest_vertex_id,
+		request.m_parameters
+	);
+
+	request.m_successful= algorithm.find(path_manager);
+}
+
+void CPathRequestQueue::CSearchContext::process	()
+{
+	VERIFY				(m_requests);
+	REQUESTS			&requests = *m_requests;
+	LONG				count = LONG(requests.size());
+	for (;;) {
+		LONG			index = InterlockedIncrement(&m_owner->m_next_request) - 1;
+		if (index >= count)
+			break;
+
+		m_owner->search	(*m_algorithm,*requests[index]);
+	}
+}
+
+void CPathRequestQueue::resolve			(REQUESTS &requests)
+{
+	if (requests.empty())
+		return;
+
+	if (m_contexts.empty())
+		create_contexts	();
+
+	// requests are picked dynamically, so one long path does not hold back a whole chunk
+	m_next_request		= 0;
+	u32					count = _min(u32(m_contexts.size()),u32(requests.size()));
+	for (u32 i=0; i<count; ++i) {
+		m_contexts[i]->m_requests	= &requests;
+		TaskScheduler.push	(m_group,fastdelegate::FastDelegate0<>(m_contexts[i],&CSearchContext::process));
+	}
+	TaskScheduler.wait	(m_group);
+}
+
+CPathRequestQueue &CGraphEngine::path_requests	()
+{
+	if (!m_path_requests)
+		m_path_requests	= xr_new<CPathRequestQueue>(m_max_vertex_count);
+
+	return				(*m_path_requests);
+}
+
+void CGraphEngine::destroy_path_requests		()
+{
+	xr_delete			(m_path_requests);
+}
+
+void path_request_queue_benchmark		(u32 path_count)
+{
+	if (!ai().get_level_graph()) {
+		Msg				("! there is no level graph!");
+		return;
+	}
+
+	typedef CPathRequestQueue::CRequest		CRequest;
+	typedef CPathRequestQueue::REQUESTS		REQUESTS;
+
+	const CLevelGraph	&graph = ai().level_graph();
+	u32					vertex_count = graph.header().vertex_count();
+	CRandom				random(0x5eed);
+
+	xr_vector<CRequest>	requests(path_count);
+	REQUESTS			batch(path_count);
+	for (u32 i=0; i<path_count; ++i) {
+		CRequest		&request = requests[i];
+		do {
+			request.m_start_vertex_id	= u32(random.randI(0x7fff)*(0x7fff + 1) + random.randI(0x7fff)) % vertex_count;
+		}
+		while (!graph.is_accessible(request.m_start_vertex_id));
+		do {
+			request.m_dest_vertex_id	= u32(random.randI(0x7fff)*(0x7fff + 1) + random.randI(0x7fff)) % vertex_count;
+		}
+		while (!graph.is_accessible(request.m_dest_vertex_id));
+		request.m_id	= i;
+		request.m_successful			= false;
+		batch[i]		= &request;
+	}
+
+	// serial : the shared graph engine, one path at a time
+	xr_vector<u32>		serial_lengths(path_count);
+	xr_vector<bool>		serial_results(path_count);
+	xr_vector<_index_type>	path;
+	CTimer				timer;
+	timer.Start			();
+	for (u32 i=0; i<path_count; ++i) {
+		serial_results[i]	= ai().graph_engine().search(graph,requests[i].m_start_vertex_id,requests[i].m_dest_vertex_id,&path,requests[i].m_parameters);
+		serial_lengths[i]	= path.size();
+	}
+	float				serial_time = timer.GetElapsed_sec();
+
+	// batched : per-thread search contexts
+	CPathRequestQueue	queue(vertex_count);
+	queue.resolve		(batch);	// warm up : contexts are allocated on the first batch
+	timer.Start			();
+	queue.resolve		(batch);
+	float				batch_time = timer.GetElapsed_sec();
+
+	u32					mismatch_count = 0;
+	u32					success_count = 0;
+	for (u32 i=0; i<path_count; ++i) {
+		if (serial_results[i])
+			++success_count;
+		if ((serial_results[i] != requests[i].m_successful) || (serial_results[i] && (serial_lengths[i] != requests[i].m_path.size())))
+			++mismatch_count;
+	}
+
+	Msg					("* Path benchmark: %d path(s), %d found, %d vertices in level graph, %d task worker(s)",path_count,success_count,vertex_count,TaskScheduler.worker_count());
+	Msg					("*   serial  : %.3f s, %.1f paths/s",serial_time,serial_time > 0.f ? float(path_count)/serial_time : 0.f);
+	Msg					("*   batched : %.3f s, %.1f paths/s",batch_time,batch_time > 0.f ? float(path_count)/batch_time : 0.f);
+	if (mismatch_count)
+		Msg				("! %d path(s) differ from the serial search",mismatch_count);
+}
@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////
+//	Module 		: path_request_queue.h
+//	Created 	: 16.10.2026
+//  Modified 	: 16.10.2026
+//	Description : Batched level graph path requests, resolved concurrently
+////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "graph_engine.h"
+#include "../xrCore/task_scheduler.h"
+
+// requests are pushed during the frame, handed to the secondary thread at the
+// frame sync point (deliver), searched there in parallel by all the task workers,
+// each with its own vertex manager/allocator/priority queue,
+// and delivered back to their owners at the next frame sync point;
+// CLevelPathBuilder sends here the level paths of the objects without restrictions,
+// the restricted ones mark their borders in the level graph and stay on the shared engine
+class CPathRequestQueue {
+public:
+	typedef SBaseParameters<
+		_dist_type,
+		_index_type,
+		_iteration_type
+	>													CParameters;
+
+	struct CRequest;
+	typedef fastdelegate::FastDelegate1<const CRequest&>	CALLBACK_TYPE;
+
+	struct CRequest {
+		u32						m_id;
+		_index_type				m_start_vertex_id;
+		_index_type				m_dest_vertex_id;
+		CParameters				m_parameters;
+		CALLBACK_TYPE			m_callback;
+		xr_vector<_index_type>	m_path;
+		bool					m_successful;
+	};
+
+	typedef xr_vector<CRequest*>						REQUESTS;
+
+private:
+	struct CSearchContext {
+		CPathRequestQueue		*m_owner;
+		CGraphEngine::CAlgorithm*m_algorithm;
+		REQUESTS				*m_requests;
+
+		void					process				();
+	};
+
+	typedef xr_vector<CSearchContext*>					CONTEXTS;
+
+private:
+	enum {
+		max_search_context_count	= 8,
+	};
+
+private:
+	REQUESTS					m_pending;
+	REQUESTS					m_processing;
+	REQUESTS					m_free;
+	CONTEXTS					m_contexts;
+	task_group					m_group;
+	volatile LONG				m_next_request;
+	u32							m_max_vertex_count;
+	u32							m_last_id;
+
+private:
+			void				create_contexts		();
+			void				search				(CGraphEngine::CAlgorithm &algorithm, CRequest &request) const;
+			void				process				();
+
+public:
+								CPathRequestQueue	(u32 max_vertex_count);
+								~CPathRequestQueue	();
+			u32					push				(const _index_type &start_vertex_id, const _index_type &dest_vertex_id, const CParameters &parameters, const CALLBACK_TYPE &callback);
+			void				cancel				(u32 request_id);
+	// frame sync point, must be called from the primary thread, while secondary one is suspended
+			void				deliver				();
+	// resolves requests right now on the calling thread plus all the task workers
+			void				resolve				(REQUESTS &requests);
+	IC		bool				empty				() const	{ return m_pending.empty() && m_processing.empty(); }
+};
+
+extern void path_request_queue_benchmark		(u32 path_count);
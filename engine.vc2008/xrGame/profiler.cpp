@@ -49,6 +49,7 @@ CProfiler::CProfiler				()
 #endif // PROFILE_CRITICAL_SECTIONS
 {
 	m_actual							= true;
+	m_section.set_name					("CProfiler::m_section");
 }
 
 CProfiler::~CProfiler				()
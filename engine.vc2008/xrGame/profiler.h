@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "../xrCore/trace_profiler.h"
+
 #ifdef XRGAME_EXPORTS
 #	ifdef DEBUG
 #		define	USE_PROFILER
@@ -82,12 +84,12 @@ extern Flags32 psAI_Flags;
 
 IC	CProfiler&	profiler();
 		
-#	define START_PROFILE(a) { CProfilePortion	__profile_portion__(a);
+#	define START_PROFILE(a) { CProfilePortion	__profile_portion__(a); trace_zone __trace_zone__(a);
 #	define STOP_PROFILE     }
 
 #	include "profiler_inline.h"
 
 #else // DEBUG
-#	define START_PROFILE(a) {
+#	define START_PROFILE(a) { trace_zone __trace_zone__(a);
 #	define STOP_PROFILE		}
 #endif // DEBUG
\ No newline at end of file
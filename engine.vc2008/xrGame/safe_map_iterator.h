@@ -33,17 +33,18 @@ protected:
 protected:
 	IC		void			update_next			();
 	IC		_iterator		&next				();
-	IC		void			start_timer			();
-	IC		bool			time_over			();
 
 public:
 	IC						CSafeMapIterator	();
 	virtual					~CSafeMapIterator	();
 	IC		void			add					(const _key_type &id, _data_type *value, bool no_assert = false);
 	IC		void			remove				(const _key_type &id, bool no_assert = false);
+	// restart_timer is false if the process time is already counted from the caller's start_timer
 	template <typename _update_predicate>
-	IC		u32				update				(const _update_predicate &predicate, bool const iterate_as_first_time_next_time);
+	IC		u32				update				(const _update_predicate &predicate, bool const iterate_as_first_time_next_time, bool const restart_timer = true);
 	IC		void			set_process_time	(const float &process_time);
+	IC		void			start_timer			();
+	IC		bool			time_over			();
 	IC		const _REGISTRY	&objects			() const;
 	IC		void			clear				();
 	IC		bool			empty				() const;
@@ -113,12 +113,13 @@ IC	const typename CSSafeMapIterator::_REGISTRY	&CSSafeMapIterator::objects	() co
 
 TEMPLATE_SPEZIALIZATION
 template <typename _update_predicate>
-IC	u32 CSSafeMapIterator::update				(const _update_predicate &predicate, bool const iterate_as_first_time_next_time )
+IC	u32 CSSafeMapIterator::update				(const _update_predicate &predicate, bool const iterate_as_first_time_next_time, bool const restart_timer)
 {
 	if (empty())
 		return			(0);
 
-	start_timer			();
+	if (restart_timer)
+		start_timer		();
 	++m_cycle_count;
 	_iterator			I = next();
 	VERIFY				(I != m_objects.end());
@@ -16,6 +16,7 @@
 #include "alife_simulator_header.h"
 #include "alife_simulator.h"
 #include "alife_spawn_registry.h"
+#include "alife_save_stream.h"
 
 extern LPCSTR alife_section;
 
@@ -76,9 +77,8 @@ CSavedGameWrapper::CSavedGameWrapper			(LPCSTR saved_game_name)
 		return;
 	}
 
-	u32							source_count = stream->r_u32();
-	void						*source_data = xr_malloc(source_count);
-	rtc_decompress				(source_data,source_count,stream->pointer(),stream->length() - 3*sizeof(u32));
+	u32							source_count;
+	void						*source_data = CALifeSaveReader::decompress(*stream,source_count);
 	FS.r_close					(stream);
 
 	IReader						reader(source_data,source_count);
@@ -35,6 +35,8 @@ enum enum_traffic_optimization
 	eto_ppmd_compression	=	1 << 0,
 	eto_lzo_compression		=	1 << 1,
 	eto_last_change			=	1 << 2,
+	eto_client_relevance	=	1 << 3,
+	eto_delta_baselines		=	1 << 4,
 };//enum enum_traffic_optimization
 
 extern u32	g_sv_traffic_optimization_level;
@@ -14,12 +14,14 @@
 #include "../xrEngine/IGame_Persistent.h"
 #include "string_table.h"
 #include "object_broker.h"
+#include "object_factory.h"
 
 #include "../xrEngine/XR_IOConsole.h"
 #include "ui/UIInventoryUtilities.h"
 #include "file_transfer.h"
 #include "screenshot_server.h"
 #include "xrServer_info.h"
+#include "xrServer_load_profile.h"
 #include "stl/_function.h"
 
 #pragma warning(push)
@@ -45,6 +47,7 @@ void	xrClientData::Clear()
 	m_ping_warn.m_maxPingWarnings			= 0;
 	m_ping_warn.m_dwLastMaxPingWarningTime	= 0;
 	m_admin_rights.m_has_admin_rights		= FALSE;
+	m_update_baselines.reset				();
 };
 
 
@@ -62,6 +65,7 @@ xrServer::xrServer() : IPureServer(Device.GetTimerGlobal(), g_dedicated_server)
 	m_server_rules		= NULL;
 	m_last_updates_size	= 0;
 	m_last_update_time	= 0;
+	m_load_profile		= NULL;
 }
 
 xrServer::~xrServer()
@@ -82,6 +86,7 @@ xrServer::~xrServer()
 	m_aDelayedPackets.clear();
 	entities.clear();
 	delete_data(m_info_uploaders);
+	delete_data(m_update_write_ranges);
 	xr_delete(m_server_logo);
 	xr_delete(m_server_rules);
 }
@@ -206,11 +211,20 @@ int	g_Dump_Update_Write = 0;
 INT g_sv_SendUpdate = 0;
 #endif
 
+void xrServer::SetLoadProfile(server_load_profile* profile)
+{
+	csMessage.Enter		();
+	m_load_profile		= profile;
+	csMessage.Leave		();
+}
+
 void xrServer::Update	()
 {
 	if (Level().IsDemoPlayStarted() || Level().IsDemoPlayFinished())
 		return;								//diabling server when demo is playing
 
+	server_load_profile* const	load_profile = m_load_profile;
+	u64 const		tick_start = load_profile ? CPU::QPC() : 0;
 	NET_Packet		Packet;
 
 	VERIFY						(verify_entities());
@@ -255,6 +269,9 @@ void xrServer::Update	()
 	{
 		UpdateBannedList();
 	}
+
+	if (load_profile)
+		load_profile->add_tick		(CPU::QPC() - tick_start);
 }
 
 void _stdcall xrServer::SendGameUpdateTo(IClient* client)
@@ -282,13 +299,35 @@ void _stdcall xrServer::SendGameUpdateTo(IClient* client)
 	SendTo					(xr_client->ID, Packet, net_flags(FALSE,TRUE));
 }
 
-void xrServer::MakeUpdatePackets()
+void xrServer::update_write_range::process()
 {
-	NET_Packet						tmpPacket;			
-	u32								position;
+	NET_Packet						tmpPacket;
+	sizes.clear						();
+	data.clear						();
+	for (update_entity const* I = first; I != last; ++I)
+	{
+		if (I->script)
+		{
+			sizes.push_back				(0);
+			continue;
+		}
 
-	m_updator.begin_updates			();
-	
+		tmpPacket.write_start			();
+		I->entity->UPDATE_Write			(tmpPacket);
+		u32 const ObjectSize			= tmpPacket.w_tell();
+		VERIFY							(ObjectSize < 256);
+		sizes.push_back					(u8(ObjectSize));
+		data.insert						(data.end(), tmpPacket.B.data, tmpPacket.B.data + ObjectSize);
+	}
+}
+
+void xrServer::MakeUpdateSnapshot()
+{
+	NET_Packet						tmpPacket;
+
+	m_update_snapshot.begin			();
+
+	m_update_entities.clear			();
 	xrS_entities::iterator I	= entities.begin();
 	xrS_entities::iterator E	= entities.end();
 	for (; I!=E; ++I)
@@ -300,36 +339,160 @@ void xrServer::MakeUpdatePackets()
 		if (Test.s_flags.is(M_SPAWN_OBJECT_PHANTOM))	continue;	// Surely: phantom
 		if (!Test.Net_Relevant() )						continue;
 
-		tmpPacket.B.count				= 0;
-		// write specific data
+		update_entity	entity;
+		entity.entity					= &Test;
+		entity.script					= object_factory().script_class(Test.m_tClassID);
+		m_update_entities.push_back		(entity);
+	}
+	if (m_update_entities.empty())
+		return;
+
+	// write specific data
+	u32 const		range_count		= _min(u32(m_update_entities.size()), TaskScheduler.worker_count() + 1);
+	while (m_update_write_ranges.size() < range_count)
+		m_update_write_ranges.push_back	(xr_new<update_write_range>());
+
+	update_entity const*	first	= &*m_update_entities.begin();
+	u32 const		entity_count	= m_update_entities.size();
+	for (u32 i = 0; i < range_count; ++i)
+	{
+		update_write_range&	range		= *m_update_write_ranges[i];
+		range.first						= first + entity_count*i/range_count;
+		range.last						= first + entity_count*(i + 1)/range_count;
+		TaskScheduler.push				(m_update_write_tasks, task_group::delegate_type(&range, &update_write_range::process));
+	}
+	TaskScheduler.wait				(m_update_write_tasks);
+
+	// in the order of the entities
+	for (u32 i = 0; i < range_count; ++i)
+	{
+		update_write_range const&	range	= *m_update_write_ranges[i];
+		u8 const*		data			= range.data.empty() ? NULL : &*range.data.begin();
+		for (update_entity const* J = range.first; J != range.last; ++J)
 		{
-			tmpPacket.w_u16					(Test.ID);
-			tmpPacket.w_chunk_open8			(position);
-			Test.UPDATE_Write				(tmpPacket);
-			u32 ObjectSize					= u32(tmpPacket.w_tell()-position)-sizeof(u8);
-			tmpPacket.w_chunk_close8		(position);
+			CSE_Abstract&	Test		= *J->entity;
+			u32 ObjectSize				= range.sizes[J - range.first];
+			u8 const*		update		= data;
+			data						+= ObjectSize;
+			if (J->script)
+			{
+				tmpPacket.write_start	();
+				Test.UPDATE_Write		(tmpPacket);
+				ObjectSize				= tmpPacket.w_tell();
+				update					= tmpPacket.B.data;
+			}
 
-			if (ObjectSize == 0)			continue;					
+			if (ObjectSize == 0)		continue;
+			VERIFY						(ObjectSize < 256);
 #ifdef DEBUG
 			if (g_Dump_Update_Write) Msg("* %s : %d", Test.name(), ObjectSize);
 #endif
-			m_updator.write_update_for		(Test.ID, tmpPacket);
+			// the items are as relevant as the ones holding them
+			CSE_Abstract*	root		= &Test;
+			while (root->ID_Parent != 0xffff)
+			{
+				CSE_Abstract*	parent	= ID_to_entity(root->ID_Parent);
+				if (!parent)			break;
+				root					= parent;
+			}
+
+			// the entities of level.spawn have no owner till a client connects : they are the server's
+			xrClientData*	owner		= Test.owner;
+			bool const		player		= owner && (owner != GetServerClient()) && (owner->owner == &Test);
+			u8 const		team		= (player && owner->ps) ? owner->ps->team : u8(-1);
+			u32 const		owner_id	= owner ? owner->ID.value() : 0;
+			m_update_snapshot.add		(Test.ID, root->o_Position, owner_id, player, team, update, u8(ObjectSize));
 		}
-	}//all entities
+	}
+}
+
+void xrServer::MakeUpdatePackets()
+{
+	NET_Packet						tmpPacket;
+
+	m_updator.begin_updates			();
+
+	typedef client_updates::update_snapshot::entities_t	snapshot_entities_t;
+	snapshot_entities_t::const_iterator	I = m_update_snapshot.entities().begin();
+	snapshot_entities_t::const_iterator	E = m_update_snapshot.entities().end();
+	for (; I!=E; ++I)
+	{
+		tmpPacket.write_start		();
+		tmpPacket.w_u16				(I->id);
+		tmpPacket.w_u8				(I->size);
+		tmpPacket.w					(m_update_snapshot.data(*I), I->size);
+		m_updator.write_update_for	(I->id, tmpPacket);
+	}
 
 	m_updator.end_updates			(m_update_begin, m_update_end);
 }
 
+void _stdcall xrServer::AddClientUpdateTarget(IClient* client)
+{
+	xrClientData*	xr_client = static_cast<xrClientData*>(client);
+	VERIFY			(xr_client);
+	if ((client == GetServerClient()) || !client->flags.bConnected)
+		return;
+
+	client_updates::update_streams::target	target;
+	target.baselines				= &xr_client->m_update_baselines;
+	target.viewer.set				(
+		client->ID.value(),
+		xr_client->owner ? &xr_client->owner->o_Position : NULL,
+		xr_client->ps ? xr_client->ps->team : u8(-1)
+	);
+	m_update_targets.push_back		(target);
+	m_update_target_ids.push_back	(client->ID);
+}
+
+void xrServer::SendClientUpdates()
+{
+	// the acknowledgements change the baselines : M_CL_UPDATES_ACK is handled in OnMessage,
+	// under csMessage, so the targets, the baselines and the sends are all under it here
+	csMessage.Enter					();
+
+	m_update_targets.clear			();
+	m_update_target_ids.clear		();
+	fastdelegate::FastDelegate1<IClient*,void> addtargetfd;
+	addtargetfd.bind				(this, &xrServer::AddClientUpdateTarget);
+	ForEachClientDo					(addtargetfd);
+
+	client_updates::stream_statistics	statistics;
+	statistics.clear				();
+	m_update_streams.write			(m_update_snapshot, m_update_targets, statistics);
+
+	for (u32 i = 0; i < m_update_target_ids.size(); ++i)
+	{
+		client_updates::update_streams::stream	s = m_update_streams.get(i);
+		if (!s.records)
+			continue;
+
+		for (; s.begin != s.end; ++s.begin)
+		{
+			m_last_updates_size		+= (*s.begin)->B.count;
+			SendTo					(m_update_target_ids[i], **s.begin, net_flags(FALSE,TRUE));
+		}
+	}
+
+	csMessage.Leave					();
+}
+
 void xrServer::SendUpdatePacketsToAll()
 {
-	m_last_updates_size = 0;
+	bool const broadcast = !client_updates::enabled();
+	if (broadcast)
+		m_last_updates_size = 0;
+
 	for (update_iterator_t i = m_update_begin; i != m_update_end; ++i)
 	{
 		NET_Packet& to_send = **i;
 		if (to_send.B.count > 2)
 		{
-			m_last_updates_size += to_send.B.count;
-			SendBroadcast	(GetServerClient()->ID, to_send, net_flags(FALSE,TRUE));
+			if (broadcast)
+			{
+				m_last_updates_size += to_send.B.count;
+				SendBroadcast	(GetServerClient()->ID, to_send, net_flags(FALSE,TRUE));
+			}
 			if (Level().IsDemoSave())
 			{
 				Level().SavePacket(to_send);
@@ -353,8 +516,19 @@ void xrServer::SendUpdatesToAll()
 
 	if ((Device.dwTimeGlobal - m_last_update_time) >= u32(1000/psNET_ServerUpdate))
 	{
-		MakeUpdatePackets				();
-		SendUpdatePacketsToAll			();
+		MakeUpdateSnapshot				();
+		if (client_updates::enabled())
+		{
+			m_last_updates_size			= 0;
+			SendClientUpdates			();
+		}
+		// the demos keep the stream every client gets without the per-client updates
+		if (!client_updates::enabled() || Level().IsDemoSave())
+		{
+			MakeUpdatePackets			();
+			SendUpdatePacketsToAll		();
+		}
+		m_update_snapshot.end			();
 
 #ifdef DEBUG
 		g_sv_SendUpdate = 0;
@@ -460,7 +634,10 @@ u32 xrServer::OnMessage	(NET_Packet& P, ClientID sender)			// Non-Zero means bro
 	{
 	case M_UPDATE:	
 		{
+			u64 const start			= m_load_profile ? CPU::QPC() : 0;
 			Process_update			(P,sender);						// No broadcast
+			if (m_load_profile)
+				m_load_profile->add_message	(M_UPDATE, 0, CPU::QPC() - start);
 			VERIFY					(verify_entities());
 		}break;
 	case M_SPAWN:	
@@ -472,7 +649,17 @@ u32 xrServer::OnMessage	(NET_Packet& P, ClientID sender)			// Non-Zero means bro
 		}break;
 	case M_EVENT:	
 		{
-			Process_event			(P,sender);
+			if (m_load_profile)
+			{
+				// u32 timestamp, u16 event type
+				u16 event_type		= 0;
+				if (P.r_tell() + sizeof(u32) + sizeof(u16) <= P.B.count)
+					CopyMemory		(&event_type, P.B.data + P.r_tell() + sizeof(u32), sizeof(event_type));
+				u64 const start		= CPU::QPC();
+				Process_event		(P,sender);
+				m_load_profile->add_message	(M_EVENT, event_type, CPU::QPC() - start);
+			}else
+				Process_event		(P,sender);
 			VERIFY					(verify_entities());
 		}break;
 	case M_EVENT_PACK:
@@ -502,6 +689,11 @@ u32 xrServer::OnMessage	(NET_Packet& P, ClientID sender)			// Non-Zero means bro
 				SendTo	(SV_Client->ID, P, net_flags(TRUE, TRUE));
 			VERIFY					(verify_entities());
 		}break;
+	case M_CL_UPDATES_ACK:
+		{
+			if (!CL)				break;
+			CL->m_update_baselines.acknowledge(P);
+		}break;
 	case M_MOVE_PLAYERS_RESPOND:
 		{
 			xrClientData* CL		= ID_to_client	(sender);
@@ -782,6 +974,8 @@ if( dbg_net_Draw_Flags.test( dbg_destroy ) )
 #endif
 	R_ASSERT					(P);
 	entities.erase				(P->ID);
+	if (client_updates::enabled())
+		m_update_snapshot.destroyed	(P->ID);
 	m_tID_Generator.vfFreeID	(P->ID,Device.TimerAsync());
 
 	if(P->owner && P->owner->owner==P)
@@ -13,6 +13,7 @@
 #include "../xrEngine/mp_logging.h"
 #include "secure_messaging.h"
 #include "xrServer_updates_compressor.h"
+#include "xrServer_client_updates.h"
 #include "xrClientsPool.h"
 
 #ifdef DEBUG
@@ -21,6 +22,7 @@
 
 
 class CSE_Abstract;
+class server_load_profile;
 
 const u32	NET_Latency		= 50;		// time in (ms)
 
@@ -51,6 +53,8 @@ public:
 	secure_messaging::key_t		m_secret_key;
 	s32							m_last_key_sync_request_seed;
 
+	client_updates::update_baselines	m_update_baselines;
+
 							xrClientData			();
 	virtual					~xrClientData			();
 	virtual void			Clear					();
@@ -97,11 +101,41 @@ private:
 	update_iterator_t			m_update_begin;
 	update_iterator_t			m_update_end;
 	server_updates_compressor	m_updator;
+	client_updates::update_snapshot	m_update_snapshot;
+	client_updates::update_streams	m_update_streams;
+	client_updates::update_streams::targets_t	m_update_targets;
+	xr_vector<ClientID>			m_update_target_ids;
+
+	// UPDATE_Write of the entities runs on the task workers, a range of the entities each,
+	// the ones created by the scripts are written on the server thread
+	struct update_entity
+	{
+		CSE_Abstract*			entity;
+		bool					script;
+	};
+	typedef xr_vector<update_entity>	update_entities_t;
+	struct update_write_range
+	{
+		update_entity const*	first;
+		update_entity const*	last;
+		xr_vector<u8>			sizes;
+		xr_vector<u8>			data;
+
+		void					process						();
+	};
+	typedef xr_vector<update_write_range*>	update_write_ranges_t;
+	update_entities_t			m_update_entities;
+	update_write_ranges_t		m_update_write_ranges;
+	task_group					m_update_write_tasks;
 	
+	void						MakeUpdateSnapshot			();
 	void						MakeUpdatePackets			();
 	void						SendUpdatePacketsToAll		();
+	void	_stdcall			AddClientUpdateTarget		(IClient* client);
+	void						SendClientUpdates			();
 	u32							m_last_updates_size;
 	u32							m_last_update_time;
+	server_load_profile*		m_load_profile;
 	
 	
 	void						SendServerInfoToClient		(ClientID const & new_client);
@@ -249,6 +283,8 @@ public:
 	u32						GetEntitiesNum		()			{ return entities.size(); };
 	CSE_Abstract*			GetEntity			(u32 Num);
 	u32 const				GetLastUpdatesSize	() const { return m_last_updates_size; };
+	// the ticks and the client messages are timed into the profile till it is reset to NULL
+	void					SetLoadProfile		(server_load_profile* profile);
 
 	xrClientData*			ID_to_client		(ClientID ID, bool ScanAll = false ) { return (xrClientData*)(IPureServer::ID_to_client( ID, ScanAll)); }
 	CSE_Abstract*			ID_to_entity		(u16 ID);
@@ -0,0 +1,615 @@
+#include "stdafx.h"
+#include "xrServer_client_updates.h"
+#include "xrServer_updates_compressor.h"
+#include "../xrCore/ppmd_compressor.h"
+#include "../xrServerEntities/object_broker.h"
+
+namespace client_updates {
+
+// the relevance grid : the entities in the cells around the viewer's one are sent with every update,
+// the farther ones with every 2nd, 4th and 8th update
+static float const	cell_size	= 50.f;
+
+bool enabled()
+{
+	return !!(g_sv_traffic_optimization_level & (eto_client_relevance | eto_delta_baselines));
+}
+
+update_snapshot::update_snapshot() :
+	m_sequence(0)
+{
+	for (u32 i = 0; i < snapshot_depth; ++i)
+		m_frames[i].valid = false;
+}
+
+void update_snapshot::begin()
+{
+	++m_sequence;
+	frame & current	= m_frames[m_sequence % snapshot_depth];
+	current.sequence= m_sequence;
+	current.valid	= true;
+	current.entities.clear();
+	current.data.clear();
+}
+
+u8 const * update_snapshot::data(u16 const sequence, u32 const offset) const
+{
+	frame const & result = m_frames[sequence % snapshot_depth];
+	if (!result.valid || (result.sequence != sequence))
+		return NULL;
+	return &*result.data.begin() + offset;
+}
+
+void update_snapshot::add(u16 const id,
+						  Fvector const & position,
+						  u32 const owner,
+						  bool const player,
+						  u8 const team,
+						  void const * data,
+						  u8 const size)
+{
+	VERIFY			(size);
+	frame & current	= m_frames[m_sequence % snapshot_depth];
+	current.entities.push_back(entity());
+	entity & result	= current.entities.back();
+	result.id		= id;
+	result.size		= size;
+	result.team		= team;
+	result.player	= player;
+	result.owner	= owner;
+	result.offset	= current.data.size();
+	result.cell_x	= iFloor(position.x / cell_size);
+	result.cell_z	= iFloor(position.z / cell_size);
+	current.data.insert(current.data.end(), static_cast<u8 const*>(data), static_cast<u8 const*>(data) + size);
+}
+
+void update_viewer::set(u32 const client, Fvector const * position, u8 const client_team)
+{
+	owner			= client;
+	team			= client_team;
+	positioned		= !!position;
+	cell_x			= position ? iFloor(position->x / cell_size) : 0;
+	cell_z			= position ? iFloor(position->z / cell_size) : 0;
+}
+
+u32 update_period(update_viewer const & viewer, update_snapshot::entity const & entity)
+{
+	if (!(g_sv_traffic_optimization_level & eto_client_relevance))
+		return 1;
+
+	//spectators and the clients being spawned
+	if (!viewer.positioned)
+		return 1;
+
+	if (entity.owner == viewer.owner)
+		return 1;
+
+	if (entity.player && (entity.team == viewer.team))
+		return 1;
+
+	int const ring = _max(_abs(entity.cell_x - viewer.cell_x), _abs(entity.cell_z - viewer.cell_z));
+	if (ring <= 1)
+		return 1;
+	if (ring <= 3)
+		return 2;
+	if (ring <= 7)
+		return 4;
+	return 8;
+}
+
+update_baselines::update_baselines()
+{
+	m_acknowledged	= false;
+	m_ack_sequence	= 0;
+	m_ack_mask		= 0;
+}
+
+update_baselines::~update_baselines()
+{
+	delete_data		(m_entities);
+}
+
+void update_baselines::reset()
+{
+	delete_data		(m_entities);
+	m_acknowledged	= false;
+	m_ack_sequence	= 0;
+	m_ack_mask		= 0;
+}
+
+void update_baselines::acknowledge(NET_Packet & P)
+{
+	u16 sequence;
+	P.r_u16			(sequence);
+	u32 const mask	= P.r_u32();
+
+	//the client has failed to decode something : starting over with the full updates
+	if (P.r_u8())
+	{
+		reset		();
+		return;
+	}
+
+	if (!m_acknowledged || (s16(sequence - m_ack_sequence) > 0))
+	{
+		m_acknowledged	= true;
+		m_ack_sequence	= sequence;
+		m_ack_mask		= mask;
+	} else if (sequence == m_ack_sequence)
+	{
+		m_ack_mask		|= mask;
+	}
+}
+
+bool update_baselines::acknowledged(u16 const sequence) const
+{
+	if (!m_acknowledged)
+		return false;
+
+	u16 const distance = static_cast<u16>(m_ack_sequence - sequence);
+	if (!distance)
+		return true;
+
+	if (distance > 32)
+		return false;
+
+	return !!(m_ack_mask & (u32(1) << (distance - 1)));
+}
+
+u8 const* update_baselines::baseline(update_snapshot const & snapshot,
+									 entity_history & history,
+									 u8 const size)
+{
+	//the newest acknowledged update becomes the baseline, the ones sent before it are of no use anymore
+	for (u32 i = 0; i < pending_depth; ++i)
+	{
+		sent_update const & update = history.pending[i];
+		if (!update.valid || !acknowledged(update.sequence))
+			continue;
+
+		if (!history.baseline.valid || (s16(update.sequence - history.baseline.sequence) > 0))
+			history.baseline = update;
+	}
+
+	sent_update const & result = history.baseline;
+	if (!result.valid)
+		return NULL;
+
+	for (u32 i = 0; i < pending_depth; ++i)
+	{
+		sent_update & update = history.pending[i];
+		if (update.valid && (s16(update.sequence - result.sequence) <= 0))
+			update.valid = false;
+	}
+
+	if (result.size != size)
+		return NULL;
+
+	//the client may have replaced it with the updates sent after it
+	if (history.sends - result.send >= receiver_depth)
+		return NULL;
+
+	return snapshot.data(result.sequence, result.offset);
+}
+
+void update_baselines::forget(u16 const id)
+{
+	if (id < m_entities.size())
+		xr_delete	(m_entities[id]);
+}
+
+u32 update_baselines::write(update_snapshot const & snapshot,
+							update_viewer const & viewer,
+							server_updates_compressor & compressor,
+							stream_statistics & statistics)
+{
+	update_snapshot::ids_t::const_iterator	di = snapshot.destroyed_ids().begin();
+	update_snapshot::ids_t::const_iterator	de = snapshot.destroyed_ids().end();
+	for (; di != de; ++di)
+		forget		(*di);
+
+	bool const	deltas			= !!(g_sv_traffic_optimization_level & eto_delta_baselines);
+	bool const	skip_unchanged	= !!(g_sv_traffic_optimization_level & eto_last_change);
+	u16 const	sequence		= snapshot.sequence();
+	u32			result			= 0;
+	NET_Packet	record;
+	u8			mask[32];
+	u8			changed[255];
+
+	update_snapshot::entities_t::const_iterator	i = snapshot.entities().begin();
+	update_snapshot::entities_t::const_iterator	e = snapshot.entities().end();
+	for (; i != e; ++i)
+	{
+		update_snapshot::entity const & entity = *i;
+		u32 const period = update_period(viewer, entity);
+		if ((sequence + entity.id) & (period - 1))
+		{
+			++statistics.irrelevant;
+			continue;
+		}
+
+		u8 const*	data	= snapshot.data(entity);
+		u8 const	size	= entity.size;
+		record.write_start	();
+		record.w_u16		(entity.id);
+		record.w_u8			(size);
+
+		entity_history*	history	= NULL;
+		u8 const*		base	= NULL;
+		if (deltas)
+		{
+			if (entity.id >= m_entities.size())
+				m_entities.resize(entity.id + 1, NULL);
+
+			history = m_entities[entity.id];
+			if (!history)
+			{
+				history = xr_new<entity_history>();
+				history->baseline.valid = false;
+				for (u32 j = 0; j < pending_depth; ++j)
+					history->pending[j].valid = false;
+				history->next	= 0;
+				history->sends	= 0;
+				m_entities[entity.id] = history;
+			}
+			base = baseline(snapshot, *history, size);
+		}
+
+		if (base)
+		{
+			u32 const	mask_size		= (size + 7) / 8;
+			u32			changed_count	= 0;
+			ZeroMemory	(mask, mask_size);
+			for (u32 j = 0; j < size; ++j)
+			{
+				if (data[j] == base[j])
+					continue;
+				mask[j >> 3] |= u8(1 << (j & 7));
+				changed[changed_count++] = data[j];
+			}
+
+			if (!changed_count && skip_unchanged)
+			{
+				++statistics.unchanged;
+				continue;
+			}
+
+			if (mask_size + changed_count < size)
+			{
+				record.w_u8	(static_cast<u8>(sequence - history->baseline.sequence));
+				record.w	(mask, mask_size);
+				record.w	(changed, changed_count);
+				++statistics.delta;
+			} else
+			{
+				base = NULL;
+			}
+		}
+
+		if (!base)
+		{
+			record.w_u8		(0);
+			record.w		(data, size);
+			++statistics.full;
+		}
+
+		compressor.write_update_for(entity.id, record);
+		++result;
+
+		if (!history)
+			continue;
+
+		sent_update & sent	= history->pending[history->next];
+		history->next		= (history->next + 1) % pending_depth;
+		sent.sequence		= sequence;
+		sent.size			= size;
+		sent.valid			= true;
+		sent.offset			= entity.offset;
+		sent.send			= history->sends++;
+	}
+	return result;
+}
+
+update_streams::update_streams()
+{
+}
+
+update_streams::~update_streams()
+{
+	TaskScheduler.wait	(m_group);
+	for (slots_t::iterator i = m_slots.begin(); i != m_slots.end(); ++i)
+	{
+		xr_delete		((*i)->compressor);
+		delete_data		((*i)->packets);
+		xr_delete		(*i);
+	}
+}
+
+void update_streams::slot::process()
+{
+	server_updates_compressor::send_ready_updates_t::const_iterator	b, e;
+	used				= 0;
+	for (u32 i = first; i < last; ++i)
+	{
+		target const & t	= (*targets)[i];
+		result & r			= results[i];
+		compressor->begin_delta_updates(snapshot->sequence());
+		r.slot				= index;
+		r.first				= used;
+		r.records			= t.baselines->write(*snapshot, t.viewer, *compressor, statistics);
+		compressor->end_updates	(b, e);
+		if (!r.records)
+		{
+			r.count			= 0;
+			continue;
+		}
+
+		for (; b != e; ++b)
+		{
+			if (used == packets.size())
+				packets.push_back	(xr_new<NET_Packet>());
+			NET_Packet & P	= *packets[used++];
+			P.B.count		= (*b)->B.count;
+			CopyMemory		(P.B.data, (*b)->B.data, (*b)->B.count);
+		}
+		r.count				= used - r.first;
+	}
+}
+
+void update_streams::write(update_snapshot const & snapshot, targets_t const & targets, stream_statistics & statistics)
+{
+	m_results.resize	(targets.size());
+	if (targets.empty())
+		return;
+
+	u32 const slot_count	= _min(u32(targets.size()), TaskScheduler.worker_count() + 1);
+	while (m_slots.size() < slot_count)
+	{
+		slot* s				= xr_new<slot>();
+		s->compressor		= xr_new<server_updates_compressor>(true);
+		s->used				= 0;
+		s->index			= m_slots.size();
+		m_slots.push_back	(s);
+	}
+
+	for (u32 i = 0; i < slot_count; ++i)
+	{
+		slot & s			= *m_slots[i];
+		s.snapshot			= &snapshot;
+		s.targets			= &targets;
+		s.results			= &*m_results.begin();
+		s.first				= u32(targets.size())*i/slot_count;
+		s.last				= u32(targets.size())*(i + 1)/slot_count;
+		s.statistics.clear	();
+		TaskScheduler.push	(m_group, task_group::delegate_type(&s, &slot::process));
+	}
+	TaskScheduler.wait		(m_group);
+
+	for (u32 i = 0; i < slot_count; ++i)
+	{
+		stream_statistics const & s = m_slots[i]->statistics;
+		statistics.full			+= s.full;
+		statistics.delta		+= s.delta;
+		statistics.unchanged	+= s.unchanged;
+		statistics.irrelevant	+= s.irrelevant;
+	}
+}
+
+update_streams::stream update_streams::get(u32 const target) const
+{
+	VERIFY				(target < m_results.size());
+	result const & r	= m_results[target];
+	packets_t const & packets = m_slots[r.slot]->packets;
+	stream				s;
+	s.records			= r.records;
+	s.begin				= packets.begin() + r.first;
+	s.end				= packets.begin() + r.first + r.count;
+	return				s;
+}
+
+update_receiver::update_receiver()
+{
+	reset			();
+}
+
+update_receiver::~update_receiver()
+{
+	delete_data		(m_entities);
+}
+
+void update_receiver::reset()
+{
+	delete_data		(m_entities);
+	for (u32 i = 0; i < parts_depth; ++i)
+		m_parts[i].count = 0;
+
+	m_acknowledged	= false;
+	m_ack_sequence	= 0;
+	m_ack_mask		= 0;
+	m_baselines_lost= false;
+}
+
+update_receiver::enum_record update_receiver::decode(u16 const sequence,
+													 NET_Packet & source,
+													 NET_Packet & record)
+{
+	u16 id;
+	source.r_u16	(id);
+	u8 const size	= source.r_u8();
+	u8 const age	= source.r_u8();
+
+	if (id >= m_entities.size())
+		m_entities.resize(id + 1, NULL);
+
+	entity_history*	history = m_entities[id];
+	if (!history)
+	{
+		history = xr_new<entity_history>();
+		history->applied	= false;
+		for (u32 j = 0; j < receiver_depth; ++j)
+			history->updates[j].valid = false;
+		m_entities[id] = history;
+	}
+
+	u8 data[255];
+	if (!age)
+	{
+		source.r	(data, size);
+	} else
+	{
+		u8 mask[32];
+		u32 const mask_size = (size + 7) / 8;
+		source.r	(mask, mask_size);
+
+		u16 const base_sequence = static_cast<u16>(sequence - age);
+		received_update const* base = NULL;
+		for (u32 j = 0; j < receiver_depth; ++j)
+		{
+			received_update const & update = history->updates[j];
+			if (update.valid && (update.sequence == base_sequence) && (update.data.size() == size))
+			{
+				base = &update;
+				break;
+			}
+		}
+
+		if (!base)
+		{
+			u32 changed_count = 0;
+			for (u32 j = 0; j < size; ++j)
+				changed_count += (mask[j >> 3] >> (j & 7)) & 1;
+			source.r_advance(changed_count);
+			m_baselines_lost = true;
+			return record_no_baseline;
+		}
+
+		for (u32 j = 0; j < size; ++j)
+			data[j] = ((mask[j >> 3] >> (j & 7)) & 1) ? source.r_u8() : base->data[j];
+	}
+
+	//the oldest update is replaced : the server may refer to any of the last ones it has sent
+	received_update* received	= NULL;
+	for (u32 j = 0; j < receiver_depth; ++j)
+	{
+		received_update & update = history->updates[j];
+		if (!update.valid)
+		{
+			received = &update;
+			break;
+		}
+		if (!received || (s16(update.sequence - received->sequence) < 0))
+			received = &update;
+	}
+	if (!received->valid || (s16(sequence - received->sequence) > 0))
+	{
+		received->sequence		= sequence;
+		received->valid			= true;
+		received->data.assign	(data, data + size);
+	}
+
+	//the unreliable packets may come in any order
+	if (history->applied && (s16(sequence - history->applied_sequence) < 0))
+		return record_outdated;
+
+	history->applied			= true;
+	history->applied_sequence	= sequence;
+
+	record.write_start	();
+	record.w_u16		(id);
+	record.w_u8			(size);
+	record.w			(data, size);
+	record.r_seek		(0);
+	return record_apply;
+}
+
+bool update_receiver::receive_part(u16 const sequence, u8 const part_count)
+{
+	sequence_parts & parts = m_parts[sequence % parts_depth];
+	if (!parts.count || (parts.sequence != sequence))
+	{
+		parts.sequence	= sequence;
+		parts.received	= 0;
+		parts.count		= part_count;
+	}
+
+	++parts.received;
+	if (parts.received < parts.count)
+		return false;
+
+	if (!m_acknowledged)
+	{
+		m_acknowledged	= true;
+		m_ack_sequence	= sequence;
+		m_ack_mask		= 0;
+		return true;
+	}
+
+	s16 const distance = s16(sequence - m_ack_sequence);
+	if (distance > 0)
+	{
+		if (distance < 32)
+			m_ack_mask	= (m_ack_mask << distance) | (u32(1) << (distance - 1));
+		else if (distance == 32)
+			m_ack_mask	= u32(1) << 31;
+		else
+			m_ack_mask	= 0;
+		m_ack_sequence	= sequence;
+	} else if ((distance < 0) && (distance >= -32))
+	{
+		m_ack_mask		|= u32(1) << (-distance - 1);
+	}
+	return true;
+}
+
+void update_receiver::write_ack(NET_Packet & P)
+{
+	P.w_u16			(m_ack_sequence);
+	P.w_u32			(m_ack_mask);
+	P.w_u8			(m_baselines_lost ? 1 : 0);
+	m_baselines_lost= false;
+}
+
+void decompress_block(u8 const compress_type,
+					  u8 const * source,
+					  u32 const size,
+					  NET_Packet & dest,
+					  compression::ppmd_trained_stream* trained_stream,
+					  compression::lzo_dictionary_buffer const & lzo_dictionary,
+					  u8* lzo_working_memory)
+{
+	if (compress_type & eto_ppmd_compression)
+	{
+		R_ASSERT(trained_stream);
+		dest.B.count = ppmd_trained_decompress(
+			dest.B.data,
+			sizeof(dest.B.data),
+			source,
+			size,
+			trained_stream
+		);
+	} else if (compress_type & eto_lzo_compression)
+	{
+		R_ASSERT(lzo_dictionary.data);
+		dest.B.count = sizeof(dest.B.data);
+		lzo_decompress_dict(
+			const_cast<u8*>(source),
+			size,
+			dest.B.data,
+			(lzo_uint*)&dest.B.count,
+			lzo_working_memory,
+			lzo_dictionary.data,
+			lzo_dictionary.size
+		);
+	} else
+	{
+		VERIFY(size <= sizeof(dest.B.data));
+		CopyMemory(dest.B.data, source, size);
+		dest.B.count = size;
+	}
+
+	VERIFY2(dest.B.count <= sizeof(dest.B.data),
+		"stack owerflow after decompressing");
+	dest.r_seek(0);
+}
+
+} //namespace client_updates
@@ -0,0 +1,270 @@
+#ifndef XRSERVER_CLIENT_UPDATES_INCLUDED
+#define XRSERVER_CLIENT_UPDATES_INCLUDED
+
+#include "traffic_optimization.h"
+#include "../xrCore/task_scheduler.h"
+
+class server_updates_compressor;
+
+// Per-client object updates (eto_client_relevance, eto_delta_baselines) :
+// every server update gets a sequence number, the entities are serialized once into a snapshot,
+// then every client gets its own stream of the entities relevant to it, written against
+// the last updates of each entity it has acknowledged.
+//
+// M_UPDATE_OBJECTS_DELTA : u8 compression, u16 sequence, u8 part, u8 part count,
+//                          { u16 block size, block (compressed, unless compression is 0) }, u16 0
+// record in a block      : u16 id, u8 size, u8 age,
+//                          age == 0 : size bytes of UPDATE_Write,
+//                          age != 0 : (size + 7)/8 bytes of the mask of the bytes, which differ from
+//                                     the update of the sequence (sequence - age), then these bytes
+// M_CL_UPDATES_ACK       : u16 sequence, u32 mask of the 32 sequences before it, u8 baselines lost
+//                          (the client acknowledges the sequences it has all the parts of)
+
+namespace client_updates {
+
+// the server keeps the snapshots of its last updates for all the clients, and for every client
+// the updates of each entity, which are not acknowledged yet, and the last acknowledged one;
+// the client keeps the last updates of each entity it has received (the packets may come
+// out of order), the server refers to the acknowledged one while the client has it for sure
+u32 const snapshot_depth	= 64;
+u32 const pending_depth		= 8;
+u32 const receiver_depth	= 16;
+
+bool	enabled					();
+
+// all the updates of the last server updates, shared by the clients
+class update_snapshot : private boost::noncopyable
+{
+public:
+	struct entity
+	{
+		u16		id;
+		u8		size;
+		u8		team;			// players only
+		bool	player;
+		u32		owner;			// ClientID of the owner
+		u32		offset;
+		int		cell_x;
+		int		cell_z;
+	};
+	typedef xr_vector<entity>	entities_t;
+	typedef xr_vector<u16>		ids_t;
+
+			update_snapshot		();
+
+	void	begin				();
+	void	add					(u16 const id, Fvector const & position, u32 const owner, bool const player, u8 const team, void const * data, u8 const size);
+	// the entities destroyed since the last update, their ids may be given to new entities
+	void	destroyed			(u16 const id)	{ m_destroyed.push_back(id); }
+	void	end					()				{ m_destroyed.clear(); }
+
+	u16					sequence		() const					{ return m_sequence; }
+	entities_t const &	entities		() const					{ return current().entities; }
+	ids_t const &		destroyed_ids	() const					{ return m_destroyed; }
+	u8 const *			data			(entity const & e) const	{ return &*current().data.begin() + e.offset; }
+	// NULL if the update is not kept anymore
+	u8 const *			data			(u16 const sequence, u32 const offset) const;
+private:
+	struct frame
+	{
+		u16				sequence;
+		bool			valid;
+		entities_t		entities;
+		xr_vector<u8>	data;
+	};
+	frame const &		current			() const					{ return m_frames[m_sequence % snapshot_depth]; }
+
+	u16			m_sequence;
+	frame		m_frames[snapshot_depth];
+	ids_t		m_destroyed;
+};//class update_snapshot
+
+struct update_viewer
+{
+	u32		owner;				// ClientID of the client
+	bool	positioned;
+	u8		team;
+	int		cell_x;
+	int		cell_z;
+
+	void	set					(u32 const client, Fvector const * position, u8 const client_team);
+};//struct update_viewer
+
+// 1, 2, 4 or 8 : the entity is sent to the viewer in one server update of these
+u32		update_period			(update_viewer const & viewer, update_snapshot::entity const & entity);
+
+struct stream_statistics
+{
+	u32		full;
+	u32		delta;
+	u32		unchanged;
+	u32		irrelevant;
+
+	void	clear				() { full = delta = unchanged = irrelevant = 0; }
+};//struct stream_statistics
+
+// server side, one for each client
+// guarded by IPureServer::csMessage : the acknowledgements come from the network threads
+class update_baselines : private boost::noncopyable
+{
+public:
+			update_baselines	();
+			~update_baselines	();
+
+	void	reset				();
+	void	acknowledge			(NET_Packet & P);
+	// the number of the records written
+	u32		write				(update_snapshot const & snapshot,
+								 update_viewer const & viewer,
+								 server_updates_compressor & compressor,
+								 stream_statistics & statistics);
+private:
+	struct sent_update
+	{
+		u16		sequence;
+		u8		size;
+		bool	valid;
+		u32		offset;			// in the snapshot of the sequence
+		u32		send;			// the number of the updates of the entity sent before this one
+	};
+	struct entity_history
+	{
+		sent_update		baseline;
+		sent_update		pending[pending_depth];
+		u32				next;
+		u32				sends;
+	};
+	typedef xr_vector<entity_history*>	entities_t;
+
+	bool			acknowledged	(u16 const sequence) const;
+	u8 const*		baseline		(update_snapshot const & snapshot, entity_history & history, u8 const size);
+	void			forget			(u16 const id);
+
+	entities_t		m_entities;
+	bool			m_acknowledged;
+	u16				m_ack_sequence;
+	u32				m_ack_mask;
+};//class update_baselines
+
+// the streams of the clients written on the task workers, a range of the clients each
+// with its own compressor; the packets are kept for the server to send them in the order of the clients
+class update_streams : private boost::noncopyable
+{
+public:
+	struct target
+	{
+		update_baselines*	baselines;
+		update_viewer		viewer;
+	};
+	typedef xr_vector<target>		targets_t;
+	typedef xr_vector<NET_Packet*>	packets_t;
+
+	struct stream
+	{
+		u32					records;
+		packets_t::const_iterator	begin;
+		packets_t::const_iterator	end;
+	};
+
+				update_streams		();
+				~update_streams		();
+
+	void		write				(update_snapshot const & snapshot, targets_t const & targets, stream_statistics & statistics);
+	// of the target of the last write
+	stream		get					(u32 const target) const;
+private:
+	struct result
+	{
+		u32		slot;
+		u32		first;
+		u32		count;
+		u32		records;
+	};
+	typedef xr_vector<result>		results_t;
+
+	struct slot
+	{
+		server_updates_compressor*	compressor;
+		packets_t					packets;
+		u32							used;
+		update_snapshot const*		snapshot;
+		targets_t const*			targets;
+		result*						results;
+		u32							index;
+		u32							first;
+		u32							last;
+		stream_statistics			statistics;
+
+		void		process				();
+	};
+	typedef xr_vector<slot*>		slots_t;
+
+	slots_t			m_slots;
+	results_t		m_results;
+	task_group		m_group;
+};//class update_streams
+
+// client side
+class update_receiver : private boost::noncopyable
+{
+public:
+	enum enum_record
+	{
+		record_apply,
+		record_outdated,		// there is a newer update of the entity applied already
+		record_no_baseline,
+	};
+			update_receiver		();
+			~update_receiver	();
+
+	void	reset				();
+	// writes the record the usual way (u16 id, u8 size, data) into the record packet
+	enum_record	decode			(u16 const sequence, NET_Packet & source, NET_Packet & record);
+	// true when the sequence is complete and has to be acknowledged
+	bool	receive_part		(u16 const sequence, u8 const part_count);
+	void	write_ack			(NET_Packet & P);
+private:
+	struct received_update
+	{
+		u16				sequence;
+		bool			valid;
+		xr_vector<u8>	data;
+	};
+	struct entity_history
+	{
+		received_update	updates[receiver_depth];
+		bool			applied;
+		u16				applied_sequence;
+	};
+	struct sequence_parts
+	{
+		u16		sequence;
+		u8		received;
+		u8		count;
+	};
+	typedef xr_vector<entity_history*>	entities_t;
+	static u32 const parts_depth	= 8;
+
+	entities_t		m_entities;
+	sequence_parts	m_parts[parts_depth];
+	bool			m_acknowledged;
+	u16				m_ack_sequence;
+	u32				m_ack_mask;
+	bool			m_baselines_lost;
+};//class update_receiver
+
+// decompresses a block of M_COMPRESSED_UPDATE_OBJECTS or M_UPDATE_OBJECTS_DELTA
+void	decompress_block		(u8 const compress_type,
+								 u8 const * source,
+								 u32 const size,
+								 NET_Packet & dest,
+								 compression::ppmd_trained_stream* trained_stream,
+								 compression::lzo_dictionary_buffer const & lzo_dictionary,
+								 u8* lzo_working_memory);
+
+// sv_client_updates_bench : synthetic clients and entities, no network, rate updates a second
+void	benchmark				(u32 const client_count, u32 const entity_count, u32 const seconds, u32 const rate);
+
+} //namespace client_updates
+
+#endif//#ifndef XRSERVER_CLIENT_UPDATES_INCLUDED
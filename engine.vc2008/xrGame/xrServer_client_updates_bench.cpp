@@ -0,0 +1,385 @@
+#include "stdafx.h"
+#include "xrServer_client_updates.h"
+#include "xrServer_updates_compressor.h"
+#include "xrMessages.h"
+#include "../xrServerEntities/object_broker.h"
+
+namespace client_updates {
+
+namespace bench {
+
+float const	map_extent			= 500.f;
+u32 const	latency				= 3;		// server updates, each way
+u32 const	loss_percent		= 5;
+
+enum enum_kind
+{
+	kind_item,
+	kind_monster,
+	kind_player,
+};
+
+struct entity
+{
+	u16			id;
+	enum_kind	kind;
+	u8			size;
+	u8			team;
+	u32			owner;
+	Fvector		center;
+	float		radius;
+	float		speed;
+	float		phase;
+};
+typedef xr_vector<entity>	entities_t;
+
+struct delayed
+{
+	u32				deliver;
+	xr_vector<u8>	data;
+};
+typedef xr_deque<delayed>	delayed_t;
+
+struct client
+{
+	u32					id;
+	u32					player;			// the index of its actor
+	update_baselines	baselines;
+	update_receiver		receiver;
+	delayed_t			packets;
+	delayed_t			acks;
+};
+typedef xr_vector<client*>	clients_t;
+
+struct result
+{
+	u64		bytes;
+	u64		time;
+	u32		records;
+	u32		checked;
+	u32		errors;
+	u32		no_baseline;
+	stream_statistics	statistics;
+};
+
+struct receiver_compression
+{
+	compression::ppmd_trained_stream*	trained_stream;
+	compression::lzo_dictionary_buffer	lzo_dictionary;
+	u8*									lzo_working_memory;
+	u8*									lzo_working_buffer;
+};
+
+// the same bytes on both sides : the clients check the records they decode against it,
+// the static bytes come first, then the server time, the position and the changing state
+static void entity_state(entity const & e, u16 const sequence, Fvector & position, u8* data)
+{
+	float const angle = e.phase + e.speed*float(sequence);
+	position.set	(e.center.x + e.radius*_cos(angle), e.center.y, e.center.z + e.radius*_sin(angle));
+
+	CRandom			random(e.id*7919 + 1);
+	for (u32 i = 0; i < e.size; ++i)
+		data[i]		= u8(random.randI(256));
+
+	if (e.kind == kind_item)
+	{
+		//the condition changes from time to time
+		data[0]		= u8((sequence + e.id) >> 6);
+		return;
+	}
+
+	u32 const time	= u32(sequence)*50;
+	CopyMemory		(data, &time, sizeof(time));
+	CopyMemory		(data + 4, &position, sizeof(position));
+	data[16]		= u8(iFloor(angle*256.f/PI_MUL_2));
+	if (e.kind == kind_player)
+	{
+		//animations, weapon state, health
+		for (u32 i = 17; i < 33; ++i)
+			data[i]	= u8((sequence + i)/(i - 13));
+	}
+}
+
+static void make_entities(u32 const client_count, u32 const entity_count, entities_t & entities)
+{
+	CRandom			random(0x0c1e);
+	entities.resize	(entity_count);
+	for (u32 i = 0; i < entity_count; ++i)
+	{
+		entity & e	= entities[i];
+		e.id		= u16(i + 1);
+		e.kind		= (i < client_count) ? kind_player : (random.randI(5) ? kind_item : kind_monster);
+		e.owner		= (e.kind == kind_player) ? (i + 1) : 0;
+		e.team		= u8(i & 1);
+		e.center.set(random.randF(-map_extent,map_extent), random.randF(-5.f,5.f), random.randF(-map_extent,map_extent));
+		switch (e.kind)
+		{
+		case kind_item		: e.size = 24;	e.radius = 0.f;							e.speed = 0.f;						break;
+		case kind_monster	: e.size = 60;	e.radius = random.randF(5.f,30.f);		e.speed = random.randF(.005f,.02f);	break;
+		case kind_player	: e.size = 120;	e.radius = random.randF(20.f,80.f);		e.speed = random.randF(.005f,.02f);	break;
+		default				: NODEFAULT;
+		}
+		e.phase		= random.randF(PI_MUL_2);
+	}
+}
+
+static void deliver_updates(client & c, u32 const cycle, entities_t const & entities, receiver_compression & compression, CRandom & random, result & r)
+{
+	NET_Packet	P;
+	NET_Packet	block;
+	NET_Packet	record;
+	u8			expected[255];
+	Fvector		position;
+	while (!c.packets.empty() && (c.packets.front().deliver <= cycle))
+	{
+		xr_vector<u8> & data = c.packets.front().data;
+		P.B.count	= data.size();
+		CopyMemory	(P.B.data, &*data.begin(), data.size());
+		c.packets.pop_front();
+
+		u16			type;
+		P.r_begin	(type);
+		VERIFY		(type == M_UPDATE_OBJECTS_DELTA);
+		u8 const	compress_type	= P.r_u8();
+		u16			sequence;
+		P.r_u16		(sequence);
+		P.r_u8		();
+		u8 const	part_count		= P.r_u8();
+
+		u16 next_size;
+		P.r_u16		(next_size);
+		while (next_size)
+		{
+			decompress_block(compress_type, P.B.data + P.r_tell(), next_size, block,
+				compression.trained_stream, compression.lzo_dictionary, compression.lzo_working_memory);
+			P.r_seek(P.r_tell() + next_size);
+
+			while (!block.r_eof())
+			{
+				switch (c.receiver.decode(sequence, block, record))
+				{
+				case update_receiver::record_apply :
+					{
+						u16 id;
+						record.r_u16	(id);
+						u8 const size	= record.r_u8();
+						entity const & e= entities[id - 1];
+						entity_state	(e, sequence, position, expected);
+						++r.checked;
+						if ((size != e.size) || memcmp(record.B.data + record.r_tell(), expected, size))
+							++r.errors;
+					}break;
+				case update_receiver::record_outdated :
+					break;
+				case update_receiver::record_no_baseline :
+					++r.no_baseline;
+					break;
+				default : NODEFAULT;
+				}
+			}
+			P.r_u16	(next_size);
+		}
+
+		if (!c.receiver.receive_part(sequence, part_count))
+			continue;
+
+		NET_Packet	ack;
+		ack.w_begin	(M_CL_UPDATES_ACK);
+		c.receiver.write_ack(ack);
+		if (u32(random.randI(100)) < loss_percent)
+			continue;
+
+		c.acks.push_back	(delayed());
+		c.acks.back().deliver	= cycle + latency;
+		c.acks.back().data.assign(ack.B.data, ack.B.data + ack.B.count);
+	}
+
+	while (!c.acks.empty() && (c.acks.front().deliver <= cycle))
+	{
+		xr_vector<u8> & data = c.acks.front().data;
+		P.B.count	= data.size();
+		CopyMemory	(P.B.data, &*data.begin(), data.size());
+		c.acks.pop_front();
+
+		u16			type;
+		P.r_begin	(type);
+		c.baselines.acknowledge(P);
+	}
+}
+
+// parallel : the blocks and the streams of the clients on the task workers, the way the server does it,
+// the whole update on the calling thread otherwise
+static void run(bool const per_client, bool const parallel, clients_t & clients, entities_t const & entities, u32 const cycle_count, receiver_compression & compression, result & r)
+{
+	ZeroMemory		(&r, sizeof(r));
+
+	server_updates_compressor*	compressor = xr_new<server_updates_compressor>(!parallel);
+	update_streams*				streams = xr_new<update_streams>();
+	update_streams::targets_t	targets(clients.size());
+	update_snapshot*			snapshot = xr_new<update_snapshot>();
+	CRandom						random(0x1055);
+	NET_Packet					record;
+	Fvector						position;
+	u8							data[255];
+	xr_vector<Fvector>			positions(entities.size());
+	server_updates_compressor::send_ready_updates_t::const_iterator	b, e;
+
+	for (u32 cycle = 0; cycle < cycle_count; ++cycle)
+	{
+		snapshot->begin		();
+		for (u32 i = 0; i < entities.size(); ++i)
+		{
+			entity const & en	= entities[i];
+			entity_state		(en, snapshot->sequence(), position, data);
+			positions[i]		= position;
+			snapshot->add		(en.id, position, en.owner, en.kind == kind_player, en.team, data, en.size);
+		}
+
+		u64 const start		= CPU::GetCLK();
+		if (!per_client)
+		{
+			compressor->begin_updates();
+			update_snapshot::entities_t::const_iterator	I = snapshot->entities().begin();
+			update_snapshot::entities_t::const_iterator	E = snapshot->entities().end();
+			for (; I != E; ++I)
+			{
+				record.write_start	();
+				record.w_u16		(I->id);
+				record.w_u8			(I->size);
+				record.w			(snapshot->data(*I), I->size);
+				compressor->write_update_for(I->id, record);
+			}
+			compressor->end_updates	(b, e);
+			r.records			+= snapshot->entities().size();
+			for (; b != e; ++b)
+				if ((*b)->B.count > 2)
+					r.bytes		+= u64((*b)->B.count)*clients.size();
+			r.time				+= CPU::GetCLK() - start;
+			snapshot->end		();
+			continue;
+		}
+
+		if (parallel)
+		{
+			for (u32 i = 0; i < clients.size(); ++i)
+			{
+				client & c			= *clients[i];
+				targets[i].baselines= &c.baselines;
+				targets[i].viewer.set	(c.id, &positions[c.player], entities[c.player].team);
+			}
+			streams->write			(*snapshot, targets, r.statistics);
+		}
+
+		for (u32 i = 0; i < clients.size(); ++i)
+		{
+			client & c			= *clients[i];
+			u32					records;
+			if (parallel)
+			{
+				update_streams::stream const s = streams->get(i);
+				records			= s.records;
+				b				= s.begin;
+				e				= s.end;
+			} else
+			{
+				update_viewer	viewer;
+				viewer.set		(c.id, &positions[c.player], entities[c.player].team);
+				compressor->begin_delta_updates(snapshot->sequence());
+				records			= c.baselines.write(*snapshot, viewer, *compressor, r.statistics);
+				compressor->end_updates	(b, e);
+			}
+			r.records			+= records;
+			if (!records)
+				continue;
+
+			for (; b != e; ++b)
+			{
+				r.bytes			+= (*b)->B.count;
+				if (u32(random.randI(100)) < loss_percent)
+					continue;
+
+				c.packets.push_back	(delayed());
+				c.packets.back().deliver	= cycle + latency;
+				c.packets.back().data.assign((*b)->B.data, (*b)->B.data + (*b)->B.count);
+			}
+		}
+		r.time				+= CPU::GetCLK() - start;
+		snapshot->end		();
+
+		for (clients_t::iterator I = clients.begin(); I != clients.end(); ++I)
+			deliver_updates	(**I, cycle, entities, compression, random, r);
+	}
+
+	xr_delete		(snapshot);
+	xr_delete		(streams);
+	xr_delete		(compressor);
+}
+
+} //namespace bench
+
+void benchmark(u32 const client_count, u32 const entity_count, u32 const seconds, u32 const rate)
+{
+	using namespace bench;
+
+	u32 const		cycle_count		= seconds*rate;
+	entities_t		entities;
+	make_entities	(client_count, entity_count, entities);
+
+	receiver_compression	compression;
+	compression::init_ppmd_trained_stream	(compression.trained_stream);
+	compression::init_lzo	(compression.lzo_working_memory, compression.lzo_working_buffer, compression.lzo_dictionary);
+
+	u32 const		level			= g_sv_traffic_optimization_level;
+	u32 const		base_level		= level & (eto_ppmd_compression | eto_lzo_compression | eto_last_change);
+	Msg				("* Client updates bench : %d clients, %d entities, %d updates/s, %d s, %d%% loss, %d updates of latency, traffic optimization %d, %d task worker(s)",
+		client_count, entity_count, rate, seconds, loss_percent, latency, base_level, TaskScheduler.worker_count());
+
+	struct mode
+	{
+		LPCSTR	name;
+		bool	per_client;
+		u32		level;
+	} const modes[] =
+	{
+		{ "broadcast",				false,	0 },
+		{ "relevance",				true,	eto_client_relevance },
+		{ "deltas",					true,	eto_delta_baselines },
+		{ "relevance + deltas",		true,	eto_client_relevance | eto_delta_baselines },
+	};
+
+	for (u32 m = 0; m < sizeof(modes)/sizeof(modes[0]); ++m)
+	for (u32 p = 0; p < 2; ++p)
+	{
+		bool const	parallel = !!p;
+		clients_t	clients(client_count);
+		for (u32 i = 0; i < client_count; ++i)
+		{
+			clients[i]			= xr_new<client>();
+			clients[i]->id		= i + 1;
+			clients[i]->player	= i;
+		}
+
+		g_sv_traffic_optimization_level = base_level | modes[m].level;
+		result		r;
+		run			(modes[m].per_client, parallel, clients, entities, cycle_count, compression, r);
+		delete_data	(clients);
+
+		Msg			("*   %-20s %-8s : %9.0f bytes/client/s, %7.3f ms/update, %6.1f records/client/update",
+			modes[m].name,
+			parallel ? "parallel" : "serial",
+			double(r.bytes)/double(client_count*seconds),
+			double(r.time)*CPU::clk_to_milisec/double(cycle_count),
+			modes[m].per_client ? float(r.records)/float(client_count*cycle_count) : float(r.records)/float(cycle_count));
+		if (modes[m].per_client)
+			Msg		("*   %-29s   %d full, %d delta, %d unchanged, %d skipped, %d checked",
+				"", r.statistics.full, r.statistics.delta, r.statistics.unchanged, r.statistics.irrelevant, r.checked);
+		if (r.errors || r.no_baseline)
+			Msg		("! Client updates bench : %d records decoded wrong, %d without the baseline", r.errors, r.no_baseline);
+	}
+
+	g_sv_traffic_optimization_level = level;
+	compression::deinit_ppmd_trained_stream	(compression.trained_stream);
+	compression::deinit_lzo	(compression.lzo_working_buffer, compression.lzo_dictionary);
+}
+
+} //namespace client_updates
@@ -0,0 +1,73 @@
+#include "stdafx.h"
+#include "xrServer_load_profile.h"
+#include "xrMessages.h"
+
+server_load_profile::server_load_profile()
+{
+	m_ticks.reserve		(1024*64);
+}
+
+server_load_profile::~server_load_profile()
+{
+}
+
+void server_load_profile::add_tick(u64 const time)
+{
+	m_ticks.push_back	(time);
+}
+
+void server_load_profile::add_message(u16 const message_type, u16 const event_type, u64 const time)
+{
+	u32 const			key = (u32(message_type) << 16) | event_type;
+	message_costs_t::iterator I = m_message_costs.find(key);
+	if (I == m_message_costs.end())
+	{
+		message_cost	cost;
+		cost.count		= 0;
+		cost.total		= 0;
+		cost.max		= 0;
+		I				= m_message_costs.insert(std::make_pair(key, cost)).first;
+	}
+	++I->second.count;
+	I->second.total		+= time;
+	I->second.max		= _max(I->second.max, time);
+}
+
+static float ticks_to_ms(u64 const ticks)
+{
+	return				float(double(ticks)*1000.0/double(CPU::qpc_freq));
+}
+
+void server_load_profile::dump() const
+{
+	if (!m_ticks.empty())
+	{
+		xr_vector<u64>	ticks = m_ticks;
+		std::sort		(ticks.begin(), ticks.end());
+		u32 const		last = ticks.size() - 1;
+		Msg				("*   server tick : p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms (%d ticks)",
+			ticks_to_ms(ticks[last*50/100]),
+			ticks_to_ms(ticks[last*95/100]),
+			ticks_to_ms(ticks[last*99/100]),
+			ticks_to_ms(ticks[last]),
+			ticks.size());
+	}
+
+	message_costs_t::const_iterator	I = m_message_costs.begin();
+	message_costs_t::const_iterator	E = m_message_costs.end();
+	for (; I != E; ++I)
+	{
+		u16 const		message_type	= u16(I->first >> 16);
+		string64		name;
+		if (message_type == M_EVENT)
+			xr_sprintf	(name, "Process_event [%d]", I->first & 0xffff);
+		else
+			xr_strcpy	(name, "Process_update");
+
+		Msg				("*   %-22s : %6d messages, %.1f us average, %.1f us max",
+			name,
+			I->second.count,
+			ticks_to_ms(I->second.total)*1000.f/float(I->second.count),
+			ticks_to_ms(I->second.max)*1000.f);
+	}
+}
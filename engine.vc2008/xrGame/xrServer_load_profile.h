@@ -0,0 +1,34 @@
+#ifndef XRSERVER_LOAD_PROFILE_INCLUDED
+#define XRSERVER_LOAD_PROFILE_INCLUDED
+
+#include "associative_vector.h"
+
+// The times of the server ticks and of the processing of the client messages,
+// collected while a load test runs (see demo_load_test.h). The messages are timed
+// under IPureServer::csMessage, as xrServer::OnMessage runs on the network threads.
+class server_load_profile : private boost::noncopyable
+{
+public:
+				server_load_profile	();
+				~server_load_profile();
+
+	// xrServer::Update, in CPU::QPC ticks
+	void		add_tick			(u64 const time);
+	// M_UPDATE or M_EVENT of the event type, in CPU::QPC ticks
+	void		add_message			(u16 const message_type, u16 const event_type, u64 const time);
+
+	void		dump				() const;
+private:
+	struct message_cost
+	{
+		u32		count;
+		u64		total;
+		u64		max;
+	};
+	typedef associative_vector<u32, message_cost>	message_costs_t;
+
+	xr_vector<u64>					m_ticks;
+	message_costs_t					m_message_costs;
+}; //class server_load_profile
+
+#endif //#ifndef XRSERVER_LOAD_PROFILE_INCLUDED
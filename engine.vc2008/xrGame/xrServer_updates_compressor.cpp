@@ -92,9 +92,9 @@ last_updates_cache::last_update_t*	last_updates_cache::search_most_expired(u32 c
 	return min_time;
 }
 
-server_updates_compressor::server_updates_compressor()
+server_updates_compressor::server_updates_compressor(bool const worker)
 {
-	u32 const need_to_reserve = (start_compress_buffer_size / sizeof(m_acc_buff.B.data)) + 1;
+	u32 const need_to_reserve = worker ? 1 : (start_compress_buffer_size / sizeof(m_acc_buff.B.data)) + 1;
 	for (u32 i = 0; i < need_to_reserve; ++i)
 	{
 		m_ready_for_send.push_back(xr_new<NET_Packet>());
@@ -103,8 +103,13 @@ server_updates_compressor::server_updates_compressor()
 	m_trained_stream		= NULL;
 	m_lzo_working_memory	= NULL;
 	m_lzo_working_buffer	= NULL;
+	m_delta					= false;
+	m_delta_sequence		= 0;
+	m_worker				= worker;
+	m_block_count			= 0;
 
-	if (!IsGameTypeSingle())
+	//the workers can't load the models themselves
+	if (worker || !IsGameTypeSingle())
 		init_compression();
 
 	dbg_update_bins_writer = NULL;
@@ -113,6 +118,9 @@ server_updates_compressor::server_updates_compressor()
 server_updates_compressor::~server_updates_compressor()
 {
 	delete_data(m_ready_for_send);
+	delete_data(m_blocks);
+	for (compress_tasks_t::iterator i = m_compress_tasks.begin(); i != m_compress_tasks.end(); ++i)
+		xr_free(i->lzo_working_buffer);
 
 	if (g_sv_write_updates_bin && dbg_update_bins_writer)
 	{
@@ -144,20 +152,65 @@ void server_updates_compressor::deinit_compression()
 	}
 }
 
+bool server_updates_compressor::compressing() const
+{
+	return ((g_sv_traffic_optimization_level & eto_ppmd_compression) ||
+		(g_sv_traffic_optimization_level & eto_lzo_compression));
+}
+
 void server_updates_compressor::begin_updates()
 {
-	m_current_update = 0;
-	if ((g_sv_traffic_optimization_level & eto_ppmd_compression) ||
-		(g_sv_traffic_optimization_level & eto_lzo_compression))
+	m_current_update	= 0;
+	m_block_count		= 0;
+	m_delta				= false;
+	if (compressing())
 	{
-		m_ready_for_send.front()->w_begin(M_COMPRESSED_UPDATE_OBJECTS);
-		m_ready_for_send.front()->w_u8(static_cast<u8>(g_sv_traffic_optimization_level));
+		if (!m_trained_stream)
+			init_compression();
 		m_acc_buff.write_start();
 	} else
 	{
-		m_ready_for_send.front()->write_start();
 		m_acc_buff.w_begin(M_UPDATE_OBJECTS);
-	}	
+	}
+	start_dest(m_ready_for_send.front());
+}
+
+void server_updates_compressor::begin_delta_updates(u16 const sequence)
+{
+	m_current_update	= 0;
+	m_block_count		= 0;
+	m_delta				= true;
+	m_delta_sequence	= sequence;
+	if (compressing() && !m_trained_stream)
+		init_compression();
+
+	m_acc_buff.write_start();
+	start_dest(m_ready_for_send.front());
+}
+
+//every packet of the update gets the header, the continuation ones including : the old
+//goto_next_dest wrote the ppmd type byte into the first packet and no header at all with lzo,
+//so a compressed update larger than one packet could not be parsed by the client
+void server_updates_compressor::start_dest(NET_Packet* dest)
+{
+	if (m_delta)
+	{
+		dest->w_begin(M_UPDATE_OBJECTS_DELTA);
+		dest->w_u8(static_cast<u8>(g_sv_traffic_optimization_level & (eto_ppmd_compression | eto_lzo_compression)));
+		dest->w_u16(m_delta_sequence);
+		dest->w_u8(static_cast<u8>(m_current_update));
+		//part count, known at the end
+		dest->w_u8(0);
+		return;
+	}
+	if (compressing())
+	{
+		dest->w_begin(M_COMPRESSED_UPDATE_OBJECTS);
+		dest->w_u8(static_cast<u8>(g_sv_traffic_optimization_level));
+	} else
+	{
+		dest->write_start();
+	}
 }
 
 NET_Packet*	server_updates_compressor::get_current_dest()
@@ -180,63 +233,125 @@ NET_Packet*	server_updates_compressor::goto_next_dest()
 		new_dest = m_ready_for_send[m_current_update];
 	}
 
+	start_dest(new_dest);
+	return new_dest;
+}
+
+void server_updates_compressor::compress(NET_Packet const & source, NET_Packet & dest, u8* lzo_working_memory) const
+{
+	R_ASSERT(m_trained_stream);
 	if (g_sv_traffic_optimization_level & eto_ppmd_compression)
 	{
-		new_dest->w_begin(M_COMPRESSED_UPDATE_OBJECTS);
-		m_ready_for_send.front()->w_u8(static_cast<u8>(g_sv_traffic_optimization_level));
+		dest.B.count = ppmd_trained_compress(
+			dest.B.data,
+			sizeof(dest.B.data),
+			source.B.data,
+			source.B.count,
+			m_trained_stream
+		);
 	} else
 	{
-		new_dest->write_start();
+		dest.B.count = sizeof(dest.B.data);
+		lzo_compress_dict(
+			source.B.data,
+			source.B.count,
+			dest.B.data,
+			(lzo_uint*)&dest.B.count,
+			lzo_working_memory,
+			m_lzo_dictionary.data, m_lzo_dictionary.size
+		);
 	}
-	
-	return new_dest;
 }
 
-void server_updates_compressor::flush_accumulative_buffer()
+void server_updates_compressor::compress_task::process()
 {
-	NET_Packet*	dst_packet = get_current_dest();
-	if ((g_sv_traffic_optimization_level & eto_ppmd_compression) ||
-		(g_sv_traffic_optimization_level & eto_lzo_compression))
+	for (u32 i = first; i < owner->m_block_count; i += step)
 	{
+		compress_block & block = *owner->m_blocks[i];
+		owner->compress(block.source, block.compressed, lzo_working_memory);
+	}
+}
+
+void server_updates_compressor::compress_blocks()
+{
+	if (!m_worker)
 		Device.Statistic->netServerCompressor.Begin();
-		R_ASSERT(m_trained_stream);
-		if (g_sv_traffic_optimization_level & eto_ppmd_compression)
+
+	//PPMd compresses under its own lock
+	u32 task_count = 1;
+	if (!m_worker && !(g_sv_traffic_optimization_level & eto_ppmd_compression))
+		task_count = _min(m_block_count, TaskScheduler.worker_count() + 1);
+
+	if (task_count <= 1)
+	{
+		for (u32 i = 0; i < m_block_count; ++i)
+			compress(m_blocks[i]->source, m_blocks[i]->compressed, m_lzo_working_memory);
+	} else
+	{
+		while (m_compress_tasks.size() < task_count)
 		{
-			m_compress_buf.B.count = ppmd_trained_compress(
-				m_compress_buf.B.data,
-				sizeof(m_compress_buf.B.data),
-				m_acc_buff.B.data,
-				m_acc_buff.B.count,
-				m_trained_stream
-			);
-		} else
+			m_compress_tasks.push_back(compress_task());
+			compress_task & task		= m_compress_tasks.back();
+			task.owner					= this;
+			if (m_compress_tasks.size() == 1)
+			{
+				task.lzo_working_memory	= m_lzo_working_memory;
+				task.lzo_working_buffer	= NULL;
+				continue;
+			}
+			// the working memory must be alligned to 16 bytes
+			task.lzo_working_buffer		= static_cast<u8*>(xr_malloc(LZO1X_999_MEM_COMPRESS + 16));
+			task.lzo_working_memory		= (u8*)(size_t(task.lzo_working_buffer + 16) & ~0xf);
+		}
+		for (u32 i = 0; i < task_count; ++i)
 		{
-			m_compress_buf.B.count = sizeof(m_compress_buf.B.data);
-			lzo_compress_dict(
-				m_acc_buff.B.data,
-				m_acc_buff.B.count,
-				m_compress_buf.B.data,
-				(lzo_uint*)&m_compress_buf.B.count,
-				m_lzo_working_memory,
-				m_lzo_dictionary.data, m_lzo_dictionary.size
-			);
+			m_compress_tasks[i].first	= i;
+			m_compress_tasks[i].step	= task_count;
+			TaskScheduler.push	(m_compress_group, task_group::delegate_type(&m_compress_tasks[i], &compress_task::process));
 		}
+		TaskScheduler.wait		(m_compress_group);
+	}
+
+	if (!m_worker)
 		Device.Statistic->netServerCompressor.End();
+}
+
+void server_updates_compressor::pack_blocks()
+{
+	//the blocks are sent as they are, when there is no compression
+	bool const	compressed	= compressing();
+	NET_Packet*	dst_packet	= get_current_dest();
+	for (u32 i = 0; i < m_block_count; ++i)
+	{
+		NET_Packet const & block = compressed ? m_blocks[i]->compressed : m_blocks[i]->source;
+		//(sizeof(u16)*2) ::= block size(2) + zero_end(2)
 		//(sizeof(u16)*2 + 1) ::= w_begin(2) + compress_type(1) + zero_end(2)
-		if (dst_packet->w_tell() + m_compress_buf.B.count + (sizeof(u16)*2 + 1) < sizeof(dst_packet->B.data))
+		u32 const reserved = m_delta ? sizeof(u16)*2 : (sizeof(u16)*2 + 1);
+		if (dst_packet->w_tell() + block.B.count + reserved >= sizeof(dst_packet->B.data))
 		{
-			dst_packet->w_u16(static_cast<u16>(m_compress_buf.B.count));
-			dst_packet->w(m_compress_buf.B.data, m_compress_buf.B.count);
-			m_acc_buff.write_start();
-			return;
+			dst_packet->w_u16(0);
+			dst_packet = goto_next_dest();
 		}
-		dst_packet->w_u16(0);
-		dst_packet = goto_next_dest();
-		dst_packet->w_u16(static_cast<u16>(m_compress_buf.B.count));
-		dst_packet->w(m_compress_buf.B.data, m_compress_buf.B.count);
+		dst_packet->w_u16(static_cast<u16>(block.B.count));
+		dst_packet->w(block.B.data, block.B.count);
+	}
+	m_block_count = 0;
+}
+
+void server_updates_compressor::flush_accumulative_buffer()
+{
+	if (m_delta || compressing())
+	{
+		if (m_block_count == m_blocks.size())
+			m_blocks.push_back(xr_new<compress_block>());
+
+		NET_Packet & source	= m_blocks[m_block_count++]->source;
+		source.B.count		= m_acc_buff.B.count;
+		CopyMemory			(source.B.data, m_acc_buff.B.data, m_acc_buff.B.count);
 		m_acc_buff.write_start();
 		return;
-	} 
+	}
+	NET_Packet*	dst_packet = get_current_dest();
 	dst_packet->w(m_acc_buff.B.data, m_acc_buff.B.count);
 	goto_next_dest();
 	m_acc_buff.w_begin(M_UPDATE_OBJECTS);
@@ -244,7 +359,8 @@ void server_updates_compressor::flush_accumulative_buffer()
 
 void server_updates_compressor::write_update_for(u16 const enity, NET_Packet & update)
 {
-	if (g_sv_traffic_optimization_level & eto_last_change)
+	//the delta streams drop the unchanged updates against their own baselines
+	if (!m_delta && (g_sv_traffic_optimization_level & eto_last_change))
 	{
 		//if (m_updates_cache.get_last_equpdates(enity, update) >= max_eq_packets)
 		if (m_updates_cache.add_update(enity, update) >= max_eq_packets)
@@ -253,7 +369,8 @@ void server_updates_compressor::write_update_for(u16 const enity, NET_Packet & u
 		}
 	}
 	//(sizeof(u16)*2 + 1) ::= w_begin(2) + compress_type(1) + zero_end(2)
-	if (m_acc_buff.w_tell() + update.w_tell() + (sizeof(u16)*2 + 1) >= sizeof(m_acc_buff.B.data))
+	u32 const reserved = m_delta ? (delta_header_size + sizeof(u16)*2) : (sizeof(u16)*2 + 1);
+	if (m_acc_buff.w_tell() + update.w_tell() + reserved >= sizeof(m_acc_buff.B.data))
 	{
 		flush_accumulative_buffer();
 	}
@@ -266,17 +383,27 @@ void server_updates_compressor::end_updates(send_ready_updates_t::const_iterator
 	if (m_acc_buff.w_tell() > 2)
 		flush_accumulative_buffer();
 	
-	if ((g_sv_traffic_optimization_level & eto_ppmd_compression) ||
-		(g_sv_traffic_optimization_level & eto_lzo_compression))
+	if (m_delta || compressing())
 	{
+		if (compressing())
+			compress_blocks();
+		pack_blocks();
 		get_current_dest()->w_u16(0);
 	}
 
 	b = m_ready_for_send.begin();
 	e = m_ready_for_send.begin() + m_current_update + 1;
 
+	if (m_delta)
+	{
+		u8 const part_count = static_cast<u8>(m_current_update + 1);
+		VERIFY(m_current_update < 255);
+		for (send_ready_updates_t::const_iterator i = b; i != e; ++i)
+			(*i)->w_seek(delta_header_size - sizeof(u8), &part_count, sizeof(part_count));
+	}
+
 
-	if (g_sv_write_updates_bin)
+	if (g_sv_write_updates_bin && !m_worker)
 	{
 		if (!dbg_update_bins_writer)
 			create_update_bin_writer();
@@ -2,6 +2,7 @@
 #define XRSERVER_UPDATES_COMPRESSOR_INCLUDED
 
 #include "traffic_optimization.h"
+#include "../xrCore/task_scheduler.h"
 
 class last_updates_cache : private boost::noncopyable
 {
@@ -29,28 +30,63 @@ private:
 	
 };//class last_updates_cache
 
+// the updates are accumulated into blocks, which are compressed at the end of the updates,
+// on the task workers (LZO only, the PPMd coder keeps its model in the global state),
+// then packed into the packets in their order
 class server_updates_compressor
 {
 public:
-	server_updates_compressor	();
+	// a compressor used on a task worker itself compresses its blocks
+	// and allocates its packets on demand
+	explicit server_updates_compressor	(bool const worker = false);
 	~server_updates_compressor	();
 
 	typedef xr_vector<NET_Packet*>	send_ready_updates_t;
 
 	void	begin_updates		();
+	// a stream of M_UPDATE_OBJECTS_DELTA packets for a single client (see xrServer_client_updates.h)
+	void	begin_delta_updates	(u16 const sequence);
 	void	write_update_for	(u16 const enity, NET_Packet & update);
 	void	end_updates			(send_ready_updates_t::const_iterator & b,
 								 send_ready_updates_t::const_iterator & e);
 private:
 	//actor update size ~ 150 bytes..
+	//(sizeof(u16)*2 + 1*3) ::= w_begin(2) + compress_type(1) + sequence(2) + part(1) + part count(1)
+	static u32 const delta_header_size				= sizeof(u16)*2 + 3;
 	static u16 const max_eq_packets					= 3;
 	static u32 const entities_count					= 32;
 	static u32 const start_compress_buffer_size		= 1024 * 150 * entities_count;
 	
 	enum_traffic_optimization		m_traffic_optimization;
+	bool							m_delta;
+	u16								m_delta_sequence;
 
 	NET_Packet						m_acc_buff;
-	NET_Packet						m_compress_buf;
+
+	struct compress_block
+	{
+		NET_Packet					source;
+		NET_Packet					compressed;
+	};
+	typedef xr_vector<compress_block*>	compress_blocks_t;
+
+	struct compress_task
+	{
+		server_updates_compressor*	owner;
+		u32							first;
+		u32							step;
+		u8*							lzo_working_memory;
+		u8*							lzo_working_buffer;		// NULL when the memory is the compressor's one
+
+		void						process						();
+	};
+	typedef xr_vector<compress_task>	compress_tasks_t;
+
+	bool							m_worker;
+	compress_blocks_t				m_blocks;
+	u32								m_block_count;
+	compress_tasks_t				m_compress_tasks;
+	task_group						m_compress_group;
 	
 	last_updates_cache				m_updates_cache;
 
@@ -66,7 +102,12 @@ private:
 	void			init_compression			();
 	void			deinit_compression			();
 
+	bool			compressing					() const;
+	void			compress					(NET_Packet const & source, NET_Packet & dest, u8* lzo_working_memory) const;
+	void			compress_blocks				();
+	void			pack_blocks					();
 	void			flush_accumulative_buffer	();
+	void			start_dest					(NET_Packet* dest);
 	NET_Packet*		get_current_dest			();
 	NET_Packet*		goto_next_dest				();
 
@@ -348,6 +348,7 @@ IPureClient::IPureClient	(CTimer* timer): net_Statistic(timer)
 	NET						= NULL;
 	net_Address_server		= NULL;
 	net_Address_device		= NULL;
+	m_transport				= NULL;
 	device_timer			= timer;
 	net_TimeDelta_User		= 0;
 	net_Time_LastUpdate		= 0;
@@ -436,6 +437,16 @@ if(!psNET_direct_connect)
 	net_Syncronised	= FALSE;
 	net_Disconnected= FALSE;
 
+	if (psNET_Flags.test(NETFLAG_UDP_TRANSPORT))
+	{
+		// any free local port, unless it is set
+		if (!Connect_Udp(server_name, psSV_Port, bPortWasSet ? psCL_Port : 0, user_name_str, user_pass, password_str))
+			return		FALSE;
+
+		net_TimeDelta	= 0;
+		return			TRUE;
+	}
+
 	//---------------------------
 	string1024 tmp="";
 //	HRESULT CoInitializeExRes = CoInitializeEx(NULL, 0);
@@ -738,9 +749,83 @@ if(!psNET_direct_connect)
 	return			TRUE;
 }
 
+BOOL IPureClient::Connect_Udp(LPCSTR server_name, u32 server_port, u32 client_port, LPCSTR user_name, LPCSTR user_pass, LPCSTR password)
+{
+	SClientConnectData			cl_data;
+	cl_data.process_id			= GetCurrentProcessId();
+	xr_strcpy( cl_data.name, user_name );
+	xr_strcpy( cl_data.pass, user_pass );
+
+	IClientTransport::SSessionInfo	session;
+	ZeroMemory					(&session, sizeof(session));
+
+	m_transport					= create_udp_client_transport(this);
+	IClientTransport::EConnect res = m_transport->Connect(server_name, server_port, client_port, cl_data, password, session);
+	switch (res)
+	{
+	case IClientTransport::ConnectOk:
+		{
+			Msg("- IPureClient : connected to UDP port %d!", server_port);
+		}break;
+	case IClientTransport::ConnectNoHost:
+		{
+			OnInvalidHost();
+		}break;
+	case IClientTransport::ConnectPortBusy:
+		{
+			Msg("! IPureClient : port %d is BUSY!", client_port);
+		}break;
+	case IClientTransport::ConnectInvalidPassword:
+		{
+			OnInvalidPassword();
+		}break;
+	case IClientTransport::ConnectSessionFull:
+		{
+			OnSessionFull();
+		}break;
+	case IClientTransport::ConnectRejected:
+		{
+			Msg("Connection result : %s", session.reject_reason);
+		}break;
+	}
+	if (res != IClientTransport::ConnectOk)
+	{
+		xr_delete				(m_transport);
+		return					FALSE;
+	}
+
+	m_game_description			= session.game_descr;
+
+	// Create ONE node
+	HOST_NODE	NODE;
+	ZeroMemory	(&NODE, sizeof(HOST_NODE));
+	NODE.dpSessionName			= session.session_name;
+	net_Hosts.push_back			(NODE);
+	return						TRUE;
+}
+
+void IPureClient::OnTransportReceive(void* data, u32 size)
+{
+	MultipacketReciever::RecievePacket( data, size );
+}
+
+void IPureClient::OnTransportTerminate(LPCSTR reason)
+{
+	net_Disconnected	= TRUE;
+	OnSessionTerminate	(reason);
+#ifdef DEBUG				
+	Msg("- Session terminated : %s", reason);
+#endif
+}
+
 void IPureClient::Disconnect()
 {
 	if( NET )	NET->Close(0);
+	if (m_transport)
+	{
+		m_transport->Close	();
+		xr_delete			(m_transport);
+	}
 
     // Clean up Host _list_
 	net_csEnumeration.Enter			();
@@ -959,6 +1044,11 @@ void	IPureClient::SendTo_LL(void* data, u32 size, u32 dwFlags, u32 dwTimeout)
 
     net_Statistic.dwBytesSended	+= size;
 	
+	if (m_transport)
+	{
+		m_transport->Send	(data, size, dwFlags);
+		return;
+	}
 
 	// verify
 	VERIFY(desc.dwBufferSize);
@@ -988,6 +1078,9 @@ void	IPureClient::Send( NET_Packet& packet, u32 dwFlags, u32 dwTimeout )
 void	IPureClient::Flush_Send_Buffer		()
 {
     MultipacketSender::FlushSendBuffer( 0 );
+
+	if (m_transport)
+		m_transport->Flush	();
 }
 
 BOOL	IPureClient::net_HasBandwidth	()
@@ -1011,12 +1104,20 @@ BOOL	IPureClient::net_HasBandwidth	()
 	}else
 	if (0 != psNET_ClientUpdate && (dwTime-net_Time_LastUpdate)>dwInterval)	
 	{
-		HRESULT hr;
-		R_ASSERT			(NET);
 		// check queue for "empty" state
 		DWORD				dwPending=0;
-		hr					= NET->GetSendQueueInfo(&dwPending,0,0);
-		if (FAILED(hr)) return FALSE;
+		if (m_transport)
+		{
+			u32				pending;
+			if (!m_transport->GetSendQueueInfo(pending)) return FALSE;
+			dwPending		= pending;
+		}else
+		{
+			HRESULT hr;
+			R_ASSERT			(NET);
+			hr					= NET->GetSendQueueInfo(&dwPending,0,0);
+			if (FAILED(hr)) return FALSE;
+		}
 
 		if (dwPending > u32(psNET_ClientPending))	
 		{
@@ -1039,8 +1140,14 @@ void	IPureClient::UpdateStatistic()
 	DPN_CONNECTION_INFO	CI;
 	ZeroMemory			(&CI,sizeof(CI));
 	CI.dwSize			= sizeof(CI);
-	HRESULT hr					= NET->GetConnectionInfo(&CI,0);
-	if (FAILED(hr)) return;
+	if (m_transport)
+	{
+		if (!m_transport->GetConnectionInfo(CI)) return;
+	}else
+	{
+		HRESULT hr					= NET->GetConnectionInfo(&CI,0);
+		if (FAILED(hr)) return;
+	}
 
 	net_Statistic.Update(CI);
 }
@@ -1051,11 +1158,16 @@ void	IPureClient::Sync_Thread	()
 
 	//***** Ping server
 	net_DeltaArray.clear();
-	R_ASSERT			(NET);
-	for (; NET && !net_Disconnected; )
+	R_ASSERT			(NET || m_transport);
+	for (; (NET || m_transport) && !net_Disconnected; )
 	{
 		// Waiting for queue empty state
 		if (net_Syncronised)	break; // Sleep(2000);
+		else if (m_transport) {
+			u32				pending=0;
+			while (m_transport->GetSendQueueInfo(pending) && pending)
+				Sleep			(1);
+		}
 		else {
 			DWORD			dwPending=0;
 			do {
@@ -1075,9 +1187,14 @@ void	IPureClient::Sync_Thread	()
 			DPNHANDLE						hAsync=0;
 			desc.dwBufferSize				= sizeof(clPing);
 			desc.pBufferData				= LPBYTE(&clPing);
-			if (0==NET || net_Disconnected)	break;
+			if ((0==NET && 0==m_transport) || net_Disconnected)	break;
 
-			if (FAILED(NET->Send(&desc,1,0,0,&hAsync,net_flags(FALSE,FALSE,TRUE))))	{
+			if (m_transport)
+			{
+				m_transport->Send	(&clPing, sizeof(clPing), net_flags(FALSE,FALSE,TRUE));
+				m_transport->Flush	();
+			}
+			else if (FAILED(NET->Send(&desc,1,0,0,&hAsync,net_flags(FALSE,FALSE,TRUE))))	{
 				Msg("* CLIENT: SyncThread: EXIT. (failed to send - disconnected?)");
 				break;
 			}
@@ -1149,6 +1266,7 @@ BOOL	IPureClient::net_IsSyncronised()
 bool	IPureClient::GetServerAddress		(ip_address& pAddress, DWORD* pPort)
 {
 	*pPort		= 0;
+	if (m_transport) return m_transport->GetServerAddress(pAddress, pPort);
 	if (!net_Address_server) return false;
 
 	WCHAR wstrHostname[ 2048 ] = {0};	
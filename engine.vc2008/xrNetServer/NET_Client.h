@@ -2,6 +2,7 @@
 
 #include "net_shared.h"
 #include "NET_Common.h"
+#include "NET_Transport.h"
 
 struct ip_address;
 
@@ -28,7 +29,8 @@ public:
 class XRNETSERVER_API 
 IPureClient
   : private MultipacketReciever,
-    private MultipacketSender
+    private MultipacketSender,
+    private IClientTransportHandler
 {
 	enum ConnectionState
 	{
@@ -50,6 +52,7 @@ protected:
 	IDirectPlay8Client*		NET;
 	IDirectPlay8Address*	net_Address_device;
 	IDirectPlay8Address*	net_Address_server;
+	IClientTransport*		m_transport;			// instead of DirectPlay, when net_udp_transport is on
 		
 	xrCriticalSection		net_csEnumeration;
 	xr_vector<HOST_NODE>	net_Hosts;
@@ -133,5 +136,10 @@ private:
 
     virtual void    _Recieve( const void* data, u32 data_size, u32 param );
     virtual void    _SendTo_LL( const void* data, u32 size, u32 flags, u32 timeout );
+
+			BOOL	Connect_Udp				(LPCSTR server_name, u32 server_port, u32 client_port, LPCSTR user_name, LPCSTR user_pass, LPCSTR password);
+
+	virtual void	OnTransportReceive		(void* data, u32 size);
+	virtual void	OnTransportTerminate	(LPCSTR reason);
 };
 
@@ -0,0 +1,273 @@
+#include "stdafx.h"
+#include "NET_Common.h"
+#include "net_server.h"
+#include "net_client.h"
+#include "net_messages.h"
+#include <functional>
+
+// net_load_test : a dedicated server and the clients in this process over the loopback,
+// DirectPlay first, then the UDP transport. The clients send timestamps at psNET_ClientUpdate,
+// the server echoes them and sends every client an update at psNET_ServerUpdate.
+
+namespace load_test {
+
+u16 const	message_echo		= 0xFFF0;
+u16 const	message_update		= 0xFFF1;
+u32 const	update_size			= 300;
+u32 const	connect_timeout		= 5000;
+
+class server : public IPureServer
+{
+public:
+						server				(CTimer* timer) : IPureServer(timer, TRUE) {}
+
+	virtual IClient*	new_client			(SClientConnectData* cl_data)
+	{
+		IClient* C			= client_Create();
+		C->ID				= cl_data->clientID;
+		C->process_id		= cl_data->process_id;
+		C->name				= cl_data->name;
+		C->server			= this;
+		net_players.AddNewClient	(C);
+		return				C;
+	}
+	virtual u32			max_players_limit	() const			{ return 1024; }
+
+	virtual IClient*	client_Create		()					{ return xr_new<IClient>(device_timer); }
+	virtual void		client_Replicate	()					{}
+	virtual void		client_Destroy		(IClient* C)
+	{
+		IClient* removed	= net_players.FindAndEraseClient(std::bind1st(std::equal_to<IClient*>(), C));
+		xr_delete			(removed);
+	}
+
+	virtual u32			OnMessage			(NET_Packet& P, ClientID sender)
+	{
+		u16					type;
+		P.r_begin			(type);
+		if (type == message_echo)
+			SendTo_Buf		(sender, P.B.data, P.B.count, net_flags(FALSE,TRUE));
+		return				0;
+	}
+
+	void				update				(bool const send_updates)
+	{
+		struct sender
+		{
+			server*		owner;
+			bool		send_updates;
+			NET_Packet	P;
+
+			void operator()	(IClient* C)
+			{
+				if (!C->flags.bConnected)
+				{
+					MSYS_CONFIG		msgConfig;
+					msgConfig.sign1	= 0x12071980;
+					msgConfig.sign2	= 0x26111975;
+					owner->SendTo_Buf	(C->ID, &msgConfig, sizeof(msgConfig), net_flags(TRUE,TRUE,TRUE,TRUE));
+					C->flags.bConnected	= TRUE;
+				}else if (send_updates)
+					owner->SendTo_Buf	(C->ID, P.B.data, P.B.count, net_flags(FALSE,TRUE));
+			}
+		} s;
+		s.owner				= this;
+		s.send_updates		= send_updates;
+		s.P.w_begin			(message_update);
+		for (u32 i = 0; i < update_size - sizeof(u16); ++i)
+			s.P.w_u8		(u8(i));
+
+		ForEachClientDo		(s);
+		Flush_Clients_Buffers	();
+	}
+
+	void				destroy_clients		()
+	{
+		struct any
+		{
+			static bool	generator	(IClient*)	{ return true; }
+		};
+		IClient* C			= net_players.GetFoundClient(&any::generator);
+		while (C)
+		{
+			client_Destroy	(C);
+			C				= net_players.GetFoundClient(&any::generator);
+		}
+	}
+}; //class server
+
+class client : public IPureClient
+{
+public:
+						client				(CTimer* timer) : IPureClient(timer), echoes(0), rtt_sum(0), rtt_max(0), updates(0) {}
+
+	virtual void		OnMessage			(void* data, u32 size)
+	{
+		NET_Packet			P;
+		P.construct			(data, size);
+		u16					type;
+		P.r_begin			(type);
+		if (type == message_echo)
+		{
+			u32 const	rtt		= TimerAsync(device_timer) - P.r_u32();
+			stats_lock.Enter();
+			++echoes;
+			rtt_sum		+= rtt;
+			rtt_max		= _max(rtt_max, rtt);
+			stats_lock.Leave();
+		}else if (type == message_update)
+			InterlockedIncrement	(&updates);
+	}
+
+	void				send_echo			()
+	{
+		NET_Packet			P;
+		P.w_begin			(message_echo);
+		P.w_u32				(TimerAsync(device_timer));
+		Send				(P, net_flags(FALSE,TRUE));
+		Flush_Send_Buffer	();
+	}
+
+	xrCriticalSection	stats_lock;
+	u32					echoes;
+	u64					rtt_sum;
+	u32					rtt_max;
+	volatile LONG		updates;
+}; //class client
+
+static u64 process_time()
+{
+	FILETIME			creation, exit, kernel, user;
+	GetProcessTimes		(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+	return				(u64(kernel.dwHighDateTime) << 32) + kernel.dwLowDateTime + (u64(user.dwHighDateTime) << 32) + user.dwLowDateTime;
+}
+
+static void run(LPCSTR transport_name, u32 const client_count, u32 const seconds)
+{
+	CTimer				timer;
+	timer.Start			();
+
+	GameDescriptionData	game_descr;
+	ZeroMemory			(&game_descr, sizeof(game_descr));
+	xr_strcpy			(game_descr.map_name, "load_test");
+
+	server*				S = xr_new<server>(&timer);
+	if (S->Connect("load_test", game_descr) != IPureServer::ErrNoError)
+	{
+		Msg				("! Net load test [%s] : can't host the server", transport_name);
+		xr_delete		(S);
+		return;
+	}
+
+	xr_vector<client*>	clients;
+	u32 const			connect_start = timer.GetElapsed_ms();
+	for (u32 i = 0; i < client_count; ++i)
+	{
+		string256		options;
+		if (psNET_Flags.test(NETFLAG_UDP_TRANSPORT))
+			xr_sprintf	(options, "localhost/name=load%d/port=%d", i, S->GetPort());
+		else
+			xr_sprintf	(options, "localhost/name=load%d/port=%d/portcl=%d", i, S->GetPort(), S->GetPort() + 1 + i);
+
+		client*			C = xr_new<client>(&timer);
+		if (!C->Connect(options))
+		{
+			xr_delete	(C);
+			continue;
+		}
+		clients.push_back	(C);
+	}
+
+	// the server confirms the connections
+	u32 const			confirm_start = timer.GetElapsed_ms();
+	for (;;)
+	{
+		S->update		(false);
+		u32 completed	= 0;
+		for (u32 i = 0; i < clients.size(); ++i)
+			completed	+= clients[i]->net_isCompleted_Connect() ? 1 : 0;
+		if ((completed == clients.size()) || (timer.GetElapsed_ms() - confirm_start > connect_timeout))
+			break;
+		Sleep			(1);
+	}
+	u32 const			connect_time = timer.GetElapsed_ms() - connect_start;
+
+	u32 const			sv_interval	= 1000/_max(psNET_ServerUpdate, 1);
+	u32 const			cl_interval	= 1000/_max(psNET_ClientUpdate, 1);
+	u32 const			start		= timer.GetElapsed_ms();
+	u64 const			cpu_start	= process_time();
+	u32					sv_last		= start;
+	u32					cl_last		= start;
+	for (u32 now = start; now - start < seconds*1000; now = timer.GetElapsed_ms())
+	{
+		bool const		sv_update	= (now - sv_last >= sv_interval);
+		if (sv_update)
+			sv_last		= now;
+		S->update		(sv_update);
+
+		if (now - cl_last >= cl_interval)
+		{
+			cl_last		= now;
+			for (u32 i = 0; i < clients.size(); ++i)
+				if (clients[i]->net_isCompleted_Connect() && !clients[i]->net_isDisconnected())
+					clients[i]->send_echo	();
+		}
+		Sleep			(1);
+	}
+	u32 const			duration	= timer.GetElapsed_ms() - start;
+	u64 const			cpu			= process_time() - cpu_start;
+
+	u32					connected	= 0;
+	u32					echoes		= 0;
+	u64					rtt_sum		= 0;
+	u32					rtt_max		= 0;
+	u64					updates		= 0;
+	for (u32 i = 0; i < clients.size(); ++i)
+	{
+		client*			C = clients[i];
+		connected		+= C->net_isCompleted_Connect() ? 1 : 0;
+		C->stats_lock.Enter	();
+		echoes			+= C->echoes;
+		rtt_sum			+= C->rtt_sum;
+		rtt_max			= _max(rtt_max, C->rtt_max);
+		C->stats_lock.Leave	();
+		updates			+= u64(C->updates);
+
+		C->Disconnect	();
+		xr_delete		(C);
+	}
+
+	S->Disconnect		();
+	S->destroy_clients	();
+	xr_delete			(S);
+
+	Msg					("* Net load test [%s] : %d/%d clients connected in %d ms", transport_name, connected, client_count, connect_time);
+	if (!connected)
+		return;
+
+	// FILETIME counts 100 ns
+	Msg					("*   rtt %.1f ms average, %d ms max, %.1f updates/client/s of %d, %.1f%% of a core",
+		echoes ? float(double(rtt_sum)/double(echoes)) : 0.f, rtt_max,
+		float(double(updates)*1000.0/double(u64(connected)*duration)), 1000/sv_interval,
+		float(double(cpu)/(double(duration)*100.0)));
+}
+
+} //namespace load_test
+
+void net_load_test(u32 client_count, u32 seconds)
+{
+	Flags32 const		flags			= psNET_Flags;
+	BOOL const			direct_connect	= psNET_direct_connect;
+
+	Msg					("* Net load test : %d clients, %d s, server updates %d/s, client updates %d/s",
+		client_count, seconds, psNET_ServerUpdate, psNET_ClientUpdate);
+
+	psNET_Flags.set		(NETFLAG_UDP_TRANSPORT, FALSE);
+	load_test::run		("DirectPlay", client_count, seconds);
+
+	psNET_Flags.set		(NETFLAG_UDP_TRANSPORT, TRUE);
+	load_test::run		("UDP", client_count, seconds);
+
+	psNET_Flags			= flags;
+	psNET_direct_connect= direct_connect;
+}
@@ -220,6 +220,7 @@ IPureServer::IPureServer	(CTimer* timer, BOOL	Dedicated)
 	SV_Client				= NULL;
 	NET						= NULL;
 	net_Address_device		= NULL;
+	m_transport				= NULL;
 	pSvNetLog				= NULL;//xr_new<INetLog>("logs\\net_sv_log.log", TimeGlobal(device_timer));
 #ifdef DEBUG
 	sender_functor_invoked = false;
@@ -277,7 +278,7 @@ IPureServer::EConnect IPureServer::Connect(LPCSTR options, GameDescriptionData &
 			strncpy_s(tmpStr, sMaxPlayers, 63);
 		dwMaxPlayers = atol(tmpStr);
 	}
-	if (dwMaxPlayers > 32 || dwMaxPlayers<1) dwMaxPlayers = 32;
+	if (dwMaxPlayers > max_players_limit() || dwMaxPlayers<1) dwMaxPlayers = max_players_limit();
 #ifdef DEBUG
 	Msg("MaxPlayers = %d", dwMaxPlayers);
 #endif // #ifdef DEBUG
@@ -299,7 +300,30 @@ IPureServer::EConnect IPureServer::Connect(LPCSTR options, GameDescriptionData &
 	}
 	//-------------------------------------------------------------------
 
-if(!psNET_direct_connect)
+if(!psNET_direct_connect && psNET_Flags.test(NETFLAG_UDP_TRANSPORT))
+{
+	// the server player of DirectPlay is not a peer here
+	m_transport				= create_udp_server_transport(this);
+	u32 const max_peers		= (m_bDedicated) ? (dwMaxPlayers+1) : dwMaxPlayers;
+
+	psNET_Port = dwServerPort;
+	while (!m_transport->Host(psNET_Port, max_peers, password_str, session_name, game_descr))
+	{
+		Msg("! IPureServer : port %d is BUSY!", psNET_Port);
+		if (bPortWasSet || (psNET_Port >= END_PORT_LAN))
+		{
+			xr_delete	(m_transport);
+			return		ErrConnect;
+		}
+		psNET_Port++;
+	}
+	Msg("- IPureServer : created on UDP port %d!", psNET_Port);
+
+	// there is no server player to create, DirectPlay does it on DPN_MSGID_CREATE_PLAYER
+	string512				res;
+	Assign_ServerType		(res);
+}
+else if(!psNET_direct_connect)
 {
 	//---------------------------
 #ifdef DEBUG
@@ -446,6 +470,11 @@ void IPureServer::Disconnect	()
 	}
 
     if( NET )	NET->Close(0);
+	if (m_transport)
+	{
+		m_transport->Close	();
+		xr_delete			(m_transport);
+	}
 	
 	// Release interfaces
     _RELEASE	(net_Address_device);
@@ -506,45 +535,14 @@ HRESULT	IPureServer::net_Handler(u32 dwMessageType, PVOID pMessage)
 	case DPN_MSGID_DESTROY_PLAYER:
 		{
 			PDPNMSG_DESTROY_PLAYER	msg = PDPNMSG_DESTROY_PLAYER(pMessage);
-			IClient* tmp_client = net_players.GetFoundClient(
-				ClientIdSearchPredicate(static_cast<ClientID>(msg->dpnidPlayer))
-			);
-			if (tmp_client)
-			{
-				tmp_client->flags.bConnected	= FALSE;
-				tmp_client->flags.bReconnect	= FALSE;
-				OnCL_Disconnected	(tmp_client);
-				// real destroy
-				client_Destroy		(tmp_client);
-			}
+			net_DestroyPlayer		(static_cast<ClientID>(msg->dpnidPlayer));
 		}
 		break;
 	case DPN_MSGID_RECEIVE:
         {
 
             PDPNMSG_RECEIVE	pMsg = PDPNMSG_RECEIVE(pMessage);
-			void*	m_data		= pMsg->pReceiveData;
-			u32		m_size		= pMsg->dwReceiveDataSize;
-			DPNID   m_sender	= pMsg->dpnidSender;
-
-			MSYS_PING*	m_ping	= (MSYS_PING*)m_data;
-			
-			if ((m_size>2*sizeof(u32)) && (m_ping->sign1==0x12071980) && (m_ping->sign2==0x26111975))
-			{
-				// this is system message
-				if (m_size==sizeof(MSYS_PING))
-				{
-					// ping - save server time and reply
-					m_ping->dwTime_Server	= TimerAsync(device_timer);
-					ClientID ID; ID.set(m_sender);
-					//						IPureServer::SendTo_LL	(ID,m_data,m_size,net_flags(FALSE,FALSE,TRUE));
-					IPureServer::SendTo_Buf	(ID,m_data,m_size,net_flags(FALSE,FALSE,TRUE, TRUE));
-				}
-			} 
-			else 
-			{
-                MultipacketReciever::RecievePacket( pMsg->pReceiveData, pMsg->dwReceiveDataSize, m_sender );
-			}
+			net_Receive		(pMsg->pReceiveData, pMsg->dwReceiveDataSize, static_cast<ClientID>(pMsg->dpnidSender));
         } break;
         
 	case DPN_MSGID_INDICATE_CONNECT :
@@ -554,17 +552,11 @@ HRESULT	IPureServer::net_Handler(u32 dwMessageType, PVOID pMessage)
 			ip_address			HAddr;
 			GetClientAddress	(msg->pAddressPlayer, HAddr);
 
-			if (GetBannedClient(HAddr)) 
-			{
-				msg->dwReplyDataSize	= sizeof(NET_BANNED_STR);
-				msg->pvReplyData		= NET_BANNED_STR;
-				return					S_FALSE;
-			};
-			//first connected client is SV_Client so if it is NULL then this server client tries to connect ;)
-			if (SV_Client && !m_ip_filter.is_ip_present(HAddr.m_data.data))
+			LPCSTR	reason		= net_CheckAddress(HAddr);
+			if (reason)
 			{
-				msg->dwReplyDataSize	= sizeof(NET_NOTFOR_SUBNET_STR);
-				msg->pvReplyData		= NET_NOTFOR_SUBNET_STR;
+				msg->dwReplyDataSize	= xr_strlen(reason) + 1;
+				msg->pvReplyData		= (PVOID)reason;
 				return					S_FALSE;
 			}
 		}break;
@@ -572,6 +564,74 @@ HRESULT	IPureServer::net_Handler(u32 dwMessageType, PVOID pMessage)
     return S_OK;
 }
 
+void IPureServer::net_Receive(void* data, u32 size, ClientID const & sender)
+{
+	MSYS_PING*	m_ping	= (MSYS_PING*)data;
+	
+	if ((size>2*sizeof(u32)) && (m_ping->sign1==0x12071980) && (m_ping->sign2==0x26111975))
+	{
+		// this is system message
+		if (size==sizeof(MSYS_PING))
+		{
+			// ping - save server time and reply
+			m_ping->dwTime_Server	= TimerAsync(device_timer);
+			//						IPureServer::SendTo_LL	(sender,data,size,net_flags(FALSE,FALSE,TRUE));
+			IPureServer::SendTo_Buf	(sender,data,size,net_flags(FALSE,FALSE,TRUE, TRUE));
+		}
+	} 
+	else 
+	{
+		MultipacketReciever::RecievePacket( data, size, sender.value() );
+	}
+}
+
+void IPureServer::net_DestroyPlayer(ClientID const & ID)
+{
+	IClient* tmp_client = net_players.GetFoundClient(
+		ClientIdSearchPredicate(ID)
+	);
+	if (tmp_client)
+	{
+		tmp_client->flags.bConnected	= FALSE;
+		tmp_client->flags.bReconnect	= FALSE;
+		OnCL_Disconnected	(tmp_client);
+		// real destroy
+		client_Destroy		(tmp_client);
+	}
+}
+
+LPCSTR IPureServer::net_CheckAddress(ip_address const & Address)
+{
+	if (GetBannedClient(Address)) 
+		return					NET_BANNED_STR;
+
+	//first connected client is SV_Client so if it is NULL then this server client tries to connect ;)
+	if (SV_Client && !m_ip_filter.is_ip_present(Address.m_data.data))
+		return					NET_NOTFOR_SUBNET_STR;
+
+	return						NULL;
+}
+
+LPCSTR IPureServer::OnTransportConnect(ip_address const & address)
+{
+	return						net_CheckAddress(address);
+}
+
+void IPureServer::OnTransportCreatePlayer(SClientConnectData & data)
+{
+	new_client					(&data);
+}
+
+void IPureServer::OnTransportDestroyPlayer(ClientID const & ID)
+{
+	net_DestroyPlayer			(ID);
+}
+
+void IPureServer::OnTransportReceive(ClientID const & sender, void* data, u32 size)
+{
+	net_Receive					(data, size, sender);
+}
+
 void	IPureServer::Flush_Clients_Buffers	()
 {
     #if NET_LOG_PACKETS
@@ -589,6 +649,9 @@ void	IPureServer::Flush_Clients_Buffers	()
 	net_players.ForEachClientDo(
 		LocalSenderFunctor::FlushBuffer
 	);
+
+	if (m_transport)
+		m_transport->Flush	();
 }
 
 void	IPureServer::SendTo_Buf(ClientID id, void* data, u32 size, u32 dwFlags, u32 dwTimeout)
@@ -630,6 +693,12 @@ void	IPureServer::SendTo_LL(ClientID ID/*DPNID ID*/, void* data, u32 size, u32 d
 	VERIFY		(desc.dwBufferSize);
 	VERIFY		(desc.pBufferData);
 
+	if (m_transport)
+	{
+		m_transport->SendTo	(ID, data, size, dwFlags);
+		return;
+	}
+
 	DPNHANDLE	hAsync	= 0;
 	HRESULT		_hr		= NET->SendTo(
 		ID.value(),
@@ -744,8 +813,17 @@ BOOL IPureServer::HasBandwidth			(IClient* C)
 	{
 		// check queue for "empty" state
 		DWORD				dwPending;
-		hr					= NET->GetSendQueueInfo(C->ID.value(),&dwPending,0,0);
-		if (FAILED(hr))		return FALSE;
+		if (m_transport)
+		{
+			u32				pending;
+			if (!m_transport->GetSendQueueInfo(C->ID, pending))
+				return		FALSE;
+			dwPending		= pending;
+		}else
+		{
+			hr				= NET->GetSendQueueInfo(C->ID.value(),&dwPending,0,0);
+			if (FAILED(hr))	return FALSE;
+		}
 
 		if (dwPending > u32(psNET_ServerPending))	
 		{
@@ -767,7 +845,11 @@ void	IPureServer::UpdateClientStatistic		(IClient* C)
 	DPN_CONNECTION_INFO			CI;
 	ZeroMemory					(&CI,sizeof(CI));
 	CI.dwSize					= sizeof(CI);
-	if(!psNET_direct_connect)
+	if (m_transport)
+	{
+		if (!m_transport->GetConnectionInfo(C->ID, CI))
+			return;
+	}else if(!psNET_direct_connect)
 	{
 		HRESULT hr					= NET->GetConnectionInfo(C->ID.value(),&CI,0);
 		if (FAILED(hr))				return;
@@ -802,6 +884,9 @@ bool			IPureServer::DisconnectClient	(IClient* C, LPCSTR Reason)
 {
 	if (!C) return false;
 
+	if (m_transport)
+		return m_transport->DestroyClient(C->ID, Reason);
+
 	HRESULT res = NET->DestroyClient(C->ID.value(), Reason, xr_strlen(Reason)+1, 0);
 	CHK_DX(res);
 	return true;
@@ -871,6 +956,9 @@ bool IPureServer::GetClientAddress	(IDirectPlay8Address* pClientAddress, ip_addr
 
 bool IPureServer::GetClientAddress	(ClientID ID, ip_address& Address, DWORD* pPort)
 {
+	if (m_transport)
+		return m_transport->GetClientAddress	(ID, Address, pPort);
+
 	IDirectPlay8Address* pClAddr	= NULL;
 	CHK_DX(NET->GetClientAddress	(ID.value(), &pClAddr, 0));
 
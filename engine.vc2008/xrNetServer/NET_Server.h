@@ -4,6 +4,7 @@
 #include "ip_filter.h"
 #include "NET_Common.h"
 #include "NET_PlayersMonitor.h"
+#include "NET_Transport.h"
 
 struct SClientConnectData
 {
@@ -146,7 +147,8 @@ class CServerInfo;
 
 class XRNETSERVER_API 
 IPureServer
-  : private MultipacketReciever
+  : private MultipacketReciever,
+	private IServerTransportHandler
 {
 public:
 	enum EConnect
@@ -159,6 +161,7 @@ protected:
 	shared_str				connect_options;
 	IDirectPlay8Server*		NET;
 	IDirectPlay8Address*	net_Address_device;
+	IServerTransport*		m_transport;			// instead of DirectPlay, when net_udp_transport is on
 	
 	NET_Compressor			net_Compressor;
 
@@ -188,6 +191,7 @@ protected:
 	IClient*				ID_to_client		(ClientID ID, bool ScanAll = false);
 	
 	virtual IClient*		new_client			( SClientConnectData* cl_data )   =0;
+	virtual u32				max_players_limit	() const	{ return 32; }
 			bool			GetClientAddress	(IDirectPlay8Address* pClientAddress, ip_address& Address, DWORD* pPort = NULL);
 
 			IBannedClient*	GetBannedClient		(const ip_address& Address);			
@@ -291,5 +295,14 @@ private:
 #endif
 
     virtual void    _Recieve( const void* data, u32 data_size, u32 param );
+
+			void			net_Receive			(void* data, u32 size, ClientID const & sender);
+			void			net_DestroyPlayer	(ClientID const & ID);
+			LPCSTR			net_CheckAddress	(ip_address const & Address);
+
+	virtual LPCSTR			OnTransportConnect			(ip_address const & address);
+	virtual void			OnTransportCreatePlayer		(SClientConnectData & data);
+	virtual void			OnTransportDestroyPlayer	(ClientID const & ID);
+	virtual void			OnTransportReceive			(ClientID const & sender, void* data, u32 size);
 };
 
@@ -35,8 +35,12 @@ enum	{
 	NETFLAG_DBG_DUMPSIZE		= (1<<1),
 	NETFLAG_LOG_SV_PACKETS		= (1<<2),
 	NETFLAG_LOG_CL_PACKETS		= (1<<3),
+	NETFLAG_UDP_TRANSPORT		= (1<<4),
 };
 
+// the server and the clients in this process, over DirectPlay and over the UDP transport
+XRNETSERVER_API void	net_load_test	(u32 client_count, u32 seconds);
+
 IC u32 TimeGlobal	(CTimer* timer)	{ return timer->GetElapsed_ms();	}
 IC u32 TimerAsync	(CTimer* timer) { return TimeGlobal	(timer);		}
 
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "net_shared.h"
+#include "NET_Common.h"
+
+struct ip_address;
+struct SClientConnectData;
+
+// The transports under IPureServer and IPureClient other than DirectPlay (the default one).
+// The events come from the transport's own thread, the way DirectPlay calls net_Handler.
+// The flags of the sends are the DPNSEND_* ones : DPNSEND_GUARANTEED messages are delivered
+// in order, the others may be lost, and the ones without DPNSEND_NONSEQUENTIAL are dropped when
+// a later one has been delivered already.
+
+//==============================================================================
+
+class IServerTransportHandler
+{
+public:
+	virtual					~IServerTransportHandler	() {}
+
+	// NULL accepts the connection, the reason the client is rejected with otherwise
+	virtual LPCSTR			OnTransportConnect			(ip_address const & address)							= 0;
+	// the player is created, clientID is set
+	virtual void			OnTransportCreatePlayer		(SClientConnectData & data)								= 0;
+	virtual void			OnTransportDestroyPlayer	(ClientID const & ID)									= 0;
+	virtual void			OnTransportReceive			(ClientID const & sender, void* data, u32 size)			= 0;
+};
+
+class XRNETSERVER_API IServerTransport
+{
+public:
+	virtual					~IServerTransport			() {}
+
+	virtual bool			Host						(u32 port, u32 max_players, LPCSTR password, LPCSTR session_name, GameDescriptionData const & game_descr)	= 0;
+	virtual void			Close						()														= 0;
+
+	// queued till the transport sends them, Flush wakes it up
+	virtual void			SendTo						(ClientID const & ID, void const* data, u32 size, u32 flags)	= 0;
+	virtual void			Flush						()														= 0;
+	virtual bool			DestroyClient				(ClientID const & ID, LPCSTR reason)					= 0;
+
+	virtual bool			GetSendQueueInfo			(ClientID const & ID, u32 & pending)					= 0;
+	virtual bool			GetConnectionInfo			(ClientID const & ID, DPN_CONNECTION_INFO & info)		= 0;
+	virtual bool			GetClientAddress			(ClientID const & ID, ip_address & address, DWORD* port)= 0;
+};
+
+//==============================================================================
+
+class IClientTransportHandler
+{
+public:
+	virtual					~IClientTransportHandler	() {}
+
+	virtual void			OnTransportReceive			(void* data, u32 size)									= 0;
+	virtual void			OnTransportTerminate		(LPCSTR reason)											= 0;
+};
+
+class XRNETSERVER_API IClientTransport
+{
+public:
+	enum EConnect
+	{
+		ConnectOk,
+		ConnectNoHost,
+		ConnectPortBusy,
+		ConnectInvalidPassword,
+		ConnectSessionFull,
+		ConnectRejected,
+	};
+
+	struct SSessionInfo
+	{
+		string256			session_name;
+		string256			reject_reason;
+		GameDescriptionData	game_descr;
+	};
+
+	virtual					~IClientTransport			() {}
+
+	// local_port 0 binds any free one
+	virtual EConnect		Connect						(LPCSTR host, u32 port, u32 local_port, SClientConnectData const & data, LPCSTR password, SSessionInfo & session)	= 0;
+	virtual void			Close						()														= 0;
+
+	virtual void			Send						(void const* data, u32 size, u32 flags)					= 0;
+	virtual void			Flush						()														= 0;
+
+	virtual bool			GetSendQueueInfo			(u32 & pending)											= 0;
+	virtual bool			GetConnectionInfo			(DPN_CONNECTION_INFO & info)							= 0;
+	virtual bool			GetServerAddress			(ip_address & address, DWORD* port)						= 0;
+};
+
+//==============================================================================
+
+XRNETSERVER_API IServerTransport*	create_udp_server_transport	(IServerTransportHandler* handler);
+XRNETSERVER_API IClientTransport*	create_udp_client_transport	(IClientTransportHandler* handler);
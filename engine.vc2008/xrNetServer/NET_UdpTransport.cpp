@@ -0,0 +1,1637 @@
+#include "stdafx.h"
+#include "NET_Transport.h"
+#include "NET_Server.h"
+
+#pragma warning(push)
+#pragma warning(disable:4995)
+#include <WINSOCK2.H>
+#include <Ws2tcpip.h>
+#pragma warning(pop)
+
+// One socket and one thread serve all the connections of a host.
+//
+// datagram        : u8 tag, u8 kind, payload
+// data datagram   : u16 sequence, u16 the newest sequence received, u32 mask (bit 0 - that one,
+//                   bit i - the one i before it), then the chunks
+// chunk           : u8 flags, u16 size, u16 sequence, [u8 fragment index, u8 fragment count], size bytes
+//
+// The reliable chunks are numbered in the order they are queued, sent again till a datagram
+// carrying them is acknowledged, and delivered in this order. The unreliable messages are
+// numbered separately, the sequential ones older than the last delivered are dropped.
+// The messages queued between two flushes are coalesced into datagrams up to the MTU, and the
+// thread drains all the datagrams received before it services the connections.
+
+namespace udp {
+
+u8 const	tag					= 0xD7;		// neither NET_TAG_* nor the first byte of the MSYS signs
+u32 const	protocol			= 2;
+u32 const	mtu					= 1200;		// never fragmented by IP
+u32 const	header_size			= 2*sizeof(u8) + 2*sizeof(u16) + sizeof(u32);
+u32 const	chunk_header_size	= sizeof(u8) + 2*sizeof(u16);
+u32 const	fragment_header_size= 2*sizeof(u8);
+u32 const	chunk_max_size		= mtu - header_size - chunk_header_size;
+u32 const	fragment_size		= chunk_max_size - fragment_header_size;
+u32 const	max_fragments		= 32;
+u32 const	window				= 512;		// reliable chunks in flight
+u32 const	history				= 256;		// datagrams waiting for the acknowledgement
+u32 const	fragment_slots		= 4;		// unreliable messages being reassembled
+u32 const	receive_batch		= 256;
+u32 const	ack_delay			= 10;		// ms, the acknowledgement waits for the data going back
+u32 const	keep_alive			= 1000;
+u32 const	timeout				= 15000;
+u32 const	connect_retry		= 500;
+u32 const	connect_tries		= 10;
+u32 const	max_wait			= 50;
+u32 const	min_resend			= 50;
+u32 const	max_resend			= 1000;
+u32 const	disconnect_sends	= 3;		// nobody acknowledges it
+u32 const	socket_buffer		= 1024*1024;
+
+enum enum_kind
+{
+	kind_connect		= 1,	// u32 protocol, u32 nonce, u32 size, SClientConnectData, password
+	kind_accept,				// u32 nonce, u32 client id, u32 size, GameDescriptionData, session name
+	kind_reject,				// u32 nonce, u8 enum_reject, reason
+	kind_data,
+	kind_disconnect,			// u32 nonce, reason
+};
+
+enum enum_reject
+{
+	reject_refused,
+	reject_password,
+	reject_full,
+	reject_protocol,
+};
+
+enum enum_chunk
+{
+	chunk_reliable		= (1<<0),
+	chunk_sequential	= (1<<1),
+	chunk_fragment		= (1<<2),
+};
+
+IC u32 remaining(u32 const deadline, u32 const now)
+{
+	return (s32(deadline - now) > 0) ? (deadline - now) : 0;
+}
+
+IC u64 address_key(sockaddr_in const & address)
+{
+	return (u64(address.sin_addr.s_addr) << 16) | address.sin_port;
+}
+
+static bool read_string(NET_Packet & P, LPSTR dest, u32 const dest_size)
+{
+	u32 const	left	= P.r_elapsed();
+	u8 const*	start	= P.B.data + P.r_tell();
+	u8 const*	end		= (u8 const*)memchr(start, 0, left);
+	if (!end || (u32(end - start) >= dest_size))
+		return			false;
+
+	P.r					(dest, u32(end - start) + 1);
+	return				true;
+}
+
+static void copy_string(LPSTR dest, u32 const dest_size, LPCSTR src)
+{
+	strncpy_s			(dest, dest_size, src ? src : "", _TRUNCATE);
+}
+
+// the messages received, delivered outside the lock
+struct deliveries
+{
+	struct message
+	{
+		ClientID	id;
+		u32			offset;
+		u32			size;
+	};
+	xr_vector<message>	messages;
+	xr_vector<u8>		data;
+
+	void	add		(ClientID const & id, u8 const* source, u32 const size)
+	{
+		message			m;
+		m.id			= id;
+		m.offset		= data.size();
+		m.size			= size;
+		messages.push_back(m);
+		data.insert		(data.end(), source, source + size);
+	}
+	void	clear	()	{ messages.clear(); data.clear(); }
+	void	swap	(deliveries & other)	{ messages.swap(other.messages); data.swap(other.data); }
+};
+
+//==============================================================================
+// peer : one end of a connection, guarded by the lock of its host
+
+class peer
+{
+public:
+					peer				(sockaddr_in const & address, u32 const now);
+
+	void			queue				(void const* data, u32 const size, u32 const flags);
+	u32				queued				() const	{ return m_queued_messages; }
+	void			receive				(u8 const* data, u32 const size, u32 const now, deliveries & out);
+	void			flush				(SOCKET s, u32 const now);
+	// ms till the peer has something to send
+	u32				wait				(u32 const now) const;
+	bool			timed_out			(u32 const now) const	{ return (now - m_last_receive) >= timeout; }
+	void			connection_info		(DPN_CONNECTION_INFO & info) const;
+
+	sockaddr_in		address;
+	ClientID		id;
+	u32				nonce;
+	bool			closing;
+private:
+	struct sent_datagram
+	{
+		u16				sequence;
+		bool			valid;
+		u32				time;
+		xr_vector<u16>	reliable;
+	};
+	struct reliable_chunk
+	{
+		u16				sequence;
+		bool			valid;
+		u32				sends;
+		xr_vector<u8>	chunk;
+	};
+	struct resend
+	{
+		u16				sequence;
+		u32				sends;
+		u32				time;
+	};
+	struct received_chunk
+	{
+		bool			valid;
+		bool			last;
+		xr_vector<u8>	data;
+	};
+	struct fragmented_message
+	{
+		u16				sequence;
+		bool			valid;
+		u8				count;
+		u32				received;
+		u32				size;
+		xr_vector<u8>	data;
+	};
+
+	u32				resend_timeout		() const	{ return _min(_max(2*m_rtt + 20, min_resend), max_resend); }
+	bool			fits				(u32 const size) const	{ return !m_open || (m_size + size <= mtu); }
+	void			open				(u32 const now);
+	void			append				(u8 const* chunk, u32 const size);
+	void			send				(SOCKET s, u32 const now);
+	bool			mark_received		(u16 const sequence);
+	void			acknowledge			(u16 const sequence, u32 const now);
+	bool			sequential			(u8 const flags, u16 const sequence);
+	void			receive_reliable	(u16 const sequence, u8 const index, u8 const count, u8 const* data, u32 const size, deliveries & out);
+	void			receive_unreliable	(u8 const flags, u16 const sequence, u8 const index, u8 const count, u8 const* data, u32 const size, deliveries & out);
+
+	// sending
+	xr_vector<u8>		m_queue;				// serialized chunks
+	u32					m_queue_read;
+	u32					m_queued_messages;
+	u16					m_reliable_next;		// the sequence of the next reliable chunk queued
+	u16					m_reliable_sent;		// the one after the last sent
+	u16					m_reliable_oldest;		// the oldest not acknowledged
+	u16					m_unreliable_next;
+	reliable_chunk		m_flight[window];
+	xr_deque<resend>	m_resends;				// in the order of the time they were sent
+	sent_datagram		m_history[history];
+	u16					m_sequence;
+	bool				m_open;
+	bool				m_open_reliable;
+	u32					m_size;
+	u8					m_datagram[mtu];
+	u32					m_rtt;
+	bool				m_rtt_measured;
+	u32					m_last_send;
+
+	// receiving
+	bool				m_received_any;
+	u16					m_received_newest;
+	u32					m_received_bits;		// bit i - the datagram i + 1 before the newest
+	bool				m_ack_pending;
+	u32					m_ack_since;
+	u16					m_reliable_expected;
+	received_chunk		m_received[window];
+	xr_vector<u8>		m_message;				// the reliable fragments delivered so far
+	fragmented_message	m_fragments[fragment_slots];
+	bool				m_sequential_any;
+	u16					m_sequential_last;
+	u32					m_last_receive;
+
+	DPN_CONNECTION_INFO	m_info;
+	u32					m_throughput_time;
+	u32					m_throughput_bytes;
+}; //class peer
+
+peer::peer(sockaddr_in const & _address, u32 const now) :
+	address				(_address),
+	nonce				(0),
+	closing				(false),
+	m_queue_read		(0),
+	m_queued_messages	(0),
+	m_reliable_next		(0),
+	m_reliable_sent		(0),
+	m_reliable_oldest	(0),
+	m_unreliable_next	(0),
+	m_sequence			(0),
+	m_open				(false),
+	m_open_reliable		(false),
+	m_size				(0),
+	m_rtt				(100),
+	m_rtt_measured		(false),
+	m_last_send			(now),
+	m_received_any		(false),
+	m_received_newest	(0),
+	m_received_bits		(0),
+	m_ack_pending		(false),
+	m_ack_since			(now),
+	m_reliable_expected	(0),
+	m_sequential_any	(false),
+	m_sequential_last	(0),
+	m_last_receive		(now),
+	m_throughput_time	(now),
+	m_throughput_bytes	(0)
+{
+	for (u32 i = 0; i < window; ++i)
+	{
+		m_flight[i].valid		= false;
+		m_received[i].valid		= false;
+	}
+	for (u32 i = 0; i < history; ++i)
+		m_history[i].valid		= false;
+	for (u32 i = 0; i < fragment_slots; ++i)
+		m_fragments[i].valid	= false;
+
+	ZeroMemory			(&m_info, sizeof(m_info));
+	m_info.dwSize		= sizeof(m_info);
+	m_info.dwRoundTripLatencyMS	= m_rtt;
+}
+
+void peer::queue(void const* data, u32 const size, u32 const flags)
+{
+	VERIFY				(size);
+	bool const	reliable	= !!(flags & DPNSEND_GUARANTEED);
+	bool const	ordered		= !(flags & DPNSEND_NONSEQUENTIAL);
+	u32 const	count		= (size <= chunk_max_size) ? 1 : (size + fragment_size - 1)/fragment_size;
+	R_ASSERT2			(count <= max_fragments, "the message is too large for the UDP transport");
+
+	u8 const	chunk_flags	= u8((reliable ? chunk_reliable : 0) | (ordered ? chunk_sequential : 0) | ((count > 1) ? chunk_fragment : 0));
+	u16 const	message		= reliable ? 0 : m_unreliable_next++;
+	u8 const*	source		= (u8 const*)data;
+	for (u32 i = 0; i < count; ++i)
+	{
+		u32 const	part	= (count == 1) ? size : _min(fragment_size, size - i*fragment_size);
+		u16 const	sequence= reliable ? m_reliable_next++ : message;
+		u32 const	offset	= m_queue.size();
+		m_queue.resize		(offset + chunk_header_size + ((count > 1) ? fragment_header_size : 0) + part);
+
+		u8*	dest			= &m_queue[offset];
+		*dest				= chunk_flags;			dest += sizeof(u8);
+		*(u16*)dest			= u16(part);			dest += sizeof(u16);
+		*(u16*)dest			= sequence;				dest += sizeof(u16);
+		if (count > 1)
+		{
+			*dest++			= u8(i);
+			*dest++			= u8(count);
+		}
+		CopyMemory			(dest, source + i*fragment_size, part);
+	}
+
+	++m_queued_messages;
+	if (flags & DPNSEND_PRIORITY_HIGH)
+		++m_info.dwMessagesTransmittedHighPriority;
+	else
+		++m_info.dwMessagesTransmittedNormalPriority;
+}
+
+void peer::open(u32 const now)
+{
+	if (m_open)
+		return;
+
+	m_open				= true;
+	m_open_reliable		= false;
+	m_size				= header_size;
+
+	sent_datagram & d	= m_history[m_sequence % history];
+	if (d.valid)
+		++m_info.dwPacketsDropped;	// never acknowledged
+
+	d.sequence			= m_sequence;
+	d.valid				= true;
+	d.time				= now;
+	d.reliable.clear	();
+}
+
+void peer::append(u8 const* chunk, u32 const size)
+{
+	VERIFY				(m_open && (m_size + size <= mtu));
+	CopyMemory			(m_datagram + m_size, chunk, size);
+	m_size				+= size;
+}
+
+void peer::send(SOCKET s, u32 const now)
+{
+	VERIFY				(m_open);
+	u8*	dest			= m_datagram;
+	*dest				= tag;					dest += sizeof(u8);
+	*dest				= kind_data;			dest += sizeof(u8);
+	*(u16*)dest			= m_sequence;			dest += sizeof(u16);
+	*(u16*)dest			= m_received_newest;	dest += sizeof(u16);
+	*(u32*)dest			= m_received_any ? ((m_received_bits << 1) | 1) : 0;
+
+	sendto				(s, (char const*)m_datagram, m_size, 0, (sockaddr const*)&address, sizeof(address));
+
+	if (m_open_reliable)
+	{
+		++m_info.dwPacketsSentGuaranteed;
+		m_info.dwBytesSentGuaranteed		+= m_size;
+	}else
+	{
+		++m_info.dwPacketsSentNonGuaranteed;
+		m_info.dwBytesSentNonGuaranteed		+= m_size;
+	}
+	m_throughput_bytes	+= m_size;
+
+	++m_sequence;
+	m_open				= false;
+	m_ack_pending		= false;
+	m_last_send			= now;
+}
+
+void peer::flush(SOCKET s, u32 const now)
+{
+	if (now - m_throughput_time >= 1000)
+	{
+		m_info.dwThroughputBPS		= u32(u64(m_throughput_bytes)*1000/(now - m_throughput_time));
+		m_info.dwPeakThroughputBPS	= _max(m_info.dwPeakThroughputBPS, m_info.dwThroughputBPS);
+		m_throughput_bytes			= 0;
+		m_throughput_time			= now;
+	}
+
+	// the chunks sent again come first
+	u32 const rto		= resend_timeout();
+	while (!m_resends.empty() && (now - m_resends.front().time >= rto))
+	{
+		resend const r	= m_resends.front();
+		m_resends.pop_front();
+
+		reliable_chunk & c	= m_flight[r.sequence % window];
+		if (!c.valid || (c.sequence != r.sequence) || (c.sends != r.sends))
+			continue;	// acknowledged or sent again already
+
+		u32 const size	= c.chunk.size();
+		if (!fits(size))
+			send		(s, now);
+		open			(now);
+		append			(&*c.chunk.begin(), size);
+		m_open_reliable	= true;
+		m_history[m_sequence % history].reliable.push_back(c.sequence);
+
+		++c.sends;
+		resend			again;
+		again.sequence	= c.sequence;
+		again.sends		= c.sends;
+		again.time		= now;
+		m_resends.push_back	(again);
+
+		++m_info.dwPacketsRetried;
+		m_info.dwBytesRetried	+= size;
+	}
+
+	while (m_queue_read < m_queue.size())
+	{
+		u8 const*	chunk	= &m_queue[m_queue_read];
+		u8 const	flags	= chunk[0];
+		u32 const	size	= chunk_header_size + ((flags & chunk_fragment) ? fragment_header_size : 0) + *(u16 const*)(chunk + 1);
+		u16 const	sequence= *(u16 const*)(chunk + 3);
+		if (flags & chunk_reliable)
+		{
+			while (m_reliable_oldest != m_reliable_sent)
+			{
+				reliable_chunk const & c	= m_flight[m_reliable_oldest % window];
+				if (c.valid && (c.sequence == m_reliable_oldest))
+					break;
+				++m_reliable_oldest;
+			}
+			if (u16(sequence - m_reliable_oldest) >= window)
+				break;	// the receiver has no room for it
+		}
+
+		if (!fits(size))
+			send		(s, now);
+		open			(now);
+		append			(chunk, size);
+
+		if (flags & chunk_reliable)
+		{
+			reliable_chunk & c	= m_flight[sequence % window];
+			c.sequence	= sequence;
+			c.valid		= true;
+			c.sends		= 1;
+			c.chunk.assign	(chunk, chunk + size);
+			m_open_reliable	= true;
+			m_history[m_sequence % history].reliable.push_back(sequence);
+
+			resend		first;
+			first.sequence	= sequence;
+			first.sends	= 1;
+			first.time	= now;
+			m_resends.push_back	(first);
+			m_reliable_sent	= u16(sequence + 1);
+		}
+
+		if (!(flags & chunk_fragment) || (chunk[chunk_header_size] + 1 == chunk[chunk_header_size + 1]))
+			--m_queued_messages;
+		m_queue_read	+= size;
+	}
+
+	if (m_queue_read == m_queue.size())
+	{
+		m_queue.clear	();
+		m_queue_read	= 0;
+	}else if (m_queue_read >= 64*1024)
+	{
+		m_queue.erase	(m_queue.begin(), m_queue.begin() + m_queue_read);
+		m_queue_read	= 0;
+	}
+
+	if (!m_open && ((m_ack_pending && (now - m_ack_since >= ack_delay)) || (now - m_last_send >= keep_alive)))
+		open			(now);
+
+	if (m_open)
+		send			(s, now);
+}
+
+u32 peer::wait(u32 const now) const
+{
+	u32 result			= _min(max_wait, remaining(m_last_send + keep_alive, now));
+	if (!m_resends.empty())
+		result			= _min(result, remaining(m_resends.front().time + resend_timeout(), now));
+	if (m_ack_pending)
+		result			= _min(result, remaining(m_ack_since + ack_delay, now));
+	return				_max(result, u32(1));
+}
+
+void peer::connection_info(DPN_CONNECTION_INFO & info) const
+{
+	info				= m_info;
+	info.dwRoundTripLatencyMS	= m_rtt;
+}
+
+bool peer::mark_received(u16 const sequence)
+{
+	if (!m_received_any)
+	{
+		m_received_any		= true;
+		m_received_newest	= sequence;
+		m_received_bits		= 0;
+		return				true;
+	}
+
+	s16 const	delta	= s16(sequence - m_received_newest);
+	if (delta > 0)
+	{
+		if (delta < 32)
+			m_received_bits	= (m_received_bits << delta) | (1u << (delta - 1));
+		else
+			m_received_bits	= (delta == 32) ? (1u << 31) : 0;
+		m_received_newest	= sequence;
+		return				true;
+	}
+
+	if (!delta || (delta < -32))
+		return				false;
+
+	u32 const	bit		= 1u << (-delta - 1);
+	if (m_received_bits & bit)
+		return				false;
+
+	m_received_bits		|= bit;
+	return				true;
+}
+
+void peer::acknowledge(u16 const sequence, u32 const now)
+{
+	sent_datagram & d	= m_history[sequence % history];
+	if (!d.valid || (d.sequence != sequence) || (m_open && (sequence == m_sequence)))
+		return;
+
+	d.valid				= false;
+	u32 const	sample	= now - d.time;
+	m_rtt				= m_rtt_measured ? (7*m_rtt + sample)/8 : sample;
+	m_rtt_measured		= true;
+
+	xr_vector<u16>::const_iterator	I = d.reliable.begin();
+	xr_vector<u16>::const_iterator	E = d.reliable.end();
+	for (; I != E; ++I)
+	{
+		reliable_chunk & c	= m_flight[*I % window];
+		if (c.valid && (c.sequence == *I))
+		{
+			c.valid		= false;
+			c.chunk.clear	();
+		}
+	}
+}
+
+void peer::receive(u8 const* data, u32 const size, u32 const now, deliveries & out)
+{
+	if (size < header_size)
+		return;
+
+	u16 const	sequence	= *(u16 const*)(data + 2);
+	u16 const	ack			= *(u16 const*)(data + 4);
+	u32 const	ack_mask	= *(u32 const*)(data + 6);
+	if (!mark_received(sequence))
+		return;	// a duplicate or too old
+
+	m_last_receive		= now;
+	++m_info.dwPacketsReceivedGuaranteed;
+	m_info.dwBytesReceivedGuaranteed	+= size;
+
+	for (u32 i = 0; i < 32; ++i)
+		if (ack_mask & (1u << i))
+			acknowledge	(u16(ack - i), now);
+
+	bool		chunks	= false;
+	u8 const*	I		= data + header_size;
+	u8 const*	E		= data + size;
+	while (I + chunk_header_size <= E)
+	{
+		u8 const	flags	= I[0];
+		u16 const	part	= *(u16 const*)(I + 1);
+		u16 const	chunk	= *(u16 const*)(I + 3);
+		I				+= chunk_header_size;
+
+		u8			index	= 0;
+		u8			count	= 1;
+		if (flags & chunk_fragment)
+		{
+			if (I + fragment_header_size > E)
+				break;
+			index		= I[0];
+			count		= I[1];
+			I			+= fragment_header_size;
+			if (!count || (index >= count) || (count > max_fragments))
+				break;
+		}
+		if (I + part > E)
+			break;
+
+		chunks			= true;
+		if (flags & chunk_reliable)
+			receive_reliable	(chunk, index, count, I, part, out);
+		else
+			receive_unreliable	(flags, chunk, index, count, I, part, out);
+		I				+= part;
+	}
+
+	if (chunks && !m_ack_pending)
+	{
+		m_ack_pending	= true;
+		m_ack_since		= now;
+	}
+}
+
+void peer::receive_reliable(u16 const sequence, u8 const index, u8 const count, u8 const* data, u32 const size, deliveries & out)
+{
+	u16 const	offset	= u16(sequence - m_reliable_expected);
+	if (offset >= window)
+		return;	// delivered already
+
+	received_chunk & c	= m_received[sequence % window];
+	if (c.valid)
+		return;
+
+	if (!offset && (index + 1 == count) && m_message.empty())
+	{
+		// the usual case : the next message in one chunk
+		out.add			(id, data, size);
+		++m_info.dwMessagesReceived;
+		++m_reliable_expected;
+	}else
+	{
+		c.valid			= true;
+		c.last			= (index + 1 == count);
+		c.data.assign	(data, data + size);
+	}
+
+	for (;;)
+	{
+		received_chunk & n	= m_received[m_reliable_expected % window];
+		if (!n.valid)
+			break;
+
+		m_message.insert(m_message.end(), n.data.begin(), n.data.end());
+		n.valid			= false;
+		++m_reliable_expected;
+		if (!n.last)
+		{
+			if (m_message.size() > max_fragments*fragment_size)
+				m_message.clear	();	// broken
+			continue;
+		}
+
+		out.add			(id, &*m_message.begin(), m_message.size());
+		++m_info.dwMessagesReceived;
+		m_message.clear	();
+	}
+}
+
+bool peer::sequential(u8 const flags, u16 const sequence)
+{
+	if (!(flags & chunk_sequential))
+		return			true;
+
+	if (m_sequential_any && (s16(sequence - m_sequential_last) <= 0))
+		return			false;
+
+	m_sequential_any	= true;
+	m_sequential_last	= sequence;
+	return				true;
+}
+
+void peer::receive_unreliable(u8 const flags, u16 const sequence, u8 const index, u8 const count, u8 const* data, u32 const size, deliveries & out)
+{
+	if (count == 1)
+	{
+		if (sequential(flags, sequence))
+		{
+			out.add		(id, data, size);
+			++m_info.dwMessagesReceived;
+		}
+		return;
+	}
+
+	// the slot of the message, a free one or the oldest
+	fragmented_message*	slot	= NULL;
+	for (u32 i = 0; i < fragment_slots; ++i)
+	{
+		fragmented_message & f	= m_fragments[i];
+		if (f.valid && (f.sequence == sequence))
+		{
+			slot		= &f;
+			break;
+		}
+		if (!slot || (slot->valid && (!f.valid || (s16(f.sequence - slot->sequence) < 0))))
+			slot		= &f;
+	}
+	if (!slot->valid || (slot->sequence != sequence))
+	{
+		slot->valid		= true;
+		slot->sequence	= sequence;
+		slot->count		= count;
+		slot->received	= 0;
+		slot->size		= 0;
+		slot->data.resize	(count*fragment_size);
+	}
+
+	if ((count != slot->count) || (size > fragment_size) || ((index + 1 < count) && (size != fragment_size)))
+		return;	// broken
+
+	u32 const	bit		= 1u << index;
+	if (slot->received & bit)
+		return;
+
+	CopyMemory			(&slot->data[index*fragment_size], data, size);
+	slot->received		|= bit;
+	if (index + 1 == count)
+		slot->size		= index*fragment_size + size;
+
+	u32 const	all		= (count == 32) ? u32(-1) : ((1u << count) - 1);
+	if (slot->received != all)
+		return;
+
+	slot->valid			= false;
+	if (sequential(flags, sequence))
+	{
+		out.add			(id, &*slot->data.begin(), slot->size);
+		++m_info.dwMessagesReceived;
+	}
+}
+
+//==============================================================================
+// host : the socket and the thread
+
+class host
+{
+public:
+					host				();
+	virtual			~host				();
+protected:
+	bool			open				(u32 const port);
+	void			close				();
+	bool			is_open				() const	{ return m_socket != INVALID_SOCKET; }
+	void			wake				()			{ if (m_wake_event) SetEvent(m_wake_event); }
+	u32				time				()			{ return m_timer.GetElapsed_ms(); }
+	void			send_datagram		(sockaddr_in const & address, NET_Packet const & P);
+	bool			local_address		(ip_address & address, DWORD* port);
+
+	// under the lock
+	virtual void	on_datagram			(sockaddr_in const & from, u8 const* data, u32 const size, u32 const now)	= 0;
+	// under the lock, returns ms till the next service
+	virtual u32		on_update			(u32 const now)																= 0;
+	// without the lock : the handlers may call the transport
+	virtual void	on_dispatch			()																			= 0;
+
+	xrCriticalSection	m_lock;
+	SOCKET				m_socket;
+private:
+	static void __cdecl	thread_entry	(void* _this);
+	void			thread				();
+
+	CTimerBase			m_timer;
+	WSAEVENT			m_read_event;
+	HANDLE				m_wake_event;
+	DWORD				m_thread_id;
+	volatile BOOL		m_exit;
+	volatile LONG		m_alive;
+	bool				m_wsa;
+	u8					m_buffer[mtu + 1];
+}; //class host
+
+host::host() :
+	m_socket		(INVALID_SOCKET),
+	m_read_event	(WSA_INVALID_EVENT),
+	m_wake_event	(NULL),
+	m_thread_id		(0),
+	m_exit			(FALSE),
+	m_alive			(0),
+	m_wsa			(false)
+{
+	m_timer.Start	();
+}
+
+host::~host()
+{
+	VERIFY			(!is_open());
+}
+
+bool host::open(u32 const port)
+{
+	VERIFY			(!is_open());
+	WSADATA			wsa_data;
+	if (WSAStartup(MAKEWORD(2,2), &wsa_data))
+	{
+		Msg			("! UDP transport : WSAStartup failed");
+		return		false;
+	}
+	m_wsa			= true;
+
+	m_socket		= socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (m_socket == INVALID_SOCKET)
+	{
+		Msg			("! UDP transport : can't create the socket (%d)", WSAGetLastError());
+		close		();
+		return		false;
+	}
+
+	int const		buffer_size	= socket_buffer;
+	setsockopt		(m_socket, SOL_SOCKET, SO_RCVBUF, (char const*)&buffer_size, sizeof(buffer_size));
+	setsockopt		(m_socket, SOL_SOCKET, SO_SNDBUF, (char const*)&buffer_size, sizeof(buffer_size));
+
+	sockaddr_in		local;
+	ZeroMemory		(&local, sizeof(local));
+	local.sin_family		= AF_INET;
+	local.sin_addr.s_addr	= htonl(INADDR_ANY);
+	local.sin_port			= htons(u16(port));
+	if (bind(m_socket, (sockaddr const*)&local, sizeof(local)) == SOCKET_ERROR)
+	{
+		close		();
+		return		false;
+	}
+
+	m_read_event	= WSACreateEvent();
+	m_wake_event	= CreateEvent(NULL, FALSE, FALSE, NULL);
+	if ((m_read_event == WSA_INVALID_EVENT) || !m_wake_event || (WSAEventSelect(m_socket, m_read_event, FD_READ) == SOCKET_ERROR))
+	{
+		Msg			("! UDP transport : can't select the socket events (%d)", WSAGetLastError());
+		close		();
+		return		false;
+	}
+
+	m_exit			= FALSE;
+	m_alive			= 1;
+	thread_spawn	(thread_entry, "network-udp", 0, this);
+	return			true;
+}
+
+void host::close()
+{
+	if (m_alive)
+	{
+		R_ASSERT2	(GetCurrentThreadId() != m_thread_id, "the UDP transport can't be closed from its handlers");
+		m_exit		= TRUE;
+		wake		();
+		while (m_alive)
+			Sleep	(1);
+	}
+
+	if (m_socket != INVALID_SOCKET)
+	{
+		closesocket	(m_socket);
+		m_socket	= INVALID_SOCKET;
+	}
+	if (m_read_event != WSA_INVALID_EVENT)
+	{
+		WSACloseEvent	(m_read_event);
+		m_read_event	= WSA_INVALID_EVENT;
+	}
+	if (m_wake_event)
+	{
+		CloseHandle	(m_wake_event);
+		m_wake_event	= NULL;
+	}
+	if (m_wsa)
+	{
+		WSACleanup	();
+		m_wsa		= false;
+	}
+}
+
+void host::send_datagram(sockaddr_in const & address, NET_Packet const & P)
+{
+	sendto			(m_socket, (char const*)P.B.data, P.B.count, 0, (sockaddr const*)&address, sizeof(address));
+}
+
+bool host::local_address(ip_address & address, DWORD* port)
+{
+	sockaddr_in		local;
+	int				local_size	= sizeof(local);
+	if (getsockname(m_socket, (sockaddr*)&local, &local_size) == SOCKET_ERROR)
+		return		false;
+
+	address.m_data.data	= local.sin_addr.s_addr;
+	if (port)
+		*port		= ntohs(local.sin_port);
+	return			true;
+}
+
+void __cdecl host::thread_entry(void* _this)
+{
+	static_cast<host*>(_this)->thread();
+}
+
+void host::thread()
+{
+	m_thread_id		= GetCurrentThreadId();
+	HANDLE			events[2] = { m_read_event, m_wake_event };
+	u32				wait = 0;
+	while (!m_exit)
+	{
+		WaitForMultipleObjects	(2, events, FALSE, wait);
+		if (m_exit)
+			break;
+
+		{
+			xrCriticalSection::raii	guard(&m_lock);
+			u32 const	now		= time();
+
+			// FD_READ is signalled again by recvfrom, when there is more to read
+			WSAResetEvent	(m_read_event);
+			for (u32 i = 0; i < receive_batch; ++i)
+			{
+				sockaddr_in	from;
+				int			from_size	= sizeof(from);
+				int const	size		= recvfrom(m_socket, (char*)m_buffer, sizeof(m_buffer), 0, (sockaddr*)&from, &from_size);
+				if (size == SOCKET_ERROR)
+				{
+					int const	error	= WSAGetLastError();
+					if ((error == WSAECONNRESET) || (error == WSAEMSGSIZE))
+						continue;	// ICMP port unreachable of a gone peer, a foreign datagram
+					break;
+				}
+				if ((size < 2) || (u32(size) > mtu) || (m_buffer[0] != tag))
+					continue;
+
+				on_datagram	(from, m_buffer, u32(size), now);
+			}
+
+			wait		= on_update(now);
+		}
+
+		on_dispatch		();
+	}
+
+	m_thread_id		= 0;
+	InterlockedExchange	(&m_alive, 0);
+}
+
+//==============================================================================
+
+class server_transport :
+	public IServerTransport,
+	private host
+{
+public:
+					server_transport	(IServerTransportHandler* handler);
+	virtual			~server_transport	();
+
+	virtual bool	Host				(u32 port, u32 max_players, LPCSTR password, LPCSTR session_name, GameDescriptionData const & game_descr);
+	virtual void	Close				();
+	virtual void	SendTo				(ClientID const & ID, void const* data, u32 size, u32 flags);
+	virtual void	Flush				();
+	virtual bool	DestroyClient		(ClientID const & ID, LPCSTR reason);
+	virtual bool	GetSendQueueInfo	(ClientID const & ID, u32 & pending);
+	virtual bool	GetConnectionInfo	(ClientID const & ID, DPN_CONNECTION_INFO & info);
+	virtual bool	GetClientAddress	(ClientID const & ID, ip_address & address, DWORD* port);
+private:
+	struct connect_request
+	{
+		sockaddr_in			address;
+		u32					nonce;
+		SClientConnectData	data;
+	};
+	typedef xr_map<u64, peer*>				addresses_t;
+	typedef xr_map<ClientID, peer*>			peers_t;
+	typedef xr_vector<connect_request>		requests_t;
+	typedef xr_vector<ClientID>				ids_t;
+
+	virtual void	on_datagram			(sockaddr_in const & from, u8 const* data, u32 const size, u32 const now);
+	virtual u32		on_update			(u32 const now);
+	virtual void	on_dispatch			();
+
+	peer*			find				(ClientID const & ID);
+	void			send_accept			(peer const & p);
+	void			send_reject			(sockaddr_in const & address, u32 const nonce, enum_reject const reason, LPCSTR message);
+	void			send_disconnect		(peer const & p, LPCSTR reason);
+	void			remove				(peer* p);
+	void			on_connect			(sockaddr_in const & from, NET_Packet & P);
+
+	IServerTransportHandler*	m_handler;
+	addresses_t		m_addresses;
+	peers_t			m_peers;
+	u32				m_max_players;
+	u32				m_next_id;
+	string64		m_password;
+	string256		m_session_name;
+	GameDescriptionData	m_game_descr;
+
+	// the events of the thread : collected under the lock, handled without it
+	requests_t		m_requests;
+	ids_t			m_destroyed;
+	deliveries		m_deliveries;
+	requests_t		m_dispatch_requests;
+	ids_t			m_dispatch_destroyed;
+	deliveries		m_dispatch_deliveries;
+}; //class server_transport
+
+server_transport::server_transport(IServerTransportHandler* handler) :
+	m_handler		(handler),
+	m_max_players	(0),
+	m_next_id		(0x00010001)
+{
+	m_password[0]		= 0;
+	m_session_name[0]	= 0;
+	ZeroMemory		(&m_game_descr, sizeof(m_game_descr));
+}
+
+server_transport::~server_transport()
+{
+	Close			();
+}
+
+bool server_transport::Host(u32 port, u32 max_players, LPCSTR password, LPCSTR session_name, GameDescriptionData const & game_descr)
+{
+	m_max_players	= max_players;
+	copy_string		(m_password, sizeof(m_password), password);
+	copy_string		(m_session_name, sizeof(m_session_name), session_name);
+	m_game_descr	= game_descr;
+	return			open(port);
+}
+
+void server_transport::Close()
+{
+	if (!is_open())
+		return;
+
+	{
+		xrCriticalSection::raii	guard(&m_lock);
+		for (peers_t::iterator I = m_peers.begin(); I != m_peers.end(); ++I)
+			send_disconnect	(*I->second, "");
+	}
+
+	close			();
+
+	for (peers_t::iterator I = m_peers.begin(); I != m_peers.end(); ++I)
+		xr_delete	(I->second);
+	m_peers.clear		();
+	m_addresses.clear	();
+	m_requests.clear	();
+	m_destroyed.clear	();
+	m_deliveries.clear	();
+}
+
+peer* server_transport::find(ClientID const & ID)
+{
+	peers_t::iterator	I = m_peers.find(ID);
+	return			((I == m_peers.end()) || I->second->closing) ? NULL : I->second;
+}
+
+void server_transport::SendTo(ClientID const & ID, void const* data, u32 size, u32 flags)
+{
+	xrCriticalSection::raii	guard(&m_lock);
+	peer*			p = find(ID);
+	if (!p)
+		return;
+
+	p->queue		(data, size, flags);
+	if (flags & DPNSEND_IMMEDIATELLY)
+		wake		();
+}
+
+void server_transport::Flush()
+{
+	wake			();
+}
+
+bool server_transport::DestroyClient(ClientID const & ID, LPCSTR reason)
+{
+	xrCriticalSection::raii	guard(&m_lock);
+	peer*			p = find(ID);
+	if (!p)
+		return		false;
+
+	send_disconnect	(*p, reason);
+	p->closing		= true;
+	wake			();
+	return			true;
+}
+
+bool server_transport::GetSendQueueInfo(ClientID const & ID, u32 & pending)
+{
+	xrCriticalSection::raii	guard(&m_lock);
+	peer*			p = find(ID);
+	if (!p)
+		return		false;
+
+	pending			= p->queued();
+	return			true;
+}
+
+bool server_transport::GetConnectionInfo(ClientID const & ID, DPN_CONNECTION_INFO & info)
+{
+	xrCriticalSection::raii	guard(&m_lock);
+	peer*			p = find(ID);
+	if (!p)
+		return		false;
+
+	p->connection_info	(info);
+	return			true;
+}
+
+bool server_transport::GetClientAddress(ClientID const & ID, ip_address & address, DWORD* port)
+{
+	xrCriticalSection::raii	guard(&m_lock);
+	peer*			p = find(ID);
+	if (!p)
+		return		false;
+
+	address.m_data.data	= p->address.sin_addr.s_addr;
+	if (port)
+		*port		= ntohs(p->address.sin_port);
+	return			true;
+}
+
+void server_transport::send_accept(peer const & p)
+{
+	NET_Packet		P;
+	P.w_u8			(tag);
+	P.w_u8			(kind_accept);
+	P.w_u32			(p.nonce);
+	P.w_u32			(p.id.value());
+	P.w_u32			(sizeof(m_game_descr));
+	P.w				(&m_game_descr, sizeof(m_game_descr));
+	P.w_stringZ		(m_session_name);
+	send_datagram	(p.address, P);
+}
+
+void server_transport::send_reject(sockaddr_in const & address, u32 const nonce, enum_reject const reason, LPCSTR message)
+{
+	string256		text;
+	copy_string		(text, sizeof(text), message);
+
+	NET_Packet		P;
+	P.w_u8			(tag);
+	P.w_u8			(kind_reject);
+	P.w_u32			(nonce);
+	P.w_u8			(u8(reason));
+	P.w_stringZ		(text);
+	send_datagram	(address, P);
+}
+
+void server_transport::send_disconnect(peer const & p, LPCSTR reason)
+{
+	string256		text;
+	copy_string		(text, sizeof(text), reason);
+
+	NET_Packet		P;
+	P.w_u8			(tag);
+	P.w_u8			(kind_disconnect);
+	P.w_u32			(p.nonce);
+	P.w_stringZ		(text);
+	for (u32 i = 0; i < disconnect_sends; ++i)
+		send_datagram	(p.address, P);
+}
+
+void server_transport::remove(peer* p)
+{
+	m_addresses.erase	(address_key(p->address));
+	m_peers.erase		(p->id);
+	m_destroyed.push_back	(p->id);
+	xr_delete		(p);
+}
+
+void server_transport::on_connect(sockaddr_in const & from, NET_Packet & P)
+{
+	if (P.r_elapsed() < 3*sizeof(u32))
+		return;
+
+	u32 const		version	= P.r_u32();
+	u32 const		nonce	= P.r_u32();
+	if (version != protocol)
+	{
+		send_reject	(from, nonce, reject_protocol, "");
+		return;
+	}
+
+	addresses_t::iterator	I = m_addresses.find(address_key(from));
+	if (I != m_addresses.end())
+	{
+		peer*		p = I->second;
+		// the accept has been lost
+		if ((p->nonce == nonce) && !p->closing)
+			send_accept	(*p);
+		// else anybody may send it from a forged address : the session is not dropped for it,
+		// a client restarted on the same port gets in once the old one has timed out
+		return;
+	}
+
+	for (requests_t::const_iterator R = m_requests.begin(); R != m_requests.end(); ++R)
+		if (address_key(R->address) == address_key(from))
+			return;
+
+	connect_request	request;
+	if ((P.r_u32() != sizeof(request.data)) || (P.r_elapsed() < sizeof(request.data)))
+		return;
+
+	string64		password;
+	P.r				(&request.data, sizeof(request.data));
+	if (!read_string(P, password, sizeof(password)))
+		return;
+
+	if (m_password[0] && xr_strcmp(password, m_password))
+	{
+		send_reject	(from, nonce, reject_password, "");
+		return;
+	}
+	if (m_peers.size() + m_requests.size() >= m_max_players)
+	{
+		send_reject	(from, nonce, reject_full, "");
+		return;
+	}
+
+	request.address	= from;
+	request.nonce	= nonce;
+	m_requests.push_back	(request);
+}
+
+void server_transport::on_datagram(sockaddr_in const & from, u8 const* data, u32 const size, u32 const now)
+{
+	u8 const		kind = data[1];
+	if (kind == kind_connect)
+	{
+		NET_Packet	P;
+		P.construct	(data + 2, size - 2);
+		on_connect	(from, P);
+		return;
+	}
+
+	addresses_t::iterator	I = m_addresses.find(address_key(from));
+	if ((I == m_addresses.end()) || I->second->closing)
+		return;
+
+	peer*			p = I->second;
+	switch (kind)
+	{
+	case kind_data :
+		p->receive	(data, size, now, m_deliveries);
+		break;
+	case kind_disconnect :
+		{
+			NET_Packet	P;
+			P.construct	(data + 2, size - 2);
+			if ((P.r_elapsed() >= sizeof(u32)) && (P.r_u32() == p->nonce))
+				remove	(p);
+		}break;
+	}
+}
+
+u32 server_transport::on_update(u32 const now)
+{
+	u32				wait = max_wait;
+	peers_t::iterator	I = m_peers.begin();
+	while (I != m_peers.end())
+	{
+		peer*		p = I->second;
+		++I;
+		if (p->closing || p->timed_out(now))
+		{
+			remove	(p);
+			continue;
+		}
+		p->flush	(m_socket, now);
+		wait		= _min(wait, p->wait(now));
+	}
+
+	std::swap		(m_requests, m_dispatch_requests);
+	std::swap		(m_destroyed, m_dispatch_destroyed);
+	m_deliveries.swap	(m_dispatch_deliveries);
+	return			wait;
+}
+
+void server_transport::on_dispatch()
+{
+	if (!m_dispatch_deliveries.messages.empty())
+	{
+		xr_vector<deliveries::message>::const_iterator	I = m_dispatch_deliveries.messages.begin();
+		xr_vector<deliveries::message>::const_iterator	E = m_dispatch_deliveries.messages.end();
+		for (; I != E; ++I)
+			m_handler->OnTransportReceive	(I->id, &m_dispatch_deliveries.data[I->offset], I->size);
+		m_dispatch_deliveries.clear	();
+	}
+
+	for (ids_t::const_iterator I = m_dispatch_destroyed.begin(); I != m_dispatch_destroyed.end(); ++I)
+		m_handler->OnTransportDestroyPlayer	(*I);
+	m_dispatch_destroyed.clear	();
+
+	for (requests_t::iterator I = m_dispatch_requests.begin(); I != m_dispatch_requests.end(); ++I)
+	{
+		ip_address	address;
+		address.m_data.data	= I->address.sin_addr.s_addr;
+		LPCSTR const	refused = m_handler->OnTransportConnect(address);
+		{
+			xrCriticalSection::raii	guard(&m_lock);
+			if (refused)
+			{
+				send_reject	(I->address, I->nonce, reject_refused, refused);
+				continue;
+			}
+			if (m_addresses.find(address_key(I->address)) != m_addresses.end())
+				continue;
+
+			peer*	p	= xr_new<peer>(I->address, time());
+			p->id		= ClientID(m_next_id++);
+			p->nonce	= I->nonce;
+			m_peers.insert		(mk_pair(p->id, p));
+			m_addresses.insert	(mk_pair(address_key(p->address), p));
+			send_accept	(*p);
+			I->data.clientID	= p->id;
+		}
+		// the client sends nothing before the accept, so its first data comes after this
+		m_handler->OnTransportCreatePlayer	(I->data);
+	}
+	m_dispatch_requests.clear	();
+}
+
+//==============================================================================
+
+class client_transport :
+	public IClientTransport,
+	private host
+{
+public:
+					client_transport	(IClientTransportHandler* handler);
+	virtual			~client_transport	();
+
+	virtual EConnect	Connect			(LPCSTR host_name, u32 port, u32 local_port, SClientConnectData const & data, LPCSTR password, SSessionInfo & session);
+	virtual void	Close				();
+	virtual void	Send				(void const* data, u32 size, u32 flags);
+	virtual void	Flush				();
+	virtual bool	GetSendQueueInfo	(u32 & pending);
+	virtual bool	GetConnectionInfo	(DPN_CONNECTION_INFO & info);
+	virtual bool	GetServerAddress	(ip_address & address, DWORD* port);
+private:
+	enum enum_state
+	{
+		state_idle,
+		state_connecting,
+		state_connected,
+		state_rejected,
+		state_terminated,
+	};
+
+	virtual void	on_datagram			(sockaddr_in const & from, u8 const* data, u32 const size, u32 const now);
+	virtual u32		on_update			(u32 const now);
+	virtual void	on_dispatch			();
+
+	void			terminate			(LPCSTR reason);
+
+	IClientTransportHandler*	m_handler;
+	peer*			m_server;
+	volatile LONG	m_state;
+	u32				m_nonce;
+	u8				m_reject;
+	SSessionInfo*	m_session;
+
+	bool			m_terminated;
+	string256		m_terminate_reason;
+	deliveries		m_deliveries;
+	deliveries		m_dispatch_deliveries;
+	bool			m_dispatch_terminated;
+}; //class client_transport
+
+client_transport::client_transport(IClientTransportHandler* handler) :
+	m_handler		(handler),
+	m_server		(NULL),
+	m_state			(state_idle),
+	m_nonce			(0),
+	m_reject		(reject_refused),
+	m_session		(NULL),
+	m_terminated	(false),
+	m_dispatch_terminated	(false)
+{
+	m_terminate_reason[0]	= 0;
+}
+
+client_transport::~client_transport()
+{
+	Close			();
+}
+
+IClientTransport::EConnect client_transport::Connect(LPCSTR host_name, u32 port, u32 local_port, SClientConnectData const & data, LPCSTR password, SSessionInfo & session)
+{
+	Close			();
+	if (!open(local_port))
+		return		ConnectPortBusy;
+
+	sockaddr_in		address;
+	ZeroMemory		(&address, sizeof(address));
+	address.sin_family		= AF_INET;
+	address.sin_port		= htons(u16(port));
+	address.sin_addr.s_addr	= inet_addr(host_name);
+	if (address.sin_addr.s_addr == INADDR_NONE)
+	{
+		hostent*	host_ent = gethostbyname(host_name);
+		if (!host_ent || !host_ent->h_addr_list[0])
+		{
+			Msg		("! UDP transport : can't resolve [%s]", host_name);
+			Close	();
+			return	ConnectNoHost;
+		}
+		address.sin_addr	= *(in_addr*)host_ent->h_addr_list[0];
+	}
+
+	{
+		xrCriticalSection::raii	guard(&m_lock);
+		m_server	= xr_new<peer>(address, time());
+		m_nonce		= u32(CPU::QPC()) ^ (GetCurrentProcessId() << 16);
+		m_session	= &session;
+		m_terminated= false;
+		m_terminate_reason[0]	= 0;
+		InterlockedExchange	(&m_state, state_connecting);
+	}
+
+	string64		password_text;
+	copy_string		(password_text, sizeof(password_text), password);
+
+	NET_Packet		P;
+	P.w_u8			(tag);
+	P.w_u8			(kind_connect);
+	P.w_u32			(protocol);
+	P.w_u32			(m_nonce);
+	P.w_u32			(sizeof(data));
+	P.w				(&data, sizeof(data));
+	P.w_stringZ		(password_text);
+
+	for (u32 i = 0; (i < connect_tries) && (m_state == state_connecting); ++i)
+	{
+		send_datagram	(address, P);
+		u32 const	start = time();
+		while ((m_state == state_connecting) && (time() - start < connect_retry))
+			Sleep	(1);
+	}
+
+	EConnect		result;
+	switch (m_state)
+	{
+	case state_connected :
+		return		ConnectOk;
+	case state_rejected :
+		switch (m_reject)
+		{
+		case reject_password	: result = ConnectInvalidPassword;	break;
+		case reject_full		: result = ConnectSessionFull;		break;
+		default					: result = ConnectRejected;			break;
+		}break;
+	default :
+		result		= ConnectNoHost;
+	}
+
+	Close			();
+	return			result;
+}
+
+void client_transport::Close()
+{
+	if (is_open())
+	{
+		{
+			xrCriticalSection::raii	guard(&m_lock);
+			if (m_state == state_connected)
+			{
+				NET_Packet	P;
+				P.w_u8		(tag);
+				P.w_u8		(kind_disconnect);
+				P.w_u32		(m_nonce);
+				P.w_stringZ	("");
+				for (u32 i = 0; i < disconnect_sends; ++i)
+					send_datagram	(m_server->address, P);
+			}
+			InterlockedExchange	(&m_state, state_idle);
+		}
+		close		();
+	}
+
+	xr_delete		(m_server);
+	m_session		= NULL;
+	m_deliveries.clear			();
+	m_dispatch_deliveries.clear	();
+	m_dispatch_terminated		= false;
+}
+
+void client_transport::Send(void const* data, u32 size, u32 flags)
+{
+	xrCriticalSection::raii	guard(&m_lock);
+	if (m_state != state_connected)
+		return;
+
+	m_server->queue	(data, size, flags);
+	if (flags & DPNSEND_IMMEDIATELLY)
+		wake		();
+}
+
+void client_transport::Flush()
+{
+	wake			();
+}
+
+bool client_transport::GetSendQueueInfo(u32 & pending)
+{
+	xrCriticalSection::raii	guard(&m_lock);
+	if (m_state != state_connected)
+		return		false;
+
+	pending			= m_server->queued();
+	return			true;
+}
+
+bool client_transport::GetConnectionInfo(DPN_CONNECTION_INFO & info)
+{
+	xrCriticalSection::raii	guard(&m_lock);
+	if (m_state != state_connected)
+		return		false;
+
+	m_server->connection_info	(info);
+	return			true;
+}
+
+bool client_transport::GetServerAddress(ip_address & address, DWORD* port)
+{
+	xrCriticalSection::raii	guard(&m_lock);
+	if (!m_server)
+		return		false;
+
+	address.m_data.data	= m_server->address.sin_addr.s_addr;
+	if (port)
+		*port		= ntohs(m_server->address.sin_port);
+	return			true;
+}
+
+void client_transport::terminate(LPCSTR reason)
+{
+	InterlockedExchange	(&m_state, state_terminated);
+	m_terminated	= true;
+	copy_string		(m_terminate_reason, sizeof(m_terminate_reason), reason);
+}
+
+void client_transport::on_datagram(sockaddr_in const & from, u8 const* data, u32 const size, u32 const now)
+{
+	if (!m_server || (address_key(from) != address_key(m_server->address)))
+		return;
+
+	NET_Packet		P;
+	switch (data[1])
+	{
+	case kind_accept :
+		{
+			if (m_state != state_connecting)
+				break;
+
+			P.construct	(data + 2, size - 2);
+			if ((P.r_elapsed() < 3*sizeof(u32)) || (P.r_u32() != m_nonce))
+				break;
+
+			u32 const	id = P.r_u32();
+			if ((P.r_u32() != sizeof(m_session->game_descr)) || (P.r_elapsed() < sizeof(m_session->game_descr)))
+				break;
+
+			P.r			(&m_session->game_descr, sizeof(m_session->game_descr));
+			if (!read_string(P, m_session->session_name, sizeof(m_session->session_name)))
+				break;
+
+			m_server->id	= ClientID(id);
+			InterlockedExchange	(&m_state, state_connected);
+		}break;
+	case kind_reject :
+		{
+			if (m_state != state_connecting)
+				break;
+
+			P.construct	(data + 2, size - 2);
+			if ((P.r_elapsed() < sizeof(u32) + sizeof(u8)) || (P.r_u32() != m_nonce))
+				break;
+
+			m_reject	= P.r_u8();
+			if (!read_string(P, m_session->reject_reason, sizeof(m_session->reject_reason)))
+				m_session->reject_reason[0]	= 0;
+			InterlockedExchange	(&m_state, state_rejected);
+		}break;
+	case kind_data :
+		if (m_state == state_connected)
+			m_server->receive	(data, size, now, m_deliveries);
+		break;
+	case kind_disconnect :
+		{
+			if (m_state != state_connected)
+				break;
+
+			string256	reason;
+			P.construct	(data + 2, size - 2);
+			if ((P.r_elapsed() < sizeof(u32)) || (P.r_u32() != m_nonce))
+				break;
+			if (!read_string(P, reason, sizeof(reason)))
+				reason[0]	= 0;
+			terminate	(reason);
+		}break;
+	}
+}
+
+u32 client_transport::on_update(u32 const now)
+{
+	u32				wait = max_wait;
+	if (m_state == state_connected)
+	{
+		if (m_server->timed_out(now))
+			terminate	("timeout");
+		else
+		{
+			m_server->flush	(m_socket, now);
+			wait		= m_server->wait(now);
+		}
+	}
+
+	m_deliveries.swap	(m_dispatch_deliveries);
+	m_dispatch_terminated	= m_terminated;
+	m_terminated	= false;
+	return			wait;
+}
+
+void client_transport::on_dispatch()
+{
+	if (!m_dispatch_deliveries.messages.empty())
+	{
+		xr_vector<deliveries::message>::const_iterator	I = m_dispatch_deliveries.messages.begin();
+		xr_vector<deliveries::message>::const_iterator	E = m_dispatch_deliveries.messages.end();
+		for (; I != E; ++I)
+			m_handler->OnTransportReceive	(&m_dispatch_deliveries.data[I->offset], I->size);
+		m_dispatch_deliveries.clear	();
+	}
+
+	if (m_dispatch_terminated)
+	{
+		m_dispatch_terminated	= false;
+		m_handler->OnTransportTerminate	(m_terminate_reason);
+	}
+}
+
+} //namespace udp
+
+IServerTransport* create_udp_server_transport(IServerTransportHandler* handler)
+{
+	return	xr_new<udp::server_transport>(handler);
+}
+
+IClientTransport* create_udp_client_transport(IClientTransportHandler* handler)
+{
+	return	xr_new<udp::client_transport>(handler);
+}
@@ -6,6 +6,7 @@
 namespace PAPI{
 // refs
 	struct ParticleEffect;
+	struct ParticleStreams;
 	struct PARTICLES_API			ParticleAction
 	{
 		enum{
@@ -18,6 +19,10 @@ namespace PAPI{
 		virtual void 	Execute		(ParticleEffect *pe, const float dt, float& m_max)	= 0;
 		virtual void 	Transform	(const Fmatrix& m)				= 0;
 
+		// SSE kernel over the structure of arrays copy : fields it reads or writes, 0 if there is no kernel
+		virtual u32		StreamFields	()													{ return 0; }
+		virtual void	ExecuteStreams	(ParticleStreams& S, const float dt, float& m_max)	{ NODEFAULT; }
+
 		virtual void 	Load		(IReader& F)=0;
 		virtual void 	Save		(IWriter& F)=0;
 	};
@@ -1631,6 +1631,14 @@ void PAVortex::Transform(const Fmatrix& m)
 static int	noise_start = 1;
 extern void	noise3Init();
 
+void PATurbulence::Prepare()
+{
+	if ( noise_start ) {
+		noise_start = 0;
+		noise3Init();
+	};
+}
+
 #ifndef _EDITOR
 
 #include <xmmintrin.h>
@@ -1762,10 +1770,7 @@ void PATurbulence::Execute(ParticleEffect *effect, const float dt, float& tm_max
 		TAL_SCOPED_TASK_NAMED( "PATurbulence::Execute()" );
 	#endif // _GPA_ENABLED
 
-	if ( noise_start ) {
-		noise_start = 0;
-		noise3Init();
-	};
+	Prepare();
 
     age		+= dt;
 
@@ -1776,7 +1781,8 @@ void PATurbulence::Execute(ParticleEffect *effect, const float dt, float& tm_max
 
 	u32 nWorkers = ttapi_GetWorkersCount();
 
-	if ( p_cnt < nWorkers * 20 )
+	// batch update is parallel by itself and ttapi is not reentrant
+	if ( ( p_cnt < nWorkers * 20 ) || effect->deferred )
 		nWorkers = 1;
 
 	TES_PARAMS* tesParams = (TES_PARAMS*) _alloca( sizeof(TES_PARAMS) * nWorkers );
@@ -1802,10 +1808,14 @@ void PATurbulence::Execute(ParticleEffect *effect, const float dt, float& tm_max
 		tesParams[i].octaves = octaves;
 		tesParams[i].magnitude = magnitude;
 
-		ttapi_AddWorker( PATurbulenceExecuteStream , (LPVOID) &tesParams[i] );
+		if ( effect->deferred )
+			PATurbulenceExecuteStream( (LPVOID) &tesParams[i] );
+		else
+			ttapi_AddWorker( PATurbulenceExecuteStream , (LPVOID) &tesParams[i] );
 	}
 
-	ttapi_RunAllWorkers();
+	if ( !effect->deferred )
+		ttapi_RunAllWorkers();
 
 }
 
@@ -1813,10 +1823,7 @@ void PATurbulence::Execute(ParticleEffect *effect, const float dt, float& tm_max
 
 void PATurbulence::Execute(ParticleEffect *effect, const float dt, float& tm_max)
 {
-	if ( noise_start ) {
-		noise_start = 0;
-		noise3Init();
-	};
+	Prepare();
 
     pVector pV;
     pVector vX;
@@ -9,6 +9,12 @@ namespace PAPI{
                     virtual void 	Save		(IWriter& F);\
                     virtual void 	Execute		(ParticleEffect *pe, const float dt, float& m_max);\
                     virtual void 	Transform	(const Fmatrix& m);
+#ifndef _EDITOR
+#	define _STREAM_METHODS	virtual u32		StreamFields	();\
+							virtual void	ExecuteStreams	(ParticleStreams& S, const float dt, float& m_max);
+#else
+#	define _STREAM_METHODS
+#endif
 
 	struct PARTICLES_API PAAvoid : public ParticleAction
 	{
@@ -46,6 +52,7 @@ namespace PAPI{
 		float vhighSqr;
 
         _METHODS;
+        _STREAM_METHODS;
 	};
 
 	struct PARTICLES_API PAExplosion : public ParticleAction
@@ -85,6 +92,7 @@ namespace PAPI{
 		pVector direction;	// Amount to increment velocity
 
         _METHODS;
+        _STREAM_METHODS;
 	};
 
 	struct PARTICLES_API PAJet : public ParticleAction
@@ -120,6 +128,7 @@ namespace PAPI{
 	struct PARTICLES_API PAMove : public ParticleAction
 	{
         _METHODS;
+        _STREAM_METHODS;
 	};
 
 	struct PARTICLES_API PAOrbitLine : public ParticleAction
@@ -210,6 +219,7 @@ namespace PAPI{
 		float max_speed;		// Clamp speed to this maximum.
 
         _METHODS;
+        _STREAM_METHODS;
 	};
 
 	struct PARTICLES_API PASource : public ParticleAction
@@ -247,6 +257,7 @@ namespace PAPI{
 		float timeTo;
 
         _METHODS;
+        _STREAM_METHODS;
 	};
 
 	struct PARTICLES_API PATargetSize : public ParticleAction
@@ -255,6 +266,7 @@ namespace PAPI{
 		pVector scale;		// Amount to shift by per frame (1 == all the way)
 
         _METHODS;
+        _STREAM_METHODS;
 	};
 
 	struct PARTICLES_API PATargetRotate : public ParticleAction
@@ -263,6 +275,7 @@ namespace PAPI{
 		float scale;		// Amount to shift by per frame (1 == all the way)
 
         _METHODS;
+        _STREAM_METHODS;
 	};
 
 	struct PARTICLES_API PATargetVelocity : public ParticleAction
@@ -272,6 +285,7 @@ namespace PAPI{
 		float scale;		// Amount to shift by (1 == all the way)
 
         _METHODS;
+        _STREAM_METHODS;
 	};
 
 	struct PARTICLES_API PAVortex : public ParticleAction
@@ -285,6 +299,7 @@ namespace PAPI{
 		float max_radius;	// Only influence particles within max_radius
 
         _METHODS;
+        _STREAM_METHODS;
 	};
 
     struct PARTICLES_API PATurbulence : public ParticleAction
@@ -296,6 +311,9 @@ namespace PAPI{
         pVector offset;		// Offset
         float age;
 
+		// the noise tables are shared by all the effects, build them before going wide
+		static void	Prepare	();
+
         _METHODS;
     };
 };
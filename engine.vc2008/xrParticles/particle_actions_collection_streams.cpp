@@ -0,0 +1,304 @@
+#include "stdafx.h"
+#pragma hdrstop
+
+#include "particle_actions_collection.h"
+#include "particle_effect.h"
+
+#ifndef _EDITOR
+
+#include <xmmintrin.h>
+#include <emmintrin.h>
+
+using namespace PAPI;
+
+// SSE kernels of the actions over ParticleStreams, 4 particles per step.
+// Every kernel does the same math as the Execute of its action, the tail lanes up to
+// p_lanes are computed too and dropped by Scatter.
+
+__forceinline __m128 _mm_select_ps( const __m128 mask , const __m128 a , const __m128 b )
+{
+	// mask ? a : b
+	return _mm_or_ps( _mm_and_ps( mask , a ) , _mm_andnot_ps( mask , b ) );
+}
+
+__forceinline __m128 _mm_length2_ps( const __m128 x , const __m128 y , const __m128 z )
+{
+	return _mm_add_ps( _mm_add_ps( _mm_mul_ps( x , x ) , _mm_mul_ps( y , y ) ) , _mm_mul_ps( z , z ) );
+}
+
+//-------------------------------------------------------------------------------------------------
+u32 PADamping::StreamFields()
+{
+	return psVel;
+}
+void PADamping::ExecuteStreams(ParticleStreams& S, const float dt, float& tm_max)
+{
+	// This is important if dt is != 1.
+	pVector one(1,1,1);
+	pVector scale(one - ((one - damping) * dt));
+
+	const __m128 _scale[3] = { _mm_set1_ps(scale.x), _mm_set1_ps(scale.y), _mm_set1_ps(scale.z) };
+	const __m128 _vlow = _mm_set1_ps(vlowSqr);
+	const __m128 _vhigh = _mm_set1_ps(vhighSqr);
+
+	for(u32 i = 0; i < S.p_lanes; i += 4)
+	{
+		__m128 vx = _mm_load_ps( S.vel[0] + i );
+		__m128 vy = _mm_load_ps( S.vel[1] + i );
+		__m128 vz = _mm_load_ps( S.vel[2] + i );
+		__m128 vSqr = _mm_length2_ps( vx , vy , vz );
+		__m128 mask = _mm_and_ps( _mm_cmpge_ps( vSqr , _vlow ) , _mm_cmple_ps( vSqr , _vhigh ) );
+
+		_mm_store_ps( S.vel[0] + i , _mm_select_ps( mask , _mm_mul_ps( vx , _scale[0] ) , vx ) );
+		_mm_store_ps( S.vel[1] + i , _mm_select_ps( mask , _mm_mul_ps( vy , _scale[1] ) , vy ) );
+		_mm_store_ps( S.vel[2] + i , _mm_select_ps( mask , _mm_mul_ps( vz , _scale[2] ) , vz ) );
+	}
+}
+//-------------------------------------------------------------------------------------------------
+
+u32 PAGravity::StreamFields()
+{
+	return psVel;
+}
+void PAGravity::ExecuteStreams(ParticleStreams& S, const float dt, float& tm_max)
+{
+	pVector ddir(direction * dt);
+
+	const __m128 _ddir[3] = { _mm_set1_ps(ddir.x), _mm_set1_ps(ddir.y), _mm_set1_ps(ddir.z) };
+	for(u32 i = 0; i < S.p_lanes; i += 4)
+		for(u32 k = 0; k < 3; k++)
+			_mm_store_ps( S.vel[k] + i , _mm_add_ps( _mm_load_ps( S.vel[k] + i ) , _ddir[k] ) );
+}
+//-------------------------------------------------------------------------------------------------
+
+u32 PAMove::StreamFields()
+{
+	return psPos|psPosB|psVel|psAge;
+}
+void PAMove::ExecuteStreams(ParticleStreams& S, const float dt, float& tm_max)
+{
+	// Step particle positions forward by dt, and age the particles.
+	const __m128 _dt = _mm_set1_ps(dt);
+	for(u32 i = 0; i < S.p_lanes; i += 4)
+	{
+		_mm_store_ps( S.age + i , _mm_add_ps( _mm_load_ps( S.age + i ) , _dt ) );
+		for(u32 k = 0; k < 3; k++)
+		{
+			__m128 p = _mm_load_ps( S.pos[k] + i );
+			_mm_store_ps( S.posB[k] + i , p );
+			_mm_store_ps( S.pos[k] + i , _mm_add_ps( p , _mm_mul_ps( _mm_load_ps( S.vel[k] + i ) , _dt ) ) );
+		}
+	}
+}
+//-------------------------------------------------------------------------------------------------
+
+u32 PASpeedLimit::StreamFields()
+{
+	return psVel;
+}
+void PASpeedLimit::ExecuteStreams(ParticleStreams& S, const float dt, float& tm_max)
+{
+	const __m128 _min_speed = _mm_set1_ps(min_speed);
+	const __m128 _max_speed = _mm_set1_ps(max_speed);
+	const __m128 _min_sqr = _mm_set1_ps(min_speed*min_speed);
+	const __m128 _max_sqr = _mm_set1_ps(max_speed*max_speed);
+	const __m128 _zero = _mm_setzero_ps();
+	const __m128 _one = _mm_set1_ps(1.f);
+
+	for(u32 i = 0; i < S.p_lanes; i += 4)
+	{
+		__m128 vx = _mm_load_ps( S.vel[0] + i );
+		__m128 vy = _mm_load_ps( S.vel[1] + i );
+		__m128 vz = _mm_load_ps( S.vel[2] + i );
+		__m128 sSqr = _mm_length2_ps( vx , vy , vz );
+		__m128 s = _mm_sqrt_ps( sSqr );
+
+		// too slow (but moving) or else too fast, the factor of the rest stays 1
+		__m128 slow = _mm_and_ps( _mm_cmplt_ps( sSqr , _min_sqr ) , _mm_cmpneq_ps( sSqr , _zero ) );
+		__m128 fast = _mm_andnot_ps( slow , _mm_cmpgt_ps( sSqr , _max_sqr ) );
+		__m128 f = _mm_select_ps( slow , _mm_div_ps( _min_speed , s ) , _one );
+		f = _mm_select_ps( fast , _mm_div_ps( _max_speed , s ) , f );
+
+		_mm_store_ps( S.vel[0] + i , _mm_mul_ps( vx , f ) );
+		_mm_store_ps( S.vel[1] + i , _mm_mul_ps( vy , f ) );
+		_mm_store_ps( S.vel[2] + i , _mm_mul_ps( vz , f ) );
+	}
+}
+//-------------------------------------------------------------------------------------------------
+
+// colors are unpacked and packed with the integer SSE2 instructions
+u32 PATargetColor::StreamFields()
+{
+	return (CPU::ID.feature&_CPU_FEATURE_SSE2) ? psColor|psAge : 0;
+}
+void PATargetColor::ExecuteStreams(ParticleStreams& S, const float dt, float& tm_max)
+{
+	// channels in the order of the u32 : b,g,r,a
+	const __m128 _scaleFac = _mm_set1_ps(scale * dt);
+	const __m128 _target[4] = { _mm_set1_ps(color.z), _mm_set1_ps(color.y), _mm_set1_ps(color.x), _mm_set1_ps(alpha) };
+	const __m128 _from = _mm_set1_ps(timeFrom*tm_max);
+	const __m128 _to = _mm_set1_ps(timeTo*tm_max);
+	const __m128 _inv255 = _mm_set1_ps(1.f/255.f);
+	const __m128 _255 = _mm_set1_ps(255.f);
+	const __m128 _zero = _mm_setzero_ps();
+	const __m128i _byte = _mm_set1_epi32(0xff);
+
+	for(u32 i = 0; i < S.p_lanes; i += 4)
+	{
+		__m128 age = _mm_load_ps( S.age + i );
+		__m128 mask = _mm_and_ps( _mm_cmpge_ps( age , _from ) , _mm_cmple_ps( age , _to ) );
+		if (!_mm_movemask_ps( mask ))
+			continue;
+
+		__m128i c_p = _mm_load_si128( (const __m128i*)( S.color + i ) );
+		__m128i c_t = _mm_setzero_si128();
+		for(int k = 0; k < 4; k++)
+		{
+			// Fcolor::set, lerp, Fcolor::get
+			__m128 c = _mm_mul_ps( _mm_cvtepi32_ps( _mm_and_si128( _mm_srli_epi32( c_p , k*8 ) , _byte ) ) , _inv255 );
+			c = _mm_add_ps( c , _mm_mul_ps( _mm_sub_ps( _target[k] , c ) , _scaleFac ) );
+			c = _mm_min_ps( _mm_max_ps( _mm_mul_ps( c , _255 ) , _zero ) , _255 );
+			c_t = _mm_or_si128( c_t , _mm_slli_epi32( _mm_cvttps_epi32( c ) , k*8 ) );
+		}
+
+		__m128i _mask = _mm_castps_si128( mask );
+		c_t = _mm_or_si128( _mm_and_si128( _mask , c_t ) , _mm_andnot_si128( _mask , c_p ) );
+		_mm_store_si128( (__m128i*)( S.color + i ) , c_t );
+	}
+}
+//-------------------------------------------------------------------------------------------------
+
+u32 PATargetSize::StreamFields()
+{
+	return psSize;
+}
+void PATargetSize::ExecuteStreams(ParticleStreams& S, const float dt, float& tm_max)
+{
+	const __m128 _size[3] = { _mm_set1_ps(size.x), _mm_set1_ps(size.y), _mm_set1_ps(size.z) };
+	const __m128 _scaleFac[3] = { _mm_set1_ps(scale.x * dt), _mm_set1_ps(scale.y * dt), _mm_set1_ps(scale.z * dt) };
+
+	for(u32 i = 0; i < S.p_lanes; i += 4)
+		for(u32 k = 0; k < 3; k++)
+		{
+			__m128 s = _mm_load_ps( S.size[k] + i );
+			_mm_store_ps( S.size[k] + i , _mm_add_ps( s , _mm_mul_ps( _mm_sub_ps( _size[k] , s ) , _scaleFac[k] ) ) );
+		}
+}
+//-------------------------------------------------------------------------------------------------
+
+u32 PATargetRotate::StreamFields()
+{
+	return psRot;
+}
+void PATargetRotate::ExecuteStreams(ParticleStreams& S, const float dt, float& tm_max)
+{
+	const __m128 _r = _mm_set1_ps(_abs(rot.x));
+	const __m128 _scaleFac = _mm_set1_ps(scale * dt);
+	const __m128 _sign = _mm_set1_ps(-0.f);
+	const __m128 _zero = _mm_setzero_ps();
+
+	for(u32 i = 0; i < S.p_lanes; i += 4)
+	{
+		__m128 rot = _mm_load_ps( S.rot + i );
+		__m128 abs_rot = _mm_andnot_ps( _sign , rot );
+		// scaleFac for the positive (and +0) rotations, -scaleFac for the negative ones
+		__m128 sign = _mm_select_ps( _mm_cmpge_ps( rot , _zero ) , _scaleFac , _mm_xor_ps( _scaleFac , _sign ) );
+		_mm_store_ps( S.rot + i , _mm_add_ps( rot , _mm_mul_ps( _mm_sub_ps( _r , abs_rot ) , sign ) ) );
+	}
+}
+//-------------------------------------------------------------------------------------------------
+
+u32 PATargetVelocity::StreamFields()
+{
+	return psVel;
+}
+void PATargetVelocity::ExecuteStreams(ParticleStreams& S, const float dt, float& tm_max)
+{
+	const __m128 _velocity[3] = { _mm_set1_ps(velocity.x), _mm_set1_ps(velocity.y), _mm_set1_ps(velocity.z) };
+	const __m128 _scaleFac = _mm_set1_ps(scale * dt);
+
+	for(u32 i = 0; i < S.p_lanes; i += 4)
+		for(u32 k = 0; k < 3; k++)
+		{
+			__m128 v = _mm_load_ps( S.vel[k] + i );
+			_mm_store_ps( S.vel[k] + i , _mm_add_ps( v , _mm_mul_ps( _mm_sub_ps( _velocity[k] , v ) , _scaleFac ) ) );
+		}
+}
+//-------------------------------------------------------------------------------------------------
+
+u32 PAVortex::StreamFields()
+{
+	return psPos;
+}
+void PAVortex::ExecuteStreams(ParticleStreams& S, const float dt, float& tm_max)
+{
+	float magdt = magnitude * dt;
+	float max_radiusSqr = max_radius * max_radius;
+
+	const __m128 _center[3] = { _mm_set1_ps(center.x), _mm_set1_ps(center.y), _mm_set1_ps(center.z) };
+	const __m128 _axis[3] = { _mm_set1_ps(axis.x), _mm_set1_ps(axis.y), _mm_set1_ps(axis.z) };
+	const __m128 _magdt = _mm_set1_ps(magdt);
+	const __m128 _epsilon = _mm_set1_ps(epsilon);
+	const __m128 _max_radiusSqr = _mm_set1_ps(max_radiusSqr);
+	const BOOL bLimited = max_radiusSqr < P_MAXFLOAT;
+
+	__declspec(align(16)) float theta[4], s[4], c[4];
+	for(u32 i = 0; i < S.p_lanes; i += 4)
+	{
+		// Vector from tip of vortex
+		__m128 px = _mm_load_ps( S.pos[0] + i );
+		__m128 py = _mm_load_ps( S.pos[1] + i );
+		__m128 pz = _mm_load_ps( S.pos[2] + i );
+		__m128 ox = _mm_sub_ps( px , _center[0] );
+		__m128 oy = _mm_sub_ps( py , _center[1] );
+		__m128 oz = _mm_sub_ps( pz , _center[2] );
+
+		// Don't do anything to particle if too far.
+		__m128 rSqr = _mm_length2_ps( ox , oy , oz );
+		__m128 mask = bLimited ? _mm_cmple_ps( rSqr , _max_radiusSqr ) : _mm_cmpeq_ps( rSqr , rSqr );
+		if (!_mm_movemask_ps( mask ))
+			continue;
+
+		// Compute normalized offset vector3.
+		__m128 r = _mm_sqrt_ps( rSqr );
+		__m128 nx = _mm_div_ps( ox , r );
+		__m128 ny = _mm_div_ps( oy , r );
+		__m128 nz = _mm_div_ps( oz , r );
+
+		// Components of offset parallel and perpendicular to axis
+		__m128 axisProj = _mm_add_ps( _mm_add_ps( _mm_mul_ps( nx , _axis[0] ) , _mm_mul_ps( ny , _axis[1] ) ) , _mm_mul_ps( nz , _axis[2] ) );
+		__m128 wx = _mm_mul_ps( _axis[0] , axisProj );
+		__m128 wy = _mm_mul_ps( _axis[1] , axisProj );
+		__m128 wz = _mm_mul_ps( _axis[2] , axisProj );
+		__m128 ux = _mm_sub_ps( nx , wx );
+		__m128 uy = _mm_sub_ps( ny , wy );
+		__m128 uz = _mm_sub_ps( nz , wz );
+
+		// Perpendicular component completing frame: axis ^ u
+		__m128 vx = _mm_sub_ps( _mm_mul_ps( _axis[1] , uz ) , _mm_mul_ps( _axis[2] , uy ) );
+		__m128 vy = _mm_sub_ps( _mm_mul_ps( _axis[2] , ux ) , _mm_mul_ps( _axis[0] , uz ) );
+		__m128 vz = _mm_sub_ps( _mm_mul_ps( _axis[0] , uy ) , _mm_mul_ps( _axis[1] , ux ) );
+
+		// Figure amount of rotation, there are no sin/cos in SSE
+		_mm_store_ps( theta , _mm_div_ps( _magdt , _mm_add_ps( rSqr , _epsilon ) ) );
+		for(int k = 0; k < 4; k++)
+		{
+			s[k] = _sin(theta[k]);
+			c[k] = _cos(theta[k]);
+		}
+		__m128 _s = _mm_load_ps( s );
+		__m128 _c = _mm_load_ps( c );
+
+		// Translate back to object space
+		__m128 rx = _mm_add_ps( _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( ux , _c ) , _mm_mul_ps( vx , _s ) ) , wx ) , r ) , _center[0] );
+		__m128 ry = _mm_add_ps( _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( uy , _c ) , _mm_mul_ps( vy , _s ) ) , wy ) , r ) , _center[1] );
+		__m128 rz = _mm_add_ps( _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( uz , _c ) , _mm_mul_ps( vz , _s ) ) , wz ) , r ) , _center[2] );
+
+		_mm_store_ps( S.pos[0] + i , _mm_select_ps( mask , rx , px ) );
+		_mm_store_ps( S.pos[1] + i , _mm_select_ps( mask , ry , py ) );
+		_mm_store_ps( S.pos[2] + i , _mm_select_ps( mask , rz , pz ) );
+	}
+}
+//-------------------------------------------------------------------------------------------------
+
+#endif // _EDITOR
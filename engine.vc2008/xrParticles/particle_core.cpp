@@ -28,7 +28,7 @@ float PAPI::NRand(float sigma)
 	}
 	while(drand48() > expf(-_sqr(y - 1.0f)*0.5f));
 	
-	if(rand() & 0x1)
+	if(drand48() < 0.5f)
 		return y * sigma * ONE_OVER_SIGMA_EXP;
 	else
 		return -y * sigma * ONE_OVER_SIGMA_EXP;
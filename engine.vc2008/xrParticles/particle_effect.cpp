@@ -3,3 +3,168 @@
 
 #include "particle_effect.h"
 
+using namespace PAPI;
+
+ParticleStreams::ParticleStreams()
+{
+	p_count			= 0;
+	p_lanes			= 0;
+	p_allocated		= 0;
+	fields			= 0;
+	real_ptr		= 0;
+	ZeroMemory		(pos,	sizeof(pos));
+	ZeroMemory		(posB,	sizeof(posB));
+	ZeroMemory		(vel,	sizeof(vel));
+	ZeroMemory		(size,	sizeof(size));
+	rot				= 0;
+	age				= 0;
+	color			= 0;
+}
+
+ParticleStreams::~ParticleStreams()
+{
+	xr_free			(real_ptr);
+}
+
+void ParticleStreams::Gather(const Particle* particles, u32 count, u32 _fields)
+{
+	p_count			= count;
+	p_lanes			= (count + 3) & ~3;
+	fields			= _fields;
+
+	if (p_lanes > p_allocated){
+		// 15 streams, every one aligned to 16 bytes
+		enum { stream_count = 15 };
+		p_allocated	= p_lanes;
+		xr_free		(real_ptr);
+		real_ptr	= xr_malloc(stream_count*p_allocated*sizeof(float) + 16);
+
+		float* base	= (float*) ( (DWORD) real_ptr + ( 16 - ( (DWORD) real_ptr & 15 ) ) % 16 );
+		for (u32 k=0; k<3; ++k){
+			pos[k]	= base;	base += p_allocated;
+			posB[k]	= base;	base += p_allocated;
+			vel[k]	= base;	base += p_allocated;
+			size[k]	= base;	base += p_allocated;
+		}
+		rot			= base;	base += p_allocated;
+		age			= base;	base += p_allocated;
+		color		= (u32*)base;
+	}
+
+	for (u32 i=0; i<count; i++){
+		const Particle& m	= particles[i];
+		if (fields&psPos)	{ pos[0][i]		= m.pos.x;	pos[1][i]	= m.pos.y;	pos[2][i]	= m.pos.z;	}
+		if (fields&psPosB)	{ posB[0][i]	= m.posB.x;	posB[1][i]	= m.posB.y;	posB[2][i]	= m.posB.z;	}
+		if (fields&psVel)	{ vel[0][i]		= m.vel.x;	vel[1][i]	= m.vel.y;	vel[2][i]	= m.vel.z;	}
+		if (fields&psSize)	{ size[0][i]	= m.size.x;	size[1][i]	= m.size.y;	size[2][i]	= m.size.z;	}
+		if (fields&psRot)	rot[i]		= m.rot.x;
+		if (fields&psAge)	age[i]		= m.age;
+		if (fields&psColor)	color[i]	= m.color;
+	}
+
+	// the tail lanes are computed as well, keep them finite
+	for (u32 i=count; i<p_lanes; i++){
+		for (u32 k=0; k<3; ++k)
+			pos[k][i]	= posB[k][i] = vel[k][i] = size[k][i] = 0.f;
+		rot[i]		= age[i] = 0.f;
+		color[i]	= 0;
+	}
+}
+
+void ParticleStreams::Scatter(Particle* particles)
+{
+	for (u32 i=0; i<p_count; i++){
+		Particle& m			= particles[i];
+		if (fields&psPos)	m.pos.set	(pos[0][i],pos[1][i],pos[2][i]);
+		if (fields&psPosB)	m.posB.set	(posB[0][i],posB[1][i],posB[2][i]);
+		if (fields&psVel)	m.vel.set	(vel[0][i],vel[1][i],vel[2][i]);
+		if (fields&psSize)	m.size.set	(size[0][i],size[1][i],size[2][i]);
+		if (fields&psRot)	m.rot.x		= rot[i];
+		if (fields&psAge)	m.age		= age[i];
+		if (fields&psColor)	m.color		= color[i];
+	}
+}
+
+void ParticleStreams::View(const ParticleStreams& S, u32 from, u32 count)
+{
+	VERIFY			(0==(from&3) && from+count<=S.p_lanes);
+	p_count			= _min(count,S.p_count>from ? S.p_count-from : 0);
+	p_lanes			= (count + 3) & ~3;
+	p_allocated		= 0;
+	fields			= S.fields;
+	real_ptr		= 0;
+	for (u32 k=0; k<3; ++k){
+		pos[k]		= S.pos[k]	+ from;
+		posB[k]		= S.posB[k]	+ from;
+		vel[k]		= S.vel[k]	+ from;
+		size[k]		= S.size[k]	+ from;
+	}
+	rot				= S.rot		+ from;
+	age				= S.age		+ from;
+	color			= S.color	+ from;
+}
+
+void ParticleEffect::BeginDeferred()
+{
+	VERIFY			(!deferred && events.empty());
+	deferred		= TRUE;
+	if (b_cb && (slot_events.size() < max_particles))
+		slot_events.resize	(max_particles,u32(-1));
+}
+
+void ParticleEffect::DeferBirth(u32 i)
+{
+	if (!b_cb)		return;
+
+	ParticleEvent	E;
+	E.particle		= particles[i];
+	E.index			= i;
+	E.slot			= i;
+	E.birth			= TRUE;
+	slot_events[i]	= events.size();
+	events.push_back(E);
+}
+
+void ParticleEffect::DeferDeath(u32 i)
+{
+	// Remove moves the last particle into the slot, the birth event follows it
+	if (b_cb){
+		u32 last		= p_count - 1;
+		if (slot_events[i]!=u32(-1))
+			events[slot_events[i]].slot	= u32(-1);
+		slot_events[i]	= (last!=i) ? slot_events[last] : u32(-1);
+		slot_events[last]	= u32(-1);
+		if (slot_events[i]!=u32(-1))
+			events[slot_events[i]].slot	= i;
+	}
+
+	if (!d_cb)		return;
+
+	ParticleEvent	E;
+	E.particle		= particles[i];
+	E.index			= i;
+	E.slot			= u32(-1);
+	E.birth			= FALSE;
+	events.push_back(E);
+}
+
+void ParticleEffect::ReplayEvents()
+{
+	VERIFY			(deferred);
+	deferred		= FALSE;
+
+	// the births of the particles which are still alive see them as they are after the update,
+	// so whatever the callback sets stays with the particle
+	for (ParticleEventVecIt it=events.begin(); it!=events.end(); ++it){
+		ParticleEvent& E	= *it;
+		if (E.birth){
+			if (E.slot!=u32(-1)){
+				slot_events[E.slot]	= u32(-1);
+				b_cb		(owner,param,particles[E.slot],E.index);
+			}else
+				b_cb		(owner,param,E.particle,E.index);
+		}else
+			d_cb			(owner,param,E.particle,E.index);
+	}
+	events.clear_not_free	();
+}
@@ -3,6 +3,54 @@
 #define particle_effectH
 
 namespace PAPI{
+	// Particle fields touched by the stream kernels of an action
+	enum{
+		psPos		= (1<<0),
+		psPosB		= (1<<1),
+		psVel		= (1<<2),
+		psSize		= (1<<3),
+		psRot		= (1<<4),
+		psAge		= (1<<5),
+		psColor		= (1<<6),
+	};
+
+	// Structure of arrays copy of the particles of an effect : runs of the actions which have
+	// SSE kernels go over it 4 particles at a time. The effect itself keeps the array of
+	// structures, so GetParticles and the birth/death callbacks see the particles as before.
+	struct ParticleStreams
+	{
+		u32			p_count;				// Particles copied in.
+		u32			p_lanes;				// p_count rounded up to 4, the tail is zeroed.
+		u32			p_allocated;
+		u32			fields;					// Copied in and copied back.
+		void*		real_ptr;
+
+		float*		pos		[3];
+		float*		posB	[3];
+		float*		vel		[3];
+		float*		size	[3];
+		float*		rot;
+		float*		age;
+		u32*		color;
+
+					ParticleStreams	();
+					~ParticleStreams();
+		void		Gather			(const Particle* particles, u32 count, u32 fields);
+		void		Scatter			(Particle* particles);
+		// window over the streams of another copy, [from,from+count) lanes, from is a multiple of 4
+		void		View			(const ParticleStreams& S, u32 from, u32 count);
+	};
+
+	// Birth or death of a particle, recorded while the effect is updated off the calling thread
+	struct ParticleEvent
+	{
+		Particle	particle;				// As it was when the callback would have been called.
+		u32			index;					// Index passed to the callback.
+		u32			slot;					// Births : where the particle is now, u32(-1) if it has died already.
+		BOOL		birth;
+	};
+	DEFINE_VECTOR	(ParticleEvent,ParticleEventVec,ParticleEventVecIt);
+
 	// A effect of particles - Info and an array of Particles
 	struct ParticleEffect
 	{
@@ -11,16 +59,27 @@ namespace PAPI{
 		u32			particles_allocated;	// Actual allocated size.
 		Particle*	particles;				// Actually, num_particles in size
 		void*		real_ptr;				// Base, possible not aligned pointer
+		ParticleStreams*	streams;		// Created on the first run of the stream kernels
         OnBirthParticleCB 	b_cb;
         OnDeadParticleCB	d_cb;
         void*				owner;
         u32					param;
+		BOOL				deferred;		// Callbacks are recorded into events and replayed by ReplayEvents.
+		ParticleEventVec	events;
+		xr_vector<u32>		slot_events;	// Slot -> index of the birth event of the particle in it.
+		CRandom				random;			// drand48 of the actions while the effect is updated.
+
+		void		DeferBirth		(u32 i);
+		void		DeferDeath		(u32 i);
         
         public:
 					ParticleEffect	(int mp)
 		{
         	owner					= 0;
             param 					= 0;
+			streams					= 0;
+			deferred				= FALSE;
+			random.seed				(::Random.randI());
         	b_cb					= 0;
         	d_cb					= 0;
    			p_count					= 0;
@@ -34,6 +93,12 @@ namespace PAPI{
 					~ParticleEffect	()
 		{
 			xr_free					(real_ptr);
+			xr_delete				(streams);
+		}
+		IC ParticleStreams&	Streams	()
+		{
+			if (!streams)			streams	= xr_new<ParticleStreams>();
+			return					*streams;
 		}
 		IC int		Resize			(u32 max_count)
 		{
@@ -71,11 +136,16 @@ namespace PAPI{
 			particles_allocated		= max_count;
 			return max_count;
 		}
+		// Records the callbacks instead of calling them, until ReplayEvents.
+		void		BeginDeferred	();
+		// Calls the recorded callbacks in the order they have happened.
+		void		ReplayEvents	();
 		IC void		Remove			(int i)
 		{
         	if (0==p_count)			return;
 			Particle& m				= particles[i];
-            if (d_cb)				d_cb(owner,param,m,i);
+			if (deferred)			DeferDeath(i);
+            else if (d_cb)			d_cb(owner,param,m,i);
             m 						= particles[--p_count]; //     !!! (dependence ParticleGroup)
 			// Msg( "pDel() : %u" , p_count );
 		}
@@ -96,7 +166,8 @@ namespace PAPI{
 				P.age 		= age;
 				P.frame 	= frame;
 				P.flags.assign(flags); 
-	            if (b_cb)	b_cb(owner,param,P,p_count);
+				if (deferred)	DeferBirth(p_count);
+	            else if (b_cb)	b_cb(owner,param,P,p_count);
 				p_count++;
 				// Msg( "pAdd() : %u" , p_count );
 				return TRUE;
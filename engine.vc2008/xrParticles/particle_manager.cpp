@@ -5,6 +5,9 @@
 #include "particle_manager.h"
 #include "particle_effect.h"
 #include "particle_actions_collection.h"
+#ifndef _EDITOR
+#	include "../xrCore/task_scheduler.h"
+#endif
 
 using namespace PAPI;
 
@@ -12,13 +15,31 @@ using namespace PAPI;
 CParticleManager PM;
 PARTICLES_API IParticleManager* PAPI::ParticleManager(){	return &PM; }
 
+// effect being updated on the thread
+static DWORD s_random_tls		= TLS_OUT_OF_INDEXES;
+
+PARTICLES_API CRandom& PAPI::ParticleRandom()
+{
+	CRandom* R			= (s_random_tls!=TLS_OUT_OF_INDEXES) ? (CRandom*)TlsGetValue(s_random_tls) : 0;
+	return				R ? *R : ::Random;
+}
+
 // 
 CParticleManager::CParticleManager	()
 {
+	s_random_tls		= TlsAlloc();
+#ifndef _EDITOR
+	m_bStreams			= TRUE;
+#else
+	m_bStreams			= FALSE;
+#endif
 }
 
 CParticleManager::~CParticleManager	()
 {
+	if (s_random_tls!=TLS_OUT_OF_INDEXES)
+		TlsFree			(s_random_tls);
+	s_random_tls		= TLS_OUT_OF_INDEXES;
 }
 
 ParticleEffect*	CParticleManager::GetEffectPtr(int effect_id)
@@ -127,6 +148,36 @@ void CParticleManager::StopEffect(int effect_id, int alist_id, BOOL deffered)
 	pa->unlock();
 }
 
+#ifndef _EDITOR
+// slice of the streams of a large effect, the stream kernels touch every particle on its own
+struct batch_range
+{
+	ParticleStreams		S;
+	PAVecIt				first;
+	PAVecIt				last;
+	float				dt;
+	float				kill_old_time;
+
+	void				process		()
+	{
+		for (PAVecIt it=first; it!=last; ++it)
+			(*it)->ExecuteStreams(S, dt, kill_old_time);
+	}
+};
+
+static const u32 batch_range_lanes	= 512;
+
+void CParticleManager::batch_item::process()
+{
+	manager->Execute	(pe, pa, dt, TRUE);
+}
+
+bool CParticleManager::batch_item::bigger(const batch_item& a, const batch_item& b)
+{
+	return				(a.pe->p_count > b.pe->p_count);
+}
+#endif
+
 // update&render
 void CParticleManager::Update(int effect_id, int alist_id, float dt)
 {
@@ -136,16 +187,106 @@ void CParticleManager::Update(int effect_id, int alist_id, float dt)
 	VERIFY(pa);
 	VERIFY(pe);
 
+	Execute				(pe, pa, dt, FALSE);
+}
+
+void CParticleManager::UpdateBatch(const ParticleUpdate* items, u32 count, float dt)
+{
+#ifndef _EDITOR
+	if ((count > 1) && TaskScheduler.initialized() && TaskScheduler.worker_count())
+	{
+		PATurbulence::Prepare	();
+
+		m_batch.resize		(count);
+		for (u32 i=0; i<count; ++i)
+		{
+			batch_item& B	= m_batch[i];
+			B.manager		= this;
+			B.pe			= GetEffectPtr(items[i].effect_id);
+			B.pa			= GetActionListPtr(items[i].alist_id);
+			B.dt			= dt;
+			VERIFY			(B.pe && B.pa);
+			B.pe->BeginDeferred	();
+		}
+
+		// the biggest effects go first, the small ones fill the gaps at the end
+		std::sort			(m_batch.begin(), m_batch.end(), batch_item::bigger);
+
+		task_group			group;
+		for (BatchItemVecIt it=m_batch.begin(); it!=m_batch.end(); ++it)
+			TaskScheduler.push	(group, fastdelegate::FastDelegate0<>(&*it, &batch_item::process));
+		TaskScheduler.wait	(group);
+
+		for (u32 i=0; i<count; ++i)
+			GetEffectPtr(items[i].effect_id)->ReplayEvents();
+		return;
+	}
+#endif
+	for (u32 i=0; i<count; ++i)
+		Update				(items[i].effect_id, items[i].alist_id, dt);
+}
+
+void CParticleManager::Execute(ParticleEffect* pe, ParticleActions* pa, float dt, BOOL ranges)
+{
+	// every effect draws from its own generator, so the result does not depend on the threads;
+	// the wait below may execute another effect on this thread, the previous one is restored
+	void* prev_random	= TlsGetValue(s_random_tls);
+	TlsSetValue			(s_random_tls, &pe->random);
+
 	pa->lock();
 
 	// Step through all the actions in the action list.
     float kill_old_time = 1.0f;
-	for(PAVecIt it=pa->begin(); it!=pa->end(); it++)
+	for(PAVecIt it=pa->begin(); it!=pa->end(); )
 	{
 		VERIFY((*it));
+#ifndef _EDITOR
+		// two and more actions in a row with SSE kernels pay for the copy to the streams and back
+		if (m_bStreams && (pe->p_count >= 8))
+		{
+			u32 fields			= 0;
+			PAVecIt run_end		= it;
+			for (; (run_end!=pa->end()) && (*run_end)->StreamFields(); ++run_end)
+				fields			|= (*run_end)->StreamFields();
+
+			if (run_end - it >= 2)
+			{
+				ParticleStreams& S	= pe->Streams();
+				S.Gather		(pe->particles, pe->p_count, fields);
+				if (ranges && (S.p_lanes >= 2*batch_range_lanes))
+				{
+					xr_vector<batch_range>	R((S.p_lanes + batch_range_lanes - 1)/batch_range_lanes);
+					task_group	group;
+					for (u32 r=0; r<R.size(); ++r)
+					{
+						u32 from	= r*batch_range_lanes;
+						R[r].S.View		(S, from, _min(batch_range_lanes, S.p_lanes-from));
+						R[r].first		= it;
+						R[r].last		= run_end;
+						R[r].dt			= dt;
+						R[r].kill_old_time	= kill_old_time;
+						TaskScheduler.push	(group, fastdelegate::FastDelegate0<>(&R[r], &batch_range::process));
+					}
+					// the waiter executes the ranges too, while the workers are busy with the other effects
+					TaskScheduler.wait	(group);
+					it				= run_end;
+				}
+				else
+				{
+					for (; it!=run_end; ++it)
+						(*it)->ExecuteStreams(S, dt, kill_old_time);
+				}
+				S.Scatter		(pe->particles);
+				continue;
+			}
+		}
+#endif
     	(*it)->Execute	(pe, dt, kill_old_time);
+		++it;
 	}
 	pa->unlock();
+
+	TlsSetValue			(s_random_tls, prev_random);
 }
 void CParticleManager::Render(int effect_id)
 {
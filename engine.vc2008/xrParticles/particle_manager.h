@@ -13,6 +13,23 @@ namespace PAPI{
 		DEFINE_VECTOR				(ParticleActions*,ParticleActionsVec,ParticleActionsVecIt);
 		ParticleEffectVec			effect_vec;
 		ParticleActionsVec			m_alist_vec;
+		BOOL						m_bStreams;
+#ifndef _EDITOR
+		// one task of the batch update
+		struct batch_item
+		{
+			CParticleManager*		manager;
+			ParticleEffect*			pe;
+			ParticleActions*		pa;
+			float					dt;
+			void					process				();
+			static bool				bigger				(const batch_item& a, const batch_item& b);
+		};
+		DEFINE_VECTOR				(batch_item,BatchItemVec,BatchItemVecIt);
+		BatchItemVec				m_batch;
+#endif
+		// ranges : runs of the stream kernels of a large effect are split into tasks too
+		void						Execute				(ParticleEffect* pe, ParticleActions* pa, float dt, BOOL ranges);
     public:
 		    						CParticleManager	();
         virtual						~CParticleManager	();
@@ -32,8 +49,11 @@ namespace PAPI{
 
         // update&render
         virtual void				Update				(int effect_id, int alist_id, float dt);
+        virtual void				UpdateBatch			(const ParticleUpdate* items, u32 count, float dt);
         virtual void				Render				(int effect_id);
         virtual void				Transform			(int alist_id, const Fmatrix& m, const Fvector& velocity);
+        virtual void				SetStreams			(BOOL enable)	{ m_bStreams = enable;	}
+        virtual BOOL				GetStreams			()				{ return m_bStreams;	}
 
         // effect
         virtual void				RemoveParticle		(int effect_id, u32 p_id);
@@ -22,7 +22,7 @@
 	#define P_MAXINT	0x7fffffff
 #endif
 
-#define drand48()		::Random.randF()
+#define drand48()		PAPI::ParticleRandom().randF()
 //#define drand48() (((float) rand())/((float) RAND_MAX))
 
 namespace PAPI{
@@ -126,6 +126,13 @@ namespace PAPI{
 	};
     struct ParticleAction;
 
+	// effect and its action list, as they are passed to Update
+	struct ParticleUpdate
+	{
+		int		effect_id;
+		int		alist_id;
+	};
+
     class IParticleManager{
     public:
 		    						IParticleManager	(){}
@@ -143,8 +150,14 @@ namespace PAPI{
 
         // update&render
         virtual void				Update				(int effect_id, int alist_id, float dt)=0;
+        // all the effects at once, spread over the task workers; the birth/death callbacks
+        // are called on the calling thread after the update, in the order they have happened
+        virtual void				UpdateBatch			(const ParticleUpdate* items, u32 count, float dt)=0;
         virtual void				Render				(int effect_id)=0;
         virtual void				Transform			(int alist_id, const Fmatrix& m, const Fvector& velocity)=0;
+        // runs of the actions with SSE kernels go over a structure of arrays copy of the particles
+        virtual void				SetStreams			(BOOL enable)=0;
+        virtual BOOL				GetStreams			()=0;
 
         // effect
         virtual void				RemoveParticle		(int effect_id, u32 p_id)=0;
@@ -160,5 +173,7 @@ namespace PAPI{
     };
 
     PARTICLES_API IParticleManager* ParticleManager		();
+    // generator of the effect being updated on the calling thread, the global one outside of the update
+    PARTICLES_API CRandom&			ParticleRandom		();
 };
 #endif //PSystemH
@@ -12,6 +12,7 @@
 
 // ALife objects, events and tasks
 #define ALIFE_VERSION				0x0006
+#define ALIFE_CHUNKED_VERSION		0x0007	// saved game file, compressed by blocks
 #define ALIFE_CHUNK_DATA			0x0000
 #define SPAWN_CHUNK_DATA			0x0001
 #define OBJECT_CHUNK_DATA			0x0002
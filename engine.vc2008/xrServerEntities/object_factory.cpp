@@ -27,3 +27,10 @@ void CObjectFactory::init		()
 {
 	register_script_classes		();
 }
+
+#if defined(DEDICATED_SERVER_ONLY) && !defined(NO_XR_GAME)
+bool CObjectFactory::script_class	(const CLASS_ID &clsid) const
+{
+	return						(false);
+}
+#endif // #if defined(DEDICATED_SERVER_ONLY) && !defined(NO_XR_GAME)
@@ -84,6 +84,10 @@ public:
 #endif
 
 	IC		int							script_clsid					(const CLASS_ID &clsid) const;
+#ifndef NO_XR_GAME
+	// the objects of the class are created by the scripts, their virtual functions may call the scripts
+			bool						script_class					(const CLASS_ID &clsid) const;
+#endif
 			void						register_script					() const;
 			void						register_script_class			(LPCSTR client_class, LPCSTR server_class, LPCSTR clsid, LPCSTR script_clsid);
 			void						register_script_class			(LPCSTR unknown_class, LPCSTR clsid, LPCSTR script_clsid);
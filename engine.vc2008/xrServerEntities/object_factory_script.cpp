@@ -91,6 +91,13 @@ void CObjectFactory::register_script	() const
 	luabind::module				(ai().script_engine().lua())[instance];
 }
 
+#ifndef NO_XR_GAME
+bool CObjectFactory::script_class	(const CLASS_ID &clsid) const
+{
+	return						(!!dynamic_cast<const CObjectItemScript*>(&item(clsid)));
+}
+#endif // NO_XR_GAME
+
 #pragma optimize("s",on)
 void CObjectFactory::script_register(lua_State *L)
 {
@@ -77,6 +77,8 @@ enum {
 	M_SECURE_MESSAGE,
 	M_CREATE_PLAYER_STATE,
 	M_COMPRESSED_UPDATE_OBJECTS,
+	M_UPDATE_OBJECTS_DELTA,			// per-client updates, against the acknowledged ones
+	M_CL_UPDATES_ACK,				// acknowledges M_UPDATE_OBJECTS_DELTA
 
 	MSG_FORCEDWORD				= u32(-1)
 };